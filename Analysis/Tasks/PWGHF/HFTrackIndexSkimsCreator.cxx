@@ -30,6 +30,7 @@
 #include "AnalysisTasksUtils/UtilsDebugLcK0Sp.h"
 
 #include <algorithm>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -350,6 +351,8 @@ struct HfTrackIndexSkimsCreator {
   Configurable<double> d_minrelchi2change{"d_minrelchi2change", 0.9, "stop iterations if chi2/chi2old > this"};
   Configurable<HFTrackIndexSkimsCreatorConfigs> configs{"configs", {}, "configurables"};
   Configurable<bool> b_debug{"b_debug", false, "debug mode"};
+  Configurable<int> nThreadsFit{"nThreadsFit", 1, "number of threads for the secondary-vertex fits of a collision (needs OpenMP)"};
+  Configurable<int> nCombinationsFit{"nCombinationsFit", 10000, "number of buffered combinations fitted at once, bounds the memory of the buffers"};
 
   HistogramRegistry registry{
     "registry",
@@ -379,15 +382,80 @@ struct HfTrackIndexSkimsCreator {
   using SelectedCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::HFSelCollision>>;
   using SelectedTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TracksCov, aod::TracksExtra, aod::HFSelTrack>>;
 
-  // FIXME
-  //Partition<SelectedTracks> tracksPos = aod::track::signed1Pt > 0.f;
-  //Partition<SelectedTracks> tracksNeg = aod::track::signed1Pt < 0.f;
+  static constexpr int n2ProngDecays = hf_cand_prong2::DecayType::N2ProngDecays; // number of 2-prong hadron types
+  static constexpr int n3ProngDecays = hf_cand_prong3::DecayType::N3ProngDecays; // number of 3-prong hadron types
+  static constexpr int nCuts2Prong = 4;                                          // how many different selections are made on 2-prongs
+  static constexpr int nCuts3Prong = 4;                                          // how many different selections are made on 3-prongs
+
+  /// track of the collision selected for vertexing
+  struct SelectedTrack {
+    int64_t globalIndex;
+    int isSelProng;
+    float dcaPrim0;
+    array<float, 3> pVec;
+  };
+
+  /// combination of N tracks passing the selections applied before the vertex fit
+  template <int N, int nDecays, int nCuts>
+  struct Candidate {
+    int isSelected;                               // bitmap of the hadron types for which the combination is selected
+    array<double, nDecays> massHypo1;             // invariant masses with the first mass hypothesis
+    array<double, nDecays> massHypo2;             // invariant masses with the second mass hypothesis
+    array<array<bool, nCuts>, nDecays> cutStatus; // status of each selection, for the debug mode
+    bool isFitted = false;                        // secondary vertex found
+    array<double, 3> secondaryVertex;             // secondary vertex
+    array<array<float, 3>, N> pVec;               // prong momenta at the secondary vertex
+  };
+  using Candidate2Prong = Candidate<2, n2ProngDecays, nCuts2Prong>;
+  using Candidate3Prong = Candidate<3, n3ProngDecays, nCuts3Prong>;
 
   double massPi = RecoDecay::getMassPDG(kPiPlus);
   double massK = RecoDecay::getMassPDG(kKPlus);
   double massProton = RecoDecay::getMassPDG(kProton);
   double massElectron = RecoDecay::getMassPDG(kElectron);
 
+  // per-collision buffers, kept to reuse their memory. The combinations are flushed every nCombinationsFit
+  std::vector<SelectedTrack> selectedTracks;                                 // tracks selected for 2-prong or 3-prong vertexing
+  std::vector<o2::track::TrackParCov> selectedTrackParVars;                  // their parametrisations
+  std::vector<int> selectedTracksPos;                                        // indices of the positive selected tracks
+  std::vector<int> selectedTracksNeg;                                        // indices of the negative selected tracks
+  std::vector<o2::vertexing::DCAFitterN<2>::Combination> combinations2Prong; // 2-prong combinations to fit
+  std::vector<Candidate2Prong> candidates2Prong;                             // and their selection status
+  std::vector<o2::vertexing::DCAFitterN<3>::Combination> combinations3Prong; // 3-prong combinations to fit
+  std::vector<Candidate3Prong> candidates3Prong;                             // and their selection status
+
+  /// Stores the secondary vertex and the prong momenta at it of a fitted combination
+  template <typename T, typename F>
+  static void setFittedVertex(T& cand, F& fitter)
+  {
+    const auto& secondaryVertex = fitter.getPCACandidate();
+    cand.isFitted = true;
+    cand.secondaryVertex = array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]};
+    for (size_t iProng = 0; iProng < cand.pVec.size(); ++iProng) {
+      fitter.getTrack(iProng).getPxPyPzGlo(cand.pVec[iProng]);
+    }
+  }
+
+  /// Dispatches the fits of a batch of combinations to nThreadsFit threads, each with its own copy of the fitter
+  template <typename F>
+  auto fitInThreads(const F& fitter) const
+  {
+    return [&fitter, nThreads = nThreadsFit.value](int nComb, auto&& fitComb) {
+#ifdef WITH_OPENMP
+#pragma omp parallel num_threads(nThreads)
+#endif
+      {
+        F threadFitter = fitter;
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+        for (int iComb = 0; iComb < nComb; iComb++) {
+          fitComb(threadFitter, iComb);
+        }
+      }
+    };
+  }
+
   // int nColls{0}; //can be added to run over limited collisions per file - for tesing purposes
 
   void process( //soa::Join<aod::Collisions, aod::Cents>::iterator const& collision, //FIXME add centrality when option for variations to the process function appears
@@ -410,14 +478,10 @@ struct HfTrackIndexSkimsCreator {
 
     //auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
 
-    //FIXME move above process function
-    const int n2ProngDecays = hf_cand_prong2::DecayType::N2ProngDecays; // number of 2-prong hadron types
-    const int n3ProngDecays = hf_cand_prong3::DecayType::N3ProngDecays; // number of 3-prong hadron types
-    int n2ProngBit = (1 << n2ProngDecays) - 1;                          // bit value for 2-prong candidates where each candidiate is one bit and they are all set to 1
-    int n3ProngBit = (1 << n3ProngDecays) - 1;                          // bit value for 3-prong candidates where each candidiate is one bit and they are all set to 1
+    int n2ProngBit = (1 << n2ProngDecays) - 1; // bit value for 2-prong candidates where each candidiate is one bit and they are all set to 1
+    int n3ProngBit = (1 << n3ProngDecays) - 1; // bit value for 3-prong candidates where each candidiate is one bit and they are all set to 1
 
     //retrieve cuts from json - to be made pT dependent when option appears in json
-    const int nCuts2Prong = 4; // how many different selections are made on 2-prongs
     double cut2ProngPtCandMin[n2ProngDecays];
     double cut2ProngInvMassCandMin[n2ProngDecays];
     double cut2ProngInvMassCandMax[n2ProngDecays];
@@ -436,7 +500,6 @@ struct HfTrackIndexSkimsCreator {
     cut2ProngCPACandMin[hf_cand_prong2::DecayType::JpsiToEE] = configs->mCPAJpsiToEEMin;
     cut2ProngImpParProductCandMax[hf_cand_prong2::DecayType::JpsiToEE] = configs->mImpParProductJpsiToEEMax;
 
-    const int nCuts3Prong = 4; // how many different selections are made on 3-prongs
     double cut3ProngPtCandMin[n3ProngDecays];
     double cut3ProngInvMassCandMin[n3ProngDecays];
     double cut3ProngInvMassCandMax[n3ProngDecays];
@@ -467,8 +530,6 @@ struct HfTrackIndexSkimsCreator {
     cut3ProngCPACandMin[hf_cand_prong3::DecayType::XicToPKPi] = configs->mCPAXicToPKPiMin;
     cut3ProngDecLenCandMin[hf_cand_prong3::DecayType::XicToPKPi] = configs->mDecLenXicToPKPiMin;
 
-    bool cutStatus2Prong[n2ProngDecays][nCuts2Prong];
-    bool cutStatus3Prong[n3ProngDecays][nCuts3Prong];
     int nCutStatus2ProngBit = (1 << nCuts2Prong) - 1; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
     int nCutStatus3ProngBit = (1 << nCuts3Prong) - 1; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
 
@@ -492,12 +553,6 @@ struct HfTrackIndexSkimsCreator {
     arr3Mass2[hf_cand_prong3::DecayType::DsToPiKK] = array{massPi, massK, massK};
     arr3Mass2[hf_cand_prong3::DecayType::XicToPKPi] = array{massPi, massK, massProton};
 
-    double mass2ProngHypo1[n2ProngDecays];
-    double mass2ProngHypo2[n2ProngDecays];
-
-    double mass3ProngHypo1[n3ProngDecays];
-    double mass3ProngHypo2[n3ProngDecays];
-
     // 2-prong vertex fitter
     o2::vertexing::DCAFitterN<2> df2;
     df2.setBz(d_bz);
@@ -522,523 +577,339 @@ struct HfTrackIndexSkimsCreator {
     auto nCand2 = rowTrackIndexProng2.lastIndex();
     auto nCand3 = rowTrackIndexProng3.lastIndex();
 
-    // first loop over positive tracks
-    //for (auto trackPos1 = tracksPos.begin(); trackPos1 != tracksPos.end(); ++trackPos1) {
-    for (auto trackPos1 = tracks.begin(); trackPos1 != tracks.end(); ++trackPos1) {
-      if (trackPos1.signed1Pt() < 0) {
-        continue;
-      }
-      bool sel2ProngStatusPos = trackPos1.isSelProng() & (1 << 0);
-      bool sel3ProngStatusPos1 = trackPos1.isSelProng() & (1 << 1);
-      if (!sel2ProngStatusPos && !sel3ProngStatusPos1) {
+    // index of the tracks selected for 2-prong or 3-prong vertexing, split by charge and kept in table order,
+    // so that the track parametrisations are built once per collision rather than once per combination
+    selectedTracks.clear();
+    selectedTrackParVars.clear();
+    selectedTracksPos.clear();
+    selectedTracksNeg.clear();
+    for (const auto& track : tracks) {
+      if (!(track.isSelProng() & ((1 << 0) | (1 << 1)))) {
         continue;
       }
+      (track.signed1Pt() < 0 ? selectedTracksNeg : selectedTracksPos).push_back(selectedTracks.size());
+      selectedTracks.push_back({track.globalIndex(), track.isSelProng(), track.dcaPrim0(), array<float, 3>{track.px(), track.py(), track.pz()}});
+      selectedTrackParVars.push_back(getTrackParCov(track));
+    }
 
-      auto trackParVarPos1 = getTrackParCov(trackPos1);
+    // the combinations are fitted and selected whenever this many of them are buffered
+    const size_t nCombinationsMax = std::max(1, nCombinationsFit.value);
 
-      // first loop over negative tracks
-      //for (auto trackNeg1 = tracksNeg.begin(); trackNeg1 != tracksNeg.end(); ++trackNeg1) {
-      for (auto trackNeg1 = tracks.begin(); trackNeg1 != tracks.end(); ++trackNeg1) {
-        if (trackNeg1.signed1Pt() > 0) {
-          continue;
-        }
-        bool sel2ProngStatusNeg = trackNeg1.isSelProng() & (1 << 0);
-        bool sel3ProngStatusNeg1 = trackNeg1.isSelProng() & (1 << 1);
-        if (!sel2ProngStatusNeg && !sel3ProngStatusNeg1) {
+    // secondary vertex reconstruction of the buffered 2-prong combinations and further selections, in the order
+    // of the combinations. The fits of the combinations are independent and can be run concurrently
+    auto fitAndSelect2Prong = [&]() {
+      df2.processBatch(selectedTrackParVars, combinations2Prong, [this](int iComb, auto& fitter) { setFittedVertex(candidates2Prong[iComb], fitter); }, fitInThreads(df2));
+      for (size_t iComb = 0; iComb < candidates2Prong.size(); ++iComb) {
+        auto& cand = candidates2Prong[iComb];
+        if (!cand.isFitted) {
           continue;
         }
+        const auto& trackPos1 = selectedTracks[combinations2Prong[iComb][0]];
+        const auto& trackNeg1 = selectedTracks[combinations2Prong[iComb][1]];
+        int iDebugCut = 1;
 
-        auto trackParVarNeg1 = getTrackParCov(trackNeg1);
+        auto pVecCandProng2 = RecoDecay::PVec(cand.pVec[0], cand.pVec[1]);
 
-        int isSelected2ProngCand = n2ProngBit; //bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+        // candidate pT cut
+        if ((b_debug || cand.isSelected > 0) && (std::count_if(std::begin(cut2ProngPtCandMin), std::end(cut2ProngPtCandMin), [](double d) { return d >= 0.; }) > 0)) {
+          double cand2ProngPt = RecoDecay::Pt(pVecCandProng2);
+          for (int n2 = 0; n2 < n2ProngDecays; n2++) {
+            if ((b_debug || (cand.isSelected & 1 << n2)) && cand2ProngPt < cut2ProngPtCandMin[n2]) {
+              cand.isSelected = cand.isSelected & ~(1 << n2);
+              cand.cutStatus[n2][iDebugCut] = false;
+            }
+          }
+        }
+        iDebugCut++;
 
-        if (b_debug) {
+        // imp. par. product cut
+        if ((b_debug || cand.isSelected > 0) && (std::count_if(std::begin(cut2ProngImpParProductCandMax), std::end(cut2ProngImpParProductCandMax), [](double d) { return d < 100.; }) > 0)) {
+          auto impParProduct = trackPos1.dcaPrim0 * trackNeg1.dcaPrim0;
           for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-            for (int n2cut = 0; n2cut < nCuts2Prong; n2cut++) {
-              cutStatus2Prong[n2][n2cut] = true;
+            if ((b_debug || (cand.isSelected & 1 << n2)) && impParProduct > cut2ProngImpParProductCandMax[n2]) {
+              cand.isSelected = cand.isSelected & ~(1 << n2);
+              cand.cutStatus[n2][iDebugCut] = false;
             }
           }
         }
-        int iDebugCut = 0;
+        iDebugCut++;
 
-        // 2-prong vertex reconstruction
-        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+        // CPA cut
+        if ((b_debug || cand.isSelected > 0) && (std::count_if(std::begin(cut2ProngCPACandMin), std::end(cut2ProngCPACandMin), [](double d) { return d > -2.; }) > 0)) {
+          auto cpa = RecoDecay::CPA(array{collision.posX(), collision.posY(), collision.posZ()}, cand.secondaryVertex, pVecCandProng2);
+          for (int n2 = 0; n2 < n2ProngDecays; n2++) {
+            if ((b_debug || (cand.isSelected & 1 << n2)) && cpa < cut2ProngCPACandMin[n2]) {
+              cand.isSelected = cand.isSelected & ~(1 << n2);
+              cand.cutStatus[n2][iDebugCut] = false;
+            }
+          }
+        }
+        iDebugCut++;
 
-          // invariant-mass cut
-          auto arrMom = array{
-            array{trackPos1.px(), trackPos1.py(), trackPos1.pz()},
-            array{trackNeg1.px(), trackNeg1.py(), trackNeg1.pz()}};
+        if (cand.isSelected == 0) {
+          continue;
+        }
+
+        // fill table row
+        rowTrackIndexProng2(trackPos1.globalIndex,
+                            trackNeg1.globalIndex, cand.isSelected);
+        if (b_debug) {
+          int Prong2CutStatus[n2ProngDecays];
           for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-            mass2ProngHypo1[n2] = RecoDecay::M(arrMom, arr2Mass1[n2]);
-            mass2ProngHypo2[n2] = RecoDecay::M(arrMom, arr2Mass2[n2]);
-            if ((b_debug || (isSelected2ProngCand & 1 << n2)) && cut2ProngInvMassCandMin[n2] >= 0. && cut2ProngInvMassCandMax[n2] > 0.) { //no need to check isSelected2Prong but to avoid mistakes
-              if ((mass2ProngHypo1[n2] < cut2ProngInvMassCandMin[n2] || mass2ProngHypo1[n2] >= cut2ProngInvMassCandMax[n2]) &&
-                  (mass2ProngHypo2[n2] < cut2ProngInvMassCandMin[n2] || mass2ProngHypo2[n2] >= cut2ProngInvMassCandMax[n2])) {
-                isSelected2ProngCand = isSelected2ProngCand & ~(1 << n2);
-                if (b_debug) {
-                  cutStatus2Prong[n2][iDebugCut] = false;
-                }
+            Prong2CutStatus[n2] = nCutStatus2ProngBit;
+            for (int n2cut = 0; n2cut < nCuts2Prong; n2cut++) {
+              if (!cand.cutStatus[n2][n2cut]) {
+                Prong2CutStatus[n2] = Prong2CutStatus[n2] & ~(1 << n2cut);
               }
             }
           }
-          iDebugCut++;
-
-          // secondary vertex reconstruction and further 2-prong selections
-          if (isSelected2ProngCand > 0 && df2.process(trackParVarPos1, trackParVarNeg1) > 0) { //should it be this or > 0 or are they equivalent
-            // get secondary vertex
-            const auto& secondaryVertex2 = df2.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            df2.getTrack(0).getPxPyPzGlo(pvec0);
-            df2.getTrack(1).getPxPyPzGlo(pvec1);
-
-            auto pVecCandProng2 = RecoDecay::PVec(pvec0, pvec1);
-
-            // candidate pT cut
-            if ((b_debug || isSelected2ProngCand > 0) && (std::count_if(std::begin(cut2ProngPtCandMin), std::end(cut2ProngPtCandMin), [](double d) { return d >= 0.; }) > 0)) {
-              double cand2ProngPt = RecoDecay::Pt(pVecCandProng2);
-              for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-                if ((b_debug || (isSelected2ProngCand & 1 << n2)) && cand2ProngPt < cut2ProngPtCandMin[n2]) {
-                  isSelected2ProngCand = isSelected2ProngCand & ~(1 << n2);
-                  if (b_debug) {
-                    cutStatus2Prong[n2][iDebugCut] = false;
-                  }
+          rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1]); //FIXME when we can do this by looping over n2ProngDecays
+        }
+
+        // fill histograms
+        if (fillHistograms) {
+
+          registry.get<TH1>(HIST("hvtx2_x"))->Fill(cand.secondaryVertex[0]);
+          registry.get<TH1>(HIST("hvtx2_y"))->Fill(cand.secondaryVertex[1]);
+          registry.get<TH1>(HIST("hvtx2_z"))->Fill(cand.secondaryVertex[2]);
+          for (int n2 = 0; n2 < n2ProngDecays; n2++) {
+            if (cand.isSelected & 1 << n2) {
+              if ((cut2ProngInvMassCandMin[n2] < 0. && cut2ProngInvMassCandMax[n2] <= 0.) || (cand.massHypo1[n2] >= cut2ProngInvMassCandMin[n2] && cand.massHypo1[n2] < cut2ProngInvMassCandMax[n2])) {
+                cand.massHypo1[n2] = RecoDecay::M(cand.pVec, arr2Mass1[n2]);
+                if (n2 == hf_cand_prong2::DecayType::D0ToPiK) {
+                  registry.get<TH1>(HIST("hmassD0ToPiK"))->Fill(cand.massHypo1[n2]);
                 }
-              }
-            }
-            iDebugCut++;
-
-            // imp. par. product cut
-            if ((b_debug || isSelected2ProngCand > 0) && (std::count_if(std::begin(cut2ProngImpParProductCandMax), std::end(cut2ProngImpParProductCandMax), [](double d) { return d < 100.; }) > 0)) {
-              auto impParProduct = trackPos1.dcaPrim0() * trackNeg1.dcaPrim0();
-              for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-                if ((b_debug || (isSelected2ProngCand & 1 << n2)) && impParProduct > cut2ProngImpParProductCandMax[n2]) {
-                  isSelected2ProngCand = isSelected2ProngCand & ~(1 << n2);
-                  if (b_debug) {
-                    cutStatus2Prong[n2][iDebugCut] = false;
-                  }
+                if (n2 == hf_cand_prong2::DecayType::JpsiToEE) {
+                  registry.get<TH1>(HIST("hmassJpsiToEE"))->Fill(cand.massHypo1[n2]);
                 }
               }
-            }
-            iDebugCut++;
-
-            // CPA cut
-            if ((b_debug || isSelected2ProngCand > 0) && (std::count_if(std::begin(cut2ProngCPACandMin), std::end(cut2ProngCPACandMin), [](double d) { return d > -2.; }) > 0)) {
-              auto cpa = RecoDecay::CPA(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex2, pVecCandProng2);
-              for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-                if ((b_debug || (isSelected2ProngCand & 1 << n2)) && cpa < cut2ProngCPACandMin[n2]) {
-                  isSelected2ProngCand = isSelected2ProngCand & ~(1 << n2);
-                  if (b_debug) {
-                    cutStatus2Prong[n2][iDebugCut] = false;
-                  }
+              if ((cut2ProngInvMassCandMin[n2] < 0. && cut2ProngInvMassCandMax[n2] <= 0.) || (cand.massHypo2[n2] >= cut2ProngInvMassCandMin[n2] && cand.massHypo2[n2] < cut2ProngInvMassCandMax[n2])) {
+                cand.massHypo2[n2] = RecoDecay::M(cand.pVec, arr2Mass2[n2]);
+                if (n2 == hf_cand_prong2::DecayType::D0ToPiK) {
+                  registry.get<TH1>(HIST("hmassD0ToPiK"))->Fill(cand.massHypo1[n2]);
                 }
               }
             }
-            iDebugCut++;
-
-            if (isSelected2ProngCand > 0) {
-              // fill table row
-              rowTrackIndexProng2(trackPos1.globalIndex(),
-                                  trackNeg1.globalIndex(), isSelected2ProngCand);
-              if (b_debug) {
-                int Prong2CutStatus[n2ProngDecays];
-                for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-                  Prong2CutStatus[n2] = nCutStatus2ProngBit;
-                  for (int n2cut = 0; n2cut < nCuts2Prong; n2cut++) {
-                    if (!cutStatus2Prong[n2][n2cut]) {
-                      Prong2CutStatus[n2] = Prong2CutStatus[n2] & ~(1 << n2cut);
-                    }
-                  }
-                }
-                rowProng2CutStatus(Prong2CutStatus[0], Prong2CutStatus[1]); //FIXME when we can do this by looping over n2ProngDecays
-              }
+          }
+        }
+      }
+      combinations2Prong.clear();
+      candidates2Prong.clear();
+    };
+
+    // same for the buffered 3-prong combinations
+    auto fitAndSelect3Prong = [&]() {
+      df3.processBatch(selectedTrackParVars, combinations3Prong, [this](int iComb, auto& fitter) { setFittedVertex(candidates3Prong[iComb], fitter); }, fitInThreads(df3));
+      for (size_t iComb = 0; iComb < candidates3Prong.size(); ++iComb) {
+        auto& cand = candidates3Prong[iComb];
+        if (!cand.isFitted) {
+          continue;
+        }
+        int iDebugCut = 1;
 
-              // fill histograms
-              if (fillHistograms) {
-
-                registry.get<TH1>(HIST("hvtx2_x"))->Fill(secondaryVertex2[0]);
-                registry.get<TH1>(HIST("hvtx2_y"))->Fill(secondaryVertex2[1]);
-                registry.get<TH1>(HIST("hvtx2_z"))->Fill(secondaryVertex2[2]);
-                arrMom = array{pvec0, pvec1};
-                for (int n2 = 0; n2 < n2ProngDecays; n2++) {
-                  if (isSelected2ProngCand & 1 << n2) {
-                    if ((cut2ProngInvMassCandMin[n2] < 0. && cut2ProngInvMassCandMax[n2] <= 0.) || (mass2ProngHypo1[n2] >= cut2ProngInvMassCandMin[n2] && mass2ProngHypo1[n2] < cut2ProngInvMassCandMax[n2])) {
-                      mass2ProngHypo1[n2] = RecoDecay::M(arrMom, arr2Mass1[n2]);
-                      if (n2 == hf_cand_prong2::DecayType::D0ToPiK) {
-                        registry.get<TH1>(HIST("hmassD0ToPiK"))->Fill(mass2ProngHypo1[n2]);
-                      }
-                      if (n2 == hf_cand_prong2::DecayType::JpsiToEE) {
-                        registry.get<TH1>(HIST("hmassJpsiToEE"))->Fill(mass2ProngHypo1[n2]);
-                      }
-                    }
-                    if ((cut2ProngInvMassCandMin[n2] < 0. && cut2ProngInvMassCandMax[n2] <= 0.) || (mass2ProngHypo2[n2] >= cut2ProngInvMassCandMin[n2] && mass2ProngHypo2[n2] < cut2ProngInvMassCandMax[n2])) {
-                      mass2ProngHypo2[n2] = RecoDecay::M(arrMom, arr2Mass2[n2]);
-                      if (n2 == hf_cand_prong2::DecayType::D0ToPiK) {
-                        registry.get<TH1>(HIST("hmassD0ToPiK"))->Fill(mass2ProngHypo1[n2]);
-                      }
-                    }
-                  }
-                }
-              }
+        auto pVecCandProng3 = RecoDecay::PVec(cand.pVec[0], cand.pVec[1], cand.pVec[2]);
+
+        // candidate pT cut
+        if (std::count_if(std::begin(cut3ProngPtCandMin), std::end(cut3ProngPtCandMin), [](double d) { return d >= 0.; }) > 0) {
+          double cand3ProngPt = RecoDecay::Pt(pVecCandProng3);
+          for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+            if (cand3ProngPt < cut3ProngPtCandMin[n3]) {
+              cand.isSelected = cand.isSelected & ~(1 << n3);
+              cand.cutStatus[n3][iDebugCut] = false;
             }
           }
+          if (!b_debug && cand.isSelected == 0) {
+            continue; //this and all further instances should be changed if 4 track loop is added
+          }
         }
-
-        // 3-prong vertex reconstruction
-        if (do3prong == 1) {
-          if (!sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
+        iDebugCut++;
+
+        // CPA cut
+        if (std::count_if(std::begin(cut3ProngCPACandMin), std::end(cut3ProngCPACandMin), [](double d) { return d > -2.; }) > 0) {
+          auto cpa = RecoDecay::CPA(array{collision.posX(), collision.posY(), collision.posZ()}, cand.secondaryVertex, pVecCandProng3);
+          for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+            if ((cand.isSelected & 1 << n3) && cpa < cut3ProngCPACandMin[n3]) {
+              cand.isSelected = cand.isSelected & ~(1 << n3);
+              cand.cutStatus[n3][iDebugCut] = false;
+            }
+          }
+          if (!b_debug && cand.isSelected == 0) {
             continue;
           }
-
-          // second loop over positive tracks
-          //for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracksPos.end(); ++trackPos2) {
-          for (auto trackPos2 = trackPos1 + 1; trackPos2 != tracks.end(); ++trackPos2) {
-            if (trackPos2.signed1Pt() < 0) {
-              continue;
-            }
-            if (!(trackPos2.isSelProng() & (1 << 1))) {
-              continue;
+        }
+        iDebugCut++;
+
+        // decay length cut
+        if (std::count_if(std::begin(cut3ProngDecLenCandMin), std::end(cut3ProngDecLenCandMin), [](double d) { return d > 0.; }) > 0) {
+          auto decayLength = RecoDecay::distance(array{collision.posX(), collision.posY(), collision.posZ()}, cand.secondaryVertex);
+          for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+            if ((cand.isSelected & 1 << n3) && decayLength < cut3ProngDecLenCandMin[n3]) {
+              cand.isSelected = cand.isSelected & ~(1 << n3);
+              cand.cutStatus[n3][iDebugCut] = false;
             }
+          }
+          if (!b_debug && cand.isSelected == 0) {
+            continue;
+          }
+        }
+        iDebugCut++;
 
-            int isSelected3ProngCand = n3ProngBit;
+        // fill table row
+        rowTrackIndexProng3(selectedTracks[combinations3Prong[iComb][0]].globalIndex,
+                            selectedTracks[combinations3Prong[iComb][1]].globalIndex,
+                            selectedTracks[combinations3Prong[iComb][2]].globalIndex, cand.isSelected);
 
-            if (b_debug) {
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                for (int n3cut = 0; n3cut < nCuts3Prong; n3cut++) {
-                  cutStatus3Prong[n3][n3cut] = true;
-                }
-              }
-            }
-            int iDebugCut = 0;
-
-            // 3-prong invariant-mass cut
-            auto arr3Mom = array{
-              array{trackPos1.px(), trackPos1.py(), trackPos1.pz()},
-              array{trackNeg1.px(), trackNeg1.py(), trackNeg1.pz()},
-              array{trackPos2.px(), trackPos2.py(), trackPos2.pz()}};
-
-            for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-              mass3ProngHypo1[n3] = RecoDecay::M(arr3Mom, arr3Mass1[n3]);
-              mass3ProngHypo2[n3] = RecoDecay::M(arr3Mom, arr3Mass2[n3]);
-              if ((isSelected3ProngCand & 1 << n3) && cut3ProngInvMassCandMin[n3] >= 0. && cut3ProngInvMassCandMax[n3] > 0.) {
-                if ((mass3ProngHypo1[n3] < cut3ProngInvMassCandMin[n3] || mass3ProngHypo1[n3] >= cut3ProngInvMassCandMax[n3]) &&
-                    (mass3ProngHypo2[n3] < cut3ProngInvMassCandMin[n3] || mass3ProngHypo2[n3] >= cut3ProngInvMassCandMax[n3])) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
-                }
+        if (b_debug) {
+          int Prong3CutStatus[n3ProngDecays];
+          for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+            Prong3CutStatus[n3] = nCutStatus3ProngBit;
+            for (int n3cut = 0; n3cut < nCuts3Prong; n3cut++) {
+              if (!cand.cutStatus[n3][n3cut]) {
+                Prong3CutStatus[n3] = Prong3CutStatus[n3] & ~(1 << n3cut);
               }
             }
-            if (!b_debug && isSelected3ProngCand == 0) {
-              continue;
-            }
-            iDebugCut++;
+          }
+          rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); //FIXME when we can do this by looping over n3ProngDecays
+        }
 
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarPos2 = getTrackParCov(trackPos2);
-            if (df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2) == 0) {
-              continue;
-            }
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            auto pVecCandProng3Pos = RecoDecay::PVec(pvec0, pvec1, pvec2);
-
-            // candidate pT cut
-            if (std::count_if(std::begin(cut3ProngPtCandMin), std::end(cut3ProngPtCandMin), [](double d) { return d >= 0.; }) > 0) {
-              double cand3ProngPt = RecoDecay::Pt(pVecCandProng3Pos);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if (cand3ProngPt < cut3ProngPtCandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
+        // fill histograms
+        if (fillHistograms) {
+
+          registry.get<TH1>(HIST("hvtx3_x"))->Fill(cand.secondaryVertex[0]);
+          registry.get<TH1>(HIST("hvtx3_y"))->Fill(cand.secondaryVertex[1]);
+          registry.get<TH1>(HIST("hvtx3_z"))->Fill(cand.secondaryVertex[2]);
+          for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+            if (cand.isSelected & 1 << n3) {
+              if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (cand.massHypo1[n3] >= cut3ProngInvMassCandMin[n3] && cand.massHypo1[n3] < cut3ProngInvMassCandMax[n3])) {
+                cand.massHypo1[n3] = RecoDecay::M(cand.pVec, arr3Mass1[n3]);
+                if (n3 == hf_cand_prong3::DecayType::DPlusToPiKPi) {
+                  registry.get<TH1>(HIST("hmassDPlusToPiKPi"))->Fill(cand.massHypo1[n3]);
                 }
-                if (b_debug) {
-                  cutStatus3Prong[n3][iDebugCut] = false;
+                if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
+                  registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(cand.massHypo1[n3]);
                 }
-              }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue; //this and all further instances should be changed if 4 track loop is added
-              }
-            }
-            iDebugCut++;
-
-            // CPA cut
-            if (std::count_if(std::begin(cut3ProngCPACandMin), std::end(cut3ProngCPACandMin), [](double d) { return d > -2.; }) > 0) {
-              auto cpa = RecoDecay::CPA(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex3, pVecCandProng3Pos);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if ((isSelected3ProngCand & 1 << n3) && cpa < cut3ProngCPACandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
+                if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
+                  registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(cand.massHypo1[n3]);
                 }
-                if (b_debug) {
-                  cutStatus3Prong[n3][iDebugCut] = false;
+                if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
+                  registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(cand.massHypo1[n3]);
                 }
               }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue;
-              }
-            }
-            iDebugCut++;
-
-            // decay length cut
-            if (std::count_if(std::begin(cut3ProngDecLenCandMin), std::end(cut3ProngDecLenCandMin), [](double d) { return d > 0.; }) > 0) {
-              auto decayLength = RecoDecay::distance(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex3);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if ((isSelected3ProngCand & 1 << n3) && decayLength < cut3ProngDecLenCandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
+              if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (cand.massHypo2[n3] >= cut3ProngInvMassCandMin[n3] && cand.massHypo2[n3] < cut3ProngInvMassCandMax[n3])) {
+                cand.massHypo2[n3] = RecoDecay::M(cand.pVec, arr3Mass2[n3]);
+                if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
+                  registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(cand.massHypo2[n3]);
                 }
-              }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue;
-              }
-            }
-            iDebugCut++;
-
-            // fill table row
-            rowTrackIndexProng3(trackPos1.globalIndex(),
-                                trackNeg1.globalIndex(),
-                                trackPos2.globalIndex(), isSelected3ProngCand);
-
-            if (b_debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                Prong3CutStatus[n3] = nCutStatus3ProngBit;
-                for (int n3cut = 0; n3cut < nCuts3Prong; n3cut++) {
-                  if (!cutStatus3Prong[n3][n3cut]) {
-                    Prong3CutStatus[n3] = Prong3CutStatus[n3] & ~(1 << n3cut);
-                  }
+                if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
+                  registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(cand.massHypo2[n3]);
                 }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); //FIXME when we can do this by looping over n3ProngDecays
-            }
-
-            // fill histograms
-            if (fillHistograms) {
-
-              registry.get<TH1>(HIST("hvtx3_x"))->Fill(secondaryVertex3[0]);
-              registry.get<TH1>(HIST("hvtx3_y"))->Fill(secondaryVertex3[1]);
-              registry.get<TH1>(HIST("hvtx3_z"))->Fill(secondaryVertex3[2]);
-              arr3Mom = array{pvec0, pvec1, pvec2};
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if (isSelected3ProngCand & 1 << n3) {
-                  if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (mass3ProngHypo1[n3] >= cut3ProngInvMassCandMin[n3] && mass3ProngHypo1[n3] < cut3ProngInvMassCandMax[n3])) {
-                    mass3ProngHypo1[n3] = RecoDecay::M(arr3Mom, arr3Mass1[n3]);
-                    if (n3 == hf_cand_prong3::DecayType::DPlusToPiKPi) {
-                      registry.get<TH1>(HIST("hmassDPlusToPiKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
-                      registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
-                      registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
-                      registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                  }
-                  if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (mass3ProngHypo2[n3] >= cut3ProngInvMassCandMin[n3] && mass3ProngHypo2[n3] < cut3ProngInvMassCandMax[n3])) {
-                    mass3ProngHypo2[n3] = RecoDecay::M(arr3Mom, arr3Mass2[n3]);
-                    if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
-                      registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
-                      registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
-                      registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                  }
+                if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
+                  registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(cand.massHypo2[n3]);
                 }
               }
             }
           }
+        }
+      }
+      combinations3Prong.clear();
+      candidates3Prong.clear();
+    };
+
+    // 3-prong invariant-mass cut, the combination is kept for the vertex fit if any hadron type survives (or in debug mode)
+    auto preselect3Prong = [&](int iTrack0, int iTrack1, int iTrack2) {
+      Candidate3Prong cand;
+      cand.isSelected = n3ProngBit;
+      auto arr3Mom = array{selectedTracks[iTrack0].pVec, selectedTracks[iTrack1].pVec, selectedTracks[iTrack2].pVec};
+      for (int n3 = 0; n3 < n3ProngDecays; n3++) {
+        cand.cutStatus[n3].fill(true);
+        cand.massHypo1[n3] = RecoDecay::M(arr3Mom, arr3Mass1[n3]);
+        cand.massHypo2[n3] = RecoDecay::M(arr3Mom, arr3Mass2[n3]);
+        if ((cand.isSelected & 1 << n3) && cut3ProngInvMassCandMin[n3] >= 0. && cut3ProngInvMassCandMax[n3] > 0.) {
+          if ((cand.massHypo1[n3] < cut3ProngInvMassCandMin[n3] || cand.massHypo1[n3] >= cut3ProngInvMassCandMax[n3]) &&
+              (cand.massHypo2[n3] < cut3ProngInvMassCandMin[n3] || cand.massHypo2[n3] >= cut3ProngInvMassCandMax[n3])) {
+            cand.isSelected = cand.isSelected & ~(1 << n3);
+            cand.cutStatus[n3][0] = false;
+          }
+        }
+      }
+      if (b_debug || cand.isSelected > 0) {
+        combinations3Prong.push_back({iTrack0, iTrack1, iTrack2});
+        candidates3Prong.push_back(cand);
+        if (combinations3Prong.size() >= nCombinationsMax) {
+          fitAndSelect3Prong();
+        }
+      }
+    };
 
-          // second loop over negative tracks
-          //for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracksNeg.end(); ++trackNeg2) {
-          for (auto trackNeg2 = trackNeg1 + 1; trackNeg2 != tracks.end(); ++trackNeg2) {
-            if (trackNeg2.signed1Pt() > 0) {
-              continue;
-            }
-            if (!(trackNeg2.isSelProng() & (1 << 1))) {
-              continue;
-            }
+    // build the 2-prong and 3-prong combinations passing the selections which do not need the secondary vertex
+    combinations2Prong.clear();
+    candidates2Prong.clear();
+    combinations3Prong.clear();
+    candidates3Prong.clear();
 
-            int isSelected3ProngCand = n3ProngBit;
+    // first loop over positive tracks
+    for (size_t iPos1 = 0; iPos1 < selectedTracksPos.size(); ++iPos1) {
+      const auto& trackPos1 = selectedTracks[selectedTracksPos[iPos1]];
+      bool sel2ProngStatusPos = trackPos1.isSelProng & (1 << 0);
+      bool sel3ProngStatusPos1 = trackPos1.isSelProng & (1 << 1);
 
-            if (b_debug) {
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                for (int n3cut = 0; n3cut < nCuts3Prong; n3cut++) {
-                  cutStatus3Prong[n3][n3cut] = true;
-                }
-              }
-            }
-            int iDebugCut = 0;
-
-            // 3-prong invariant-mass cut
-            auto arr3Mom = array{
-              array{trackNeg1.px(), trackNeg1.py(), trackNeg1.pz()},
-              array{trackPos1.px(), trackPos1.py(), trackPos1.pz()},
-              array{trackNeg2.px(), trackNeg2.py(), trackNeg2.pz()}};
-
-            for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-              mass3ProngHypo1[n3] = RecoDecay::M(arr3Mom, arr3Mass1[n3]);
-              mass3ProngHypo2[n3] = RecoDecay::M(arr3Mom, arr3Mass2[n3]);
-              if ((isSelected3ProngCand & 1 << n3) && cut3ProngInvMassCandMin[n3] >= 0. && cut3ProngInvMassCandMax[n3] > 0.) {
-                if ((mass3ProngHypo1[n3] < cut3ProngInvMassCandMin[n3] || mass3ProngHypo1[n3] >= cut3ProngInvMassCandMax[n3]) &&
-                    (mass3ProngHypo2[n3] < cut3ProngInvMassCandMin[n3] || mass3ProngHypo2[n3] >= cut3ProngInvMassCandMax[n3])) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
-                }
+      // first loop over negative tracks
+      for (size_t iNeg1 = 0; iNeg1 < selectedTracksNeg.size(); ++iNeg1) {
+        const auto& trackNeg1 = selectedTracks[selectedTracksNeg[iNeg1]];
+        bool sel2ProngStatusNeg = trackNeg1.isSelProng & (1 << 0);
+        bool sel3ProngStatusNeg1 = trackNeg1.isSelProng & (1 << 1);
+
+        // 2-prong invariant-mass cut
+        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+          Candidate2Prong cand;
+          cand.isSelected = n2ProngBit; //bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+          auto arrMom = array{trackPos1.pVec, trackNeg1.pVec};
+          for (int n2 = 0; n2 < n2ProngDecays; n2++) {
+            cand.cutStatus[n2].fill(true);
+            cand.massHypo1[n2] = RecoDecay::M(arrMom, arr2Mass1[n2]);
+            cand.massHypo2[n2] = RecoDecay::M(arrMom, arr2Mass2[n2]);
+            if ((b_debug || (cand.isSelected & 1 << n2)) && cut2ProngInvMassCandMin[n2] >= 0. && cut2ProngInvMassCandMax[n2] > 0.) { //no need to check isSelected2Prong but to avoid mistakes
+              if ((cand.massHypo1[n2] < cut2ProngInvMassCandMin[n2] || cand.massHypo1[n2] >= cut2ProngInvMassCandMax[n2]) &&
+                  (cand.massHypo2[n2] < cut2ProngInvMassCandMin[n2] || cand.massHypo2[n2] >= cut2ProngInvMassCandMax[n2])) {
+                cand.isSelected = cand.isSelected & ~(1 << n2);
+                cand.cutStatus[n2][0] = false;
               }
             }
-            if (!b_debug && isSelected3ProngCand == 0) {
-              continue;
+          }
+          if (cand.isSelected > 0) {
+            combinations2Prong.push_back({selectedTracksPos[iPos1], selectedTracksNeg[iNeg1]});
+            candidates2Prong.push_back(cand);
+            if (combinations2Prong.size() >= nCombinationsMax) {
+              fitAndSelect2Prong();
             }
-            iDebugCut++;
+          }
+        }
 
-            // reconstruct the 3-prong secondary vertex
-            auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-            if (df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2) == 0) {
-              continue;
-            }
+        // 3-prong combinations
+        if (do3prong != 1 || !sel3ProngStatusPos1 || !sel3ProngStatusNeg1) {
+          continue;
+        }
 
-            // get secondary vertex
-            const auto& secondaryVertex3 = df3.getPCACandidate();
-            // get track momenta
-            array<float, 3> pvec0;
-            array<float, 3> pvec1;
-            array<float, 3> pvec2;
-            df3.getTrack(0).getPxPyPzGlo(pvec0);
-            df3.getTrack(1).getPxPyPzGlo(pvec1);
-            df3.getTrack(2).getPxPyPzGlo(pvec2);
-
-            auto pVecCandProng3Neg = RecoDecay::PVec(pvec0, pvec1, pvec2);
-
-            // candidate pT cut
-            if (std::count_if(std::begin(cut3ProngPtCandMin), std::end(cut3ProngPtCandMin), [](double d) { return d >= 0.; }) > 0) {
-              double cand3ProngPt = RecoDecay::Pt(pVecCandProng3Neg);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if (cand3ProngPt < cut3ProngPtCandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
-                }
-              }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue;
-              }
-            }
-            iDebugCut++;
-
-            // CPA cut
-            if (std::count_if(std::begin(cut3ProngCPACandMin), std::end(cut3ProngCPACandMin), [](double d) { return d > -2.; }) > 0) {
-              auto cpa = RecoDecay::CPA(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex3, pVecCandProng3Neg);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if ((isSelected3ProngCand & 1 << n3) && cpa < cut3ProngCPACandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
-                }
-              }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue;
-              }
-            }
-            iDebugCut++;
-
-            // decay length cut
-            if (std::count_if(std::begin(cut3ProngDecLenCandMin), std::end(cut3ProngDecLenCandMin), [](double d) { return d > 0.; }) > 0) {
-              auto decayLength = RecoDecay::distance(array{collision.posX(), collision.posY(), collision.posZ()}, secondaryVertex3);
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if ((isSelected3ProngCand & 1 << n3) && decayLength < cut3ProngDecLenCandMin[n3]) {
-                  isSelected3ProngCand = isSelected3ProngCand & ~(1 << n3);
-                  if (b_debug) {
-                    cutStatus3Prong[n3][iDebugCut] = false;
-                  }
-                }
-              }
-              if (!b_debug && isSelected3ProngCand == 0) {
-                continue;
-              }
-            }
-            iDebugCut++;
-
-            // fill table row
-            rowTrackIndexProng3(trackNeg1.globalIndex(),
-                                trackPos1.globalIndex(),
-                                trackNeg2.globalIndex(), isSelected3ProngCand);
-
-            if (b_debug) {
-              int Prong3CutStatus[n3ProngDecays];
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                Prong3CutStatus[n3] = nCutStatus3ProngBit;
-                for (int n3cut = 0; n3cut < nCuts3Prong; n3cut++) {
-                  if (!cutStatus3Prong[n3][n3cut]) {
-                    Prong3CutStatus[n3] = Prong3CutStatus[n3] & ~(1 << n3cut);
-                  }
-                }
-              }
-              rowProng3CutStatus(Prong3CutStatus[0], Prong3CutStatus[1], Prong3CutStatus[2], Prong3CutStatus[3]); //FIXME when we can do this by looping over n3ProngDecays
-            }
+        // second loop over positive tracks
+        for (size_t iPos2 = iPos1 + 1; iPos2 < selectedTracksPos.size(); ++iPos2) {
+          if (selectedTracks[selectedTracksPos[iPos2]].isSelProng & (1 << 1)) {
+            preselect3Prong(selectedTracksPos[iPos1], selectedTracksNeg[iNeg1], selectedTracksPos[iPos2]);
+          }
+        }
 
-            // fill histograms
-            if (fillHistograms) {
-
-              registry.get<TH1>(HIST("hvtx3_x"))->Fill(secondaryVertex3[0]);
-              registry.get<TH1>(HIST("hvtx3_y"))->Fill(secondaryVertex3[1]);
-              registry.get<TH1>(HIST("hvtx3_z"))->Fill(secondaryVertex3[2]);
-              arr3Mom = array{pvec0, pvec1, pvec2};
-              for (int n3 = 0; n3 < n3ProngDecays; n3++) {
-                if (isSelected3ProngCand & 1 << n3) {
-                  if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (mass3ProngHypo1[n3] >= cut3ProngInvMassCandMin[n3] && mass3ProngHypo1[n3] < cut3ProngInvMassCandMax[n3])) {
-                    mass3ProngHypo1[n3] = RecoDecay::M(arr3Mom, arr3Mass1[n3]);
-                    if (n3 == hf_cand_prong3::DecayType::DPlusToPiKPi) {
-                      registry.get<TH1>(HIST("hmassDPlusToPiKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
-                      registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
-                      registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
-                      registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(mass3ProngHypo1[n3]);
-                    }
-                  }
-                  if ((cut3ProngInvMassCandMin[n3] < 0. && cut3ProngInvMassCandMax[n3] <= 0.) || (mass3ProngHypo2[n3] >= cut3ProngInvMassCandMin[n3] && mass3ProngHypo2[n3] < cut3ProngInvMassCandMax[n3])) {
-                    mass3ProngHypo2[n3] = RecoDecay::M(arr3Mom, arr3Mass2[n3]);
-                    if (n3 == hf_cand_prong3::DecayType::LcToPKPi) {
-                      registry.get<TH1>(HIST("hmassLcToPKPi"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::DsToPiKK) {
-                      registry.get<TH1>(HIST("hmassDsToPiKK"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                    if (n3 == hf_cand_prong3::DecayType::XicToPKPi) {
-                      registry.get<TH1>(HIST("hmassXicToPKPi"))->Fill(mass3ProngHypo2[n3]);
-                    }
-                  }
-                }
-              }
-            }
+        // second loop over negative tracks
+        for (size_t iNeg2 = iNeg1 + 1; iNeg2 < selectedTracksNeg.size(); ++iNeg2) {
+          if (selectedTracks[selectedTracksNeg[iNeg2]].isSelProng & (1 << 1)) {
+            preselect3Prong(selectedTracksNeg[iNeg1], selectedTracksPos[iPos1], selectedTracksNeg[iNeg2]);
           }
         }
       }
     }
 
+    // fit and select the remaining combinations
+    fitAndSelect2Prong();
+    fitAndSelect3Prong();
+
     auto nTracks = tracks.size();                      // number of tracks passing 2 and 3 prong selection in this collision
     nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
     nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
@@ -0,0 +1,250 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldFlat.h
+/// \brief Definition of the flat copy of the MagneticWrapperChebyshev parameterizations
+
+#ifndef ALICEO2_FIELD_MAGFIELDFLAT_H_
+#define ALICEO2_FIELD_MAGFIELDFLAT_H_
+
+#include "FlatObject.h"
+#include "MathUtils/Chebyshev3DCalc.h"
+#include "Rtypes.h"
+#include <string>
+
+class TFile;
+
+namespace o2
+{
+namespace field
+{
+class MagneticWrapperChebyshev;
+
+/// Flat copy of the Chebyshev parameterizations of MagneticWrapperChebyshev: all pieces of the solenoid,
+/// TPC integrals and dipole field are stored in a single contiguous buffer, with the data of every piece
+/// starting at a cache line boundary. The evaluation does not touch TObjArrays nor the mutable temporaries
+/// of Chebyshev3D, so the object can be queried concurrently.
+/// The piece containing the query point is taken from a regular grid of piece indices precomputed over the
+/// parameterized volume; the grid cells crossed by the piece boundaries are flagged and only for them the search
+/// in the original segment tables is done. The results are identical to those of MagneticWrapperChebyshev.
+class MagFieldFlat : public o2::gpu::FlatObject
+{
+ public:
+  enum ParamSet : int { kSolenoid,
+                        kTPCIntegral,
+                        kTPCRatIntegral,
+                        kDipole,
+                        kNParamSets };
+
+  static constexpr int MaxChebyshevOrder = 64; ///< max number of rows/columns of the parameterization pieces
+  static constexpr int BatchSize = 64;          ///< number of points processed together by the batched evaluation
+  static constexpr int MinBatchPoints = 8;      ///< min number of points of the batch in a piece to evaluate them together
+  static constexpr int CacheLine = 64;          ///< alignment of the pieces data in the flat buffer
+
+  /// parameterization piece, the Chebyshev3DCalc of each field component is addressed by its offset in the flat buffer
+  struct Piece {
+    float bMin[3];      ///< lower boundaries of the fitted box
+    float bMax[3];      ///< upper boundaries of the fitted box
+    float mapOffset[3]; ///< offsets of the mapping to [-1:1] interval
+    float mapScale[3];  ///< scales of the mapping to [-1:1] interval
+    int calc[3];        ///< offsets of the flattened Chebyshev3DCalc of each field component
+    int reserved;       ///< padding to the cache line size
+  };
+
+  /// flattened Chebyshev3DCalc, its arrays follow it in the flat buffer
+  struct Calc {
+    int nRows;      ///< number of rows of significant coefficients
+    int colsAtRow;  ///< offset of the numbers of significant columns at each row (UShort_t[nRows])
+    int colAtRowBg; ///< offset of the beginning of each row in the 2D boundary matrix (UShort_t[nRows])
+    int bound2D0;   ///< offset of the number of significant coefficients of each column (UShort_t[nElemBound2D])
+    int bound2D1;   ///< offset of the beginning of each column in the coefficients array (UShort_t[nElemBound2D])
+    int coefs;      ///< offset of the coefficients (Float_t[nCoefs])
+  };
+
+  /// lookup tables of one set of parameterization pieces, the arrays are addressed by their offsets in the flat buffer.
+  /// Coordinates are (r,phi,z) for the solenoid and TPC integrals and (x,y,z) for the dipole.
+  struct Set {
+    int nPieces;          ///< number of parameterization pieces
+    int pieces;           ///< offset of Piece[nPieces]
+    int nZSeg;            ///< number of distinct Z segments
+    int segZ;             ///< offset of the Z segments coordinates (Float_t[nZSeg])
+    int begSegP;          ///< offset of the beginning of P(Y) segments of each Z segment (Int_t[nZSeg])
+    int nSegP;            ///< offset of the number of P(Y) segments of each Z segment (Int_t[nZSeg])
+    int segP;             ///< offset of the P(Y) segments coordinates (Float_t)
+    int begSegR;          ///< offset of the beginning of R(X) segments of each P(Y) segment (Int_t)
+    int nSegR;            ///< offset of the number of R(X) segments of each P(Y) segment (Int_t)
+    int segR;             ///< offset of the R(X) segments coordinates (Float_t)
+    int segID;            ///< offset of the piece ID of each R(X) segment (Int_t)
+    int grid;             ///< offset of the piece index of each grid cell, -1 for cells needing the search (Short_t)
+    int gridN[3];         ///< number of grid cells in each dimension
+    float gridMin[3];     ///< lower edge of the grid
+    float gridStepInv[3]; ///< inverse cell size
+  };
+
+  /// header of the flat buffer
+  struct Layout {
+    Set sets[kNParamSets];
+    float minZSolenoid;       ///< Min Z of Solenoid parameterization
+    float maxZSolenoid;       ///< Max Z of Solenoid parameterization
+    float maxRSolenoid;       ///< max radius for Solenoid field
+    float minZTPC;            ///< Min Z of TPC integral parameterization
+    float maxZTPC;            ///< Max Z of TPC integral parameterization
+    float maxRTPC;            ///< max radius for TPC integral
+    float minZTPCRat;         ///< Min Z of TPC field ratios integral parameterization
+    float maxZTPCRat;         ///< Max Z of TPC field ratios integral parameterization
+    float maxRTPCRat;         ///< max radius for TPC field ratios integral
+    float minZDipole;         ///< Min Z of Dipole parameterization
+    float maxZDipole;         ///< Max Z of Dipole parameterization
+  };
+
+  MagFieldFlat() = default;
+  ~MagFieldFlat() = default;
+  MagFieldFlat(const MagFieldFlat&) = delete;
+
+  /// Creates the flat copy of the parameterizations of src. The segment index grid has cells of cellSize cm
+  /// in r,z (x,y,z for the dipole) and of cellPhi radians in phi
+  void build(const MagneticWrapperChebyshev& src, float cellSize = 10.f, float cellPhi = 0.1f);
+
+  /// Computes field in cartesian coordinates, 0 outside of the parameterized region
+  void Field(const double* xyz, double* b) const;
+
+  /// Computes field in cartesian coordinates for n points, xyz and b are n consecutive triplets
+  void Field(int n, const double* xyz, double* b) const;
+
+  /// Computes Bz for the point in cartesian coordinates
+  double getBz(const double* xyz) const;
+
+  /// Computes solenoid field in cylindrical coordinates
+  void fieldCylindrical(const double* rphiz, double* b) const;
+
+  /// Computes TPC region field integral in cartesian coordinates
+  void getTPCIntegral(const double* xyz, double* b) const;
+
+  /// Computes TPC region field integral in cylindrical coordinates
+  void getTPCIntegralCylindrical(const double* rphiz, double* b) const;
+
+  /// Computes TPC region field ratios integral in cartesian coordinates
+  void getTPCRatIntegral(const double* xyz, double* b) const;
+
+  /// Computes TPC region field ratios integral in cylindrical coordinates
+  void getTPCRatIntegralCylindrical(const double* rphiz, double* b) const;
+
+  /// Finds the parameterization piece of the set containing point p, -1 if none
+  int findPiece(int set, const double* p) const;
+
+  /// Finds the parameterization piece in the segment tables, as MagneticWrapperChebyshev does
+  int searchPiece(int set, const double* p) const;
+
+  const Layout* get() const { return reinterpret_cast<const Layout*>(mFlatBufferPtr); }
+  float getMinZ() const { return get()->sets[kDipole].nPieces ? get()->minZDipole : get()->minZSolenoid; }
+  float getMaxZ() const { return get()->maxZSolenoid; }
+  int getNPieces(int set) const { return get()->sets[set].nPieces; }
+  const Piece& getPiece(int set, int id) const { return at<Piece>(get()->sets[set].pieces)[id]; }
+
+  void print() const;
+
+  /// write/read to/from the file
+  int writeToFile(TFile& outf, const char* name = "MagFieldFlat");
+  static MagFieldFlat* readFromFile(TFile& inpf, const char* name = "MagFieldFlat");
+
+  // the buffer content is addressed by offsets, there are no pointers to relocate
+  using o2::gpu::FlatObject::adoptInternalBuffer;
+  using o2::gpu::FlatObject::cloneFromObject;
+  using o2::gpu::FlatObject::moveBufferTo;
+  using o2::gpu::FlatObject::releaseInternalBuffer;
+  using o2::gpu::FlatObject::setActualBufferAddress;
+  using o2::gpu::FlatObject::setFutureBufferAddress;
+
+ private:
+  template <typename T>
+  const T* at(int offset) const
+  {
+    return reinterpret_cast<const T*>(mFlatBufferPtr + offset);
+  }
+
+  bool isInside(const Piece& piece, const double* p) const
+  {
+    for (int i = 3; i--;) {
+      if (piece.bMin[i] > p[i] || p[i] > piece.bMax[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// finds the Z segment of the point, -1 if below the 1st one
+  int searchZSegment(const Set& set, const double* p) const;
+
+  /// finds the R(X) and P(Y) segments of the point in the Z segment seg[2], stores them to seg[0] and seg[1]
+  void searchSegment(const Set& set, const double* p, int* seg) const;
+
+  /// fills the piece index grid of the set
+  void buildGrid(int iset);
+
+  /// evaluates all field components of the piece
+  void evalPiece(const Piece& piece, const double* p, double* b) const
+  {
+    float par[3];
+    for (int i = 3; i--;) {
+      par[i] = (p[i] - piece.mapOffset[i]) * piece.mapScale[i];
+    }
+    for (int i = 3; i--;) {
+      b[i] = evalCalc(piece.calc[i], par);
+    }
+  }
+
+  /// evaluates one field component of the piece
+  double evalPiece(const Piece& piece, const double* p, int idim) const
+  {
+    float par[3];
+    for (int i = 3; i--;) {
+      par[i] = (p[i] - piece.mapOffset[i]) * piece.mapScale[i];
+    }
+    return evalCalc(piece.calc[idim], par);
+  }
+
+  float evalCalc(int offset, const float* par) const;
+
+  /// evaluates the Chebyshev3DCalc for n <= BatchSize points, par[d] are the mapped coordinates of the points
+  void evalCalc(int offset, int n, const float* const* par, float* res) const;
+
+  /// evaluates the piece of the set containing p, 0 outside of the parameterized region
+  void evalSet(int set, const double* p, double* b) const;
+
+  ClassDefNV(MagFieldFlat, 1);
+};
+
+inline float MagFieldFlat::evalCalc(int offset, const float* par) const
+{
+  const Calc& calc = *at<Calc>(offset);
+  const auto* colsAtRow = at<UShort_t>(calc.colsAtRow);
+  const auto* colAtRowBg = at<UShort_t>(calc.colAtRowBg);
+  const auto* bound2D0 = at<UShort_t>(calc.bound2D0);
+  const auto* bound2D1 = at<UShort_t>(calc.bound2D1);
+  const auto* coefs = at<float>(calc.coefs);
+  using o2::math_utils::Chebyshev3DCalc;
+  float tmp1D[MaxChebyshevOrder], tmp2D[MaxChebyshevOrder];
+  for (int id0 = calc.nRows; id0--;) {
+    int nCLoc = colsAtRow[id0]; // number of significant coefs on this row
+    int col0 = colAtRowBg[id0]; // beginning of local column in the 2D boundary matrix
+    for (int id1 = nCLoc; id1--;) {
+      int id = id1 + col0;
+      tmp2D[id1] = Chebyshev3DCalc::chebyshevEvaluation1D(par[2], coefs + bound2D1[id], bound2D0[id]);
+    }
+    tmp1D[id0] = Chebyshev3DCalc::chebyshevEvaluation1D(par[1], tmp2D, nCLoc);
+  }
+  return Chebyshev3DCalc::chebyshevEvaluation1D(par[0], tmp1D, calc.nRows);
+}
+
+} // namespace field
+} // namespace o2
+
+#endif
@@ -20,6 +20,7 @@
 #include "Field/MagFieldParam.h"
 #include "Field/MagneticWrapperChebyshev.h" // for MagneticWrapperChebyshev
 #include "Field/MagFieldFast.h"
+#include "Field/MagFieldFlat.h"
 #include "TSystem.h"
 #include "Rtypes.h" // for Double_t, Char_t, Int_t, Float_t, etc
 #include "TNamed.h" // for TNamed
@@ -78,6 +79,9 @@ class MagneticField : public FairField
   /// allow fast field param
   void AllowFastField(bool v = true);
 
+  /// allow flat copy of the measured map, thread-safe and with batched evaluation
+  void AllowFlatMap(bool v = true);
+
   /// Virtual methods from FairField
 
   /// X component, avoid using since slow
@@ -107,6 +111,9 @@ class MagneticField : public FairField
   /// Main interface from TVirtualMagField used in simulation
   void Field(const Double_t* __restrict__ point, Double_t* __restrict__ bField) override;
 
+  /// Method to calculate the field at n points, point and bField are n consecutive triplets
+  void Field(int n, const Double_t* __restrict__ point, Double_t* __restrict__ bField);
+
   /// 3d field query alias for Alias Method to calculate the field at point xyz
   void GetBxyz(const Double_t p[3], Double_t* b) override { MagneticField::Field(p, b); }
 
@@ -134,6 +141,9 @@ class MagneticField : public FairField
   /// get fast field direct pointer
   const MagFieldFast* getFastField() const { return mFastField.get(); }
 
+  /// get flat map direct pointer
+  const MagFieldFlat* getFlatMap() const { return mFlatMap.get(); }
+
   // Former MagF methods or their aliases
 
   /// Sets the sign/scale of the current in the L3 according to sPolarityConvention
@@ -215,6 +225,7 @@ class MagneticField : public FairField
  private:
   std::unique_ptr<MagneticWrapperChebyshev> mMeasuredMap; //! Measured part of the field map
   std::unique_ptr<MagFieldFast> mFastField;               // ! optional fast parametrization
+  std::unique_ptr<MagFieldFlat> mFlatMap;                 //! optional flat copy of the measured map
   MagFieldParam::BMap_t mMapType;                         ///< field map type
   Double_t mSolenoid;                                     ///< Solenoid field setting
   MagFieldParam::BeamType_t mBeamType;                    ///< Beam type: A-A (mBeamType=0) or p-p (mBeamType=1)
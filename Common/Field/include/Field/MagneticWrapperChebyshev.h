@@ -326,6 +326,8 @@ class MagneticWrapperChebyshev : public TNamed
   Double_t fieldCylindricalSolenoidBz(const Double_t* rphiz) const;
 
  private:
+  friend class MagFieldFlat; // creates the flat copy of the segment tables
+
   Int_t mNumberOfParameterizationSolenoid;  ///< Total number of parameterization pieces for solenoid
   Int_t mNumberOfDistinctZSegmentsSolenoid; ///< number of distinct Z segments in Solenoid
   Int_t mNumberOfDistinctPSegmentsSolenoid; ///< number of distinct P segments in Solenoid
@@ -20,5 +20,6 @@
 #pragma link C++ class o2::field::MagFieldContFact + ;
 #pragma link C++ class o2::field::MagFieldFact + ;
 #pragma link C++ class o2::field::MagFieldFast + ;
+#pragma link C++ class o2::field::MagFieldFlat + ;
 
 #endif
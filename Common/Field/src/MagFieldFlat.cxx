@@ -0,0 +1,666 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MagFieldFlat.cxx
+/// \brief Implementation of the flat copy of the MagneticWrapperChebyshev parameterizations
+
+#include "Field/MagFieldFlat.h"
+#include "Field/MagneticWrapperChebyshev.h"
+#include "MathUtils/Chebyshev3D.h"
+#include "FairLogger.h"
+#include <TFile.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+using namespace o2::field;
+using o2::math_utils::Chebyshev3D;
+using o2::math_utils::Chebyshev3DCalc;
+
+ClassImp(MagFieldFlat);
+
+namespace
+{
+/// segment tables of one parameterization set of MagneticWrapperChebyshev
+struct SetTables {
+  int nPieces = 0;
+  const TObjArray* pieces = nullptr;
+  int nZSeg = 0;
+  int nPSeg = 0;
+  int nRSeg = 0;
+  const float* segZ = nullptr;
+  const int* begSegP = nullptr;
+  const int* nSegP = nullptr;
+  const float* segP = nullptr;
+  const int* begSegR = nullptr;
+  const int* nSegR = nullptr;
+  const float* segR = nullptr;
+  const int* segID = nullptr;
+};
+
+/// appends n elements of size sz to the buffer at the offset aligned to align, returns the offset
+int append(std::vector<char>& buf, const void* src, size_t sz, size_t n, size_t align)
+{
+  size_t offs = o2::gpu::FlatObject::alignSize(buf.size(), align);
+  buf.resize(offs + sz * n);
+  if (src && n) {
+    std::memcpy(buf.data() + offs, src, sz * n);
+  }
+  return offs;
+}
+
+template <typename T>
+int append(std::vector<char>& buf, const T* src, int n, size_t align = alignof(T))
+{
+  return append(buf, src, sizeof(T), n, align);
+}
+/// stores the Chebyshev3DCalc followed by its arrays, returns its offset
+int storeCalc(std::vector<char>& buf, const Chebyshev3DCalc& cc, size_t align)
+{
+  if (cc.getNumberOfRows() > MagFieldFlat::MaxChebyshevOrder || cc.getNumberOfColumns() > MagFieldFlat::MaxChebyshevOrder) {
+    LOG(FATAL) << "MagFieldFlat::build: Chebyshev parameterization with " << cc.getNumberOfRows() << " rows and " << cc.getNumberOfColumns()
+               << " columns, max supported is " << MagFieldFlat::MaxChebyshevOrder;
+  }
+  MagFieldFlat::Calc calc{};
+  int offset = append(buf, &calc, 1, align);
+  calc.nRows = cc.getNumberOfRows();
+  calc.coefs = append(buf, cc.getCoefficients(), cc.getNumberOfCoefficients());
+  calc.colsAtRow = append(buf, cc.getNumberOfColumnsAtRow(), cc.getNumberOfRows());
+  calc.colAtRowBg = append(buf, cc.getColAtRowBg(), cc.getNumberOfRows());
+  calc.bound2D0 = append(buf, cc.getCoefficientBound2D0(), cc.getNumberOfElementsBound2D());
+  calc.bound2D1 = append(buf, cc.getCoefficientBound2D1(), cc.getNumberOfElementsBound2D());
+  std::memcpy(buf.data() + offset, &calc, sizeof(calc));
+  return offset;
+}
+
+/// Chebyshev3DCalc::chebyshevEvaluation1D for n points sharing the coefficients
+void chebyshevEvaluation1D(int n, const float* x, const float* array, int ncf, float* res)
+{
+  if (ncf <= 0) {
+    std::fill(res, res + n, 0.f);
+    return;
+  }
+  float b0[MagFieldFlat::BatchSize], b1[MagFieldFlat::BatchSize], b2[MagFieldFlat::BatchSize], x2[MagFieldFlat::BatchSize];
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+  for (int j = 0; j < n; j++) {
+    b0[j] = array[ncf - 1];
+    b1[j] = b2[j] = 0;
+    x2[j] = x[j] + x[j];
+  }
+  for (int i = ncf - 1; i--;) {
+    const float a = array[i];
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+    for (int j = 0; j < n; j++) {
+      b2[j] = b1[j];
+      b1[j] = b0[j];
+      b0[j] = a + x2[j] * b1[j] - b2[j];
+    }
+  }
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+  for (int j = 0; j < n; j++) {
+    res[j] = b0[j] - x[j] * b1[j];
+  }
+}
+
+/// Chebyshev3DCalc::chebyshevEvaluation1D for n points with the coefficients array[i][j] of point j
+void chebyshevEvaluation1D(int n, const float* x, const float (*array)[MagFieldFlat::BatchSize], int ncf, float* res)
+{
+  if (ncf <= 0) {
+    std::fill(res, res + n, 0.f);
+    return;
+  }
+  float b0[MagFieldFlat::BatchSize], b1[MagFieldFlat::BatchSize], b2[MagFieldFlat::BatchSize], x2[MagFieldFlat::BatchSize];
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+  for (int j = 0; j < n; j++) {
+    b0[j] = array[ncf - 1][j];
+    b1[j] = b2[j] = 0;
+    x2[j] = x[j] + x[j];
+  }
+  for (int i = ncf - 1; i--;) {
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+    for (int j = 0; j < n; j++) {
+      b2[j] = b1[j];
+      b1[j] = b0[j];
+      b0[j] = array[i][j] + x2[j] * b1[j] - b2[j];
+    }
+  }
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+  for (int j = 0; j < n; j++) {
+    res[j] = b0[j] - x[j] * b1[j];
+  }
+}
+} // namespace
+
+//__________________________________________________________________________________________
+void MagFieldFlat::build(const MagneticWrapperChebyshev& src, float cellSize, float cellPhi)
+{
+  SetTables tables[kNParamSets];
+  auto& sol = tables[kSolenoid];
+  sol.nPieces = src.mNumberOfParameterizationSolenoid;
+  sol.pieces = src.mParameterizationSolenoid;
+  sol.nZSeg = src.mNumberOfDistinctZSegmentsSolenoid;
+  sol.nPSeg = src.mNumberOfDistinctPSegmentsSolenoid;
+  sol.nRSeg = src.mNumberOfDistinctRSegmentsSolenoid;
+  sol.segZ = src.mCoordinatesSegmentsZSolenoid;
+  sol.begSegP = src.mBeginningOfSegmentsPSolenoid;
+  sol.nSegP = src.mNumberOfSegmentsPSolenoid;
+  sol.segP = src.mCoordinatesSegmentsPSolenoid;
+  sol.begSegR = src.mBeginningOfSegmentsRSolenoid;
+  sol.nSegR = src.mNumberOfRSegmentsSolenoid;
+  sol.segR = src.mCoordinatesSegmentsRSolenoid;
+  sol.segID = src.mSegmentIdSolenoid;
+
+  auto& tpc = tables[kTPCIntegral];
+  tpc.nPieces = src.mNumberOfParameterizationTPC;
+  tpc.pieces = src.mParameterizationTPC;
+  tpc.nZSeg = src.mNumberOfDistinctZSegmentsTPC;
+  tpc.nPSeg = src.mNumberOfDistinctPSegmentsTPC;
+  tpc.nRSeg = src.mNumberOfDistinctRSegmentsTPC;
+  tpc.segZ = src.mCoordinatesSegmentsZTPC;
+  tpc.begSegP = src.mBeginningOfSegmentsPTPC;
+  tpc.nSegP = src.mNumberOfSegmentsPTPC;
+  tpc.segP = src.mCoordinatesSegmentsPTPC;
+  tpc.begSegR = src.mBeginningOfSegmentsRTPC;
+  tpc.nSegR = src.mNumberOfRSegmentsTPC;
+  tpc.segR = src.mCoordinatesSegmentsRTPC;
+  tpc.segID = src.mSegmentIdTPC;
+
+  auto& tpcRat = tables[kTPCRatIntegral];
+  tpcRat.nPieces = src.mNumberOfParameterizationTPCRat;
+  tpcRat.pieces = src.mParameterizationTPCRat;
+  tpcRat.nZSeg = src.mNumberOfDistinctZSegmentsTPCRat;
+  tpcRat.nPSeg = src.mNumberOfDistinctPSegmentsTPCRat;
+  tpcRat.nRSeg = src.mNumberOfDistinctRSegmentsTPCRat;
+  tpcRat.segZ = src.mCoordinatesSegmentsZTPCRat;
+  tpcRat.begSegP = src.mBeginningOfSegmentsPTPCRat;
+  tpcRat.nSegP = src.mNumberOfSegmentsPTPCRat;
+  tpcRat.segP = src.mCoordinatesSegmentsPTPCRat;
+  tpcRat.begSegR = src.mBeginningOfSegmentsRTPCRat;
+  tpcRat.nSegR = src.mNumberOfRSegmentsTPCRat;
+  tpcRat.segR = src.mCoordinatesSegmentsRTPCRat;
+  tpcRat.segID = src.mSegmentIdTPCRat;
+
+  auto& dip = tables[kDipole];
+  dip.nPieces = src.mNumberOfParameterizationDipole;
+  dip.pieces = src.mParameterizationDipole;
+  dip.nZSeg = src.mNumberOfDistinctZSegmentsDipole;
+  dip.nPSeg = src.mNumberOfDistinctYSegmentsDipole;
+  dip.nRSeg = src.mNumberOfDistinctXSegmentsDipole;
+  dip.segZ = src.mCoordinatesSegmentsZDipole;
+  dip.begSegP = src.mBeginningOfSegmentsYDipole;
+  dip.nSegP = src.mNumberOfSegmentsYDipole;
+  dip.segP = src.mCoordinatesSegmentsYDipole;
+  dip.begSegR = src.mBeginningOfSegmentsXDipole;
+  dip.nSegR = src.mNumberOfSegmentsXDipole;
+  dip.segR = src.mCoordinatesSegmentsXDipole;
+  dip.segID = src.mSegmentIdDipole;
+
+  startConstruction();
+
+  std::vector<char> buf;
+  Layout layout{};
+  layout.minZSolenoid = src.getMinZSol();
+  layout.maxZSolenoid = src.getMaxZSol();
+  layout.maxRSolenoid = src.getMaxRSol();
+  layout.minZTPC = src.getMinZTPCIntegral();
+  layout.maxZTPC = src.getMaxZTPCIntegral();
+  layout.maxRTPC = src.getMaxRTPCIntegral();
+  layout.minZTPCRat = src.getMinZTPCRatIntegral();
+  layout.maxZTPCRat = src.getMaxZTPCRatIntegral();
+  layout.maxRTPCRat = src.getMaxRTPCRatIntegral();
+  layout.minZDipole = src.getMinZDip();
+  layout.maxZDipole = src.getMaxZDip();
+  append(buf, &layout, 1, CacheLine);
+
+  for (int iset = 0; iset < kNParamSets; iset++) {
+    const auto& tb = tables[iset];
+    auto& set = layout.sets[iset];
+    if (!tb.nPieces || !tb.pieces) {
+      continue;
+    }
+    set.nPieces = tb.nPieces;
+    set.nZSeg = tb.nZSeg;
+    set.segZ = append(buf, tb.segZ, tb.nZSeg);
+    set.begSegP = append(buf, tb.begSegP, tb.nZSeg);
+    set.nSegP = append(buf, tb.nSegP, tb.nZSeg);
+    set.segP = append(buf, tb.segP, tb.nPSeg);
+    set.begSegR = append(buf, tb.begSegR, tb.nPSeg);
+    set.nSegR = append(buf, tb.nSegR, tb.nPSeg);
+    set.segR = append(buf, tb.segR, tb.nRSeg);
+    set.segID = append(buf, tb.segID, tb.nRSeg);
+
+    std::vector<Piece> pieces(tb.nPieces);
+    set.pieces = append(buf, pieces.data(), tb.nPieces, CacheLine); // placeholder, filled once the calcs are stored
+    float bMin[3] = {1e9, 1e9, 1e9}, bMax[3] = {-1e9, -1e9, -1e9};
+    for (int ip = 0; ip < tb.nPieces; ip++) {
+      const auto* cheb = static_cast<const Chebyshev3D*>(tb.pieces->UncheckedAt(ip));
+      if (cheb->getOutputArrayDimension() != 3) {
+        LOG(FATAL) << "MagFieldFlat::build: piece " << ip << " of set " << iset << " has " << cheb->getOutputArrayDimension() << " output dimensions instead of 3";
+      }
+      auto& piece = pieces[ip];
+      for (int i = 0; i < 3; i++) {
+        piece.bMin[i] = cheb->getBoundMin(i);
+        piece.bMax[i] = cheb->getBoundMax(i);
+        piece.mapOffset[i] = cheb->getBoundaryMappingOffset(i);
+        piece.mapScale[i] = cheb->getBoundaryMappingScale(i);
+        bMin[i] = std::min(bMin[i], piece.bMin[i]);
+        bMax[i] = std::max(bMax[i], piece.bMax[i]);
+      }
+      for (int ic = 0; ic < 3; ic++) {
+        const Chebyshev3DCalc* cc = cheb->getChebyshevCalc(ic);
+        // the components of the piece are stored one after the other, the 1st one at the cache line boundary
+        piece.calc[ic] = storeCalc(buf, *cc, ic ? alignof(Calc) : CacheLine);
+      }
+    }
+    std::memcpy(buf.data() + set.pieces, pieces.data(), sizeof(Piece) * tb.nPieces);
+
+    // grid of piece indices over the bounding box of all pieces
+    if (tb.nPieces >= 0x7fff) {
+      LOG(WARNING) << "MagFieldFlat::build: too many pieces in set " << iset << " for the segment index grid, the search will be used";
+      continue;
+    }
+    const float cellCyl[3] = {cellSize, cellPhi, cellSize}, cellCart[3] = {cellSize, cellSize, cellSize};
+    const float* cell = iset == kDipole ? cellCart : cellCyl;
+    const int maxCells = 512; // per dimension
+    size_t nCells = 1;
+    for (int i = 0; i < 3; i++) {
+      float ext = bMax[i] - bMin[i];
+      set.gridN[i] = std::max(1, std::min(maxCells, int(std::ceil(ext / cell[i]))));
+      set.gridMin[i] = bMin[i];
+      set.gridStepInv[i] = ext > 0 ? set.gridN[i] / ext : 0.f;
+      nCells *= set.gridN[i];
+    }
+    set.grid = append(buf, (const short*)nullptr, int(nCells), CacheLine);
+  }
+  std::memcpy(buf.data(), &layout, sizeof(Layout));
+
+  finishConstruction(buf.size());
+  std::memcpy(mFlatBufferPtr, buf.data(), buf.size());
+
+  for (int iset = 0; iset < kNParamSets; iset++) {
+    if (get()->sets[iset].grid) {
+      buildGrid(iset);
+    }
+  }
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::buildGrid(int iset)
+{
+  // A cell gets the index of the piece found by the search at its corners if all corners of the cell, enlarged by
+  // a small margin to absorb the rounding in the cell index calculation, are found in the same Z,P,R segments and
+  // are inside the piece: by the monotonicity of the search the same piece is found for any point of the cell,
+  // without the recheck of the previous Z segment. Other cells get -1.
+  const Set& set = get()->sets[iset];
+  const auto* segID = at<int>(set.segID);
+  const auto* pieces = at<Piece>(set.pieces);
+  auto* grid = reinterpret_cast<short*>(mFlatBufferPtr + set.grid);
+  const float margin = 1e-3;
+  double step[3];
+  for (int i = 0; i < 3; i++) {
+    step[i] = set.gridStepInv[i] > 0 ? 1. / set.gridStepInv[i] : 0.;
+  }
+  int nFilled = 0;
+  for (int i2 = 0; i2 < set.gridN[2]; i2++) {
+    for (int i1 = 0; i1 < set.gridN[1]; i1++) {
+      for (int i0 = 0; i0 < set.gridN[0]; i0++) {
+        const int idx[3] = {i0, i1, i2};
+        int id = -1, seg0[3] = {-1, -1, -1};
+        for (int corner = 0; corner < 8; corner++) {
+          double p[3];
+          for (int i = 0; i < 3; i++) {
+            p[i] = set.gridMin[i] + ((corner >> i) & 0x1 ? idx[i] + 1 + margin : idx[i] - margin) * step[i];
+          }
+          int seg[3];
+          seg[2] = searchZSegment(set, p);
+          if (seg[2] < 0) {
+            id = -1;
+            break;
+          }
+          searchSegment(set, p, seg);
+          if (!corner) {
+            std::copy(seg, seg + 3, seg0);
+            id = segID[seg[0]];
+          }
+          if (!std::equal(seg, seg + 3, seg0) || !isInside(pieces[id], p)) {
+            id = -1;
+            break;
+          }
+        }
+        grid[(i2 * set.gridN[1] + i1) * set.gridN[0] + i0] = id;
+        nFilled += id >= 0;
+      }
+    }
+  }
+  LOG(DEBUG) << "MagFieldFlat::buildGrid: " << nFilled << " of " << set.gridN[0] * set.gridN[1] * set.gridN[2] << " cells of set " << iset << " are assigned to a piece";
+}
+
+//__________________________________________________________________________________________
+int MagFieldFlat::searchZSegment(const Set& set, const double* p) const
+{
+  // same as TMath::BinarySearch used by MagneticWrapperChebyshev
+  const auto* segZ = at<float>(set.segZ);
+  float z = p[2];
+  const float* pind = std::lower_bound(segZ, segZ + set.nZSeg, z);
+  return (pind != segZ + set.nZSeg && *pind == z) ? pind - segZ : pind - segZ - 1;
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::searchSegment(const Set& set, const double* p, int* seg) const
+{
+  // find the P and R segments within Z segment seg[2], store them to seg[1] and seg[0]
+  const auto* begSegP = at<int>(set.begSegP);
+  const auto* nSegP = at<int>(set.nSegP);
+  const auto* segP = at<float>(set.segP);
+  const auto* begSegR = at<int>(set.begSegR);
+  const auto* nSegR = at<int>(set.nSegR);
+  const auto* segR = at<float>(set.segR);
+  int zid = seg[2], pid, rid;
+  int psegBeg = begSegP[zid];
+  for (pid = 0; pid < nSegP[zid]; pid++) {
+    if (p[1] < segP[psegBeg + pid]) {
+      break;
+    }
+  }
+  if (--pid < 0) {
+    pid = 0;
+  }
+  pid += psegBeg;
+
+  int rsegBeg = begSegR[pid];
+  for (rid = 0; rid < nSegR[pid]; rid++) {
+    if (p[0] < segR[rsegBeg + rid]) {
+      break;
+    }
+  }
+  if (--rid < 0) {
+    rid = 0;
+  }
+  seg[0] = rid + rsegBeg;
+  seg[1] = pid;
+}
+
+//__________________________________________________________________________________________
+int MagFieldFlat::searchPiece(int iset, const double* p) const
+{
+  const Set& set = get()->sets[iset];
+  if (!set.nPieces) {
+    return -1;
+  }
+  int seg[3];
+  seg[2] = searchZSegment(set, p);
+  if (seg[2] < 0) {
+    return -1;
+  }
+  const auto* segID = at<int>(set.segID);
+  searchSegment(set, p, seg);
+  // to make sure that due to the precision problems we did not pick the next Zbin
+  if ((p[2] - at<float>(set.segZ)[seg[2]] < 3.e-5) && seg[2] && !isInside(at<Piece>(set.pieces)[segID[seg[0]]], p)) { // check the previous Z bin
+    seg[2]--;
+    searchSegment(set, p, seg);
+  }
+  return segID[seg[0]];
+}
+
+//__________________________________________________________________________________________
+int MagFieldFlat::findPiece(int iset, const double* p) const
+{
+  const Set& set = get()->sets[iset];
+  if (set.grid) {
+    int idx[3];
+    bool inGrid = true;
+    for (int i = 0; i < 3; i++) {
+      double t = (p[i] - set.gridMin[i]) * set.gridStepInv[i];
+      inGrid &= t >= 0. && t < set.gridN[i];
+      idx[i] = inGrid ? int(t) : 0;
+    }
+    if (inGrid) {
+      int id = at<short>(set.grid)[(idx[2] * set.gridN[1] + idx[1]) * set.gridN[0] + idx[0]];
+      if (id >= 0) {
+        return id;
+      }
+    }
+  }
+  return searchPiece(iset, p);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::evalCalc(int offset, int n, const float* const* par, float* res) const
+{
+  // same sums as in the single point evaluation, done for all points at once
+  const Calc& calc = *at<Calc>(offset);
+  const auto* colsAtRow = at<UShort_t>(calc.colsAtRow);
+  const auto* colAtRowBg = at<UShort_t>(calc.colAtRowBg);
+  const auto* bound2D0 = at<UShort_t>(calc.bound2D0);
+  const auto* bound2D1 = at<UShort_t>(calc.bound2D1);
+  const auto* coefs = at<float>(calc.coefs);
+  float tmp1D[MaxChebyshevOrder][BatchSize], tmp2D[MaxChebyshevOrder][BatchSize];
+  for (int id0 = calc.nRows; id0--;) {
+    int nCLoc = colsAtRow[id0]; // number of significant coefs on this row
+    int col0 = colAtRowBg[id0]; // beginning of local column in the 2D boundary matrix
+    for (int id1 = nCLoc; id1--;) {
+      int id = id1 + col0;
+      chebyshevEvaluation1D(n, par[2], coefs + bound2D1[id], bound2D0[id], tmp2D[id1]);
+    }
+    chebyshevEvaluation1D(n, par[1], tmp2D, nCLoc, tmp1D[id0]);
+  }
+  chebyshevEvaluation1D(n, par[0], tmp1D, calc.nRows, res);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::evalSet(int iset, const double* p, double* b) const
+{
+  b[0] = b[1] = b[2] = 0.;
+  int id = findPiece(iset, p);
+  if (id < 0) {
+    return;
+  }
+  const Piece& piece = getPiece(iset, id);
+  if (!isInside(piece, p)) {
+    return;
+  }
+  evalPiece(piece, p, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::Field(const double* xyz, double* b) const
+{
+  if (xyz[2] > get()->minZSolenoid) {
+    double rphiz[3];
+    MagneticWrapperChebyshev::cartesianToCylindrical(xyz, rphiz);
+    evalSet(kSolenoid, rphiz, b);
+    // convert field to cartesian system
+    MagneticWrapperChebyshev::cylindricalToCartesianCylB(rphiz, b, b);
+    return;
+  }
+  evalSet(kDipole, xyz, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::Field(int n, const double* xyz, double* b) const
+{
+  // The points of the batch falling in the same piece have their Chebyshev sums evaluated together, in loops
+  // vectorized over the points. The lookup and the coordinates transformations are done per point.
+  const float minZSolenoid = get()->minZSolenoid;
+  double rphiz[BatchSize][3], bLoc[BatchSize][3];
+  bool isSol[BatchSize];
+  for (int i0 = 0; i0 < n; i0 += BatchSize) {
+    const int nb = std::min(BatchSize, n - i0);
+    const double* pnt = xyz + 3 * i0;
+    double* res = b + 3 * i0;
+    for (int i = 0; i < nb; i++) {
+      isSol[i] = pnt[3 * i + 2] > minZSolenoid;
+      if (isSol[i]) {
+        MagneticWrapperChebyshev::cartesianToCylindrical(pnt + 3 * i, rphiz[i]);
+      }
+    }
+    // group the points by parameterization piece, the sums of each piece are evaluated for all its points at once.
+    // The sorted entries are the piece/set key in the upper bits and the point index in the lower 8 bits
+    static_assert(BatchSize <= 0xff, "point index must fit in 8 bits");
+    int order[BatchSize], nEval = 0;
+    for (int i = 0; i < nb; i++) {
+      const int iset = isSol[i] ? kSolenoid : kDipole;
+      const double* p = isSol[i] ? rphiz[i] : pnt + 3 * i;
+      bLoc[i][0] = bLoc[i][1] = bLoc[i][2] = 0.;
+      int id = findPiece(iset, p);
+      if (id >= 0 && isInside(getPiece(iset, id), p)) {
+        order[nEval++] = ((id * kNParamSets + iset) << 8) | i;
+      }
+    }
+    std::sort(order, order + nEval);
+    for (int j0 = 0, j1 = 0; j0 < nEval; j0 = j1) {
+      const int k = order[j0] >> 8;
+      while (j1 < nEval && (order[j1] >> 8) == k) {
+        j1++;
+      }
+      const int iset = k % kNParamSets, m = j1 - j0;
+      const Piece& piece = getPiece(iset, k / kNParamSets);
+      if (m < MinBatchPoints) {
+        for (int j = j0; j < j1; j++) {
+          const int i = order[j] & 0xff;
+          evalPiece(piece, iset == kSolenoid ? rphiz[i] : pnt + 3 * i, bLoc[i]);
+        }
+        continue;
+      }
+      float par[3][BatchSize], comp[BatchSize];
+      for (int j = 0; j < m; j++) {
+        const int i = order[j0 + j] & 0xff;
+        const double* p = iset == kSolenoid ? rphiz[i] : pnt + 3 * i;
+        for (int d = 0; d < 3; d++) {
+          par[d][j] = (p[d] - piece.mapOffset[d]) * piece.mapScale[d];
+        }
+      }
+      const float* parPtr[3] = {par[0], par[1], par[2]};
+      for (int ic = 0; ic < 3; ic++) {
+        evalCalc(piece.calc[ic], m, parPtr, comp);
+        for (int j = 0; j < m; j++) {
+          bLoc[order[j0 + j] & 0xff][ic] = comp[j];
+        }
+      }
+    }
+    // convert solenoid field to cartesian system
+    for (int i = 0; i < nb; i++) {
+      if (isSol[i]) {
+        MagneticWrapperChebyshev::cylindricalToCartesianCylB(rphiz[i], bLoc[i], res + 3 * i);
+      } else {
+        std::copy(bLoc[i], bLoc[i] + 3, res + 3 * i);
+      }
+    }
+  }
+}
+
+//__________________________________________________________________________________________
+double MagFieldFlat::getBz(const double* xyz) const
+{
+  double rphiz[3];
+  int iset = kDipole;
+  const double* p = xyz;
+  if (xyz[2] > get()->minZSolenoid) {
+    MagneticWrapperChebyshev::cartesianToCylindrical(xyz, rphiz);
+    iset = kSolenoid;
+    p = rphiz;
+  }
+  int id = findPiece(iset, p);
+  if (id < 0) {
+    return 0.;
+  }
+  const Piece& piece = getPiece(iset, id);
+  return isInside(piece, p) ? evalPiece(piece, p, 2) : 0.;
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::fieldCylindrical(const double* rphiz, double* b) const
+{
+  evalSet(kSolenoid, rphiz, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::getTPCIntegralCylindrical(const double* rphiz, double* b) const
+{
+  evalSet(kTPCIntegral, rphiz, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::getTPCRatIntegralCylindrical(const double* rphiz, double* b) const
+{
+  evalSet(kTPCRatIntegral, rphiz, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::getTPCIntegral(const double* xyz, double* b) const
+{
+  double rphiz[3];
+  // convert coordinates to cyl system
+  MagneticWrapperChebyshev::cartesianToCylindrical(xyz, rphiz);
+  if ((rphiz[2] > get()->maxZTPC || rphiz[2] < get()->minZTPC) || rphiz[0] > get()->maxRTPC) {
+    b[0] = b[1] = b[2] = 0.;
+    return;
+  }
+  getTPCIntegralCylindrical(rphiz, b);
+  // convert field to cartesian system
+  MagneticWrapperChebyshev::cylindricalToCartesianCylB(rphiz, b, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::getTPCRatIntegral(const double* xyz, double* b) const
+{
+  double rphiz[3];
+  // convert coordinates to cyl system
+  MagneticWrapperChebyshev::cartesianToCylindrical(xyz, rphiz);
+  if ((rphiz[2] > get()->maxZTPCRat || rphiz[2] < get()->minZTPCRat) || rphiz[0] > get()->maxRTPCRat) {
+    b[0] = b[1] = b[2] = 0.;
+    return;
+  }
+  getTPCRatIntegralCylindrical(rphiz, b);
+  // convert field to cartesian system
+  MagneticWrapperChebyshev::cylindricalToCartesianCylB(rphiz, b, b);
+}
+
+//__________________________________________________________________________________________
+void MagFieldFlat::print() const
+{
+  const char* names[kNParamSets] = {"Solenoid", "TPC integral", "TPC ratios integral", "Dipole"};
+  LOG(INFO) << "Flat Chebyshev parameterization of the magnetic field, buffer size " << getFlatBufferSize() << " bytes";
+  for (int iset = 0; iset < kNParamSets; iset++) {
+    const Set& set = get()->sets[iset];
+    int nCells = set.gridN[0] * set.gridN[1] * set.gridN[2], nFilled = 0;
+    for (int i = 0; set.grid && i < nCells; i++) {
+      nFilled += at<short>(set.grid)[i] >= 0;
+    }
+    LOG(INFO) << names[iset] << ": " << set.nPieces << " pieces, segment index grid " << set.gridN[0] << "x" << set.gridN[1] << "x" << set.gridN[2]
+              << " with " << nFilled << " cells assigned to a piece";
+  }
+}
+
+//__________________________________________________________________________________________
+int MagFieldFlat::writeToFile(TFile& outf, const char* name)
+{
+  return FlatObject::writeToFile(*this, outf, name);
+}
+
+//__________________________________________________________________________________________
+MagFieldFlat* MagFieldFlat::readFromFile(TFile& inpf, const char* name)
+{
+  return FlatObject::readFromFile<MagFieldFlat>(inpf, name);
+}
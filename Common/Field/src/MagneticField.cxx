@@ -66,6 +66,7 @@ MagneticField::MagneticField()
   : FairField(),
     mMeasuredMap(nullptr),
     mFastField(nullptr),
+    mFlatMap(nullptr),
     mMapType(MagFieldParam::k5kG),
     mSolenoid(0),
     mBeamType(MagFieldParam::kNoBeamField),
@@ -95,6 +96,7 @@ MagneticField::MagneticField(const char* name, const char* title, Double_t facto
   : FairField(name, title),
     mMeasuredMap(nullptr),
     mFastField(nullptr),
+    mFlatMap(nullptr),
     mMapType(maptype),
     mSolenoid(0),
     mBeamType(bt),
@@ -124,6 +126,7 @@ MagneticField::MagneticField(const MagFieldParam& param)
   : FairField(param.GetName(), param.GetTitle()),
     mMeasuredMap(nullptr),
     mFastField(nullptr),
+    mFlatMap(nullptr),
     mMapType(param.GetMapType()),
     mSolenoid(0),
     mBeamType(param.GetBeamType()),
@@ -265,7 +268,11 @@ void MagneticField::Field(const Double_t* __restrict__ xyz, Double_t* __restrict
   }
 
   if (mMeasuredMap && xyz[2] > mMeasuredMap->getMinZ() && xyz[2] < mMeasuredMap->getMaxZ()) {
-    mMeasuredMap->Field(xyz, b);
+    if (mFlatMap) {
+      mFlatMap->Field(xyz, b);
+    } else {
+      mMeasuredMap->Field(xyz, b);
+    }
     if (xyz[2] > sSolenoidToDipoleZ || mDipoleOnOffFlag) {
       for (int i = 3; i--;) {
         b[i] *= mMultipicativeFactorSolenoid;
@@ -280,6 +287,33 @@ void MagneticField::Field(const Double_t* __restrict__ xyz, Double_t* __restrict
   }
 }
 
+void MagneticField::Field(int n, const Double_t* __restrict__ xyz, Double_t* __restrict__ b)
+{
+  /*
+   * query field values at n points, the flat map evaluates them in batches
+   */
+
+  if (mFastField || !mFlatMap) {
+    for (int i = 0; i < n; i++) {
+      MagneticField::Field(xyz + 3 * i, b + 3 * i);
+    }
+    return;
+  }
+  mFlatMap->Field(n, xyz, b);
+  for (int i = 0; i < n; i++) {
+    const Double_t* pnt = xyz + 3 * i;
+    Double_t* bp = b + 3 * i;
+    if (pnt[2] > mMeasuredMap->getMinZ() && pnt[2] < mMeasuredMap->getMaxZ()) {
+      double fc = (pnt[2] > sSolenoidToDipoleZ || mDipoleOnOffFlag) ? mMultipicativeFactorSolenoid : mMultipicativeFactorDipole;
+      for (int j = 3; j--;) {
+        bp[j] *= fc;
+      }
+    } else {
+      MachineField(pnt, bp);
+    }
+  }
+}
+
 Double_t MagneticField::getBz(const Double_t* xyz) const
 {
   /*
@@ -293,7 +327,7 @@ Double_t MagneticField::getBz(const Double_t* xyz) const
     }
   }
   if (mMeasuredMap && xyz[2] > mMeasuredMap->getMinZ() && xyz[2] < mMeasuredMap->getMaxZ()) {
-    double bz = mMeasuredMap->getBz(xyz);
+    double bz = mFlatMap ? mFlatMap->getBz(xyz) : mMeasuredMap->getBz(xyz);
     return (xyz[2] > sSolenoidToDipoleZ || mDipoleOnOffFlag) ? bz * mMultipicativeFactorSolenoid
                                                              : bz * mMultipicativeFactorDipole;
   } else {
@@ -323,6 +357,11 @@ MagneticField& MagneticField::operator=(const MagneticField& src)
     mDipoleOnOffFlag = src.mDipoleOnOffFlag;
     mParameterNames = src.mParameterNames;
     mFastField.reset(src.mFastField ? new MagFieldFast(*src.getFastField()) : nullptr);
+    mFlatMap.reset(nullptr);
+    if (src.mFlatMap) {
+      mFlatMap = std::make_unique<MagFieldFlat>();
+      mFlatMap->cloneFromObject(*src.getFlatMap(), nullptr);
+    }
   }
   return *this;
 }
@@ -434,7 +473,11 @@ void MagneticField::getTPCIntegral(const Double_t* xyz, Double_t* b) const
 {
   b[0] = b[1] = b[2] = 0.0;
   if (mMeasuredMap) {
-    mMeasuredMap->getTPCIntegral(xyz, b);
+    if (mFlatMap) {
+      mFlatMap->getTPCIntegral(xyz, b);
+    } else {
+      mMeasuredMap->getTPCIntegral(xyz, b);
+    }
     for (int i = 3; i--;) {
       b[i] *= mMultipicativeFactorSolenoid;
     }
@@ -445,7 +488,11 @@ void MagneticField::getTPCRatIntegral(const Double_t* xyz, Double_t* b) const
 {
   b[0] = b[1] = b[2] = 0.0;
   if (mMeasuredMap) {
-    mMeasuredMap->getTPCRatIntegral(xyz, b);
+    if (mFlatMap) {
+      mFlatMap->getTPCRatIntegral(xyz, b);
+    } else {
+      mMeasuredMap->getTPCRatIntegral(xyz, b);
+    }
     b[2] /= 100;
   }
 }
@@ -454,7 +501,11 @@ void MagneticField::getTPCIntegralCylindrical(const Double_t* rphiz, Double_t* b
 {
   b[0] = b[1] = b[2] = 0.0;
   if (mMeasuredMap) {
-    mMeasuredMap->getTPCIntegralCylindrical(rphiz, b);
+    if (mFlatMap) {
+      mFlatMap->getTPCIntegralCylindrical(rphiz, b);
+    } else {
+      mMeasuredMap->getTPCIntegralCylindrical(rphiz, b);
+    }
     for (int i = 3; i--;) {
       b[i] *= mMultipicativeFactorSolenoid;
     }
@@ -465,7 +516,11 @@ void MagneticField::getTPCRatIntegralCylindrical(const Double_t* rphiz, Double_t
 {
   b[0] = b[1] = b[2] = 0.0;
   if (mMeasuredMap) {
-    mMeasuredMap->getTPCRatIntegralCylindrical(rphiz, b);
+    if (mFlatMap) {
+      mFlatMap->getTPCRatIntegralCylindrical(rphiz, b);
+    } else {
+      mMeasuredMap->getTPCRatIntegralCylindrical(rphiz, b);
+    }
     b[2] /= 100;
   }
 }
@@ -678,3 +733,20 @@ void MagneticField::AllowFastField(bool v)
     mFastField.reset(nullptr);
   }
 }
+
+//_____________________________________________________________________________
+void MagneticField::AllowFlatMap(bool v)
+{
+  if (v) {
+    if (!mFlatMap) {
+      if (!mMeasuredMap) {
+        LOG(WARNING) << "MagneticField::AllowFlatMap: no measured map to create the flat copy from";
+        return;
+      }
+      mFlatMap = std::make_unique<MagFieldFlat>();
+      mFlatMap->build(*mMeasuredMap);
+    }
+  } else {
+    mFlatMap.reset(nullptr);
+  }
+}
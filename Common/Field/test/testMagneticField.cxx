@@ -17,6 +17,7 @@
 #include "Field/MagneticField.h"
 #include "Field/MagFieldFast.h"
 #include <memory>
+#include <vector>
 #include "FairLogger.h" // for FairLogger
 #include <TStopwatch.h>
 #include <TRandom.h>
@@ -98,3 +99,67 @@ BOOST_AUTO_TEST_CASE(MagneticField_test)
     BOOST_CHECK(TMath::Abs(rms[i] / nomBz) < 1.e-3);
   }
 }
+
+BOOST_AUTO_TEST_CASE(MagneticField_flat_test)
+{
+  std::unique_ptr<MagneticField> fld = std::make_unique<MagneticField>("Maps", "Maps", 1., 1., o2::field::MagFieldParam::k5kG);
+  const int ntst = 10000;
+  float rnd[3];
+  std::vector<double> xyz(3 * ntst), bxyz(3 * ntst), bflat(3 * ntst), bbatch(3 * ntst), bz(ntst), btpc(3 * ntst);
+  // fill input in the solenoid and dipole regions
+  for (int it = ntst; it--;) {
+    gRandom->RndmArray(3, rnd);
+    xyz[3 * it] = rnd[0] * 400. * TMath::Cos(rnd[1] * TMath::Pi() * 2);
+    xyz[3 * it + 1] = rnd[0] * 400. * TMath::Sin(rnd[1] * TMath::Pi() * 2);
+    xyz[3 * it + 2] = -1000. + rnd[2] * 1500.;
+  }
+  for (int it = ntst; it--;) {
+    fld->Field(&xyz[3 * it], &bxyz[3 * it]);
+    bz[it] = fld->getBz(&xyz[3 * it]);
+    fld->getTPCIntegral(&xyz[3 * it], &btpc[3 * it]);
+  }
+
+  const int repFactor = 10;
+  TStopwatch swSlow;
+  swSlow.Start();
+  for (int ii = repFactor; ii--;) {
+    for (int it = ntst; it--;) {
+      fld->Field(&xyz[3 * it], &bflat[3 * it]);
+    }
+  }
+  swSlow.Stop();
+
+  fld->AllowFlatMap(true);
+  BOOST_REQUIRE(fld->getFlatMap());
+  fld->getFlatMap()->print();
+
+  TStopwatch swFlat;
+  swFlat.Start();
+  for (int ii = repFactor; ii--;) {
+    for (int it = ntst; it--;) {
+      fld->Field(&xyz[3 * it], &bflat[3 * it]);
+    }
+  }
+  swFlat.Stop();
+  TStopwatch swBatch;
+  swBatch.Start();
+  for (int ii = repFactor; ii--;) {
+    fld->Field(ntst, xyz.data(), bbatch.data());
+  }
+  swBatch.Stop();
+  LOG(INFO) << "Timing: Exact param: " << swSlow.CpuTime() / (ntst * repFactor) << " Flat param: " << swFlat.CpuTime() / (ntst * repFactor)
+            << " Batched flat param: " << swBatch.CpuTime() / (ntst * repFactor) << " s/call";
+
+  // the flat copy reproduces the parameterization up to the rounding of the float sums
+  const double tol = 1.e-4, tolTPC = 1.e-2; // kG and kG*cm
+  for (int it = ntst; it--;) {
+    double btpcFlat[3];
+    fld->getTPCIntegral(&xyz[3 * it], btpcFlat);
+    for (int i = 0; i < 3; i++) {
+      BOOST_CHECK_SMALL(bflat[3 * it + i] - bxyz[3 * it + i], tol);
+      BOOST_CHECK_SMALL(bbatch[3 * it + i] - bxyz[3 * it + i], tol);
+      BOOST_CHECK_SMALL(btpcFlat[i] - btpc[3 * it + i], tolTPC);
+    }
+    BOOST_CHECK_SMALL(fld->getBz(&xyz[3 * it]) - bz[it], tol);
+  }
+}
@@ -29,7 +29,9 @@
 #ifndef ALICEO2_MATHUTILS_RANDOMRING_H_
 #define ALICEO2_MATHUTILS_RANDOMRING_H_
 
+#include <algorithm>
 #include <array>
+#include <vector>
 
 #include "TF1.h"
 #include "TRandom.h"
@@ -56,6 +58,11 @@ class RandomRing
   /// @param [in] randomType type of the random generator
   RandomRing(const RandomType randomType = RandomType::Gaus);
 
+  /// constructor with the random generator to use
+  /// @param [in] randomType type of the random generator
+  /// @param [in] random random generator filling the ring
+  RandomRing(const RandomType randomType, TRandom& random);
+
   /// constructor accepting TF1
   /// @param [in] function TF1 function
   RandomRing(TF1& function);
@@ -64,10 +71,21 @@ class RandomRing
   /// @param [in] randomType type of the random generator
   void initialize(const RandomType randomType = RandomType::Gaus);
 
+  /// initialisation of the random ring with the random generator to use
+  /// @param [in] randomType type of the random generator
+  /// @param [in] random random generator filling the ring
+  void initialize(const RandomType randomType, TRandom& random);
+
   /// initialisation of the random ring
   /// @param [in] randomType type of the random generator
   void initialize(TF1& function);
 
+  /// initialisation of the random ring with the random generator to use
+  /// The function is sampled from its cumulative distribution on a grid of GetNpx() points
+  /// @param [in] function TF1 function
+  /// @param [in] random random generator filling the ring
+  void initialize(TF1& function, TRandom& random);
+
   /// initialisation of the random ring
   /// @param [in] randomType type of the random generator
   void initialize(std::function<float()> function);
@@ -86,6 +104,25 @@ class RandomRing
     return value;
   }
 
+  /// next n random values from the ring buffer
+  /// This function copies the values to the output array, to be processed
+  /// in bulk (e.g. in vectorised loops), and increases the buffer position by n
+  /// @param [out] values array of at least n values
+  /// @param [in] n number of values
+  void getNextValues(float* values, size_t n)
+  {
+    while (n > 0) {
+      const size_t nChunk = std::min(n, mRandomNumbers.size() - mRingPosition);
+      std::copy_n(&mRandomNumbers[mRingPosition], nChunk, values);
+      values += nChunk;
+      n -= nChunk;
+      mRingPosition += nChunk;
+      if (mRingPosition >= mRandomNumbers.size()) {
+        mRingPosition = 0;
+      }
+    }
+  }
+
   /// next vector with random values
   /// This function retuns a Vc vector with random numbers to be
   /// used for vectorised programming and increases the buffer
@@ -110,6 +147,10 @@ class RandomRing
   /// @return position in the ring buffer
   unsigned int getRingPosition() const { return mRingPosition; }
 
+  /// set the position in the ring buffer
+  /// @param [in] position new position, wrapped around the ring size
+  void setRingPosition(size_t position) { mRingPosition = position % mRandomNumbers.size(); }
+
  private:
   // =========================================================================
   // ===| members |===========================================================
@@ -131,6 +172,16 @@ inline RandomRing<N>::RandomRing(const RandomType randomType)
   initialize(randomType);
 }
 
+//______________________________________________________________________________
+template <size_t N>
+inline RandomRing<N>::RandomRing(const RandomType randomType, TRandom& random)
+  : mRandomType(randomType),
+    mRandomNumbers()
+
+{
+  initialize(randomType, random);
+}
+
 //______________________________________________________________________________
 template <size_t N>
 inline RandomRing<N>::RandomRing(TF1& function)
@@ -143,17 +194,24 @@ inline RandomRing<N>::RandomRing(TF1& function)
 //______________________________________________________________________________
 template <size_t N>
 inline void RandomRing<N>::initialize(const RandomType randomType)
+{
+  initialize(randomType, *gRandom);
+}
+
+//______________________________________________________________________________
+template <size_t N>
+inline void RandomRing<N>::initialize(const RandomType randomType, TRandom& random)
 {
 
   for (auto& v : mRandomNumbers) {
     // TODO: configurable mean and sigma
     switch (randomType) {
       case RandomType::Gaus: {
-        v = gRandom->Gaus(0, 1);
+        v = random.Gaus(0, 1);
         break;
       }
       case RandomType::Flat: {
-        v = gRandom->Rndm();
+        v = random.Rndm();
         break;
       }
       default: {
@@ -174,6 +232,26 @@ inline void RandomRing<N>::initialize(TF1& function)
   }
 }
 
+//______________________________________________________________________________
+template <size_t N>
+inline void RandomRing<N>::initialize(TF1& function, TRandom& random)
+{
+  mRandomType = RandomType::CustomTF1;
+  const int nPoints = function.GetNpx();
+  const double xMin = function.GetXmin();
+  const double dx = (function.GetXmax() - xMin) / nPoints;
+  std::vector<double> cumulative(nPoints + 1, 0.);
+  for (int i = 0; i < nPoints; ++i) {
+    cumulative[i + 1] = cumulative[i] + std::max(0., function.Eval(xMin + (i + 0.5) * dx));
+  }
+  for (auto& v : mRandomNumbers) {
+    const double r = random.Rndm() * cumulative.back();
+    const int bin = std::min<int>(std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin() - 1, nPoints - 1);
+    const double width = cumulative[bin + 1] - cumulative[bin];
+    v = xMin + (bin + (width > 0 ? (r - cumulative[bin]) / width : 0.5)) * dx;
+  }
+}
+
 //______________________________________________________________________________
 template <size_t N>
 inline void RandomRing<N>::initialize(std::function<float()> function)
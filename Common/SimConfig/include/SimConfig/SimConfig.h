@@ -45,6 +45,9 @@ struct SimConfigData {
   int mInternalChunkSize;                    //
   int mStartSeed;                            // base for random number seeds
   int mSimWorkers = 1;                       // number of parallel sim workers (when it applies)
+  int mMergerThreads = 4;                    // number of threads of the hit merger (when it applies)
+  int mPrefetchEvents = 4;                   // max number of events generated in advance by the primary server
+  int mPrefetchMemory = 1024;                // max memory (MB) of the events generated in advance by the primary server
   bool mFilterNoHitEvents = false;           // whether to filter out events not leaving any response
   std::string mCCDBUrl;                      // the URL where to find CCDB
   long mTimestamp;                           // timestamp to anchor transport simulation to
@@ -52,7 +55,7 @@ struct SimConfigData {
   bool mUniformField = false;                // uniform magnetic field
   bool mAsService = false;                   // if simulation should be run as service/deamon (does not exit after run)
 
-  ClassDefNV(SimConfigData, 4);
+  ClassDefNV(SimConfigData, 6);
 };
 
 // A singleton class which can be used
@@ -113,6 +116,9 @@ class SimConfig
   int getInternalChunkSize() const { return mConfigData.mInternalChunkSize; }
   int getStartSeed() const { return mConfigData.mStartSeed; }
   int getNSimWorkers() const { return mConfigData.mSimWorkers; }
+  int getNMergerThreads() const { return mConfigData.mMergerThreads; }
+  int getNPrefetchEvents() const { return mConfigData.mPrefetchEvents; }
+  int getPrefetchMemory() const { return mConfigData.mPrefetchMemory; }
   bool isFilterOutNoHitEvents() const { return mConfigData.mFilterNoHitEvents; }
   bool asService() const { return mConfigData.mAsService; }
 
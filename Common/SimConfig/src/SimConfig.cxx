@@ -47,6 +47,9 @@ void SimConfig::initOptions(boost::program_options::options_description& options
     "seed", bpo::value<int>()->default_value(-1), "initial seed (default: -1 random)")(
     "field", bpo::value<std::string>()->default_value("-5"), "L3 field rounded to kGauss, allowed values +-2,+-5 and 0; +-5U for uniform field ")(
     "nworkers,j", bpo::value<int>()->default_value(nsimworkersdefault), "number of parallel simulation workers (only for parallel mode)")(
+    "mergerThreads", bpo::value<int>()->default_value(4), "number of threads of the hit merger, merging the detectors concurrently (only for parallel mode)")(
+    "prefetchEvents", bpo::value<int>()->default_value(4), "max number of events generated in advance by the primary server (only for parallel mode)")(
+    "prefetchMemory", bpo::value<int>()->default_value(1024), "max memory in MB of the events generated in advance by the primary server (only for parallel mode)")(
     "noemptyevents", "only writes events with at least one hit")(
     "CCDBUrl", bpo::value<std::string>()->default_value("ccdb-test.cern.ch:8080"), "URL for CCDB to be used.")(
     "timestamp", bpo::value<long>()->default_value(-1), "global timestamp value (for anchoring) - default is now")(
@@ -106,6 +109,9 @@ bool SimConfig::resetFromParsedMap(boost::program_options::variables_map const&
   mConfigData.mInternalChunkSize = vm["chunkSizeI"].as<int>();
   mConfigData.mStartSeed = vm["seed"].as<int>();
   mConfigData.mSimWorkers = vm["nworkers"].as<int>();
+  mConfigData.mMergerThreads = vm["mergerThreads"].as<int>();
+  mConfigData.mPrefetchEvents = vm["prefetchEvents"].as<int>();
+  mConfigData.mPrefetchMemory = vm["prefetchMemory"].as<int>();
   mConfigData.mTimestamp = vm["timestamp"].as<long>();
   mConfigData.mCCDBUrl = vm["CCDBUrl"].as<std::string>();
   mConfigData.mAsService = vm["asservice"].as<bool>();
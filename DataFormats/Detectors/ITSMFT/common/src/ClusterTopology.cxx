@@ -93,7 +93,7 @@ unsigned int ClusterTopology::hashFunction(const void* key, int len)
 unsigned long ClusterTopology::getCompleteHash(int nRow, int nCol,
                                                const unsigned char patt[ClusterPattern::MaxPatternBytes])
 {
-  unsigned char extended_pattern[ClusterPattern::kExtendedPatternBytes] = {0};
+  unsigned char extended_pattern[ClusterPattern::kExtendedPatternBytes]; // only the nBytes + 2 leading bytes are used, no need to clear it
   extended_pattern[0] = (unsigned char)nRow;
   extended_pattern[1] = (unsigned char)nCol;
   int nBits = nRow * nCol;
@@ -24,6 +24,7 @@
 #include <type_traits>
 #include <cstring> // memmove, memcpy
 #include <memory>
+#include <utility>
 #include <vector>
 
 // type traits are needed for the compile time consistency check
@@ -35,6 +36,8 @@ namespace o2
 class MCCompLabel;
 namespace dataformats
 {
+template <typename TruthElement>
+class MCTruthContainerBuilder;
 
 /// @struct MCTruthHeaderElement
 /// @brief Simple struct having information about truth elements for particular indices:
@@ -95,6 +98,24 @@ class MCTruthContainer
   /// e.g. directly on the memory of the incoming message.
   std::vector<char> mStreamerData; // buffer used for streaming a flat raw buffer
 
+  friend class MCTruthContainerBuilder<TruthElement>; // fills the arrays directly
+
+  // position in the truth array of the 1st element of dataindex, the number of elements for dataindex == getIndexedSize()
+  size_t getTruthIndex(size_t dataindex) const
+  {
+    return dataindex < getIndexedSize() ? getMCTruthHeader(dataindex).index : getNElements();
+  }
+
+  static std::vector<MergeRange> makeMergeRanges(gsl::span<const MCTruthContainer<TruthElement>* const> others)
+  {
+    std::vector<MergeRange> ranges;
+    ranges.reserve(others.size());
+    for (const auto* other : others) {
+      ranges.push_back(MergeRange{other, 0, other->getIndexedSize()});
+    }
+    return ranges;
+  }
+
   size_t getSize(uint32_t dataindex) const
   {
     // calculate size / number of labels from a difference in pointed indices
@@ -174,6 +195,13 @@ class MCTruthContainer
     mTruthArray.clear();
   }
 
+  // reserve memory for nIndices data indices and nElements truth elements
+  void reserve(size_t nIndices, size_t nElements)
+  {
+    mHeaderArray.reserve(nIndices);
+    mTruthArray.reserve(nElements);
+  }
+
   // clear and force freeing the memory
   void clear_andfreememory()
   {
@@ -315,8 +343,8 @@ class MCTruthContainer
     const auto* trtArrEnd = (endIdx == other.mHeaderArray.size()) ? (&other.mTruthArray.back()) + 1 : &other.mTruthArray[other.getMCTruthHeader(endIdx).index];
 
     // copy from other
-    std::copy(headBeg, headEnd, std::back_inserter(mHeaderArray));
-    std::copy(trtArrBeg, trtArrEnd, std::back_inserter(mTruthArray));
+    mHeaderArray.insert(mHeaderArray.end(), headBeg, headEnd);
+    mTruthArray.insert(mTruthArray.end(), trtArrBeg, trtArrEnd);
     long offset = long(oldtruthsize) - other.getMCTruthHeader(from).index;
     // adjust information of newly attached part
     for (uint32_t i = oldheadersize; i < mHeaderArray.size(); ++i) {
@@ -324,6 +352,69 @@ class MCTruthContainer
     }
   }
 
+  /// part of another container to merge: "n" entries starting from "from"
+  struct MergeRange {
+    const MCTruthContainer<TruthElement>* container = nullptr;
+    size_t from = 0;
+    size_t n = 0;
+  };
+
+  /// Merge several containers or their parts to the back of this one, in the order of the ranges.
+  /// The arrays are resized once and the ranges are copied one after the other.
+  void mergeAtBack(gsl::span<const MergeRange> ranges)
+  {
+    mergeAtBack(ranges, [](size_t n, auto&& copyRange) {
+      for (size_t i = 0; i < n; i++) {
+        copyRange(i);
+      }
+    });
+  }
+
+  /// Merge several containers or their parts to the back of this one, see above.
+  /// The copies of the ranges are independent of each other and are dispatched by the caller provided
+  /// parallelFor(n, copyRange), which must call copyRange(i) once for every i in [0, n), e.g. from an
+  /// OpenMP loop of a library compiled with OpenMP. Keeps the threading out of this header.
+  template <typename ParallelFor>
+  void mergeAtBack(gsl::span<const MergeRange> ranges, ParallelFor&& parallelFor)
+  {
+    const size_t nRanges = ranges.size();
+    std::vector<size_t> headerOffsets(nRanges + 1), truthOffsets(nRanges + 1);
+    headerOffsets[0] = mHeaderArray.size();
+    truthOffsets[0] = mTruthArray.size();
+    for (size_t ir = 0; ir < nRanges; ir++) {
+      const auto& r = ranges[ir];
+      assert(r.from + r.n <= r.container->getIndexedSize());
+      headerOffsets[ir + 1] = headerOffsets[ir] + r.n;
+      truthOffsets[ir + 1] = truthOffsets[ir] + r.container->getTruthIndex(r.from + r.n) - r.container->getTruthIndex(r.from);
+    }
+    mHeaderArray.resize(headerOffsets[nRanges]);
+    mTruthArray.resize(truthOffsets[nRanges]);
+    auto copyRange = [&](size_t ir) {
+      const auto& r = ranges[ir];
+      const auto& other = *r.container;
+      const auto truthBeg = other.getTruthIndex(r.from);
+      const long offset = long(truthOffsets[ir]) - truthBeg;
+      for (size_t i = 0; i < r.n; i++) {
+        mHeaderArray[headerOffsets[ir] + i].index = other.mHeaderArray[r.from + i].index + offset;
+      }
+      std::copy(other.mTruthArray.begin() + truthBeg, other.mTruthArray.begin() + other.getTruthIndex(r.from + r.n), mTruthArray.begin() + truthOffsets[ir]);
+    };
+    parallelFor(nRanges, copyRange);
+  }
+
+  /// Merge several containers to the back of this one, see above
+  void mergeAtBack(gsl::span<const MCTruthContainer<TruthElement>* const> others)
+  {
+    mergeAtBack(makeMergeRanges(others));
+  }
+
+  /// Merge several containers to the back of this one, with the copies dispatched by parallelFor, see above
+  template <typename ParallelFor>
+  void mergeAtBack(gsl::span<const MCTruthContainer<TruthElement>* const> others, ParallelFor&& parallelFor)
+  {
+    mergeAtBack(makeMergeRanges(others), std::forward<ParallelFor>(parallelFor));
+  }
+
   /// Flatten the internal arrays to the provided container
   /// Copies the content of the two vectors of PODs to a contiguous container.
   /// The flattened data starts with a specific header @ref FlatHeader describing
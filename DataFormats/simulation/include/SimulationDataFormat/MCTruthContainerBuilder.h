@@ -0,0 +1,151 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file MCTruthContainerBuilder.h
+/// \brief Staging area to fill a MCTruthContainer with the elements of the data indices added in any order
+
+#ifndef ALICEO2_DATAFORMATS_MCTRUTHBUILDER_H_
+#define ALICEO2_DATAFORMATS_MCTRUTHBUILDER_H_
+
+#include "SimulationDataFormat/MCTruthContainer.h"
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace o2
+{
+namespace dataformats
+{
+
+/// @class MCTruthContainerBuilder
+/// @brief Collects the truth elements of data indices added in arbitrary order and produces the
+/// flat header/truth arrays of the MCTruthContainer in a single pass.
+///
+/// MCTruthContainer::addElementRandomAccess has to shift the following elements and header indices
+/// on every insertion. The builder instead chains the elements of each data index in a staging array,
+/// counting them, so that flushing to the container is a prefix sum over the counts followed by a
+/// single copy of every element to its final position. The elements of a data index keep the order in
+/// which they were added. The staging arrays keep their capacity when the builder is flushed or cleared,
+/// so a builder reused for many events does not allocate in the steady state.
+template <typename TruthElement>
+class MCTruthContainerBuilder
+{
+ public:
+  static constexpr uint32_t NoElement = -1;
+
+  // add element for a particular dataindex, the indices can come in any order
+  void addElement(uint32_t dataindex, TruthElement const& element)
+  {
+    if (dataindex >= mFirst.size()) {
+      mFirst.resize(dataindex + 1, NoElement);
+      mLast.resize(dataindex + 1, NoElement);
+      mCount.resize(dataindex + 1, 0);
+    }
+    const uint32_t id = mElements.size();
+    mElements.emplace_back(element);
+    mNext.push_back(NoElement);
+    if (mFirst[dataindex] == NoElement) {
+      mFirst[dataindex] = id;
+    } else {
+      mNext[mLast[dataindex]] = id;
+    }
+    mLast[dataindex] = id;
+    mCount[dataindex]++;
+  }
+
+  // check if an element satisfying the predicate was added for the dataindex
+  template <typename Predicate>
+  bool hasElementIf(uint32_t dataindex, Predicate&& pred) const
+  {
+    for (uint32_t id = dataindex < mFirst.size() ? mFirst[dataindex] : NoElement; id != NoElement; id = mNext[id]) {
+      if (pred(mElements[id])) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // check if the element was added for the dataindex
+  bool hasElement(uint32_t dataindex, TruthElement const& element) const
+  {
+    return hasElementIf(dataindex, [&element](TruthElement const& e) { return e == element; });
+  }
+
+  // return the number of data indices (the highest one added + 1)
+  size_t getIndexedSize() const { return mFirst.size(); }
+  // return the number of elements added
+  size_t getNElements() const { return mElements.size(); }
+  // return the number of elements added for the dataindex
+  size_t getSize(uint32_t dataindex) const { return dataindex < mCount.size() ? mCount[dataindex] : 0; }
+
+  // reserve the staging arrays
+  void reserve(size_t nIndices, size_t nElements)
+  {
+    mFirst.reserve(nIndices);
+    mLast.reserve(nIndices);
+    mCount.reserve(nIndices);
+    mElements.reserve(nElements);
+    mNext.reserve(nElements);
+  }
+
+  // clear the staged elements, keeping the memory
+  void clear()
+  {
+    mFirst.clear();
+    mLast.clear();
+    mCount.clear();
+    mElements.clear();
+    mNext.clear();
+  }
+
+  /// Append the staged elements to the back of the container, the dataindex 0 of the builder becoming
+  /// the index container.getIndexedSize(), and clear the builder.
+  void flushTo(MCTruthContainer<TruthElement>& container)
+  {
+    flushTo(container, nullptr);
+  }
+
+  /// Same as above, with the elements of every dataindex sorted with the comparator
+  template <typename Compare>
+  void flushTo(MCTruthContainer<TruthElement>& container, Compare&& cmp)
+  {
+    auto& header = container.mHeaderArray;
+    auto& truth = container.mTruthArray;
+    const size_t headerOffset = header.size();
+    uint32_t pos = truth.size();
+    header.resize(headerOffset + mFirst.size());
+    truth.resize(pos + mElements.size());
+    for (size_t i = 0; i < mFirst.size(); i++) {
+      header[headerOffset + i].index = pos;
+      const uint32_t beg = pos;
+      for (uint32_t id = mFirst[i]; id != NoElement; id = mNext[id]) {
+        truth[pos++] = mElements[id];
+      }
+      if constexpr (!std::is_same_v<std::decay_t<Compare>, std::nullptr_t>) {
+        std::sort(truth.begin() + beg, truth.begin() + pos, cmp);
+      }
+    }
+    clear();
+  }
+
+ private:
+  std::vector<uint32_t> mFirst;        // first staged element of every dataindex
+  std::vector<uint32_t> mLast;         // last staged element of every dataindex
+  std::vector<uint32_t> mCount;        // number of staged elements of every dataindex
+  std::vector<TruthElement> mElements; // staged elements in the order of addition
+  std::vector<uint32_t> mNext;         // next staged element of the same dataindex
+};
+
+} // namespace dataformats
+} // namespace o2
+
+#endif
@@ -25,9 +25,8 @@
 #include "Rtypes.h"
 #include "TParticle.h"
 
-#include <map>
 #include <memory>
-#include <stack>
+#include <vector>
 #include <utility>
 #include <functional>
 
@@ -44,8 +43,9 @@ class Detector;
 namespace data
 {
 /// This class handles the particle stack for the transport simulation.
-/// For the stack FILO functunality, it uses the STL stack. To store
-/// the tracks during transport, a TParticle array is used.
+/// For the stack FILO functunality, it uses a vector of compact particle records:
+/// a TParticle is only created for a secondary when it is handed to the transport.
+/// To store the tracks during transport, a MCTrack array is used.
 /// At the end of the event, tracks satisfying the filter criteria
 /// are copied to a MCTrack array, which is stored in the output.
 ///
@@ -230,9 +230,29 @@ class Stack : public FairGenericStack
   typedef std::function<bool(const TParticle& p, const std::vector<TParticle>& particles)> TransportFcn;
 
  private:
-  /// STL stack (FILO) used to handle the TParticles for tracking
-  /// stack entries refer to
-  std::stack<TParticle> mStack; //!
+  /// compact record of a particle put on the stack: either a reference to a primary
+  /// or the parameters of a secondary needed to create its TParticle
+  struct StackParticle {
+    Double_t px, py, pz, e;       // momentum [GeV]
+    Double_t vx, vy, vz, time;    // start vertex [cm] and time [s]
+    Double_t polx, poly, polz;    // polarisation
+    Double_t weight;              // particle weight
+    Int_t pdgCode;                // particle type
+    Int_t status;                 // status code (trackID for secondaries)
+    Int_t parentId, secondParentId, daughter1Id, daughter2Id;
+    Int_t proc;                   // production process
+    Int_t primary = -1;           // index in mPrimaryParticles for primaries
+    bool toBeDone;                // if the particle is to be transported
+  };
+
+  /// create the TParticle of a secondary record in p
+  void fillParticle(const StackParticle& entry, TParticle& p) const;
+
+  /// push the last primary particle on the stack
+  void pushPrimary();
+
+  /// FILO used to handle the particles for tracking
+  std::vector<StackParticle> mStack; //!
 
   /// Array of TParticles (contains all TParticles put into or created
   /// by the transport)
@@ -242,7 +262,7 @@ class Stack : public FairGenericStack
   std::vector<int> mTrackIDtoParticlesEntry; //! an O(1) mapping of trackID to the entry of mParticles
   // the current TParticle object
   TParticle mCurrentParticle;
-  TParticle mCurrentParticle0;
+  StackParticle mLastSecondary{}; //! the last secondary pushed
 
   // keep primary particles in its original form
   // (mainly for the PopPrimaryParticleInterface
@@ -251,8 +271,16 @@ class Stack : public FairGenericStack
   /// vector of reducded tracks written to the output
   std::vector<o2::MCTrack>* mTracks;
 
-  /// STL map from particle index to persistent track index
-  std::map<Int_t, Int_t> mIndexMap; //!
+  /// map from particle index to persistent track index (-1 if the track is not kept)
+  std::vector<int> mIndexMap; //!
+
+  // work buffers of the filtering and reordering at the end of each primary, keeping their capacity
+  std::vector<int> mIndicesKept;         //! index in mParticles -> index of the kept track
+  std::vector<int> mReOrderedIndices;    //! new -> old index of the kept tracks
+  std::vector<int> mInvReOrderedIndices; //! old -> new index of the kept tracks
+  std::vector<int> mDaughters;           //! daughters of every kept track, grouped by mother
+  std::vector<int> mFirstDaughter;       //! offset of the daughters of every kept track in mDaughters
+  std::vector<char> mReorderDone;        //! if a kept track has been placed by the reordering
 
   /// cache active O2 detectors
   std::vector<o2::base::Detector*> mActiveDetectors; //!
@@ -315,7 +343,7 @@ class Stack : public FairGenericStack
 
   void handleTransportPrimary(TParticle& p);
 
-  ClassDefOverride(Stack, 1);
+  ClassDefOverride(Stack, 2);
 };
 
 inline void Stack::addTrackReference(const o2::TrackReference& ref)
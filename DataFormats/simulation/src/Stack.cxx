@@ -205,7 +205,8 @@ void Stack::PushTrack(Int_t toBeDone, Int_t parentId, Int_t pdgCode, Double_t px
   // - in all cases to push a secondary particle
   //
   //
-  // Create new TParticle and add it to the TParticle array
+  // Secondaries are only recorded in a compact form, their TParticle is created
+  // if and when they are handed to the transport.
 
   Int_t trackId = mNumberOfEntriesInParticles;
   // Set track variable
@@ -213,46 +214,77 @@ void Stack::PushTrack(Int_t toBeDone, Int_t parentId, Int_t pdgCode, Double_t px
   //  Int_t daughter1Id = -1;
   //  Int_t daughter2Id = -1;
   Int_t iStatus = (proc == kPPrimary) ? is : trackId;
+
+  if (proc != kPPrimary) {
+    mNumberOfEntriesInParticles++;
+    insertInVector(mTrackIDtoParticlesEntry, trackId, (int)(mParticles.size()));
+
+    StackParticle entry;
+    entry.px = px;
+    entry.py = py;
+    entry.pz = pz;
+    entry.e = e;
+    entry.vx = vx;
+    entry.vy = vy;
+    entry.vz = vz;
+    entry.time = time;
+    entry.polx = polx;
+    entry.poly = poly;
+    entry.polz = polz;
+    entry.weight = weight;
+    entry.pdgCode = pdgCode;
+    entry.status = iStatus;
+    entry.parentId = parentId;
+    entry.secondParentId = secondparentId;
+    entry.daughter1Id = daughter1Id;
+    entry.daughter2Id = daughter2Id;
+    entry.proc = proc;
+    entry.toBeDone = toBeDone == 1;
+
+    // same content as the MCTrack made from the TParticle
+    auto& track = mParticles.emplace_back(pdgCode, parentId, secondparentId, daughter1Id, daughter2Id, px, py, pz, vx, vy, vz, time * 1e09, 0);
+    track.setProcess(proc);
+    track.setToBeDone(entry.toBeDone);
+    mLastSecondary = entry;
+    mStack.push_back(entry);
+    return;
+  }
+
+  // Create new TParticle for the primary
   TParticle p(pdgCode, iStatus, parentId, secondparentId, daughter1Id, daughter2Id, px, py, pz, e, vx, vy, vz, time);
   p.SetPolarisation(polx, poly, polz);
   p.SetWeight(weight);
   p.SetUniqueID(proc); // using the unique ID to transfer process ID
-  p.SetBit(ParticleStatus::kPrimary, proc == kPPrimary ? 1 : 0); // set primary bit
-  p.SetBit(ParticleStatus::kToBeDone, toBeDone == 1 ? 1 : 0);    // set to be done bit
+  p.SetBit(ParticleStatus::kPrimary, 1);                      // set primary bit
+  p.SetBit(ParticleStatus::kToBeDone, toBeDone == 1 ? 1 : 0); // set to be done bit
   mNumberOfEntriesInParticles++;
 
   insertInVector(mTrackIDtoParticlesEntry, trackId, (int)(mParticles.size()));
 
   handleTransportPrimary(p); // handle selective transport of primary particles
 
-  // Push particle on the stack if toBeDone is set
-  if (p.TestBit(ParticleStatus::kPrimary)) {
-    // This is a particle from the primary particle generator
-    //
-    // SetBit is used to pass information about the primary particle to the stack during transport.
-    // Sime particles have already decayed or are partons from a shower. They are needed for the
-    // event history in the stack, but not for transport.
-    //
-
-    // primary particles might have been pushed with a second creation process
-    // in case we pushed a secondary track of a previous simulation to be continued.
-    // We save therefore in the UniqueID the correct process
-    // while the particle will still be treated as a primary given its bit settings
-    p.SetUniqueID(proc2);
-
-    mIndexMap[trackId] = trackId;
-    p.SetBit(ParticleStatus::kKeep, 1);
-    if (p.TestBit(ParticleStatus::kToBeDone)) {
-      mNumberOfPrimariesforTracking++;
-    }
-    mNumberOfPrimaryParticles++;
-    mPrimaryParticles.push_back(p);
-    mTracks->emplace_back(p);
-  } else {
-    mParticles.emplace_back(p);
-    mCurrentParticle0 = p;
+  // This is a particle from the primary particle generator
+  //
+  // SetBit is used to pass information about the primary particle to the stack during transport.
+  // Sime particles have already decayed or are partons from a shower. They are needed for the
+  // event history in the stack, but not for transport.
+  //
+
+  // primary particles might have been pushed with a second creation process
+  // in case we pushed a secondary track of a previous simulation to be continued.
+  // We save therefore in the UniqueID the correct process
+  // while the particle will still be treated as a primary given its bit settings
+  p.SetUniqueID(proc2);
+
+  insertInVector(mIndexMap, trackId, trackId);
+  p.SetBit(ParticleStatus::kKeep, 1);
+  if (p.TestBit(ParticleStatus::kToBeDone)) {
+    mNumberOfPrimariesforTracking++;
   }
-  mStack.push(p);
+  mNumberOfPrimaryParticles++;
+  mPrimaryParticles.push_back(p);
+  mTracks->emplace_back(p);
+  pushPrimary();
 }
 
 void Stack::handleTransportPrimary(TParticle& p)
@@ -279,18 +311,37 @@ void Stack::PushTrack(int toBeDone, TParticle& p)
   // - during parallel simulation to push primary particles (called by the stack itself)
   if (p.TestBit(ParticleStatus::kPrimary)) {
     // one to one mapping for primaries
-    mIndexMap[mNumberOfPrimaryParticles] = mNumberOfPrimaryParticles;
+    insertInVector(mIndexMap, mNumberOfPrimaryParticles, mNumberOfPrimaryParticles);
     mNumberOfPrimaryParticles++;
     mPrimaryParticles.push_back(p);
     // Push particle on the stack
     if (p.TestBit(ParticleStatus::kToBeDone)) {
       mNumberOfPrimariesforTracking++;
     }
-    mStack.push(p);
+    pushPrimary();
     mTracks->emplace_back(p);
   }
 }
 
+void Stack::pushPrimary()
+{
+  StackParticle entry{};
+  entry.primary = mPrimaryParticles.size() - 1;
+  entry.toBeDone = mPrimaryParticles.back().TestBit(ParticleStatus::kToBeDone);
+  mStack.push_back(entry);
+}
+
+void Stack::fillParticle(const StackParticle& entry, TParticle& p) const
+{
+  p = TParticle(entry.pdgCode, entry.status, entry.parentId, entry.secondParentId, entry.daughter1Id, entry.daughter2Id,
+                entry.px, entry.py, entry.pz, entry.e, entry.vx, entry.vy, entry.vz, entry.time);
+  p.SetPolarisation(entry.polx, entry.poly, entry.polz);
+  p.SetWeight(entry.weight);
+  p.SetUniqueID(entry.proc); // using the unique ID to transfer process ID
+  p.SetBit(ParticleStatus::kPrimary, 0);
+  p.SetBit(ParticleStatus::kToBeDone, entry.toBeDone);
+}
+
 /// Set the current track number
 /// Declared in TVirtualMCStack
 /// \param iTrack track number
@@ -302,7 +353,7 @@ void Stack::SetCurrentTrack(Int_t iTrack)
     mCurrentParticle = p;
     mIndexOfCurrentPrimary = iTrack;
   } else {
-    mCurrentParticle = mCurrentParticle0;
+    fillParticle(mLastSecondary, mCurrentParticle);
   }
 }
 
@@ -344,18 +395,21 @@ TParticle* Stack::PopNextTrack(Int_t& iTrack)
   TParticle* nextParticle = nullptr;
   while (!found && !mStack.empty()) {
     // get next particle from stack
-    mCurrentParticle = mStack.top();
+    const auto entry = mStack.back();
     // remove particle from the top
-    mStack.pop();
+    mStack.pop_back();
     // test if primary to be transported
-    if (mCurrentParticle.TestBit(ParticleStatus::kToBeDone)) {
-      if (mCurrentParticle.TestBit(ParticleStatus::kPrimary)) {
+    if (entry.toBeDone) {
+      // create the TParticle given to the transport
+      if (entry.primary >= 0) {
+        mCurrentParticle = mPrimaryParticles[entry.primary];
         // particle is primary and needs to be tracked -> indicates that previous particle finished
         mNumberOfPrimariesPopped++;
         mIndexOfCurrentPrimary = mStack.size();
         mIndexOfCurrentTrack = mIndexOfCurrentPrimary;
       } else {
-        mIndexOfCurrentTrack = mCurrentParticle.GetStatusCode();
+        fillParticle(entry, mCurrentParticle);
+        mIndexOfCurrentTrack = entry.status;
       }
       iTrack = mIndexOfCurrentTrack;
       if (o2::conf::SimCutParams::Instance().trackSeed) {
@@ -431,8 +485,10 @@ void Stack::FinishPrimary()
   int indexNew = 0;
   int indexoffset = mTracks->size();
   int neglected = 0;
-  std::vector<int> indicesKept((int)(mParticles.size()));
-  std::vector<MCTrack> tmpTracks;
+  // the kept tracks are compacted in place at the front of mParticles
+  auto& indicesKept = mIndicesKept;
+  indicesKept.resize(mParticles.size());
+  auto& tmpTracks = mParticles;
   Int_t ic = 0;
 
   // mTrackIDtoParticlesEntry
@@ -457,7 +513,9 @@ void Stack::FinishPrimary()
       }
       // at this point we have the correct mother index in mParticles or
       // a negative one which is a pointer to a primary
-      tmpTracks.emplace_back(particle);
+      if (indexNew != indexOld) {
+        tmpTracks[indexNew] = particle;
+      }
       indicesKept[indexOld] = indexNew;
       indexNew++;
     } else {
@@ -467,9 +525,14 @@ void Stack::FinishPrimary()
     indexOld++;
     mTracksDone++;
   }
+  // the particles are not needed any longer, only the kept tracks remain
+  const Int_t nparticles = (int)(mParticles.size());
+  tmpTracks.resize(indexNew);
   Int_t ntr = (int)(tmpTracks.size());
-  std::vector<int> reOrderedIndices(ntr);
-  std::vector<int> invreOrderedIndices(ntr);
+  auto& reOrderedIndices = mReOrderedIndices;
+  auto& invreOrderedIndices = mInvReOrderedIndices;
+  reOrderedIndices.resize(ntr);
+  invreOrderedIndices.resize(ntr);
   for (Int_t i = 0; i < ntr; i++) {
     invreOrderedIndices[i] = i;
     reOrderedIndices[i] = i;
@@ -482,6 +545,7 @@ void Stack::FinishPrimary()
       invreOrderedIndices[index] = i;
     }
   }
+  mTracks->reserve(mTracks->size() + ntr);
   for (Int_t i = 0; i < ntr; i++) {
     Int_t index = reOrderedIndices[i];
     auto& particle = tmpTracks[index];
@@ -493,7 +557,7 @@ void Stack::FinishPrimary()
     imo += indexoffset;
     particle.SetMotherTrackId(imo);
     mTracks->emplace_back(particle);
-    auto& mother = mTracks->at(imo);
+    auto& mother = (*mTracks)[imo];
     if (mother.getFirstDaughterTrackId() == -1) {
       mother.SetFirstDaughterTrackId((int)(mTracks->size()) - 1);
     }
@@ -504,22 +568,23 @@ void Stack::FinishPrimary()
   // Update index map
   //
   Int_t imax = mNumberOfEntriesInParticles;
-  Int_t imin = imax - mParticles.size();
+  Int_t imin = imax - nparticles;
   for (Int_t idTrack = imin; idTrack < imax; idTrack++) {
     Int_t index1 = mTrackIDtoParticlesEntry[idTrack];
     Int_t index2 = indicesKept[index1];
     if (index2 == -1) {
+      insertInVector(mIndexMap, idTrack, -1);
       continue;
     }
     Int_t index3 = (mIsG4Like) ? invreOrderedIndices[index2] : index2;
-    mIndexMap[idTrack] = index3 + indexoffset;
+    insertInVector(mIndexMap, idTrack, index3 + indexoffset);
   }
 
-  // we can now clear the particles buffer!
+  // we can now clear the particles buffer, the work buffers keep their memory
   reOrderedIndices.clear();
   invreOrderedIndices.clear();
+  indicesKept.clear();
   mParticles.clear();
-  tmpTracks.clear();
   mTransportedIDs.clear();
   mTrackIDtoParticlesEntry.clear();
   mIndexOfPrimaries.clear();
@@ -559,12 +624,11 @@ void Stack::UpdateTrackIndex(TRefArray* detList)
   // use some caching since repeated trackIDs
   for (auto& ref : *mTrackRefs) {
     const auto id = ref.getTrackID();
-    auto iter = mIndexMap.find(id);
-    if (iter == mIndexMap.end()) {
+    if (id < 0 || id >= (int)mIndexMap.size() || mIndexMap[id] == -1) {
       LOG(INFO) << "Invalid trackref ... needs to be rmoved \n";
       ref.setTrackID(-1);
     } else {
-      ref.setTrackID(iter->second);
+      ref.setTrackID(mIndexMap[id]);
     }
   }
 
@@ -590,9 +654,7 @@ void Stack::Reset()
 
   mIndexOfCurrentTrack = -1;
   mNumberOfPrimaryParticles = mNumberOfEntriesInParticles = mNumberOfEntriesInTracks = 0;
-  while (!mStack.empty()) {
-    mStack.pop();
-  }
+  mStack.clear();
   mParticles.clear();
   mTracks->clear();
   if (!mIsExternalMode && (mPrimariesDone != mNumberOfPrimariesforTracking)) {
@@ -860,42 +922,60 @@ void Stack::ReorderKine(std::vector<MCTrack>& particles, std::vector<int>& reOrd
   // Particles are ordered in a way that descendants of a particle appear next to each other.
   // This has the advantage that their position in the stack can be identified by two number,
   // for example the index of the first and last descentant.
-  // The result of the ordering is returned via the look-up table reOrderedIndices
+  // The result of the ordering is returned via the look-up table reOrderedIndices.
+  // The daughters of every particle are grouped once, so that the ordering is done in a single pass.
   //
 
   Int_t ntr = (int)(particles.size());
-  std::vector<bool> done(ntr, false);
-
   int indexoffset = mTracks->size();
-  Int_t index = 0;
-  Int_t imoOld = 0;
-  for (Int_t i = 0; i < ntr; i++) {
-    reOrderedIndices[i] = i;
+  const Int_t imoPrimary = mIndexOfCurrentPrimary - indexoffset;
+
+  // daughters j of particle m (with m < j) are at mDaughters[mFirstDaughter[m] .. mFirstDaughter[m + 1]),
+  // in increasing order of j
+  auto& done = mReorderDone;
+  auto& daughters = mDaughters;
+  auto& first = mFirstDaughter;
+  done.assign(ntr, 0);
+  daughters.resize(ntr);
+  first.assign(ntr + 2, 0);
+  for (Int_t j = 0; j < ntr; j++) {
+    const auto m = particles[j].getMotherTrackId();
+    if (m >= 0 && m < j) {
+      first[m + 2]++;
+    }
+  }
+  for (Int_t i = 2; i < ntr + 2; i++) {
+    first[i] += first[i - 1];
+  }
+  for (Int_t j = 0; j < ntr; j++) {
+    const auto m = particles[j].getMotherTrackId();
+    if (m >= 0 && m < j) {
+      daughters[first[m + 1]++] = j;
+    }
   }
 
-  for (Int_t i = -1; i < ntr; i++) {
-    if (i != -1) {
-      // secondaries
-      if (!done[i]) {
-        reOrderedIndices[index] = i;
-        index++;
-        done[i] = true;
-      }
-      imoOld = i;
-    } else {
-      // current primary
-      imoOld = mIndexOfCurrentPrimary - indexoffset;
+  Int_t index = 0;
+  // daughters of the current primary
+  for (Int_t j = 0; j < ntr; j++) {
+    if (particles[j].getMotherTrackId() == imoPrimary) {
+      reOrderedIndices[index++] = j;
+      done[j] = 1;
+    }
+  }
+  // secondaries, each followed by its daughters
+  for (Int_t i = 0; i < ntr; i++) {
+    if (!done[i]) {
+      reOrderedIndices[index++] = i;
+      done[i] = 1;
     }
-    for (Int_t j = i + 1; j < ntr; j++) {
+    for (Int_t k = first[i]; k < first[i + 1]; k++) {
+      const auto j = daughters[k];
       if (!done[j]) {
-        if ((particles[j]).getMotherTrackId() == imoOld) {
-          reOrderedIndices[index] = j;
-          index++;
-          done[j] = true;
-        } // child found
-      }   // done
-    }     // j
-  }       // i
+        reOrderedIndices[index++] = j;
+        done[j] = 1;
+      }
+    }
+  }
 }
 
 FairGenericStack* Stack::CloneStack() const { return new o2::data::Stack(*this); }
@@ -23,6 +23,10 @@
 #include "TFile.h"
 #include "TParticle.h"
 #include "TMCProcess.h"
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
 
 using namespace o2;
 
@@ -93,3 +97,121 @@ BOOST_AUTO_TEST_CASE(Stack_test)
     BOOST_CHECK(inst->getPrimaries().size() == 2);
   }
 }
+
+// the reordering of the kinematics as it was done before it was made a single pass,
+// used as reference: daughters of the current primary first, then every particle followed by its daughters
+std::vector<int> reorderKineReference(const std::vector<MCTrack>& particles, int imoPrimary)
+{
+  int ntr = particles.size();
+  std::vector<bool> done(ntr, false);
+  std::vector<int> reOrderedIndices(ntr);
+  int index = 0;
+  for (int i = -1; i < ntr; i++) {
+    int imoOld = imoPrimary;
+    if (i != -1) {
+      if (!done[i]) {
+        reOrderedIndices[index++] = i;
+        done[i] = true;
+      }
+      imoOld = i;
+    }
+    for (int j = i + 1; j < ntr; j++) {
+      if (!done[j] && particles[j].getMotherTrackId() == imoOld) {
+        reOrderedIndices[index++] = j;
+        done[j] = true;
+      }
+    }
+  }
+  return reOrderedIndices;
+}
+
+BOOST_AUTO_TEST_CASE(Stack_ReorderKine)
+{
+  o2::data::Stack st;
+  int a;
+  st.PushTrack(1, -1, 211, 0., 0., 1., 1., 0., 0., 0., 0., 0., 0., 0., kPPrimary, a, 1., 1);
+  st.PopNextTrack(a);
+  // one primary is stored and transported: its daughters have mother -1 in the particle buffer
+  const int imoPrimary = -1;
+
+  auto makeTracks = [](std::vector<int> const& mothers) {
+    std::vector<MCTrack> tracks;
+    for (auto m : mothers) {
+      tracks.emplace_back(211, m, -1, -1, -1, 0., 0., 1., 0., 0., 0., 0., 0);
+    }
+    return tracks;
+  };
+
+  // hand-built tree
+  auto tracks = makeTracks({-1, -1, 0, 1, 0, 2, 3, -1});
+  std::vector<int> reOrderedIndices(tracks.size());
+  st.ReorderKine(tracks, reOrderedIndices);
+  BOOST_CHECK(reOrderedIndices == (std::vector<int>{0, 1, 7, 2, 4, 3, 5, 6}));
+  BOOST_CHECK(reOrderedIndices == reorderKineReference(tracks, imoPrimary));
+
+  // random trees, including mothers which come after their daughters and mothers of other primaries
+  std::mt19937 gen(1234);
+  for (int itree = 0; itree < 1000; itree++) {
+    const int ntr = gen() % 50;
+    std::vector<int> mothers(ntr);
+    for (int j = 0; j < ntr; j++) {
+      switch (gen() % 4) {
+        case 0:
+          mothers[j] = imoPrimary;
+          break;
+        case 1:
+          mothers[j] = -int(gen() % 3) - 2;
+          break;
+        case 2:
+          mothers[j] = gen() % ntr;
+          break;
+        default:
+          mothers[j] = j > 0 ? int(gen() % j) : imoPrimary;
+      }
+    }
+    tracks = makeTracks(mothers);
+    reOrderedIndices.assign(ntr, -1);
+    st.ReorderKine(tracks, reOrderedIndices);
+    BOOST_CHECK(reOrderedIndices == reorderKineReference(tracks, imoPrimary));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(Stack_FinishPrimary)
+{
+  o2::data::Stack st;
+  st.pruneKinematics(true);
+  int a;
+  st.PushTrack(1, -1, 211, 0., 0., 1., 1., 0., 0., 0., 0., 0., 0., 0., kPPrimary, a, 1., 1);
+  st.PopNextTrack(a);
+  BOOST_CHECK_EQUAL(a, 0);
+
+  // secondaries 1 .. 6 with mothers 0, 0, 1, 2, 3, 4 and pdg code 100 + trackID
+  const int mothers[] = {0, 0, 1, 2, 3, 4};
+  for (int i = 0; i < 6; i++) {
+    int ntr;
+    st.PushTrack(1, mothers[i], 101 + i, 0., 0., 1., 1., 0., 0., 0., 0., 0., 0., 0., kPHadronic, ntr, 1., 0);
+    BOOST_CHECK_EQUAL(ntr, i + 1);
+  }
+  // only track 5 leaves a hit: it is kept with its ancestors 3 and 1, the direct daughters
+  // of the primary (1 and 2) are kept in any case, 4 and 6 are dropped
+  st.SetCurrentTrack(5);
+  st.addHit(0);
+  st.FinishPrimary();
+
+  // expected output, as produced before the compaction was done in place:
+  // pdg code, mother, first and last daughter
+  const std::vector<std::array<int, 4>> expected{{211, -1, 1, 2},
+                                                 {101, 0, 3, 3},
+                                                 {102, 0, -1, -1},
+                                                 {103, 1, 4, 4},
+                                                 {105, 3, -1, -1}};
+  auto tracks = st.getMCTracks();
+  BOOST_CHECK_EQUAL(tracks->size(), expected.size());
+  for (size_t i = 0; i < std::min(tracks->size(), expected.size()); i++) {
+    const auto& track = (*tracks)[i];
+    BOOST_CHECK_EQUAL(track.GetPdgCode(), expected[i][0]);
+    BOOST_CHECK_EQUAL(track.getMotherTrackId(), expected[i][1]);
+    BOOST_CHECK_EQUAL(track.getFirstDaughterTrackId(), expected[i][2]);
+    BOOST_CHECK_EQUAL(track.getLastDaughterTrackId(), expected[i][3]);
+  }
+}
@@ -15,6 +15,7 @@
 #include <boost/test/unit_test.hpp>
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "SimulationDataFormat/ConstMCTruthContainer.h"
+#include "SimulationDataFormat/MCTruthContainerBuilder.h"
 #include "SimulationDataFormat/LabelContainer.h"
 #include "SimulationDataFormat/IOMCTruthContainerView.h"
 #include <algorithm>
@@ -155,6 +156,111 @@ BOOST_AUTO_TEST_CASE(MCTruth_RandomAccess)
   }
 }
 
+BOOST_AUTO_TEST_CASE(MCTruth_Builder)
+{
+  using TruthElement = long;
+  // same content as in MCTruth_RandomAccess
+  dataformats::MCTruthContainerBuilder<TruthElement> builder;
+  builder.addElement(0, TruthElement(1));
+  builder.addElement(0, TruthElement(2));
+  builder.addElement(1, TruthElement(1));
+  builder.addElement(2, TruthElement(10));
+  builder.addElement(1, TruthElement(5));
+  builder.addElement(0, TruthElement(5));
+  builder.addElement(3, TruthElement(20));
+  builder.addElement(3, TruthElement(21));
+  BOOST_CHECK(builder.getIndexedSize() == 4);
+  BOOST_CHECK(builder.getNElements() == 8);
+  BOOST_CHECK(builder.getSize(0) == 3);
+  BOOST_CHECK(builder.hasElement(1, TruthElement(5)));
+  BOOST_CHECK(!builder.hasElement(1, TruthElement(2)));
+
+  dataformats::MCTruthContainer<TruthElement> container;
+  container.addElement(0, TruthElement(100));
+  builder.flushTo(container);
+  BOOST_CHECK(builder.getNElements() == 0);
+  BOOST_CHECK(container.getIndexedSize() == 5);
+  BOOST_CHECK(container.getNElements() == 9);
+  BOOST_CHECK(container.getMCTruthHeader(1).index == 1);
+  BOOST_CHECK(container.getMCTruthHeader(2).index == 4);
+  BOOST_CHECK(container.getMCTruthHeader(3).index == 6);
+  BOOST_CHECK(container.getMCTruthHeader(4).index == 7);
+  {
+    auto view = container.getLabels(1);
+    BOOST_CHECK(view.size() == 3);
+    BOOST_CHECK(view[0] == 1 && view[1] == 2 && view[2] == 5);
+  }
+  {
+    auto view = container.getLabels(2);
+    BOOST_CHECK(view.size() == 2);
+    BOOST_CHECK(view[0] == 1 && view[1] == 5);
+  }
+
+  // indices without elements and sorting of the elements of each index
+  builder.addElement(2, TruthElement(3));
+  builder.addElement(2, TruthElement(1));
+  builder.addElement(2, TruthElement(2));
+  dataformats::MCTruthContainer<TruthElement> container2;
+  builder.flushTo(container2, [](TruthElement a, TruthElement b) { return a < b; });
+  BOOST_CHECK(container2.getIndexedSize() == 3);
+  BOOST_CHECK(container2.getLabels(0).size() == 0);
+  BOOST_CHECK(container2.getLabels(1).size() == 0);
+  auto view = container2.getLabels(2);
+  BOOST_CHECK(view.size() == 3);
+  BOOST_CHECK(view[0] == 1 && view[1] == 2 && view[2] == 3);
+}
+
+BOOST_AUTO_TEST_CASE(MCTruth_MergeRanges)
+{
+  using TruthElement = long;
+  using TruthContainer = dataformats::MCTruthContainer<TruthElement>;
+  std::vector<TruthContainer> parts(4);
+  for (int ip = 0; ip < parts.size(); ip++) {
+    for (int i = 0; i < 10 + ip; i++) {
+      for (int j = 0; j <= i % 3; j++) {
+        parts[ip].addElement(i, TruthElement(1000 * ip + 10 * i + j));
+      }
+    }
+  }
+  // bulk merge of full containers vs one by one merge
+  TruthContainer merged, reference;
+  const TruthContainer* ptrs[] = {&parts[0], &parts[1], &parts[2], &parts[3]};
+  merged.mergeAtBack(gsl::span<const TruthContainer* const>(ptrs), [](size_t n, auto&& copyRange) {
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(2)
+#endif
+    for (size_t i = 0; i < n; i++) {
+      copyRange(i);
+    }
+  });
+  for (const auto& p : parts) {
+    reference.mergeAtBack(p);
+  }
+  BOOST_CHECK(merged.getIndexedSize() == reference.getIndexedSize());
+  BOOST_CHECK(merged.getNElements() == reference.getNElements());
+  for (int i = 0; i < reference.getIndexedSize(); i++) {
+    BOOST_CHECK(merged.getMCTruthHeader(i).index == reference.getMCTruthHeader(i).index);
+  }
+  BOOST_CHECK(merged.getTruthArray() == reference.getTruthArray());
+
+  // bulk merge of parts vs one by one merge of parts, including empty ones
+  std::vector<TruthContainer::MergeRange> ranges{{&parts[1], 2, 5}, {&parts[0], 0, 0}, {&parts[3], 10, 3}, {&parts[2], 0, 4}};
+  TruthContainer mergedR, referenceR;
+  mergedR.addElement(0, TruthElement(-1));
+  referenceR.addElement(0, TruthElement(-1));
+  mergedR.mergeAtBack(gsl::span<const TruthContainer::MergeRange>(ranges));
+  for (const auto& r : ranges) {
+    if (r.n) {
+      referenceR.mergeAtBack(*r.container, r.from, r.n);
+    }
+  }
+  BOOST_CHECK(mergedR.getIndexedSize() == referenceR.getIndexedSize());
+  for (int i = 0; i < referenceR.getIndexedSize(); i++) {
+    BOOST_CHECK(mergedR.getMCTruthHeader(i).index == referenceR.getMCTruthHeader(i).index);
+  }
+  BOOST_CHECK(mergedR.getTruthArray() == referenceR.getTruthArray());
+}
+
 BOOST_AUTO_TEST_CASE(MCTruthContainer_flatten)
 {
   using TruthElement = long;
@@ -23,6 +23,7 @@
 #include "CCDB/BasicCCDBManager.h"
 #include "Steer/MCKinematicsReader.h"
 #include "SimulationDataFormat/MCCompLabel.h"
+#include "SimulationDataFormat/MCTrack.h"
 #include "ReconstructionDataFormats/PrimaryVertex.h"
 #include "ReconstructionDataFormats/GlobalTrackID.h"
 #include "DataFormatsGlobalTracking/RecoContainer.h"
@@ -33,9 +34,6 @@
 
 #include <string>
 #include <vector>
-#include <boost/tuple/tuple.hpp>
-#include <boost/unordered_map.hpp>
-#include <boost/functional/hash.hpp>
 
 using namespace o2::framework;
 using GID = o2::dataformats::GlobalTrackID;
@@ -118,29 +116,8 @@ using MCParticlesTable = o2::soa::Table<o2::aod::mcparticle::McCollisionId,
                                         o2::aod::mcparticle::Vz,
                                         o2::aod::mcparticle::Vt>;
 
-typedef boost::tuple<int, int, int> Triplet_t;
-
-struct TripletHash : std::unary_function<Triplet_t, std::size_t> {
-  std::size_t operator()(Triplet_t const& e) const
-  {
-    std::size_t seed = 0;
-    boost::hash_combine(seed, e.get<0>());
-    boost::hash_combine(seed, e.get<1>());
-    boost::hash_combine(seed, e.get<2>());
-    return seed;
-  }
-};
-
-struct TripletEqualTo : std::binary_function<Triplet_t, Triplet_t, bool> {
-  bool operator()(Triplet_t const& x, Triplet_t const& y) const
-  {
-    return (x.get<0>() == y.get<0>() &&
-            x.get<1>() == y.get<1>() &&
-            x.get<2>() == y.get<2>());
-  }
-};
-
-typedef boost::unordered_map<Triplet_t, int, TripletHash, TripletEqualTo> TripletsMap_t;
+// index of the MC particles in the MC particles table, per source, event and particle (-1 if not stored)
+using MCParticlesIndex_t = std::vector<std::vector<std::vector<int>>>;
 
 class AODProducerWorkflowDPL : public Task
 {
@@ -159,6 +136,7 @@ class AODProducerWorkflowDPL : public Task
   int64_t mTFNumber{-1};
   int mTruncate{1};
   int mRecoOnly{0};
+  int mNThreads{1};
   bool mFillSVertices{false};
   TStopwatch mTimer;
 
@@ -242,7 +220,9 @@ class AODProducerWorkflowDPL : public Task
                             gsl::span<const o2::MCCompLabel>& mcTruthITS, std::vector<bool>& isStoredITS,
                             gsl::span<const o2::MCCompLabel>& mcTruthMFT, std::vector<bool>& isStoredMFT,
                             gsl::span<const o2::MCCompLabel>& mcTruthTPC, std::vector<bool>& isStoredTPC,
-                            TripletsMap_t& toStore);
+                            MCParticlesIndex_t& toStore);
+
+  int markMCParticlesToStore(std::vector<MCTrack> const& mcParticles, std::vector<int>& particleIndex) const;
 };
 
 /// create a processor spec
@@ -40,9 +40,13 @@
 #include "FT0Base/Geometry.h"
 #include "TMath.h"
 #include "MathUtils/Utils.h"
+#include <algorithm>
 #include <map>
 #include <unordered_map>
 #include <vector>
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 using namespace o2::framework;
 using namespace o2::math_utils::detail;
@@ -194,143 +198,169 @@ void AODProducerWorkflowDPL::addToMFTTracksTable(mftTracksCursorType& mftTracksC
                   track.getTrackChi2());
 }
 
+int AODProducerWorkflowDPL::markMCParticlesToStore(std::vector<MCTrack> const& mcParticles, std::vector<int>& particleIndex) const
+{
+  // particleIndex must have the size of mcParticles and contain -1 for all particles,
+  // except for the reconstructed ones which are marked with a non-negative value
+  // on return, it contains the index of each particle among the stored ones of this event (-1 if not stored)
+  // and the number of stored particles is returned
+
+  // loop over stack of MC particles from end to beginning: daughters are stored after mothers
+  if (mRecoOnly) {
+    for (int particle = mcParticles.size() - 1; particle >= 0; particle--) {
+      int mother0 = mcParticles[particle].getMotherTrackId();
+      if (mother0 == -1) {
+        particleIndex[particle] = 0;
+      }
+      if (particleIndex[particle] < 0) {
+        continue;
+      }
+      if (mother0 != -1) {
+        particleIndex[mother0] = 0;
+      }
+      int mother1 = mcParticles[particle].getSecondMotherTrackId();
+      if (mother1 != -1) {
+        particleIndex[mother1] = 0;
+      }
+      int daughter0 = mcParticles[particle].getFirstDaughterTrackId();
+      if (daughter0 != -1) {
+        particleIndex[daughter0] = 0;
+      }
+      int daughterL = mcParticles[particle].getLastDaughterTrackId();
+      if (daughterL != -1) {
+        particleIndex[daughterL] = 0;
+      }
+    }
+  }
+
+  // enumerate stored mc particles to get mother/daughter relations
+  // if all mc particles are stored, all mc particles are enumerated
+  int nStored = 0;
+  for (int particle = 0; particle < mcParticles.size(); particle++) {
+    if (!mRecoOnly || particleIndex[particle] >= 0) {
+      particleIndex[particle] = nStored++;
+    }
+  }
+  return nStored;
+}
+
 template <typename MCParticlesCursorType>
 void AODProducerWorkflowDPL::fillMCParticlesTable(o2::steer::MCKinematicsReader& mcReader, const MCParticlesCursorType& mcParticlesCursor,
                                                   gsl::span<const o2::MCCompLabel>& mcTruthITS, std::vector<bool>& isStoredITS,
                                                   gsl::span<const o2::MCCompLabel>& mcTruthMFT, std::vector<bool>& isStoredMFT,
                                                   gsl::span<const o2::MCCompLabel>& mcTruthTPC, std::vector<bool>& isStoredTPC,
-                                                  TripletsMap_t& toStore)
+                                                  MCParticlesIndex_t& toStore)
 {
-  // mark reconstructed MC particles to store them into the table
-  for (int i = 0; i < mcTruthITS.size(); i++) {
-    auto& mcTruth = mcTruthITS[i];
-    if (!mcTruth.isValid()) {
-      continue;
-    }
-    int source = mcTruth.getSourceID();
-    int event = mcTruth.getEventID();
-    int particle = mcTruth.getTrackID();
-    toStore[Triplet_t(source, event, particle)] = 1;
+  toStore.resize(mcReader.getNSources());
+  for (int source = 0; source < mcReader.getNSources(); source++) {
+    toStore[source].resize(mcReader.getNEvents(source));
   }
-  for (int i = 0; i < mcTruthMFT.size(); i++) {
-    auto& mcTruth = mcTruthMFT[i];
-    if (!mcTruth.isValid()) {
-      continue;
+
+  // mark reconstructed MC particles to store them into the table
+  // the index arrays of the events are extended to their full size when the event is processed
+  int nBadLabels = 0;
+  for (auto mcTruthArray : {mcTruthITS, mcTruthMFT, mcTruthTPC}) {
+    for (auto& mcTruth : mcTruthArray) {
+      if (!mcTruth.isValid()) {
+        continue;
+      }
+      int source = mcTruth.getSourceID();
+      int event = mcTruth.getEventID();
+      if (source >= (int)toStore.size() || event >= (int)toStore[source].size()) {
+        nBadLabels++;
+        continue;
+      }
+      auto& particleIndex = toStore[source][event];
+      int particle = mcTruth.getTrackID();
+      if (particle >= (int)particleIndex.size()) {
+        particleIndex.resize(particle + 1, -1);
+      }
+      particleIndex[particle] = 0;
     }
-    int source = mcTruth.getSourceID();
-    int event = mcTruth.getEventID();
-    int particle = mcTruth.getTrackID();
-    toStore[Triplet_t(source, event, particle)] = 1;
   }
-  for (int i = 0; i < mcTruthTPC.size(); i++) {
-    auto& mcTruth = mcTruthTPC[i];
-    if (!mcTruth.isValid()) {
-      continue;
-    }
-    int source = mcTruth.getSourceID();
-    int event = mcTruth.getEventID();
-    int particle = mcTruth.getTrackID();
-    toStore[Triplet_t(source, event, particle)] = 1;
+  if (nBadLabels) {
+    LOG(WARNING) << "Skipped " << nBadLabels << " MC labels with source or event out of the collision context";
   }
-  int tableIndex = 1;
+
+  // events are processed in batches: the kinematics is read sequentially (the reader serializes the access with a lock),
+  // then the particles to store are found for all the events of the batch in parallel on the tracks read beforehand,
+  // and finally they are filled into the table in order
+  const int batchSize = 4 * mNThreads;
+  std::vector<int> nStored(batchSize);
+  std::vector<o2::steer::MCKinematicsCache::TrackVectorPtr> batchTracks(batchSize);
+  int tableIndex = 0;
   for (int source = 0; source < mcReader.getNSources(); source++) {
-    for (int event = 0; event < mcReader.getNEvents(source); event++) {
-      std::vector<MCTrack> const& mcParticles = mcReader.getTracks(source, event);
-      // mark tracks to be stored per event
-      // loop over stack of MC particles from end to beginning: daughters are stored after mothers
-      if (mRecoOnly) {
-        for (int particle = mcParticles.size() - 1; particle >= 0; particle--) {
-          int mother0 = mcParticles[particle].getMotherTrackId();
-          if (mother0 == -1) {
-            toStore[Triplet_t(source, event, particle)] = 1;
-          }
-          if (toStore.find(Triplet_t(source, event, particle)) == toStore.end()) {
-            continue;
-          }
-          if (mother0 != -1) {
-            toStore[Triplet_t(source, event, mother0)] = 1;
-          }
-          int mother1 = mcParticles[particle].getSecondMotherTrackId();
-          if (mother1 != -1) {
-            toStore[Triplet_t(source, particle, mother1)] = 1;
-          }
-          int daughter0 = mcParticles[particle].getFirstDaughterTrackId();
-          if (daughter0 != -1) {
-            toStore[Triplet_t(source, event, daughter0)] = 1;
-          }
-          int daughterL = mcParticles[particle].getLastDaughterTrackId();
-          if (daughterL != -1) {
-            toStore[Triplet_t(source, event, daughterL)] = 1;
-          }
-        }
-        // enumerate reconstructed mc particles and their relatives to get mother/daughter relations
-        for (int particle = 0; particle < mcParticles.size(); particle++) {
-          auto mapItem = toStore.find(Triplet_t(source, event, particle));
-          if (mapItem != toStore.end()) {
-            mapItem->second = tableIndex - 1;
-            tableIndex++;
+    int nEvents = mcReader.getNEvents(source);
+    for (int firstEvent = 0; firstEvent < nEvents; firstEvent += batchSize) {
+      int lastEvent = std::min(nEvents, firstEvent + batchSize);
+      for (int event = firstEvent; event < lastEvent; event++) {
+        auto& tracks = batchTracks[event - firstEvent];
+        tracks = mcReader.getTracksPtr(source, event);
+        auto& particleIndex = toStore[source][event];
+        int nParticles = tracks ? tracks->size() : 0;
+        if ((int)particleIndex.size() > nParticles) {
+          int nBeyond = std::count_if(particleIndex.begin() + nParticles, particleIndex.end(), [](int index) { return index >= 0; });
+          if (nBeyond) {
+            LOG(WARNING) << "Skipped " << nBeyond << " MC labels beyond the " << nParticles << " particles of source " << source << " event " << event;
           }
         }
+        particleIndex.resize(nParticles, -1);
       }
-      // if all mc particles are stored, all mc particles will be enumerated
-      if (!mRecoOnly) {
-        for (int particle = 0; particle < mcParticles.size(); particle++) {
-          toStore[Triplet_t(source, event, particle)] = tableIndex - 1;
-          tableIndex++;
-        }
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+      for (int event = firstEvent; event < lastEvent; event++) {
+        auto const& tracks = batchTracks[event - firstEvent];
+        nStored[event - firstEvent] = tracks ? markMCParticlesToStore(*tracks, toStore[source][event]) : 0;
       }
+
       // fill survived mc tracks into the table
-      for (int particle = 0; particle < mcParticles.size(); particle++) {
-        if (toStore.find(Triplet_t(source, event, particle)) == toStore.end()) {
-          continue;
-        }
-        int statusCode = 0;
-        uint8_t flags = 0;
-        float weight = 0.f;
-        int mcMother0 = mcParticles[particle].getMotherTrackId();
-        auto item = toStore.find(Triplet_t(source, event, mcMother0));
-        int mother0 = -1;
-        if (item != toStore.end()) {
-          mother0 = item->second;
-        }
-        int mcMother1 = mcParticles[particle].getSecondMotherTrackId();
-        int mother1 = -1;
-        item = toStore.find(Triplet_t(source, event, mcMother1));
-        if (item != toStore.end()) {
-          mother1 = item->second;
-        }
-        int mcDaughter0 = mcParticles[particle].getFirstDaughterTrackId();
-        int daughter0 = -1;
-        item = toStore.find(Triplet_t(source, event, mcDaughter0));
-        if (item != toStore.end()) {
-          daughter0 = item->second;
+      for (int event = firstEvent; event < lastEvent; event++) {
+        auto& particleIndex = toStore[source][event];
+        auto getTableIndex = [&particleIndex, tableIndex](int particle) {
+          return (particle < 0 || particleIndex[particle] < 0) ? -1 : tableIndex + particleIndex[particle];
+        };
+        for (int particle = 0; particle < (int)particleIndex.size(); particle++) {
+          if (particleIndex[particle] < 0) {
+            continue;
+          }
+          auto const& mcParticles = *batchTracks[event - firstEvent];
+          int statusCode = 0;
+          uint8_t flags = 0;
+          float weight = 0.f;
+          int mother0 = getTableIndex(mcParticles[particle].getMotherTrackId());
+          int mother1 = getTableIndex(mcParticles[particle].getSecondMotherTrackId());
+          int daughter0 = getTableIndex(mcParticles[particle].getFirstDaughterTrackId());
+          int daughterL = getTableIndex(mcParticles[particle].getLastDaughterTrackId());
+          mcParticlesCursor(0,
+                            event,
+                            mcParticles[particle].GetPdgCode(),
+                            statusCode,
+                            flags,
+                            mother0,
+                            mother1,
+                            daughter0,
+                            daughterL,
+                            truncateFloatFraction(weight, mMcParticleW),
+                            truncateFloatFraction((float)mcParticles[particle].Px(), mMcParticleMom),
+                            truncateFloatFraction((float)mcParticles[particle].Py(), mMcParticleMom),
+                            truncateFloatFraction((float)mcParticles[particle].Pz(), mMcParticleMom),
+                            truncateFloatFraction((float)mcParticles[particle].GetEnergy(), mMcParticleMom),
+                            truncateFloatFraction((float)mcParticles[particle].Vx(), mMcParticlePos),
+                            truncateFloatFraction((float)mcParticles[particle].Vy(), mMcParticlePos),
+                            truncateFloatFraction((float)mcParticles[particle].Vz(), mMcParticlePos),
+                            truncateFloatFraction((float)mcParticles[particle].T(), mMcParticlePos));
         }
-        int mcDaughterL = mcParticles[particle].getLastDaughterTrackId();
-        int daughterL = -1;
-        item = toStore.find(Triplet_t(source, event, mcDaughterL));
-        if (item != toStore.end()) {
-          daughterL = item->second;
+        // convert to the index in the table, used to fill the track labels
+        for (auto& index : particleIndex) {
+          if (index >= 0) {
+            index += tableIndex;
+          }
         }
-        mcParticlesCursor(0,
-                          event,
-                          mcParticles[particle].GetPdgCode(),
-                          statusCode,
-                          flags,
-                          mother0,
-                          mother1,
-                          daughter0,
-                          daughterL,
-                          truncateFloatFraction(weight, mMcParticleW),
-                          truncateFloatFraction((float)mcParticles[particle].Px(), mMcParticleMom),
-                          truncateFloatFraction((float)mcParticles[particle].Py(), mMcParticleMom),
-                          truncateFloatFraction((float)mcParticles[particle].Pz(), mMcParticleMom),
-                          truncateFloatFraction((float)mcParticles[particle].GetEnergy(), mMcParticleMom),
-                          truncateFloatFraction((float)mcParticles[particle].Vx(), mMcParticlePos),
-                          truncateFloatFraction((float)mcParticles[particle].Vy(), mMcParticlePos),
-                          truncateFloatFraction((float)mcParticles[particle].Vz(), mMcParticlePos),
-                          truncateFloatFraction((float)mcParticles[particle].T(), mMcParticlePos));
+        tableIndex += nStored[event - firstEvent];
+        batchTracks[event - firstEvent].reset();
+        mcReader.releaseTracksForSourceAndEvent(source, event);
       }
-      mcReader.releaseTracksForSourceAndEvent(source, event);
     }
   }
 }
@@ -346,6 +376,7 @@ void AODProducerWorkflowDPL::init(InitContext& ic)
   mTFNumber = ic.options().get<int64_t>("aod-timeframe-id");
   mRecoOnly = ic.options().get<int>("reco-mctracks-only");
   mTruncate = ic.options().get<int>("enable-truncation");
+  mNThreads = std::max(1, ic.options().get<int>("nthreads"));
 
   if (mTFNumber == -1L) {
     LOG(INFO) << "TFNumber will be obtained from CCDB";
@@ -353,6 +384,9 @@ void AODProducerWorkflowDPL::init(InitContext& ic)
 
   LOG(INFO) << "Track filling flags are set to: "
             << "\n ITS = " << mFillTracksITS << "\n MFT = " << mFillTracksMFT << "\n TPC = " << mFillTracksTPC << "\n ITSTPC = " << mFillTracksITSTPC;
+#ifdef WITH_OPENMP
+  LOG(INFO) << "Independent tables are filled with up to " << mNThreads << " threads";
+#endif
 
   if (mTruncate != 1) {
     LOG(INFO) << "Truncation is not used!";
@@ -488,6 +522,14 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
   std::map<uint64_t, int> bcsMap;
   collectBCs(ft0RecPoints, primVertices, mcRecords, bcsMap);
 
+  // preallocate the columns of the tables whose (maximum) number of rows is known in advance
+  tracksBuilder.reserve<o2::aodproducer::TracksTable>(primVerGIs.size());
+  tracksCovBuilder.reserve<o2::aodproducer::TracksCovTable>(primVerGIs.size());
+  tracksExtraBuilder.reserve<o2::aodproducer::TracksExtraTable>(primVerGIs.size());
+  mcTrackLabelBuilder.reserve<o2::aod::McTrackLabels>(primVerGIs.size());
+  collisionsBuilder.reserve<o2::aod::Collisions>(primVertices.size());
+  bcBuilder.reserve<o2::aod::BCs>(bcsMap.size());
+
   const auto* dh = o2::header::get<o2::header::DataHeader*>(pc.inputs().getByPos(0).header);
   o2::InteractionRecord startIR = {0, dh->firstTForbit};
 
@@ -500,392 +542,421 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
     tfNumber = mTFNumber;
   }
 
-  // TODO: add real FV0A, FV0C, FDD, ZDC tables instead of dummies
-  uint64_t dummyBC = 0;
-  float dummyTime = 0.f;
-  float dummyFV0AmplA[48] = {0.};
-  uint8_t dummyTriggerMask = 0;
-  fv0aCursor(0,
-             dummyBC,
-             dummyFV0AmplA,
-             dummyTime,
-             dummyTriggerMask);
-
-  float dummyFV0AmplC[32] = {0.};
-  fv0cCursor(0,
-             dummyBC,
-             dummyFV0AmplC,
-             dummyTime);
-
-  float dummyFDDAmplA[4] = {0.};
-  float dummyFDDAmplC[4] = {0.};
-  fddCursor(0,
-            dummyBC,
-            dummyFDDAmplA,
-            dummyFDDAmplC,
-            dummyTime,
-            dummyTime,
-            dummyTriggerMask);
-
-  float dummyEnergyZEM1 = 0;
-  float dummyEnergyZEM2 = 0;
-  float dummyEnergyCommonZNA = 0;
-  float dummyEnergyCommonZNC = 0;
-  float dummyEnergyCommonZPA = 0;
-  float dummyEnergyCommonZPC = 0;
-  float dummyEnergySectorZNA[4] = {0.};
-  float dummyEnergySectorZNC[4] = {0.};
-  float dummyEnergySectorZPA[4] = {0.};
-  float dummyEnergySectorZPC[4] = {0.};
-  zdcCursor(0,
-            dummyBC,
-            dummyEnergyZEM1,
-            dummyEnergyZEM2,
-            dummyEnergyCommonZNA,
-            dummyEnergyCommonZNC,
-            dummyEnergyCommonZPA,
-            dummyEnergyCommonZPC,
-            dummyEnergySectorZNA,
-            dummyEnergySectorZNC,
-            dummyEnergySectorZPA,
-            dummyEnergySectorZPC,
-            dummyTime,
-            dummyTime,
-            dummyTime,
-            dummyTime,
-            dummyTime,
-            dummyTime);
-
-  // TODO: figure out collision weight
-  float mcColWeight = 1.;
-  // filling mcCollision table
-  int index = 0;
-  for (auto& rec : mcRecords) {
-    auto time = rec.getTimeNS();
-    uint64_t globalBC = rec.toLong();
-    auto item = bcsMap.find(globalBC);
-    int bcID = -1;
-    if (item != bcsMap.end()) {
-      bcID = item->second;
-    } else {
-      LOG(FATAL) << "Error: could not find a corresponding BC ID for MC collision; BC = " << globalBC << ", index = " << index;
-    }
-    auto& colParts = mcParts[index];
-    for (auto colPart : colParts) {
-      auto eventID = colPart.entryID;
-      auto sourceID = colPart.sourceID;
-      // FIXME:
-      // use generators' names for generatorIDs (?)
-      short generatorID = sourceID;
-      auto& header = mcReader.getMCEventHeader(sourceID, eventID);
-      mcCollisionsCursor(0,
-                         bcID,
-                         generatorID,
-                         truncateFloatFraction(header.GetX(), mCollisionPosition),
-                         truncateFloatFraction(header.GetY(), mCollisionPosition),
-                         truncateFloatFraction(header.GetZ(), mCollisionPosition),
-                         truncateFloatFraction(time, mCollisionPosition),
-                         truncateFloatFraction(mcColWeight, mCollisionPosition),
-                         header.GetB());
-    }
-    index++;
-  }
-
-  // vector of FT0 amplitudes
-  int nFT0Channels = o2::ft0::Geometry::Nchannels;
-  int nFT0ChannelsAside = o2::ft0::Geometry::NCellsA * 4;
-  std::vector<float> vAmplitudes(nFT0Channels, 0.);
-  // filling FT0 table
-  for (auto& ft0RecPoint : ft0RecPoints) {
-    const auto channelData = ft0RecPoint.getBunchChannelData(ft0ChData);
-    // TODO: switch to calibrated amplitude
-    for (auto& channel : channelData) {
-      vAmplitudes[channel.ChId] = channel.QTCAmpl; // amplitude, mV
-    }
-    float aAmplitudesA[nFT0ChannelsAside];
-    float aAmplitudesC[133];
-    for (int i = 0; i < nFT0Channels; i++) {
-      if (i < nFT0ChannelsAside) {
-        aAmplitudesA[i] = truncateFloatFraction(vAmplitudes[i], mT0Amplitude);
-      } else {
-        aAmplitudesC[i - nFT0ChannelsAside] = truncateFloatFraction(vAmplitudes[i], mT0Amplitude);
+  // the tables below do not depend on each other and are filled concurrently,
+  // each one with its own TableBuilder; the MC particles and labels are filled afterwards
+  // since they need the flags of the stored tracks
+#ifdef WITH_OPENMP
+#pragma omp parallel sections num_threads(mNThreads)
+#endif
+  {
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif
+    {
+      // filling unassigned tracks first
+      // so that all unassigned tracks are stored in the beginning of the table together
+      auto& trackRefU = primVer2TRefs.back(); // references to unassigned tracks are at the end
+      for (int src = GIndex::NSources; src--;) {
+        int start = trackRefU.getFirstEntryOfSource(src);
+        int end = start + trackRefU.getEntriesOfSource(src);
+        LOG(DEBUG) << "Unassigned tracks: src = " << src << ", start = " << start << ", end = " << end;
+        for (int ti = start; ti < end; ti++) {
+          extraInfoHolder.tpcInnerParam = 0.f;
+          extraInfoHolder.flags = 0;
+          extraInfoHolder.itsClusterMap = 0;
+          extraInfoHolder.tpcNClsFindable = 0;
+          extraInfoHolder.tpcNClsFindableMinusFound = 0;
+          extraInfoHolder.tpcNClsFindableMinusCrossedRows = 0;
+          extraInfoHolder.tpcNClsShared = 0;
+          extraInfoHolder.trdPattern = 0;
+          extraInfoHolder.itsChi2NCl = -999.f;
+          extraInfoHolder.tpcChi2NCl = -999.f;
+          extraInfoHolder.trdChi2 = -999.f;
+          extraInfoHolder.tofChi2 = -999.f;
+          extraInfoHolder.tpcSignal = -999.f;
+          extraInfoHolder.trdSignal = -999.f;
+          extraInfoHolder.tofSignal = -999.f;
+          extraInfoHolder.length = -999.f;
+          extraInfoHolder.tofExpMom = -999.f;
+          extraInfoHolder.trackEtaEMCAL = -999.f;
+          extraInfoHolder.trackPhiEMCAL = -999.f;
+          auto& trackIndex = primVerGIs[ti];
+          if (src == GIndex::Source::ITS && mFillTracksITS) {
+            const auto& track = tracksITS[trackIndex.getIndex()];
+            isStoredITS[trackIndex.getIndex()] = true;
+            // extra info
+            extraInfoHolder.itsClusterMap = track.getPattern();
+            // track
+            addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
+            addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+          }
+          if (src == GIndex::Source::TPC && mFillTracksTPC) {
+            const auto& track = tracksTPC[trackIndex.getIndex()];
+            isStoredTPC[trackIndex.getIndex()] = true;
+            // extra info
+            extraInfoHolder.tpcChi2NCl = track.getNClusters() ? track.getChi2() / track.getNClusters() : 0;
+            extraInfoHolder.tpcSignal = track.getdEdx().dEdxTotTPC;
+            extraInfoHolder.tpcNClsFindable = track.getNClusters();
+            // track
+            addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
+            addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+          }
+          if (src == GIndex::Source::ITSTPC && mFillTracksITSTPC) {
+            const auto& track = tracksITSTPC[trackIndex.getIndex()];
+            auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
+            // extra info from sub-tracks
+            if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
+              isStoredITS[track.getRefITS()] = true;
+              const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
+              extraInfoHolder.itsClusterMap = itsOrig.getPattern();
+            }
+            if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
+              isStoredTPC[track.getRefTPC()] = true;
+              const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
+              extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
+              extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
+              extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+            }
+            addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
+            addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+          }
+          if (src == GIndex::Source::ITSTPCTOF && mFillTracksITSTPC) {
+            auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
+            const auto& track = recoData.getITSTPCTOFTrack(contributorsGID[GIndex::Source::ITSTPCTOF]);
+            const auto& tofMatch = recoData.getTOFMatch(contributorsGID[GIndex::Source::ITSTPCTOF]);
+            extraInfoHolder.tofChi2 = tofMatch.getChi2();
+            const auto& tofInt = tofMatch.getLTIntegralOut();
+            extraInfoHolder.tofSignal = tofInt.getTOF(0); // fixme: what id should be used here?
+            extraInfoHolder.length = tofInt.getL();
+            // extra info from sub-tracks
+            if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
+              isStoredITS[track.getRefITS()] = true;
+              const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
+              extraInfoHolder.itsClusterMap = itsOrig.getPattern();
+            }
+            if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
+              isStoredTPC[track.getRefTPC()] = true;
+              const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
+              extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
+              extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
+              extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+            }
+            addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
+            addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+          }
+          if (src == GIndex::Source::MFT && mFillTracksMFT) {
+            const auto& track = tracksMFT[trackIndex.getIndex()];
+            isStoredMFT[trackIndex.getIndex()] = true;
+            addToMFTTracksTable(mftTracksCursor, track, -1);
+          }
+        }
       }
-    }
-    uint64_t globalBC = ft0RecPoint.getInteractionRecord().toLong();
-    uint64_t bc = globalBC;
-    auto item = bcsMap.find(bc);
-    int bcID = -1;
-    if (item != bcsMap.end()) {
-      bcID = item->second;
-    } else {
-      LOG(FATAL) << "Error: could not find a corresponding BC ID for a FT0 rec. point; BC = " << bc;
-    }
-    ft0Cursor(0,
-              bcID,
-              aAmplitudesA,
-              aAmplitudesC,
-              truncateFloatFraction(ft0RecPoint.getCollisionTimeA() / 1E3, mT0Time), // ps to ns
-              truncateFloatFraction(ft0RecPoint.getCollisionTimeC() / 1E3, mT0Time), // ps to ns
-              ft0RecPoint.getTrigger().triggersignals);
-  }
-
-  // filling MC collision labels
-  for (auto& label : primVerLabels) {
-    int32_t mcCollisionID = label.getEventID();
-    uint16_t mcMask = 0; // todo: set mask using normalized weights?
-    mcColLabelsCursor(0, mcCollisionID, mcMask);
-  }
 
-  // filling unassigned tracks first
-  // so that all unassigned tracks are stored in the beginning of the table together
-  auto& trackRefU = primVer2TRefs.back(); // references to unassigned tracks are at the end
-  for (int src = GIndex::NSources; src--;) {
-    int start = trackRefU.getFirstEntryOfSource(src);
-    int end = start + trackRefU.getEntriesOfSource(src);
-    LOG(DEBUG) << "Unassigned tracks: src = " << src << ", start = " << start << ", end = " << end;
-    for (int ti = start; ti < end; ti++) {
-      extraInfoHolder.tpcInnerParam = 0.f;
-      extraInfoHolder.flags = 0;
-      extraInfoHolder.itsClusterMap = 0;
-      extraInfoHolder.tpcNClsFindable = 0;
-      extraInfoHolder.tpcNClsFindableMinusFound = 0;
-      extraInfoHolder.tpcNClsFindableMinusCrossedRows = 0;
-      extraInfoHolder.tpcNClsShared = 0;
-      extraInfoHolder.trdPattern = 0;
-      extraInfoHolder.itsChi2NCl = -999.f;
-      extraInfoHolder.tpcChi2NCl = -999.f;
-      extraInfoHolder.trdChi2 = -999.f;
-      extraInfoHolder.tofChi2 = -999.f;
-      extraInfoHolder.tpcSignal = -999.f;
-      extraInfoHolder.trdSignal = -999.f;
-      extraInfoHolder.tofSignal = -999.f;
-      extraInfoHolder.length = -999.f;
-      extraInfoHolder.tofExpMom = -999.f;
-      extraInfoHolder.trackEtaEMCAL = -999.f;
-      extraInfoHolder.trackPhiEMCAL = -999.f;
-      auto& trackIndex = primVerGIs[ti];
-      if (src == GIndex::Source::ITS && mFillTracksITS) {
-        const auto& track = tracksITS[trackIndex.getIndex()];
-        isStoredITS[trackIndex.getIndex()] = true;
-        // extra info
-        extraInfoHolder.itsClusterMap = track.getPattern();
-        // track
-        addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
-        addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
-      }
-      if (src == GIndex::Source::TPC && mFillTracksTPC) {
-        const auto& track = tracksTPC[trackIndex.getIndex()];
-        isStoredTPC[trackIndex.getIndex()] = true;
-        // extra info
-        extraInfoHolder.tpcChi2NCl = track.getNClusters() ? track.getChi2() / track.getNClusters() : 0;
-        extraInfoHolder.tpcSignal = track.getdEdx().dEdxTotTPC;
-        extraInfoHolder.tpcNClsFindable = track.getNClusters();
-        // track
-        addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
-        addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
-      }
-      if (src == GIndex::Source::ITSTPC && mFillTracksITSTPC) {
-        const auto& track = tracksITSTPC[trackIndex.getIndex()];
-        auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
-        // extra info from sub-tracks
-        if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
-          isStoredITS[track.getRefITS()] = true;
-          const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
-          extraInfoHolder.itsClusterMap = itsOrig.getPattern();
-        }
-        if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
-          isStoredTPC[track.getRefTPC()] = true;
-          const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
-          extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
-          extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
-          extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+      // filling tracks attached to the primary vertices
+      for (int collisionID = 0; collisionID < primVertices.size(); collisionID++) {
+        auto& trackRef = primVer2TRefs[collisionID];
+        for (int src = GIndex::NSources; src--;) {
+          int start = trackRef.getFirstEntryOfSource(src);
+          int end = start + trackRef.getEntriesOfSource(src);
+          LOG(DEBUG) << " ====> Collision " << collisionID << " ; src = " << src << " : ntracks = " << end - start;
+          LOG(DEBUG) << "start = " << start << ", end = " << end;
+          for (int ti = start; ti < end; ti++) {
+            extraInfoHolder.tpcInnerParam = 0.f;
+            extraInfoHolder.flags = 0;
+            extraInfoHolder.itsClusterMap = 0;
+            extraInfoHolder.tpcNClsFindable = 0;
+            extraInfoHolder.tpcNClsFindableMinusFound = 0;
+            extraInfoHolder.tpcNClsFindableMinusCrossedRows = 0;
+            extraInfoHolder.tpcNClsShared = 0;
+            extraInfoHolder.trdPattern = 0;
+            extraInfoHolder.itsChi2NCl = -999.f;
+            extraInfoHolder.tpcChi2NCl = -999.f;
+            extraInfoHolder.trdChi2 = -999.f;
+            extraInfoHolder.tofChi2 = -999.f;
+            extraInfoHolder.tpcSignal = -999.f;
+            extraInfoHolder.trdSignal = -999.f;
+            extraInfoHolder.tofSignal = -999.f;
+            extraInfoHolder.length = -999.f;
+            extraInfoHolder.tofExpMom = -999.f;
+            extraInfoHolder.trackEtaEMCAL = -999.f;
+            extraInfoHolder.trackPhiEMCAL = -999.f;
+            auto& trackIndex = primVerGIs[ti];
+            if (src == GIndex::Source::ITS && mFillTracksITS) {
+              const auto& track = tracksITS[trackIndex.getIndex()];
+              isStoredITS[trackIndex.getIndex()] = true;
+              // extra info
+              extraInfoHolder.itsClusterMap = track.getPattern();
+              // track
+              addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
+              addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+            }
+            if (src == GIndex::Source::TPC && mFillTracksTPC) {
+              const auto& track = tracksTPC[trackIndex.getIndex()];
+              isStoredTPC[trackIndex.getIndex()] = true;
+              // extra info
+              extraInfoHolder.tpcChi2NCl = track.getNClusters() ? track.getChi2() / track.getNClusters() : 0;
+              extraInfoHolder.tpcSignal = track.getdEdx().dEdxTotTPC;
+              extraInfoHolder.tpcNClsFindable = track.getNClusters();
+              // track
+              addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
+              addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+            }
+            if (src == GIndex::Source::ITSTPC && mFillTracksITSTPC) {
+              const auto& track = tracksITSTPC[trackIndex.getIndex()];
+              auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
+              // extra info from sub-tracks
+              if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
+                isStoredITS[track.getRefITS()] = true;
+                const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
+                extraInfoHolder.itsClusterMap = itsOrig.getPattern();
+              }
+              if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
+                isStoredTPC[track.getRefTPC()] = true;
+                const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
+                extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
+                extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
+                extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+              }
+              addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
+              addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+            }
+            if (src == GIndex::Source::ITSTPCTOF && mFillTracksITSTPC) {
+              auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
+              const auto& track = recoData.getITSTPCTOFTrack(contributorsGID[GIndex::Source::ITSTPCTOF]);
+              const auto& tofMatch = recoData.getTOFMatch(contributorsGID[GIndex::Source::ITSTPCTOF]);
+              extraInfoHolder.tofChi2 = tofMatch.getChi2();
+              const auto& tofInt = tofMatch.getLTIntegralOut();
+              extraInfoHolder.tofSignal = tofInt.getTOF(0); // fixme: what id should be used here?
+              extraInfoHolder.length = tofInt.getL();
+              // extra info from sub-tracks
+              if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
+                isStoredITS[track.getRefITS()] = true;
+                const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
+                extraInfoHolder.itsClusterMap = itsOrig.getPattern();
+              }
+              if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
+                isStoredTPC[track.getRefTPC()] = true;
+                const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
+                extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
+                extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
+                extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+              }
+              addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
+              addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+            }
+            if (src == GIndex::Source::MFT && mFillTracksMFT) {
+              const auto& track = tracksMFT[trackIndex.getIndex()];
+              isStoredMFT[trackIndex.getIndex()] = true;
+              addToMFTTracksTable(mftTracksCursor, track, collisionID);
+            }
+          }
         }
-        addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
-        addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
       }
-      if (src == GIndex::Source::ITSTPCTOF && mFillTracksITSTPC) {
-        auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
-        const auto& track = recoData.getITSTPCTOFTrack(contributorsGID[GIndex::Source::ITSTPCTOF]);
-        const auto& tofMatch = recoData.getTOFMatch(contributorsGID[GIndex::Source::ITSTPCTOF]);
-        extraInfoHolder.tofChi2 = tofMatch.getChi2();
-        const auto& tofInt = tofMatch.getLTIntegralOut();
-        extraInfoHolder.tofSignal = tofInt.getTOF(0); // fixme: what id should be used here?
-        extraInfoHolder.length = tofInt.getL();
-        // extra info from sub-tracks
-        if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
-          isStoredITS[track.getRefITS()] = true;
-          const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
-          extraInfoHolder.itsClusterMap = itsOrig.getPattern();
-        }
-        if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
-          isStoredTPC[track.getRefTPC()] = true;
-          const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
-          extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
-          extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
-          extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
+    }
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif
+    {
+      // filling collisions table
+      int collisionID = 0;
+      for (auto& vertex : primVertices) {
+        auto& cov = vertex.getCov();
+        auto& timeStamp = vertex.getTimeStamp();
+        double tsTimeStamp = timeStamp.getTimeStamp() * 1E3; // mus to ns
+        uint64_t globalBC = std::round(tsTimeStamp / o2::constants::lhc::LHCBunchSpacingNS);
+        LOG(DEBUG) << globalBC << " " << tsTimeStamp;
+        // collision timestamp in ns wrt the beginning of collision BC
+        tsTimeStamp = globalBC * o2::constants::lhc::LHCBunchSpacingNS - tsTimeStamp;
+        auto item = bcsMap.find(globalBC);
+        int bcID = -1;
+        if (item != bcsMap.end()) {
+          bcID = item->second;
+        } else {
+          LOG(FATAL) << "Error: could not find a corresponding BC ID for a collision; BC = " << globalBC << ", collisionID = " << collisionID;
         }
-        addToTracksTable(tracksCursor, tracksCovCursor, track, -1, src);
-        addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
-      }
-      if (src == GIndex::Source::MFT && mFillTracksMFT) {
-        const auto& track = tracksMFT[trackIndex.getIndex()];
-        isStoredMFT[trackIndex.getIndex()] = true;
-        addToMFTTracksTable(mftTracksCursor, track, -1);
+        // TODO: get real collision time mask
+        int collisionTimeMask = 0;
+        collisionsCursor(0,
+                         bcID,
+                         truncateFloatFraction(vertex.getX(), mCollisionPosition),
+                         truncateFloatFraction(vertex.getY(), mCollisionPosition),
+                         truncateFloatFraction(vertex.getZ(), mCollisionPosition),
+                         truncateFloatFraction(cov[0], mCollisionPositionCov),
+                         truncateFloatFraction(cov[1], mCollisionPositionCov),
+                         truncateFloatFraction(cov[2], mCollisionPositionCov),
+                         truncateFloatFraction(cov[3], mCollisionPositionCov),
+                         truncateFloatFraction(cov[4], mCollisionPositionCov),
+                         truncateFloatFraction(cov[5], mCollisionPositionCov),
+                         vertex.getFlags(),
+                         truncateFloatFraction(vertex.getChi2(), mCollisionPositionCov),
+                         vertex.getNContributors(),
+                         truncateFloatFraction(tsTimeStamp, mCollisionPosition),
+                         truncateFloatFraction(timeStamp.getTimeStampError() * 1E3, mCollisionPositionCov),
+                         collisionTimeMask);
+        collisionID++;
       }
-    }
-  }
 
-  // filling collisions table
-  int collisionID = 0;
-  for (auto& vertex : primVertices) {
-    auto& cov = vertex.getCov();
-    auto& timeStamp = vertex.getTimeStamp();
-    double tsTimeStamp = timeStamp.getTimeStamp() * 1E3; // mus to ns
-    uint64_t globalBC = std::round(tsTimeStamp / o2::constants::lhc::LHCBunchSpacingNS);
-    LOG(DEBUG) << globalBC << " " << tsTimeStamp;
-    // collision timestamp in ns wrt the beginning of collision BC
-    tsTimeStamp = globalBC * o2::constants::lhc::LHCBunchSpacingNS - tsTimeStamp;
-    auto item = bcsMap.find(globalBC);
-    int bcID = -1;
-    if (item != bcsMap.end()) {
-      bcID = item->second;
-    } else {
-      LOG(FATAL) << "Error: could not find a corresponding BC ID for a collision; BC = " << globalBC << ", collisionID = " << collisionID;
+      // filling MC collision labels
+      for (auto& label : primVerLabels) {
+        int32_t mcCollisionID = label.getEventID();
+        uint16_t mcMask = 0; // todo: set mask using normalized weights?
+        mcColLabelsCursor(0, mcCollisionID, mcMask);
+      }
     }
-    // TODO: get real collision time mask
-    int collisionTimeMask = 0;
-    collisionsCursor(0,
-                     bcID,
-                     truncateFloatFraction(vertex.getX(), mCollisionPosition),
-                     truncateFloatFraction(vertex.getY(), mCollisionPosition),
-                     truncateFloatFraction(vertex.getZ(), mCollisionPosition),
-                     truncateFloatFraction(cov[0], mCollisionPositionCov),
-                     truncateFloatFraction(cov[1], mCollisionPositionCov),
-                     truncateFloatFraction(cov[2], mCollisionPositionCov),
-                     truncateFloatFraction(cov[3], mCollisionPositionCov),
-                     truncateFloatFraction(cov[4], mCollisionPositionCov),
-                     truncateFloatFraction(cov[5], mCollisionPositionCov),
-                     vertex.getFlags(),
-                     truncateFloatFraction(vertex.getChi2(), mCollisionPositionCov),
-                     vertex.getNContributors(),
-                     truncateFloatFraction(tsTimeStamp, mCollisionPosition),
-                     truncateFloatFraction(timeStamp.getTimeStampError() * 1E3, mCollisionPositionCov),
-                     collisionTimeMask);
-    auto& trackRef = primVer2TRefs[collisionID];
-    for (int src = GIndex::NSources; src--;) {
-      int start = trackRef.getFirstEntryOfSource(src);
-      int end = start + trackRef.getEntriesOfSource(src);
-      LOG(DEBUG) << " ====> Collision " << collisionID << " ; src = " << src << " : ntracks = " << end - start;
-      LOG(DEBUG) << "start = " << start << ", end = " << end;
-      for (int ti = start; ti < end; ti++) {
-        extraInfoHolder.tpcInnerParam = 0.f;
-        extraInfoHolder.flags = 0;
-        extraInfoHolder.itsClusterMap = 0;
-        extraInfoHolder.tpcNClsFindable = 0;
-        extraInfoHolder.tpcNClsFindableMinusFound = 0;
-        extraInfoHolder.tpcNClsFindableMinusCrossedRows = 0;
-        extraInfoHolder.tpcNClsShared = 0;
-        extraInfoHolder.trdPattern = 0;
-        extraInfoHolder.itsChi2NCl = -999.f;
-        extraInfoHolder.tpcChi2NCl = -999.f;
-        extraInfoHolder.trdChi2 = -999.f;
-        extraInfoHolder.tofChi2 = -999.f;
-        extraInfoHolder.tpcSignal = -999.f;
-        extraInfoHolder.trdSignal = -999.f;
-        extraInfoHolder.tofSignal = -999.f;
-        extraInfoHolder.length = -999.f;
-        extraInfoHolder.tofExpMom = -999.f;
-        extraInfoHolder.trackEtaEMCAL = -999.f;
-        extraInfoHolder.trackPhiEMCAL = -999.f;
-        auto& trackIndex = primVerGIs[ti];
-        if (src == GIndex::Source::ITS && mFillTracksITS) {
-          const auto& track = tracksITS[trackIndex.getIndex()];
-          isStoredITS[trackIndex.getIndex()] = true;
-          // extra info
-          extraInfoHolder.itsClusterMap = track.getPattern();
-          // track
-          addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
-          addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif
+    {
+      // TODO: figure out collision weight
+      float mcColWeight = 1.;
+      // filling mcCollision table
+      int index = 0;
+      for (auto& rec : mcRecords) {
+        auto time = rec.getTimeNS();
+        uint64_t globalBC = rec.toLong();
+        auto item = bcsMap.find(globalBC);
+        int bcID = -1;
+        if (item != bcsMap.end()) {
+          bcID = item->second;
+        } else {
+          LOG(FATAL) << "Error: could not find a corresponding BC ID for MC collision; BC = " << globalBC << ", index = " << index;
         }
-        if (src == GIndex::Source::TPC && mFillTracksTPC) {
-          const auto& track = tracksTPC[trackIndex.getIndex()];
-          isStoredTPC[trackIndex.getIndex()] = true;
-          // extra info
-          extraInfoHolder.tpcChi2NCl = track.getNClusters() ? track.getChi2() / track.getNClusters() : 0;
-          extraInfoHolder.tpcSignal = track.getdEdx().dEdxTotTPC;
-          extraInfoHolder.tpcNClsFindable = track.getNClusters();
-          // track
-          addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
-          addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+        auto& colParts = mcParts[index];
+        for (auto colPart : colParts) {
+          auto eventID = colPart.entryID;
+          auto sourceID = colPart.sourceID;
+          // FIXME:
+          // use generators' names for generatorIDs (?)
+          short generatorID = sourceID;
+          auto& header = mcReader.getMCEventHeader(sourceID, eventID);
+          mcCollisionsCursor(0,
+                             bcID,
+                             generatorID,
+                             truncateFloatFraction(header.GetX(), mCollisionPosition),
+                             truncateFloatFraction(header.GetY(), mCollisionPosition),
+                             truncateFloatFraction(header.GetZ(), mCollisionPosition),
+                             truncateFloatFraction(time, mCollisionPosition),
+                             truncateFloatFraction(mcColWeight, mCollisionPosition),
+                             header.GetB());
         }
-        if (src == GIndex::Source::ITSTPC && mFillTracksITSTPC) {
-          const auto& track = tracksITSTPC[trackIndex.getIndex()];
-          auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
-          // extra info from sub-tracks
-          if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
-            isStoredITS[track.getRefITS()] = true;
-            const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
-            extraInfoHolder.itsClusterMap = itsOrig.getPattern();
-          }
-          if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
-            isStoredTPC[track.getRefTPC()] = true;
-            const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
-            extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
-            extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
-            extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
-          }
-          addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
-          addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
+        index++;
+      }
+    }
+#ifdef WITH_OPENMP
+#pragma omp section
+#endif
+    {
+      // vector of FT0 amplitudes
+      int nFT0Channels = o2::ft0::Geometry::Nchannels;
+      int nFT0ChannelsAside = o2::ft0::Geometry::NCellsA * 4;
+      std::vector<float> vAmplitudes(nFT0Channels, 0.);
+      // filling FT0 table
+      for (auto& ft0RecPoint : ft0RecPoints) {
+        const auto channelData = ft0RecPoint.getBunchChannelData(ft0ChData);
+        // TODO: switch to calibrated amplitude
+        for (auto& channel : channelData) {
+          vAmplitudes[channel.ChId] = channel.QTCAmpl; // amplitude, mV
         }
-        if (src == GIndex::Source::ITSTPCTOF && mFillTracksITSTPC) {
-          auto contributorsGID = recoData.getSingleDetectorRefs(trackIndex);
-          const auto& track = recoData.getITSTPCTOFTrack(contributorsGID[GIndex::Source::ITSTPCTOF]);
-          const auto& tofMatch = recoData.getTOFMatch(contributorsGID[GIndex::Source::ITSTPCTOF]);
-          extraInfoHolder.tofChi2 = tofMatch.getChi2();
-          const auto& tofInt = tofMatch.getLTIntegralOut();
-          extraInfoHolder.tofSignal = tofInt.getTOF(0); // fixme: what id should be used here?
-          extraInfoHolder.length = tofInt.getL();
-          // extra info from sub-tracks
-          if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
-            isStoredITS[track.getRefITS()] = true;
-            const auto& itsOrig = recoData.getITSTrack(contributorsGID[GIndex::ITS]);
-            extraInfoHolder.itsClusterMap = itsOrig.getPattern();
+        float aAmplitudesA[nFT0ChannelsAside];
+        float aAmplitudesC[133];
+        for (int i = 0; i < nFT0Channels; i++) {
+          if (i < nFT0ChannelsAside) {
+            aAmplitudesA[i] = truncateFloatFraction(vAmplitudes[i], mT0Amplitude);
+          } else {
+            aAmplitudesC[i - nFT0ChannelsAside] = truncateFloatFraction(vAmplitudes[i], mT0Amplitude);
           }
-          if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
-            isStoredTPC[track.getRefTPC()] = true;
-            const auto& tpcOrig = recoData.getTPCTrack(contributorsGID[GIndex::TPC]);
-            extraInfoHolder.tpcChi2NCl = tpcOrig.getNClusters() ? tpcOrig.getChi2() / tpcOrig.getNClusters() : 0;
-            extraInfoHolder.tpcSignal = tpcOrig.getdEdx().dEdxTotTPC;
-            extraInfoHolder.tpcNClsFindable = tpcOrig.getNClusters();
-          }
-          addToTracksTable(tracksCursor, tracksCovCursor, track, collisionID, src);
-          addToTracksExtraTable(tracksExtraCursor, extraInfoHolder);
         }
-        if (src == GIndex::Source::MFT && mFillTracksMFT) {
-          const auto& track = tracksMFT[trackIndex.getIndex()];
-          isStoredMFT[trackIndex.getIndex()] = true;
-          addToMFTTracksTable(mftTracksCursor, track, collisionID);
+        uint64_t globalBC = ft0RecPoint.getInteractionRecord().toLong();
+        uint64_t bc = globalBC;
+        auto item = bcsMap.find(bc);
+        int bcID = -1;
+        if (item != bcsMap.end()) {
+          bcID = item->second;
+        } else {
+          LOG(FATAL) << "Error: could not find a corresponding BC ID for a FT0 rec. point; BC = " << bc;
         }
+        ft0Cursor(0,
+                  bcID,
+                  aAmplitudesA,
+                  aAmplitudesC,
+                  truncateFloatFraction(ft0RecPoint.getCollisionTimeA() / 1E3, mT0Time), // ps to ns
+                  truncateFloatFraction(ft0RecPoint.getCollisionTimeC() / 1E3, mT0Time), // ps to ns
+                  ft0RecPoint.getTrigger().triggersignals);
       }
-    }
-    collisionID++;
-  }
 
-  // filling BC table
-  // TODO: get real triggerMask
-  uint64_t triggerMask = 1;
-  for (auto& item : bcsMap) {
-    uint64_t bc = item.first;
-    bcCursor(0,
-             runNumber,
-             bc,
-             triggerMask);
+      // TODO: add real FV0A, FV0C, FDD, ZDC tables instead of dummies
+      uint64_t dummyBC = 0;
+      float dummyTime = 0.f;
+      float dummyFV0AmplA[48] = {0.};
+      uint8_t dummyTriggerMask = 0;
+      fv0aCursor(0,
+                 dummyBC,
+                 dummyFV0AmplA,
+                 dummyTime,
+                 dummyTriggerMask);
+
+      float dummyFV0AmplC[32] = {0.};
+      fv0cCursor(0,
+                 dummyBC,
+                 dummyFV0AmplC,
+                 dummyTime);
+
+      float dummyFDDAmplA[4] = {0.};
+      float dummyFDDAmplC[4] = {0.};
+      fddCursor(0,
+                dummyBC,
+                dummyFDDAmplA,
+                dummyFDDAmplC,
+                dummyTime,
+                dummyTime,
+                dummyTriggerMask);
+
+      float dummyEnergyZEM1 = 0;
+      float dummyEnergyZEM2 = 0;
+      float dummyEnergyCommonZNA = 0;
+      float dummyEnergyCommonZNC = 0;
+      float dummyEnergyCommonZPA = 0;
+      float dummyEnergyCommonZPC = 0;
+      float dummyEnergySectorZNA[4] = {0.};
+      float dummyEnergySectorZNC[4] = {0.};
+      float dummyEnergySectorZPA[4] = {0.};
+      float dummyEnergySectorZPC[4] = {0.};
+      zdcCursor(0,
+                dummyBC,
+                dummyEnergyZEM1,
+                dummyEnergyZEM2,
+                dummyEnergyCommonZNA,
+                dummyEnergyCommonZNC,
+                dummyEnergyCommonZPA,
+                dummyEnergyCommonZPC,
+                dummyEnergySectorZNA,
+                dummyEnergySectorZNC,
+                dummyEnergySectorZPA,
+                dummyEnergySectorZPC,
+                dummyTime,
+                dummyTime,
+                dummyTime,
+                dummyTime,
+                dummyTime,
+                dummyTime);
+
+      // filling BC table
+      // TODO: get real triggerMask
+      uint64_t triggerMask = 1;
+      for (auto& item : bcsMap) {
+        uint64_t bc = item.first;
+        bcCursor(0,
+                 runNumber,
+                 bc,
+                 triggerMask);
+      }
+    }
   }
 
   bcsMap.clear();
 
   // filling mc particles table
-  TripletsMap_t toStore;
+  MCParticlesIndex_t toStore;
   fillMCParticlesTable(mcReader, mcParticlesCursor,
                        tracksITSMCTruth, isStoredITS,
                        tracksMFTMCTruth, isStoredMFT,
@@ -911,6 +982,16 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
   uint16_t labelMask;
   uint8_t mftLabelMask;
 
+  // index of the particle of a label in the MC particles table, labels skipped when filling the table give no index
+  auto getMCParticleID = [&toStore](const o2::MCCompLabel& label) {
+    int source = label.getSourceID(), event = label.getEventID(), particle = label.getTrackID();
+    if (source >= (int)toStore.size() || event >= (int)toStore[source].size() || particle >= (int)toStore[source][event].size() ||
+        toStore[source][event][particle] < 0) {
+      return std::numeric_limits<uint32_t>::max();
+    }
+    return (uint32_t)toStore[source][event][particle];
+  };
+
   // need to go through labels in the same order as for tracks
   for (auto& trackRef : primVer2TRefs) {
     for (int src = GIndex::NSources; src--;) {
@@ -927,7 +1008,7 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
         if (src == GIndex::Source::ITS && mFillTracksITS) {
           auto& mcTruthITS = tracksITSMCTruth[trackIndex.getIndex()];
           if (mcTruthITS.isValid()) {
-            labelID = toStore.at(Triplet_t(mcTruthITS.getSourceID(), mcTruthITS.getEventID(), mcTruthITS.getTrackID()));
+            labelID = getMCParticleID(mcTruthITS);
           }
           if (mcTruthITS.isFake()) {
             labelMask |= (0x1 << 15);
@@ -943,7 +1024,7 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
         if (src == GIndex::Source::TPC && mFillTracksTPC) {
           auto& mcTruthTPC = tracksTPCMCTruth[trackIndex.getIndex()];
           if (mcTruthTPC.isValid()) {
-            labelID = toStore.at(Triplet_t(mcTruthTPC.getSourceID(), mcTruthTPC.getEventID(), mcTruthTPC.getTrackID()));
+            labelID = getMCParticleID(mcTruthTPC);
           }
           if (mcTruthTPC.isFake()) {
             labelMask |= (0x1 << 15);
@@ -966,12 +1047,12 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
           // its-contributor label
           if (contributorsGID[GIndex::Source::ITS].isIndexSet()) {
             if (mcTruthITS.isValid()) {
-              labelITS = toStore.at(Triplet_t(mcTruthITS.getSourceID(), mcTruthITS.getEventID(), mcTruthITS.getTrackID()));
+              labelITS = getMCParticleID(mcTruthITS);
             }
           }
           if (contributorsGID[GIndex::Source::TPC].isIndexSet()) {
             if (mcTruthTPC.isValid()) {
-              labelTPC = toStore.at(Triplet_t(mcTruthTPC.getSourceID(), mcTruthTPC.getEventID(), mcTruthTPC.getTrackID()));
+              labelTPC = getMCParticleID(mcTruthTPC);
             }
           }
           labelID = labelTPC;
@@ -994,7 +1075,7 @@ void AODProducerWorkflowDPL::run(ProcessingContext& pc)
         if (src == GIndex::Source::MFT && mFillTracksMFT) {
           auto& mcTruthMFT = tracksMFTMCTruth[trackIndex.getIndex()];
           if (mcTruthMFT.isValid()) {
-            labelID = toStore.at(Triplet_t(mcTruthMFT.getSourceID(), mcTruthMFT.getEventID(), mcTruthMFT.getTrackID()));
+            labelID = getMCParticleID(mcTruthMFT);
           }
           if (mcTruthMFT.isFake()) {
             mftLabelMask |= (0x1 << 7);
@@ -1065,6 +1146,7 @@ DataProcessorSpec getAODProducerWorkflowSpec(GID::mask_t src, bool useMC, bool f
       ConfigParamSpec{"fill-tracks-its-tpc", VariantType::Int, 1, {"Fill ITS-TPC tracks into tracks table"}},
       ConfigParamSpec{"aod-timeframe-id", VariantType::Int64, -1L, {"Set timeframe number"}},
       ConfigParamSpec{"enable-truncation", VariantType::Int, 1, {"Truncation parameter: 1 -- on, != 1 -- off"}},
+      ConfigParamSpec{"nthreads", VariantType::Int, 4, {"Number of threads used to fill independent tables concurrently (needs OpenMP)"}},
       ConfigParamSpec{"reco-mctracks-only", VariantType::Int, 0, {"Store only reconstructed MC tracks and their mothers/daughters. 0 -- off, != 0 -- on"}}}};
 }
 
@@ -19,6 +19,7 @@
 #include <vector>
 #include <initializer_list>
 #include <memory>
+#include <utility>
 
 #include "FairDetector.h" // for FairDetector
 #include "FairRootManager.h"
@@ -44,6 +45,26 @@ namespace o2
 namespace base
 {
 
+/// Data of one sub-event as collected by the hit merger: n elements of some type starting at ptr.
+/// The memory is kept valid by the owner (the received message for flat messages or the decoded container otherwise).
+struct SubEventPayload {
+  std::shared_ptr<void> owner;
+  void const* ptr = nullptr;
+  size_t n = 0;
+
+  template <typename T>
+  T const* begin() const
+  {
+    return static_cast<T const*>(ptr);
+  }
+  template <typename T>
+  T const* end() const
+  {
+    return static_cast<T const*>(ptr) + n;
+  }
+  size_t size() const { return n; }
+};
+
 /// This is the basic class for any AliceO2 detector module, whether it is
 /// sensitive or not. Detector classes depend on this.
 class Detector : public FairDetector
@@ -158,17 +179,21 @@ class Detector : public FairDetector
   // usually called by the Stack, at the end of an event, which might have changed
   // the track indices due to filtering
   // FIXME: make private friend of stack?
-  virtual void updateHitTrackIndices(std::map<int, int> const&) = 0;
+  // the mapping is indexed by the old track index and gives the new one
+  virtual void updateHitTrackIndices(std::vector<int> const&) = 0;
 
   // interfaces to attach properly encoded hit information to a FairMQ message
   // and to decode it
   virtual void attachHits(FairMQChannel&, FairMQParts&) = 0;
-  virtual void fillHitBranch(TTree& tr, FairMQParts& parts, int& index) = 0;
+  // decodes the hits of one sub-event into one payload per hit branch (as used by hit merger process)
+  virtual void decodeHits(FairMQParts& parts, int& index, std::vector<SubEventPayload>& hits) = 0;
 
-  // interface needed to merge together hit entries in TBranches (as used by hit merger process)
+  // interface needed to merge together the hits of the sub-events of an event into a single entry
+  // of the target TTree (as used by hit merger process)
+  // hits: the payloads of every sub-event (in the order of arrival) as produced by decodeHits
   // trackoffsets: a map giving the corresponding trackoffset to be applied to the trackID property when
   // merging
-  virtual void mergeHitEntries(TTree& origin, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) = 0;
+  virtual void mergeHits(std::vector<std::vector<SubEventPayload> const*> const& hits, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) = 0;
 
   // hook which is called automatically to custom initialize the O2 detectors
   // all initialization not able to do in constructors should be done here
@@ -266,6 +291,34 @@ T decodeTMessage(FairMQParts& dataparts, int index)
   return static_cast<T>(decodeTMessageCore(dataparts, index));
 }
 
+// flat variant for vectors of trivially copyable elements: the elements are copied as they are into a message
+// allocated by the channel (in shared memory for the shmem transport) and are used by the receiver without
+// any deserialization
+void attachFlatMessageCore(void const* data, size_t size, FairMQChannel& channel, FairMQParts& parts);
+template <typename T>
+void attachFlatMessage(std::vector<T> const& data, FairMQChannel& channel, FairMQParts& parts)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "flat messages need trivially copyable elements");
+  attachFlatMessageCore(data.data(), data.size() * sizeof(T), channel, parts);
+}
+
+// the returned payload takes the ownership of the message
+SubEventPayload decodeFlatMessageCore(FairMQParts& dataparts, int index, size_t elemsize);
+template <typename T>
+SubEventPayload decodeFlatMessage(FairMQParts& dataparts, int index)
+{
+  return decodeFlatMessageCore(dataparts, index, sizeof(T));
+}
+
+// payload owning a container decoded or copied from a message
+template <typename Container>
+SubEventPayload makeSubEventPayload(std::shared_ptr<Container> data)
+{
+  auto ptr = data->data();
+  auto n = data->size();
+  return SubEventPayload{std::move(data), ptr, n};
+}
+
 void attachDetIDHeaderMessage(int id, FairMQChannel& channel, FairMQParts& parts);
 
 template <typename T>
@@ -308,14 +361,13 @@ class DetImpl : public o2::base::Detector
   // generic implementation for the updateHitTrackIndices interface
   // assumes Detectors have a GetHits(int) function that return some iterable
   // hits which are o2::BaseHits
-  void updateHitTrackIndices(std::map<int, int> const& indexmapping) override
+  void updateHitTrackIndices(std::vector<int> const& indexmapping) override
   {
     int probe = 0; // some Detectors have multiple hit vectors and we are probing
                    // them via a probe integer until we get a nullptr
     while (auto hits = static_cast<Det*>(this)->Det::getHits(probe++)) {
       for (auto& hit : *hits) {
-        auto iter = indexmapping.find(hit.GetTrackID());
-        hit.SetTrackID(iter->second);
+        hit.SetTrackID(indexmapping[hit.GetTrackID()]);
       }
     }
   }
@@ -332,128 +384,114 @@ class DetImpl : public o2::base::Detector
     attachDetIDHeaderMessage(GetDetId(), channel, parts); // the DetId s are universal as they come from o2::detector::DetID
 
     while (auto hits = static_cast<Det*>(this)->Det::getHits(probe++)) {
-      if (!UseShm<Det>::value || !o2::utils::ShmManager::Instance().isOperational()) {
-        attachTMessage(*hits, channel, parts);
-      } else {
+      if (UseShm<Det>::value && o2::utils::ShmManager::Instance().isOperational()) {
         // this is the shared mem variant
         // we will just send the sharedmem ID and the offset inside
         *mShmBusy[mCurrentBuffer] = true;
         attachShmMessage((void*)hits, channel, parts, mShmBusy[mCurrentBuffer]);
+      } else if constexpr (isFlat()) {
+        attachFlatMessage(*hits, channel, parts);
+      } else {
+        attachTMessage(*hits, channel, parts);
       }
     }
   }
 
-  // this merges several entries from the TBranch brname from the origin TTree
-  // into a single entry in a target TTree / same branch
+  // this merges the hits of the sub-events for the hit branch probe into a single entry
+  // in a target TTree / branch brname
   // (assuming T is typically a vector; merging is simply done by appending)
-  // make this function a (static helper)
   template <typename T>
-  void mergeAndAdjustHits(std::string const& brname, TTree& origin, TTree& target,
+  void mergeAndAdjustHits(std::string const& brname, int probe, std::vector<std::vector<SubEventPayload> const*> const& hits, TTree& target,
                           std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered)
   {
-    auto originbr = origin.GetBranch(brname.c_str());
-    if (originbr) {
-      auto targetdata = new T;
-      T* incomingdata = nullptr;
-      originbr->SetAddress(&incomingdata);
-
-      T* filladdress = nullptr;
-      if (origin.GetEntries() == 1) {
-        originbr->GetEntry(0);
-        filladdress = incomingdata;
-      } else {
-        Int_t entries = origin.GetEntries();
-        Int_t nprimTot = 0;
-        for (auto entry = 0; entry < entries; entry++) {
-          nprimTot += nprimaries[entry];
-        }
-        // offset for pimary track index
-        Int_t idelta0 = 0;
-        // offset for secondary track index
-        Int_t idelta1 = nprimTot;
-        for (int entry = entries - 1; entry >= 0; --entry) {
-          // proceed in the order of subevent Ids
-          Int_t index = subevtsOrdered[entry];
-          // numbe of primaries for this event
-          Int_t nprim = nprimaries[index];
-          idelta1 -= nprim;
-          filladdress = targetdata;
-          originbr->GetEntry(index);
-          if (incomingdata) {
-            // fix the trackIDs for this data
-            for (auto& hit : *incomingdata) {
-              const auto oldID = hit.GetTrackID();
-              // offset depends on whether the trackis a primary or secondary
-              Int_t offset = (oldID < nprim) ? idelta0 : idelta1;
-              hit.SetTrackID(oldID + offset);
-            }
-            // this could be further generalized by using a policy for T
-            std::copy(incomingdata->begin(), incomingdata->end(), std::back_inserter(*targetdata));
-            // adjust offset
-            delete incomingdata;
-            incomingdata = nullptr;
-          }
-          // adjust offsets for next subevent
-          idelta0 += nprim;
-          idelta1 += trackoffsets[index];
-        } // subevent loop
-      }
-      // fill target for this event
-      auto targetbr = o2::base::getOrMakeBranch(target, brname.c_str(), &filladdress);
-      targetbr->SetAddress(&filladdress);
-      targetbr->Fill();
-      targetbr->ResetAddress();
-      targetdata->clear();
-      if (incomingdata) {
-        delete incomingdata;
-        incomingdata = nullptr;
+    using Hit_t = typename T::value_type;
+    auto payload = [&hits, probe](int entry) -> SubEventPayload const* {
+      auto& subevent = *hits[entry];
+      return probe < (int)subevent.size() ? &subevent[probe] : nullptr;
+    };
+
+    Int_t entries = hits.size();
+    Int_t nprimTot = 0;
+    size_t nhits = 0;
+    bool found = false;
+    for (auto entry = 0; entry < entries; entry++) {
+      nprimTot += nprimaries[entry];
+      if (auto p = payload(entry)) {
+        nhits += p->size();
+        found = true;
       }
-      delete targetdata;
     }
+    if (!found) {
+      return;
+    }
+    auto targetdata = std::make_unique<T>();
+    targetdata->reserve(nhits);
+    // offset for pimary track index
+    Int_t idelta0 = 0;
+    // offset for secondary track index
+    Int_t idelta1 = nprimTot;
+    for (int entry = entries - 1; entry >= 0; --entry) {
+      // proceed in the order of subevent Ids
+      Int_t index = subevtsOrdered[entry];
+      // numbe of primaries for this event
+      Int_t nprim = nprimaries[index];
+      idelta1 -= nprim;
+      if (auto p = payload(index)) {
+        const auto first = targetdata->size();
+        targetdata->insert(targetdata->end(), p->template begin<Hit_t>(), p->template end<Hit_t>());
+        // fix the trackIDs for this data
+        for (auto hit = targetdata->begin() + first; hit != targetdata->end(); ++hit) {
+          const auto oldID = hit->GetTrackID();
+          // offset depends on whether the trackis a primary or secondary
+          Int_t offset = (oldID < nprim) ? idelta0 : idelta1;
+          hit->SetTrackID(oldID + offset);
+        }
+      }
+      // adjust offsets for next subevent
+      idelta0 += nprim;
+      idelta1 += trackoffsets[index];
+    } // subevent loop
+    // fill target for this event
+    T* filladdress = targetdata.get();
+    auto targetbr = o2::base::getOrMakeBranch(target, brname.c_str(), &filladdress);
+    targetbr->SetAddress(&filladdress);
+    targetbr->Fill();
+    targetbr->ResetAddress();
   }
 
-  void mergeHitEntries(TTree& origin, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) final
+  void mergeHits(std::vector<std::vector<SubEventPayload> const*> const& hits, TTree& target, std::vector<int> const& trackoffsets, std::vector<int> const& nprimaries, std::vector<int> const& subevtsOrdered) final
   {
     // loop over hit containers / different branches
     // adjust trackID in hits on the go
     int probe = 0;
     using Hit_t = decltype(static_cast<Det*>(this)->Det::getHits(probe));
-    std::string name = static_cast<Det*>(this)->getHitBranchNames(probe++);
+    std::string name = static_cast<Det*>(this)->getHitBranchNames(probe);
     while (name.size() > 0) {
-      mergeAndAdjustHits<typename std::remove_pointer<Hit_t>::type>(name, origin, target, trackoffsets, nprimaries, subevtsOrdered);
+      mergeAndAdjustHits<typename std::remove_pointer<Hit_t>::type>(name, probe, hits, target, trackoffsets, nprimaries, subevtsOrdered);
       // next name
-      name = static_cast<Det*>(this)->getHitBranchNames(probe++);
+      name = static_cast<Det*>(this)->getHitBranchNames(++probe);
     }
   }
 
  public:
-  void fillHitBranch(TTree& tr, FairMQParts& parts, int& index) override
+  void decodeHits(FairMQParts& parts, int& index, std::vector<SubEventPayload>& hits) override
   {
     int probe = 0;
     bool* busy = nullptr;
     using Hit_t = decltype(static_cast<Det*>(this)->Det::getHits(probe));
+    using Container_t = typename std::remove_pointer<Hit_t>::type;
     std::string name = static_cast<Det*>(this)->getHitBranchNames(probe++);
     while (name.size() > 0) {
-      if (!UseShm<Det>::value || !o2::utils::ShmManager::Instance().isOperational()) {
-
-        // for each branch name we extract/decode hits from the message parts ...
-        auto hitsptr = decodeTMessage<Hit_t>(parts, index++);
-        if (hitsptr) {
-          // ... and fill the tree branch
-          auto br = getOrMakeBranch(tr, name.c_str(), hitsptr);
-          br->SetAddress(static_cast<void*>(&hitsptr));
-          br->Fill();
-          br->ResetAddress();
-          delete hitsptr;
-        }
-      } else {
-        // for each branch name we extract/decode hits from the message parts ...
+      // for each branch name we extract/decode hits from the message parts
+      if (UseShm<Det>::value && o2::utils::ShmManager::Instance().isOperational()) {
+        // the hits stay in the buffer of the sender, which is released below: take a plain copy
         auto hitsptr = decodeShmMessage<Hit_t>(parts, index++, busy);
-        // ... and fill the tree branch
-        auto br = getOrMakeBranch(tr, name.c_str(), hitsptr);
-        br->SetAddress(static_cast<void*>(&hitsptr));
-        br->Fill();
-        br->ResetAddress();
+        hits.emplace_back(makeSubEventPayload(std::make_shared<Container_t>(*hitsptr)));
+      } else if constexpr (isFlat()) {
+        hits.emplace_back(decodeFlatMessage<typename Container_t::value_type>(parts, index++));
+      } else {
+        auto hitsptr = decodeTMessage<Hit_t>(parts, index++);
+        hits.emplace_back(hitsptr ? makeSubEventPayload(std::shared_ptr<Container_t>(hitsptr)) : SubEventPayload{});
       }
       // next name
       name = static_cast<Det*>(this)->getHitBranchNames(probe++);
@@ -465,6 +503,13 @@ class DetImpl : public o2::base::Detector
     }
   }
 
+  // true if the hits are sent as flat messages when not using the shared mem variant
+  static constexpr bool isFlat()
+  {
+    using Hit_t = decltype(std::declval<Det&>().Det::getHits(0));
+    return std::is_trivially_copyable<typename std::remove_pointer<Hit_t>::type::value_type>::value;
+  }
+
   // implementing CloneModule (for G4-MT mode) automatically for each deriving
   // Detector class "Det"; calls copy constructor of Det
   FairModule* CloneModule() const final
@@ -51,6 +51,14 @@ class MatLayerCylSet : public o2::gpu::FlatObject
 {
 
  public:
+  /// R2 intervals found for the last ray, used as a starting point of the layers range search for the next ray.
+  /// The consecutive steps of a track propagation move monotonically in radius, so the intervals
+  /// of the next step are found in a few comparisons instead of a binary search.
+  struct LayersRangeCache {
+    int minInterval = -1; ///< R2 interval of the min radius of the last ray, -1 if not set
+    int maxInterval = -1; ///< R2 interval of the max radius of the last ray, -1 if not set
+  };
+
   MatLayerCylSet() CON_DEFAULT;
   ~MatLayerCylSet() CON_DEFAULT;
   MatLayerCylSet(const MatLayerCylSet& src) CON_DELETE;
@@ -61,7 +69,7 @@ class MatLayerCylSet : public o2::gpu::FlatObject
   GPUd() int getNLayers() const { return get() ? get()->mNLayers : 0; }
   GPUd() const MatLayerCyl& getLayer(int i) const { return get()->mLayers[i]; }
 
-  GPUd() bool getLayersRange(const Ray& ray, short& lmin, short& lmax) const;
+  GPUd() bool getLayersRange(const Ray& ray, short& lmin, short& lmax, LayersRangeCache* cache = nullptr) const;
   GPUd() float getRMin() const { return get()->mRMin; }
   GPUd() float getRMax() const { return get()->mRMax; }
   GPUd() float getZMax() const { return get()->mZMax; }
@@ -83,15 +91,19 @@ class MatLayerCylSet : public o2::gpu::FlatObject
 #endif // !GPUCA_ALIGPUCODE
 
 #ifndef GPUCA_ALIGPUCODE // this part is unvisible on GPU version
-  MatBudget getMatBudget(const math_utils::Point3D<float>& point0, const math_utils::Point3D<float>& point1) const
+  MatBudget getMatBudget(const math_utils::Point3D<float>& point0, const math_utils::Point3D<float>& point1, LayersRangeCache* cache = nullptr) const
   {
     // get material budget traversed on the line between point0 and point1
-    return getMatBudget(point0.X(), point0.Y(), point0.Z(), point1.X(), point1.Y(), point1.Z());
+    return getMatBudget(point0.X(), point0.Y(), point0.Z(), point1.X(), point1.Y(), point1.Z(), cache);
   }
+
+  // get material budgets of n segments points0[i]:points1[i], the consecutive segments (e.g. steps of a track) share the layers range cache
+  void getMatBudget(const math_utils::Point3D<float>* points0, const math_utils::Point3D<float>* points1, int n, MatBudget* budgets) const;
 #endif // !GPUCA_ALIGPUCODE
-  GPUd() MatBudget getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const;
+  GPUd() MatBudget getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1, LayersRangeCache* cache = nullptr) const;
 
   GPUd() int searchSegment(float val, int low = -1, int high = -1) const;
+  GPUd() int searchSegmentFrom(float val, int start, int low, int high) const;
 
 #ifndef GPUCA_GPUCODE
   //-----------------------------------------------------------
@@ -113,6 +113,38 @@ class PropagatorImpl
                                    gpu::gpustd::array<value_type, 2>* dca = nullptr, track::TrackLTIntegral* tofInfo = nullptr,
                                    int signCorr = 0, value_type maxD = 999.f) const;
 
+#ifndef GPUCA_GPUCODE
+  static constexpr int BatchSize = 32; ///< number of tracks in the groups of the batched propagation
+
+  /// Propagates n tracks to the common X, with the same result as propagateTo() called for each of them.
+  /// The tracks are processed in groups of BatchSize, doing the steps of all tracks of the group in turn. Each track is
+  /// propagated on its own (the field is fetched and the material correction is done per track), keeping its own
+  /// material layers range cache. status[i] is set to the success of the propagation of track i, tofInfo (if not null)
+  /// must have n elements. The groups are distributed over nThreads threads if OpenMP is available, unless the TGeo
+  /// material is queried. Returns the number of tracks propagated successfully.
+  int propagateBatchTo(TrackParCov_t* tracks, int n, value_type x, bool* status, bool bzOnly = false,
+                       value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP, MatCorrType matCorr = MatCorrType::USEMatCorrLUT,
+                       track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0, int nThreads = 1) const;
+
+  int propagateBatchTo(TrackPar_t* tracks, int n, value_type x, bool* status, bool bzOnly = false,
+                       value_type maxSnp = MAX_SIN_PHI, value_type maxStep = MAX_STEP, MatCorrType matCorr = MatCorrType::USEMatCorrLUT,
+                       track::TrackLTIntegral* tofInfo = nullptr, int signCorr = 0, int nThreads = 1) const;
+
+  /// Propagates n tracks to their DCA to the common vertex in the constant field bZ, with the same result as propagateToDCA()
+  /// called for each of them, the groups of tracks being processed as in propagateBatchTo().
+  /// dcaInfo and tofInfo (if not null) must have n elements. Returns the number of tracks propagated successfully.
+  int propagateBatchToDCA(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status, value_type bZ,
+                          value_type maxStep = MAX_STEP, MatCorrType matCorr = MatCorrType::USEMatCorrLUT,
+                          o2::dataformats::DCA* dcaInfo = nullptr, track::TrackLTIntegral* tofInfo = nullptr,
+                          int signCorr = 0, value_type maxD = 999.f, int nThreads = 1) const;
+
+  /// Same as propagateBatchToDCA(), but with the full field, as propagateToDCABxByBz()
+  int propagateBatchToDCABxByBz(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status,
+                                value_type maxStep = MAX_STEP, MatCorrType matCorr = MatCorrType::USEMatCorrLUT,
+                                o2::dataformats::DCA* dcaInfo = nullptr, track::TrackLTIntegral* tofInfo = nullptr,
+                                int signCorr = 0, value_type maxD = 999.f, int nThreads = 1) const;
+#endif
+
   PropagatorImpl(PropagatorImpl const&) = delete;
   PropagatorImpl(PropagatorImpl&&) = delete;
   PropagatorImpl& operator=(PropagatorImpl const&) = delete;
@@ -140,7 +172,8 @@ class PropagatorImpl
   static int initFieldFromGRP(const std::string grpFileName = "", std::string grpName = "GRP", bool verbose = false);
 #endif
 
-  GPUd() MatBudget getMatBudget(MatCorrType corrType, const o2::math_utils::Point3D<value_type>& p0, const o2::math_utils::Point3D<value_type>& p1) const;
+  GPUd() MatBudget getMatBudget(MatCorrType corrType, const o2::math_utils::Point3D<value_type>& p0, const o2::math_utils::Point3D<value_type>& p1,
+                                MatLayerCylSet::LayersRangeCache* cache = nullptr) const;
 
   GPUd() void getFieldXYZ(const math_utils::Point3D<float> xyz, float* bxyz) const;
 
@@ -155,6 +188,26 @@ class PropagatorImpl
   template <typename T>
   GPUd() void getFieldXYZImpl(const math_utils::Point3D<T> xyz, T* bxyz) const;
 
+#ifndef GPUCA_GPUCODE
+  /// propagates up to BatchSize tracks, each to its own X, in the field bZ if bzOnly
+  template <typename track_T>
+  int propagateBatch(track_T* tracks, const value_type* xToGo, int n, bool* status, bool bzOnly, value_type bZ, value_type maxSnp, value_type maxStep,
+                     MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr) const;
+
+  /// propagates the tracks to the common X in groups of BatchSize
+  template <typename track_T>
+  int propagateBatchToImpl(track_T* tracks, int n, value_type x, bool* status, bool bzOnly, value_type maxSnp, value_type maxStep,
+                           MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr, int nThreads) const;
+
+  /// propagates the tracks to their DCA to the vertex in groups of BatchSize
+  int propagateBatchToDCAImpl(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status, bool bzOnly, value_type bZ,
+                              value_type maxStep, MatCorrType matCorr, o2::dataformats::DCA* dcaInfo, track::TrackLTIntegral* tofInfo,
+                              int signCorr, value_type maxD, int nThreads) const;
+
+  /// number of threads to use for the batched propagation
+  int getBatchThreads(MatCorrType matCorr, int nThreads) const;
+#endif
+
   const o2::field::MagFieldFast* mField = nullptr; ///< External fast field (barrel only for the moment)
   value_type mBz = 0;                              // nominal field
 
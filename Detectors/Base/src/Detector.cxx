@@ -195,6 +195,7 @@ int Detector::registerSensitiveVolumeAndGetVolID(std::string const& name)
 #include <FairMQMessage.h>
 #include <FairMQParts.h>
 #include <FairMQChannel.h>
+#include <cstring>
 namespace o2
 {
 namespace base
@@ -243,6 +244,23 @@ void* decodeShmCore(FairMQParts& dataparts, int index, bool*& busy)
   return info->object_ptr;
 }
 
+void attachFlatMessageCore(void const* data, size_t size, FairMQChannel& channel, FairMQParts& parts)
+{
+  std::unique_ptr<FairMQMessage> message(channel.NewMessage(size));
+  if (size) {
+    memcpy(message->GetData(), data, size);
+  }
+  parts.AddPart(std::move(message));
+}
+
+SubEventPayload decodeFlatMessageCore(FairMQParts& dataparts, int index, size_t elemsize)
+{
+  std::shared_ptr<FairMQMessage> message(std::move(dataparts.At(index)));
+  auto ptr = message->GetData();
+  auto n = message->GetSize() / elemsize;
+  return SubEventPayload{std::move(message), ptr, n};
+}
+
 void* decodeTMessageCore(FairMQParts& dataparts, int index)
 {
   class TMessageWrapper : public TMessage
@@ -191,6 +191,16 @@ MatLayerCylSet* MatLayerCylSet::loadFromFile(std::string inpFName, std::string n
   return mb;
 }
 
+//________________________________________________________________________________
+void MatLayerCylSet::getMatBudget(const math_utils::Point3D<float>* points0, const math_utils::Point3D<float>* points1, int n, MatBudget* budgets) const
+{
+  // get material budgets of n segments, the layers range search of each segment starts from the result of the previous one
+  LayersRangeCache cache;
+  for (int i = 0; i < n; i++) {
+    budgets[i] = getMatBudget(points0[i].X(), points0[i].Y(), points0[i].Z(), points1[i].X(), points1[i].Y(), points1[i].Z(), &cache);
+  }
+}
+
 //________________________________________________________________________________
 void MatLayerCylSet::optimizePhiSlices(float maxRelDiff)
 {
@@ -241,13 +251,14 @@ std::size_t MatLayerCylSet::estimateFlatBufferSize() const
 #endif // ! GPUCA_GPUCODE
 
 //_________________________________________________________________________________________________
-GPUd() MatBudget MatLayerCylSet::getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1) const
+GPUd() MatBudget MatLayerCylSet::getMatBudget(float x0, float y0, float z0, float x1, float y1, float z1, LayersRangeCache* cache) const
 {
   // get material budget traversed on the line between point0 and point1
+  // if provided, the cache of the previous (close) segment is used to speed up the layers range search
   MatBudget rval;
   Ray ray(x0, y0, z0, x1, y1, z1);
   short lmin, lmax; // get innermost and outermost relevant layer
-  if (ray.isTooShort() || !getLayersRange(ray, lmin, lmax)) {
+  if (ray.isTooShort() || !getLayersRange(ray, lmin, lmax, cache)) {
     rval.length = ray.getDist();
     return rval;
   }
@@ -365,7 +376,7 @@ GPUd() MatBudget MatLayerCylSet::getMatBudget(float x0, float y0, float z0, floa
 }
 
 //_________________________________________________________________________________________________
-GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& lmax) const
+GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& lmax, LayersRangeCache* cache) const
 {
   // get range of layers corresponding to rmin/rmax
   //
@@ -377,8 +388,17 @@ GPUd() bool MatLayerCylSet::getLayersRange(const Ray& ray, short& lmin, short& l
     return false;
   }
   int lmxInt, lmnInt;
-  lmxInt = rmax2 < getRMax2() ? searchSegment(rmax2, 0) : get()->mNRIntervals - 2;
-  lmnInt = rmin2 >= getRMin2() ? searchSegment(rmin2, 0, lmxInt + 1) : 0;
+  if (cache && cache->maxInterval >= 0) { // start from the intervals of the previous ray
+    lmxInt = rmax2 < getRMax2() ? searchSegmentFrom(rmax2, cache->maxInterval, 0, get()->mNRIntervals) : get()->mNRIntervals - 2;
+    lmnInt = rmin2 >= getRMin2() ? searchSegmentFrom(rmin2, cache->minInterval, 0, lmxInt + 1) : 0;
+  } else {
+    lmxInt = rmax2 < getRMax2() ? searchSegment(rmax2, 0) : get()->mNRIntervals - 2;
+    lmnInt = rmin2 >= getRMin2() ? searchSegment(rmin2, 0, lmxInt + 1) : 0;
+  }
+  if (cache) {
+    cache->maxInterval = lmxInt;
+    cache->minInterval = lmnInt;
+  }
   const auto* interval2LrID = get()->mInterval2LrID;
   lmax = interval2LrID[lmxInt];
   lmin = interval2LrID[lmnInt];
@@ -414,6 +434,21 @@ GPUd() int MatLayerCylSet::searchSegment(float val, int low, int high) const
   return mid;
 }
 
+GPUd() int MatLayerCylSet::searchSegmentFrom(float val, int start, int low, int high) const
+{
+  ///< search segment val belongs to, walking from the segment start (e.g. the one of a close value found before).
+  ///< Gives the same result as searchSegment(val, low, high)
+  const auto* r2Intervals = get()->mR2Intervals;
+  int i = start < low ? low : (start >= high ? high - 1 : start);
+  while (i > low && val < r2Intervals[i]) {
+    i--;
+  }
+  while (i + 1 < high && val >= r2Intervals[i + 1]) {
+    i++;
+  }
+  return i;
+}
+
 #ifndef GPUCA_ALIGPUCODE // this part is unvisible on GPU version
 
 void MatLayerCylSet::flatten()
@@ -21,6 +21,8 @@ using namespace o2::gpu;
 
 #if !defined(GPUCA_GPUCODE)
 #include "Field/MagFieldFast.h" // Don't use this on the GPU
+#include <algorithm>
+#include <type_traits>
 #endif
 
 #if !defined(GPUCA_STANDALONE) && !defined(GPUCA_GPUCODE)
@@ -136,6 +138,7 @@ GPUd() bool PropagatorImpl<value_T>::PropagateToXBxByBz(TrackParCov_t& track, va
   }
 
   gpu::gpustd::array<value_type, 3> b;
+  MatLayerCylSet::LayersRangeCache matCache; // the steps are close in radius, the layers range search starts from the previous one
   while (math_utils::detail::abs<value_type>(dx) > Epsilon) {
     auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(dx), maxStep);
     if (dir < 0) {
@@ -153,7 +156,7 @@ GPUd() bool PropagatorImpl<value_T>::PropagateToXBxByBz(TrackParCov_t& track, va
     }
     if (matCorr != MatCorrType::USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, &matCache);
       if (!track.correctForMaterial(mb.meanX2X0, mb.getXRho(signCorr))) {
         return false;
       }
@@ -198,6 +201,7 @@ GPUd() bool PropagatorImpl<value_T>::PropagateToXBxByBz(TrackPar_t& track, value
   }
 
   gpu::gpustd::array<value_type, 3> b;
+  MatLayerCylSet::LayersRangeCache matCache; // the steps are close in radius, the layers range search starts from the previous one
   while (math_utils::detail::abs<value_type>(dx) > Epsilon) {
     auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(dx), maxStep);
     if (dir < 0) {
@@ -215,7 +219,7 @@ GPUd() bool PropagatorImpl<value_T>::PropagateToXBxByBz(TrackPar_t& track, value
     }
     if (matCorr != MatCorrType::USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, &matCache);
       if (!track.correctForELoss(((signCorr < 0) ? -mb.length : mb.length) * mb.meanRho)) {
         return false;
       }
@@ -257,6 +261,7 @@ GPUd() bool PropagatorImpl<value_T>::propagateToX(TrackParCov_t& track, value_ty
     signCorr = -dir; // sign of eloss correction is not imposed
   }
 
+  MatLayerCylSet::LayersRangeCache matCache; // the steps are close in radius, the layers range search starts from the previous one
   while (math_utils::detail::abs<value_type>(dx) > Epsilon) {
     auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(dx), maxStep);
     if (dir < 0) {
@@ -273,7 +278,7 @@ GPUd() bool PropagatorImpl<value_T>::propagateToX(TrackParCov_t& track, value_ty
     }
     if (matCorr != MatCorrType::USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, &matCache);
       //
       if (!track.correctForMaterial(mb.meanX2X0, mb.getXRho(signCorr))) {
         return false;
@@ -317,6 +322,7 @@ GPUd() bool PropagatorImpl<value_T>::propagateToX(TrackPar_t& track, value_type
     signCorr = -dir; // sign of eloss correction is not imposed
   }
 
+  MatLayerCylSet::LayersRangeCache matCache; // the steps are close in radius, the layers range search starts from the previous one
   while (math_utils::detail::abs<value_type>(dx) > Epsilon) {
     auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(dx), maxStep);
     if (dir < 0) {
@@ -333,7 +339,7 @@ GPUd() bool PropagatorImpl<value_T>::propagateToX(TrackPar_t& track, value_type
     }
     if (matCorr != MatCorrType::USEMatCorrNONE) {
       auto xyz1 = track.getXYZGlo();
-      auto mb = getMatBudget(matCorr, xyz0, xyz1);
+      auto mb = getMatBudget(matCorr, xyz0, xyz1, &matCache);
       //
       if (!track.correctForELoss(mb.getXRho(signCorr))) {
         return false;
@@ -574,14 +580,15 @@ GPUd() void PropagatorImpl<value_T>::estimateLTFast(o2::track::TrackLTIntegral&
 
 //____________________________________________________________
 template <typename value_T>
-GPUd() MatBudget PropagatorImpl<value_T>::getMatBudget(PropagatorImpl<value_type>::MatCorrType corrType, const math_utils::Point3D<value_type>& p0, const math_utils::Point3D<value_type>& p1) const
+GPUd() MatBudget PropagatorImpl<value_T>::getMatBudget(PropagatorImpl<value_type>::MatCorrType corrType, const math_utils::Point3D<value_type>& p0, const math_utils::Point3D<value_type>& p1,
+                                                       MatLayerCylSet::LayersRangeCache* cache) const
 {
 #if !defined(GPUCA_STANDALONE) && !defined(GPUCA_GPUCODE)
   if (corrType == MatCorrType::USEMatCorrTGeo || !mMatLUT) {
     return GeometryManager::meanMaterialBudget(p0, p1);
   }
 #endif
-  return mMatLUT->getMatBudget(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z());
+  return mMatLUT->getMatBudget(p0.X(), p0.Y(), p0.Z(), p1.X(), p1.Y(), p1.Z(), cache);
 }
 
 template <typename value_T>
@@ -620,6 +627,254 @@ GPUd() void PropagatorImpl<value_T>::getFieldXYZ(const math_utils::Point3D<doubl
   getFieldXYZImpl<double>(xyz, bxyz);
 }
 
+#ifndef GPUCA_GPUCODE
+//_______________________________________________________________________
+template <typename value_T>
+template <typename track_T>
+int PropagatorImpl<value_T>::propagateBatch(track_T* tracks, const value_type* xToGo, int n, bool* status, bool bzOnly, value_type bZ, value_type maxSnp, value_type maxStep,
+                                            PropagatorImpl<value_T>::MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr) const
+{
+  // Propagates n <= BatchSize tracks, doing for each of them the same steps as propagateToX (bzOnly)
+  // or PropagateToXBxByBz. The steps of the tracks are done in turn, each track being propagated on its own.
+  constexpr bool withCov = std::is_same_v<track_T, TrackParCov_t>;
+  const value_type Epsilon = 0.00001;
+  math_utils::Point3D<value_type> xyz0[BatchSize];
+  gpu::gpustd::array<value_type, 3> b[BatchSize] = {};
+  MatLayerCylSet::LayersRangeCache matCache[BatchSize]; // the steps of each track are close in radius
+  int dir[BatchSize], sgn[BatchSize], active[BatchSize];
+  int nActive = 0, nOK = 0;
+  for (int i = 0; i < n; i++) {
+    auto dx = xToGo[i] - tracks[i].getX();
+    dir[i] = dx > 0.f ? 1 : -1;
+    sgn[i] = signCorr ? signCorr : -dir[i]; // sign of eloss correction, if not imposed
+    status[i] = true;
+    if (math_utils::detail::abs<value_type>(dx) > Epsilon) {
+      active[nActive++] = i;
+    } else {
+      tracks[i].setX(xToGo[i]);
+      nOK++;
+    }
+  }
+
+  while (nActive) {
+    // start points of the current step of the tracks and, with the full field, the field there
+    for (int k = 0; k < nActive; k++) {
+      xyz0[k] = tracks[active[k]].getXYZGlo();
+    }
+    if (!bzOnly) {
+      for (int k = 0; k < nActive; k++) {
+        getFieldXYZ(xyz0[k], &b[active[k]][0]);
+      }
+    }
+    int nKeep = 0;
+    for (int k = 0; k < nActive; k++) {
+      const int i = active[k];
+      auto& track = tracks[i];
+      auto step = math_utils::detail::min<value_type>(math_utils::detail::abs<value_type>(xToGo[i] - track.getX()), maxStep);
+      if (dir[i] < 0) {
+        step = -step;
+      }
+      auto x = track.getX() + step;
+      bool ok;
+      if constexpr (withCov) {
+        ok = bzOnly ? track.propagateTo(x, bZ) : track.propagateTo(x, b[i]);
+      } else {
+        ok = bzOnly ? track.propagateParamTo(x, bZ) : track.propagateParamTo(x, b[i]);
+      }
+      if (ok && maxSnp > 0 && math_utils::detail::abs<value_type>(track.getSnp()) >= maxSnp) {
+        ok = false;
+      }
+      if (ok && matCorr != MatCorrType::USEMatCorrNONE) {
+        auto xyz1 = track.getXYZGlo();
+        auto mb = getMatBudget(matCorr, xyz0[k], xyz1, &matCache[i]);
+        if constexpr (withCov) {
+          ok = track.correctForMaterial(mb.meanX2X0, mb.getXRho(sgn[i]));
+        } else {
+          ok = track.correctForELoss(mb.getXRho(sgn[i]));
+        }
+        if (ok && tofInfo) {
+          tofInfo[i].addStep(mb.length, track.getP2Inv()); // fill L,ToF info using already calculated step length
+          tofInfo[i].addX2X0(mb.meanX2X0);
+          if (withCov && !bzOnly) {
+            tofInfo[i].addXRho(mb.getXRho(sgn[i]));
+          }
+        }
+      } else if (ok && tofInfo) { // if tofInfo filling was requested w/o material correction, we need to calculate the step lenght
+        auto xyz1 = track.getXYZGlo();
+        math_utils::Vector3D<value_type> stepV(xyz1.X() - xyz0[k].X(), xyz1.Y() - xyz0[k].Y(), xyz1.Z() - xyz0[k].Z());
+        tofInfo[i].addStep(stepV.R(), track.getP2Inv());
+      }
+      if (!ok) {
+        status[i] = false;
+      } else if (math_utils::detail::abs<value_type>(xToGo[i] - track.getX()) > Epsilon) {
+        active[nKeep++] = i;
+      } else {
+        track.setX(xToGo[i]);
+        nOK++;
+      }
+    }
+    nActive = nKeep;
+  }
+  return nOK;
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::getBatchThreads(PropagatorImpl<value_T>::MatCorrType matCorr, int nThreads) const
+{
+#ifdef WITH_OPENMP
+  // TGeo navigation is not thread safe
+  bool useTGeo = matCorr == MatCorrType::USEMatCorrTGeo || (matCorr == MatCorrType::USEMatCorrLUT && !mMatLUT);
+  return useTGeo ? 1 : (nThreads > 0 ? nThreads : 1);
+#else
+  return 1;
+#endif
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+template <typename track_T>
+int PropagatorImpl<value_T>::propagateBatchToImpl(track_T* tracks, int n, value_type x, bool* status, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                                  PropagatorImpl<value_T>::MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr, int nThreads) const
+{
+  value_type xToGo[BatchSize];
+  std::fill_n(xToGo, BatchSize, x);
+  const int nBatches = (n + BatchSize - 1) / BatchSize;
+  int nOK = 0;
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(getBatchThreads(matCorr, nThreads)) reduction(+ : nOK)
+#endif
+  for (int ib = 0; ib < nBatches; ib++) {
+    const int first = ib * BatchSize;
+    nOK += propagateBatch(tracks + first, xToGo, math_utils::detail::min<int>(BatchSize, n - first), status + first, bzOnly, mBz, maxSnp, maxStep,
+                          matCorr, tofInfo ? tofInfo + first : nullptr, signCorr);
+  }
+  return nOK;
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchTo(TrackParCov_t* tracks, int n, value_type x, bool* status, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                              PropagatorImpl<value_T>::MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr, int nThreads) const
+{
+  return propagateBatchToImpl(tracks, n, x, status, bzOnly, maxSnp, maxStep, matCorr, tofInfo, signCorr, nThreads);
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchTo(TrackPar_t* tracks, int n, value_type x, bool* status, bool bzOnly, value_type maxSnp, value_type maxStep,
+                                              PropagatorImpl<value_T>::MatCorrType matCorr, track::TrackLTIntegral* tofInfo, int signCorr, int nThreads) const
+{
+  return propagateBatchToImpl(tracks, n, x, status, bzOnly, maxSnp, maxStep, matCorr, tofInfo, signCorr, nThreads);
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToDCA(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status, value_type bZ,
+                                                 value_type maxStep, PropagatorImpl<value_T>::MatCorrType matCorr,
+                                                 o2::dataformats::DCA* dcaInfo, track::TrackLTIntegral* tofInfo,
+                                                 int signCorr, value_type maxD, int nThreads) const
+{
+  return propagateBatchToDCAImpl(vtx, tracks, n, status, true, bZ, maxStep, matCorr, dcaInfo, tofInfo, signCorr, maxD, nThreads);
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToDCABxByBz(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status,
+                                                       value_type maxStep, PropagatorImpl<value_T>::MatCorrType matCorr,
+                                                       o2::dataformats::DCA* dcaInfo, track::TrackLTIntegral* tofInfo,
+                                                       int signCorr, value_type maxD, int nThreads) const
+{
+  return propagateBatchToDCAImpl(vtx, tracks, n, status, false, mBz, maxStep, matCorr, dcaInfo, tofInfo, signCorr, maxD, nThreads);
+}
+
+//_______________________________________________________________________
+template <typename value_T>
+int PropagatorImpl<value_T>::propagateBatchToDCAImpl(const o2::dataformats::VertexBase& vtx, TrackParCov_t* tracks, int n, bool* status, bool bzOnly,
+                                                     value_type bZ, value_type maxStep, PropagatorImpl<value_T>::MatCorrType matCorr,
+                                                     o2::dataformats::DCA* dcaInfo, track::TrackLTIntegral* tofInfo,
+                                                     int signCorr, value_type maxD, int nThreads) const
+{
+  const int nBatches = (n + BatchSize - 1) / BatchSize;
+  int nOK = 0;
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(getBatchThreads(matCorr, nThreads)) reduction(+ : nOK)
+#endif
+  for (int ib = 0; ib < nBatches; ib++) {
+    const int first = ib * BatchSize, nb = math_utils::detail::min<int>(BatchSize, n - first);
+    TrackParCov_t tmpT[BatchSize]; // operate on the copies to recover after the failure
+    track::TrackLTIntegral tmpLT[BatchSize];
+    value_type xToGo[BatchSize], yvLoc[BatchSize], alpha[BatchSize];
+    bool ok[BatchSize];
+    int index[BatchSize], nProp = 0;
+    // rotate each track to the frame of its estimated DCA to the vertex, as propagateToDCA does
+    for (int it = first; it < first + nb; it++) {
+      const auto& track = tracks[it];
+      status[it] = false;
+      value_type sn, cs, alp = track.getAlpha();
+      math_utils::detail::sincos<value_type>(alp, sn, cs);
+      value_type x = track.getX(), y = track.getY(), snp = track.getSnp(), csp = math_utils::detail::sqrt<value_type>((1.f - snp) * (1.f + snp));
+      value_type xv = vtx.getX() * cs + vtx.getY() * sn, yv = -vtx.getX() * sn + vtx.getY() * cs;
+      x -= xv;
+      y -= yv;
+      //Estimate the impact parameter neglecting the track curvature
+      value_type d = math_utils::detail::abs<value_type>(x * snp - y * csp);
+      if (d > maxD) {
+        continue;
+      }
+      value_type crv = track.getCurvature(bZ);
+      value_type tgfv = -(crv * x - snp) / (crv * y + csp);
+      sn = tgfv / math_utils::detail::sqrt<value_type>(1.f + tgfv * tgfv);
+      cs = math_utils::detail::sqrt<value_type>((1. - sn) * (1. + sn));
+      cs = (math_utils::detail::abs<value_type>(tgfv) > o2::constants::math::Almost0) ? sn / tgfv : o2::constants::math::Almost1;
+
+      x = xv * cs + yv * sn;
+      yv = -xv * sn + yv * cs;
+      xv = x;
+
+      tmpT[nProp] = track;
+      alp += math_utils::detail::asin<value_type>(sn);
+      if (!tmpT[nProp].rotate(alp)) {
+        LOG(WARNING) << "failed to propagate to alpha=" << alp << " X=" << xv << vtx << " | Track is: ";
+        tmpT[nProp].print();
+        continue;
+      }
+      if (tofInfo) {
+        tmpLT[nProp] = tofInfo[it];
+      }
+      xToGo[nProp] = xv;
+      yvLoc[nProp] = yv;
+      alpha[nProp] = alp;
+      index[nProp++] = it;
+    }
+    propagateBatch(tmpT, xToGo, nProp, ok, bzOnly, bZ, value_type(0.85), maxStep, matCorr, tofInfo ? tmpLT : nullptr, signCorr);
+    for (int k = 0; k < nProp; k++) {
+      const int it = index[k];
+      if (tofInfo) {
+        tofInfo[it] = tmpLT[k]; // as in propagateToDCA, the steps done before a failure are accounted
+      }
+      if (!ok[k]) {
+        LOG(WARNING) << "failed to propagate to alpha=" << alpha[k] << " X=" << xToGo[k] << vtx << " | Track is: ";
+        tmpT[k].print();
+        continue;
+      }
+      auto& track = tracks[it];
+      track = tmpT[k];
+      if (dcaInfo) {
+        value_type sn, cs;
+        math_utils::detail::sincos<value_type>(alpha[k], sn, cs);
+        auto s2ylocvtx = vtx.getSigmaX2() * sn * sn + vtx.getSigmaY2() * cs * cs - 2. * vtx.getSigmaXY() * cs * sn;
+        dcaInfo[it].set(track.getY() - yvLoc[k], track.getZ() - vtx.getZ(),
+                        track.getSigmaY2() + s2ylocvtx, track.getSigmaZY(), track.getSigmaZ2() + vtx.getSigmaZ2());
+      }
+      status[it] = true;
+      nOK++;
+    }
+  }
+  return nOK;
+}
+#endif
+
 namespace o2::base
 {
 template class PropagatorImpl<float>;
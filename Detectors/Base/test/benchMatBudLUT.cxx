@@ -0,0 +1,113 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+// \file benchMatBudLUT.cxx
+// Benchmark of the material budget queries of the MatLayerCylSet along straight tracks.
+// The LUT is read from the file given by the O2_MATBUD_FILE environment variable (default: matbud.root),
+// see buildMatBudLUT.C for its creation.
+
+#include "benchmark/benchmark.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using o2::base::MatBudget;
+using o2::base::MatLayerCylSet;
+using Point3D = o2::math_utils::Point3D<float>;
+
+const MatLayerCylSet* getLUT()
+{
+  static std::unique_ptr<MatLayerCylSet> lut = []() {
+    const char* env = std::getenv("O2_MATBUD_FILE");
+    return std::unique_ptr<MatLayerCylSet>(MatLayerCylSet::loadFromFile(env ? env : "matbud.root", "MatBud"));
+  }();
+  return lut.get();
+}
+
+// the steps of nTracks straight tracks from the beam line to the outer radius of the LUT, with radial step rStep
+void makeSteps(const MatLayerCylSet& lut, float rStep, std::vector<Point3D>& points0, std::vector<Point3D>& points1)
+{
+  const int nTracks = 100;
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<float> phiDist(0.f, 2.f * M_PI), tglDist(-1.f, 1.f);
+  points0.clear();
+  points1.clear();
+  for (int it = 0; it < nTracks; it++) {
+    float phi = phiDist(gen), tgl = tglDist(gen), cs = std::cos(phi), sn = std::sin(phi);
+    for (float r = 0.f; r < lut.getRMax(); r += rStep) {
+      points0.emplace_back(r * cs, r * sn, r * tgl);
+      points1.emplace_back((r + rStep) * cs, (r + rStep) * sn, (r + rStep) * tgl);
+    }
+  }
+}
+
+static void benchMatBudgetNoCache(benchmark::State& state)
+{
+  const auto* lut = getLUT();
+  if (!lut) {
+    state.SkipWithError("material budget LUT is not available");
+    return;
+  }
+  std::vector<Point3D> points0, points1;
+  makeSteps(*lut, state.range(0) * 0.1f, points0, points1);
+  for (auto _ : state) {
+    for (size_t i = 0; i < points0.size(); i++) {
+      benchmark::DoNotOptimize(lut->getMatBudget(points0[i], points1[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points0.size());
+}
+
+static void benchMatBudgetCache(benchmark::State& state)
+{
+  const auto* lut = getLUT();
+  if (!lut) {
+    state.SkipWithError("material budget LUT is not available");
+    return;
+  }
+  std::vector<Point3D> points0, points1;
+  makeSteps(*lut, state.range(0) * 0.1f, points0, points1);
+  for (auto _ : state) {
+    MatLayerCylSet::LayersRangeCache cache;
+    for (size_t i = 0; i < points0.size(); i++) {
+      benchmark::DoNotOptimize(lut->getMatBudget(points0[i], points1[i], &cache));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * points0.size());
+}
+
+static void benchMatBudgetBatch(benchmark::State& state)
+{
+  const auto* lut = getLUT();
+  if (!lut) {
+    state.SkipWithError("material budget LUT is not available");
+    return;
+  }
+  std::vector<Point3D> points0, points1;
+  makeSteps(*lut, state.range(0) * 0.1f, points0, points1);
+  std::vector<MatBudget> budgets(points0.size());
+  for (auto _ : state) {
+    lut->getMatBudget(points0.data(), points1.data(), points0.size(), budgets.data());
+    benchmark::DoNotOptimize(budgets.data());
+  }
+  state.SetItemsProcessed(state.iterations() * points0.size());
+}
+
+// radial steps of 0.5, 2 and 10 cm
+BENCHMARK(benchMatBudgetNoCache)->Arg(5)->Arg(20)->Arg(100);
+BENCHMARK(benchMatBudgetCache)->Arg(5)->Arg(20)->Arg(100);
+BENCHMARK(benchMatBudgetBatch)->Arg(5)->Arg(20)->Arg(100);
+
+BENCHMARK_MAIN();
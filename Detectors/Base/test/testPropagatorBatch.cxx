@@ -0,0 +1,225 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test Propagator batched propagation
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "DetectorsBase/Propagator.h"
+#include "DetectorsBase/MatLayerCylSet.h"
+#include "ReconstructionDataFormats/Vertex.h"
+#include "ReconstructionDataFormats/DCA.h"
+#include "GPUTPCGMPolynomialField.h"
+#include "GPUTPCGMPolynomialFieldManager.h"
+#include <TGeoManager.h>
+#include <TGeoMaterial.h>
+#include <TGeoMedium.h>
+#include <TGeoVolume.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace base
+{
+using TrackParCov = o2::track::TrackParCov;
+using TrackPar = o2::track::TrackPar;
+using MatCorrType = Propagator::MatCorrType;
+
+// silicon shells along the beam line, which are crossed by the tracks: (rMin, rMax) of each shell
+const std::vector<std::pair<float, float>> ShellRadii{{3.9f, 4.0f}, {19.9f, 20.1f}, {39.8f, 40.2f}, {59.7f, 60.3f}};
+
+/// \brief Prepares the propagator with the nominal field Bz = 5 kG, the polynomial approximation of the full 5 kG field
+/// and the material LUT of a toy geometry of silicon shells, which is also loaded for the TGeo material queries
+Propagator* getPropagator()
+{
+  static o2::gpu::GPUTPCGMPolynomialField field;
+  static o2::base::MatLayerCylSet lut;
+  auto prop = Propagator::Instance(true);
+  if (!gGeoManager) {
+    auto geom = new TGeoManager("toy", "silicon shells");
+    auto vacuum = new TGeoMedium("vacuum", 1, new TGeoMaterial("vacuum", 0, 0, 0));
+    auto silicon = new TGeoMedium("silicon", 2, new TGeoMaterial("silicon", 28.09, 14, 2.33));
+    auto world = geom->MakeBox("world", vacuum, 200, 200, 200);
+    geom->SetTopVolume(world);
+    for (size_t i = 0; i < ShellRadii.size(); i++) {
+      auto shell = geom->MakeTube(("shell" + std::to_string(i)).c_str(), silicon, ShellRadii[i].first, ShellRadii[i].second, 150);
+      world->AddNode(shell, 1);
+    }
+    geom->CloseGeometry();
+
+    for (const auto& [rMin, rMax] : ShellRadii) {
+      lut.addLayer(rMin - 0.1f, rMax + 0.1f, 150.f, 10.f, 10.f);
+    }
+    lut.populateFromTGeo(2);
+    lut.optimizePhiSlices();
+    lut.flatten();
+
+    o2::gpu::GPUTPCGMPolynomialFieldManager::GetPolynomialField(5.f, field);
+    prop->setBz(5.f);
+    prop->setMatLUT(&lut);
+    prop->setGPUField(&field);
+  }
+  return prop;
+}
+
+// tracks close to the beam line, with curvatures including loopers and with large inclinations in the tracking frame,
+// so that a part of them cannot reach the X of the batch or gets beyond the max. sin(phi)
+std::vector<TrackParCov> generateTracks(int n, float xMin, float xMax, float yMax)
+{
+  std::mt19937 gen(12345);
+  std::uniform_real_distribution<float> uni(-1.f, 1.f);
+  std::vector<TrackParCov> tracks;
+  for (int i = 0; i < n; i++) {
+    float x = xMin + 0.5f * (1.f + uni(gen)) * (xMax - xMin);
+    float alpha = 3.14159f * uni(gen);
+    std::array<float, 5> par{yMax * uni(gen), 10.f * uni(gen), 0.8f * uni(gen), uni(gen), 10.f * uni(gen)};
+    std::array<float, 15> cov{1e-2, 1e-4, 1e-2, 1e-5, 1e-6, 1e-4, 1e-6, 1e-5, 1e-7, 1e-4, 1e-5, 1e-6, 1e-6, 1e-7, 1e-3};
+    tracks.emplace_back(x, alpha, par, cov);
+  }
+  return tracks;
+}
+
+template <typename T>
+void checkSameTrack(const T& batch, const T& single)
+{
+  const float Tolerance = 1e-5;
+  BOOST_CHECK_SMALL(batch.getX() - single.getX(), Tolerance);
+  BOOST_CHECK_SMALL(batch.getAlpha() - single.getAlpha(), Tolerance);
+  for (int i = 0; i < 5; i++) {
+    BOOST_CHECK_SMALL(batch.getParam(i) - single.getParam(i), Tolerance * std::max(1.f, std::abs(single.getParam(i))));
+  }
+  if constexpr (std::is_same_v<T, TrackParCov>) {
+    for (int i = 0; i < 15; i++) {
+      BOOST_CHECK_SMALL(batch.getCov()[i] - single.getCov()[i], Tolerance * std::max(1.f, std::abs(single.getCov()[i])));
+    }
+  }
+}
+
+void checkSameLT(const o2::track::TrackLTIntegral& batch, const o2::track::TrackLTIntegral& single)
+{
+  const float Tolerance = 1e-5;
+  BOOST_CHECK_SMALL(batch.getL() - single.getL(), Tolerance * std::max(1.f, single.getL()));
+  for (int id = 0; id < o2::track::TrackLTIntegral::getNTOFs(); id++) {
+    BOOST_CHECK_SMALL(batch.getTOF(id) - single.getTOF(id), Tolerance * std::max(1.f, single.getTOF(id)));
+  }
+}
+
+/// \brief The batched propagation to a common X gives the same tracks, status and integrated length and time of flight
+/// as the propagation of each track, for the tracks with and without covariance, serially and in threads
+template <typename T>
+void testBatchTo(const std::vector<TrackParCov>& input, float x, bool bzOnly, MatCorrType matCorr, int nThreads)
+{
+  auto prop = getPropagator();
+  const int n = input.size();
+  std::vector<T> single(input.begin(), input.end()), batch(input.begin(), input.end());
+  std::vector<o2::track::TrackLTIntegral> ltSingle(n), ltBatch(n);
+  std::unique_ptr<bool[]> status(new bool[n]);
+  std::vector<bool> okSingle(n);
+  int nOKSingle = 0, nFailed = 0;
+  for (int i = 0; i < n; i++) {
+    okSingle[i] = prop->propagateTo(single[i], x, bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP, matCorr, &ltSingle[i]);
+    nOKSingle += okSingle[i];
+  }
+  int nOK = prop->propagateBatchTo(batch.data(), n, x, status.get(), bzOnly, Propagator::MAX_SIN_PHI, Propagator::MAX_STEP,
+                                   matCorr, ltBatch.data(), 0, nThreads);
+  BOOST_CHECK_EQUAL(nOK, nOKSingle);
+  for (int i = 0; i < n; i++) {
+    BOOST_CHECK(status[i] == okSingle[i]);
+    nFailed += !okSingle[i];
+    checkSameTrack(batch[i], single[i]); // the failed tracks are left where the propagation stopped, as by propagateTo()
+    checkSameLT(ltBatch[i], ltSingle[i]);
+  }
+  BOOST_CHECK(nFailed > 0 && nFailed < n); // both cases are tested
+}
+
+/// the combinations of field and material correction tested: nominal field w/o material, with the material from the LUT
+/// and from TGeo (the latter being processed serially), full field with the material from the LUT
+const std::vector<std::pair<bool, MatCorrType>> Configurations{{true, MatCorrType::USEMatCorrNONE},
+                                                               {true, MatCorrType::USEMatCorrLUT},
+                                                               {true, MatCorrType::USEMatCorrTGeo},
+                                                               {false, MatCorrType::USEMatCorrLUT}};
+
+BOOST_AUTO_TEST_CASE(PropagatorBatchTo)
+{
+  auto tracks = generateTracks(1000, 0.f, 5.f, 1.f);
+  for (const auto& [bzOnly, matCorr] : Configurations) {
+    for (int nThreads : {1, 4}) {
+      testBatchTo<TrackParCov>(tracks, 80.f, bzOnly, matCorr, nThreads);
+      testBatchTo<TrackPar>(tracks, 80.f, bzOnly, matCorr, nThreads);
+    }
+  }
+}
+
+/// \brief The batched propagation to the DCA to a common vertex gives the same tracks, status, DCAs and integrated length
+/// and time of flight as the propagation of each track. The failures include the tracks rejected by the max. DCA estimate.
+void testBatchToDCA(const std::vector<TrackParCov>& input, bool bzOnly, MatCorrType matCorr, int nThreads)
+{
+  auto prop = getPropagator();
+  const float maxD = 3.f;
+  o2::dataformats::VertexBase vtx;
+  vtx.setXYZ(0.05f, -0.02f, 1.f);
+  vtx.setCov(1e-4, 1e-6, 1e-4, 1e-6, 1e-6, 1e-3);
+  const int n = input.size();
+  std::vector<TrackParCov> single(input), batch(input);
+  std::vector<o2::track::TrackLTIntegral> ltSingle(n), ltBatch(n);
+  std::vector<o2::dataformats::DCA> dcaSingle(n), dcaBatch(n);
+  std::unique_ptr<bool[]> status(new bool[n]);
+  int nOKSingle = 0, nFailed = 0;
+  std::vector<bool> okSingle(n);
+  for (int i = 0; i < n; i++) {
+    okSingle[i] = bzOnly ? prop->propagateToDCA(vtx, single[i], prop->getNominalBz(), Propagator::MAX_STEP, matCorr, &dcaSingle[i], &ltSingle[i], 0, maxD)
+                         : prop->propagateToDCABxByBz(vtx, single[i], Propagator::MAX_STEP, matCorr, &dcaSingle[i], &ltSingle[i], 0, maxD);
+    nOKSingle += okSingle[i];
+  }
+  int nOK = bzOnly ? prop->propagateBatchToDCA(vtx, batch.data(), n, status.get(), prop->getNominalBz(), Propagator::MAX_STEP, matCorr,
+                                               dcaBatch.data(), ltBatch.data(), 0, maxD, nThreads)
+                   : prop->propagateBatchToDCABxByBz(vtx, batch.data(), n, status.get(), Propagator::MAX_STEP, matCorr,
+                                                     dcaBatch.data(), ltBatch.data(), 0, maxD, nThreads);
+  BOOST_CHECK_EQUAL(nOK, nOKSingle);
+  for (int i = 0; i < n; i++) {
+    BOOST_CHECK(status[i] == okSingle[i]);
+    checkSameTrack(batch[i], single[i]); // the failed tracks are not modified
+    checkSameLT(ltBatch[i], ltSingle[i]);
+    if (okSingle[i]) {
+      const float Tolerance = 1e-5;
+      BOOST_CHECK_SMALL(dcaBatch[i].getY() - dcaSingle[i].getY(), Tolerance);
+      BOOST_CHECK_SMALL(dcaBatch[i].getZ() - dcaSingle[i].getZ(), Tolerance);
+      BOOST_CHECK_SMALL(dcaBatch[i].getSigmaY2() - dcaSingle[i].getSigmaY2(), Tolerance);
+      BOOST_CHECK_SMALL(dcaBatch[i].getSigmaYZ() - dcaSingle[i].getSigmaYZ(), Tolerance);
+      BOOST_CHECK_SMALL(dcaBatch[i].getSigmaZ2() - dcaSingle[i].getSigmaZ2(), Tolerance);
+    } else {
+      nFailed++;
+    }
+  }
+  BOOST_CHECK(nFailed > 0 && nFailed < n); // both cases are tested
+}
+
+BOOST_AUTO_TEST_CASE(PropagatorBatchToDCA)
+{
+  auto tracks = generateTracks(1000, 30.f, 50.f, 4.f);
+  for (const auto& [bzOnly, matCorr] : Configurations) {
+    for (int nThreads : {1, 4}) {
+      testBatchToDCA(tracks, bzOnly, matCorr, nThreads);
+    }
+  }
+}
+
+} // namespace base
+} // namespace o2
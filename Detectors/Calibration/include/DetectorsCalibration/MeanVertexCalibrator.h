@@ -45,7 +45,7 @@ class MeanVertexCalibrator final : public o2::calibration::TimeSlotCalibration<o
     mSMAdata.init(useFit, nBinsX, rangeX, nBinsY, rangeY, nBinsZ, rangeZ);
   }
 
-  ~MeanVertexCalibrator() final = default;
+  ~MeanVertexCalibrator() final { stopFinalization(); }
 
   bool hasEnoughData(const Slot& slot) const final
   {
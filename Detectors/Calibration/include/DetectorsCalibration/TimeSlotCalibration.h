@@ -15,9 +15,13 @@
 /// @brief Processor for the multiple time slots calibration
 
 #include "DetectorsCalibration/TimeSlot.h"
+#include <cassert>
+#include <condition_variable>
 #include <deque>
 #include <gsl/gsl>
 #include <limits>
+#include <mutex>
+#include <thread>
 
 namespace o2
 {
@@ -31,7 +35,9 @@ class TimeSlotCalibration
 
  public:
   TimeSlotCalibration() = default;
-  virtual ~TimeSlotCalibration() = default;
+  // the background finalization calls the pure virtual finalizeSlot, it must be stopped by the user at the end of the
+  // stream, or by the destructor of the derived class, before the destruction reaches this class
+  virtual ~TimeSlotCalibration() { assert(!mFinalizeThread.joinable()); }
   uint64_t getMaxSlotsDelay() const { return mMaxSlotsDelay; }
   void setMaxSlotsDelay(uint64_t v) { mMaxSlotsDelay = v; }
 
@@ -49,6 +55,21 @@ class TimeSlotCalibration
 
   void setUpdateAtTheEndOfRunOnly() { mUpdateAtTheEndOfRunOnly = kTRUE; }
 
+  // finalize the slots on a dedicated thread, so that the filling of new TFs is not blocked by long finalizations;
+  // the finalizeSlot of the derived class must then only access the slot and its output, and the output must be
+  // accessed by the user only while holding lockOutput() or tryLockOutput()
+  void setFinalizeInBackground(bool v = true);
+  bool getFinalizeInBackground() const { return mFinalizeInBackground; }
+  // wait until all slots handed over to the background thread are finalized
+  void waitForFinalization();
+  // number of slots queued or being finalized in background
+  size_t getNSlotsInFinalization() const;
+  // lock of the output filled by finalizeSlot: it is held by the background thread during the finalization
+  std::unique_lock<std::mutex> lockOutput() { return std::unique_lock<std::mutex>(mOutputMutex); }
+  std::unique_lock<std::mutex> tryLockOutput() { return std::unique_lock<std::mutex>(mOutputMutex, std::try_to_lock); }
+  // drain the background finalization and stop its thread, to be called at the end of the stream
+  void stopFinalization();
+
   int getNSlots() const { return mSlots.size(); }
   Slot& getSlotForTF(TFType tf);
   Slot& getSlot(int i) { return (Slot&)mSlots.at(i); }
@@ -78,6 +99,8 @@ class TimeSlotCalibration
 
  private:
   TFType tf2SlotMin(TFType tf) const;
+  void finalizeOrQueue(Slot& slot);
+  void finalizeInBackground();
 
   std::deque<Slot> mSlots;
 
@@ -98,6 +121,16 @@ class TimeSlotCalibration
                                                 // after how many TF to check again.
   bool mWasCheckedInfiniteSlot = false;         // flag to know whether the statistics of the infinite slot was already checked
 
+  bool mFinalizeInBackground = false;      //! whether the slots are finalized on mFinalizeThread
+  bool mStopFinalization = false;          //! request to mFinalizeThread to quit once the queue is empty
+  size_t mNSlotsInFinalization = 0;        //! slots queued or being finalized in background
+  std::deque<Slot> mSlotsToFinalize;       //! slots closed but not yet finalized
+  std::thread mFinalizeThread;             //!
+  mutable std::mutex mFinalizeMutex;       //! protects the queue and the counters above
+  std::condition_variable mFinalizeCV;     //! signals new slots in the queue
+  std::condition_variable mFinalizeDoneCV; //! signals the completion of a finalization
+  std::mutex mOutputMutex;                 //! held while finalizeSlot fills the output
+
   ClassDef(TimeSlotCalibration, 1);
 };
 
@@ -164,7 +197,7 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
         mSlots[0].setTFStart(mLastClosedTF);
         mSlots[0].setTFEnd(mMaxSeenTF);
         LOG(INFO) << "Finalizing slot for " << mSlots[0].getTFStart() << " <= TF <= " << mSlots[0].getTFEnd();
-        finalizeSlot(mSlots[0]);                  // will be removed after finalization
+        finalizeOrQueue(mSlots[0]);               // will be removed after finalization
         mLastClosedTF = mSlots[0].getTFEnd() + 1; // will not accept any TF below this
         mSlots.erase(mSlots.begin());
         // creating a new slot if we are not at the end of run
@@ -186,7 +219,7 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
       if ((slot->getTFEnd() + maxDelay) < tf) {
         if (hasEnoughData(*slot)) {
           LOG(DEBUG) << "Finalizing slot for " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd();
-          finalizeSlot(*slot); // will be removed after finalization
+          finalizeOrQueue(*slot); // will be removed after finalization
         } else if ((slot + 1) != mSlots.end()) {
           LOG(INFO) << "Merging underpopulated slot " << slot->getTFStart() << " <= TF <= " << slot->getTFEnd()
                     << " to slot " << (slot + 1)->getTFStart() << " <= TF <= " << (slot + 1)->getTFEnd();
@@ -206,6 +239,9 @@ void TimeSlotCalibration<Input, Container>::checkSlotsToFinalize(TFType tf, int
       }
     }
   }
+  if (tf == INFINITE_TF) { // end of run: the output must be complete when we return
+    waitForFinalization();
+  }
 }
 
 //_________________________________________________
@@ -217,11 +253,103 @@ void TimeSlotCalibration<Input, Container>::finalizeOldestSlot()
     LOG(WARNING) << "There are no slots defined";
     return;
   }
-  finalizeSlot(mSlots.front());
+  finalizeOrQueue(mSlots.front());
   mLastClosedTF = mSlots.front().getTFEnd() + 1; // do not accept any TF below this
   mSlots.erase(mSlots.begin());
 }
 
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::setFinalizeInBackground(bool v)
+{
+  if (v == mFinalizeInBackground) {
+    return;
+  }
+  if (v) {
+    mStopFinalization = false;
+    mFinalizeThread = std::thread(&TimeSlotCalibration<Input, Container>::finalizeInBackground, this);
+  } else {
+    stopFinalization();
+  }
+  mFinalizeInBackground = v;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::waitForFinalization()
+{
+  std::unique_lock<std::mutex> lock(mFinalizeMutex);
+  mFinalizeDoneCV.wait(lock, [this] { return mNSlotsInFinalization == 0; });
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+size_t TimeSlotCalibration<Input, Container>::getNSlotsInFinalization() const
+{
+  std::lock_guard<std::mutex> lock(mFinalizeMutex);
+  return mNSlotsInFinalization;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::stopFinalization()
+{
+  if (!mFinalizeThread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mFinalizeMutex);
+    mStopFinalization = true;
+  }
+  mFinalizeCV.notify_one();
+  mFinalizeThread.join(); // the queue is drained before the thread quits
+  mFinalizeInBackground = false;
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::finalizeOrQueue(Slot& slot)
+{
+  // finalize the slot in place or hand it over to the background thread; in the latter case
+  // the slot keeps its TF boundaries but loses its container, so it must be erased by the caller
+  if (!mFinalizeInBackground) {
+    finalizeSlot(slot);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mFinalizeMutex);
+    mSlotsToFinalize.emplace_back(std::move(slot));
+    mNSlotsInFinalization++;
+  }
+  mFinalizeCV.notify_one();
+}
+
+//_________________________________________________
+template <typename Input, typename Container>
+void TimeSlotCalibration<Input, Container>::finalizeInBackground()
+{
+  // slots are finalized one at a time and in the order they were closed, as finalizeSlot may depend on
+  // the previously finalized ones (e.g. moving averages)
+  std::unique_lock<std::mutex> lock(mFinalizeMutex);
+  while (true) {
+    mFinalizeCV.wait(lock, [this] { return mStopFinalization || !mSlotsToFinalize.empty(); });
+    if (mSlotsToFinalize.empty()) {
+      return;
+    }
+    Slot slot = std::move(mSlotsToFinalize.front());
+    mSlotsToFinalize.pop_front();
+    lock.unlock();
+    {
+      std::lock_guard<std::mutex> outLock(mOutputMutex);
+      LOG(DEBUG) << "Finalizing in background slot for " << slot.getTFStart() << " <= TF <= " << slot.getTFEnd();
+      finalizeSlot(slot);
+    }
+    lock.lock();
+    mNSlotsInFinalization--;
+    mFinalizeDoneCV.notify_all();
+  }
+}
+
 //________________________________________
 template <typename Input, typename Container>
 inline TFType TimeSlotCalibration<Input, Container>::tf2SlotMin(TFType tf) const
@@ -44,6 +44,7 @@ void MeanVertexCalibDevice::init(InitContext& ic)
   mCalibrator = std::make_unique<o2::calibration::MeanVertexCalibrator>(minEnt, useFit, nbX, rangeX, nbY, rangeY, nbZ, rangeZ, nSlots4SMA);
   mCalibrator->setSlotLength(slotL);
   mCalibrator->setMaxSlotsDelay(delay);
+  mCalibrator->setFinalizeInBackground(ic.options().get<bool>("finalize-in-background"));
 }
 
 //_____________________________________________________________
@@ -56,8 +57,6 @@ void MeanVertexCalibDevice::run(o2::framework::ProcessingContext& pc)
   LOG(INFO) << "Processing TF " << tfcounter << " with " << data.size() << " tracks";
   mCalibrator->process(tfcounter, data);
   sendOutput(pc.outputs());
-  const auto& infoVec = mCalibrator->getMeanVertexObjectInfoVector();
-  LOG(INFO) << "Created " << infoVec.size() << " objects for TF " << tfcounter;
 }
 
 //_____________________________________________________________
@@ -68,6 +67,7 @@ void MeanVertexCalibDevice::endOfStream(o2::framework::EndOfStreamContext& ec)
   LOG(INFO) << "Finalizing calibration";
   constexpr uint64_t INFINITE_TF = 0xffffffffffffffff;
   mCalibrator->checkSlotsToFinalize(INFINITE_TF);
+  mCalibrator->stopFinalization();
   sendOutput(ec.outputs());
 }
 
@@ -80,9 +80,14 @@ void MeanVertexCalibDevice::sendOutput(DataAllocator& output)
   // TODO in principle, this routine is generic, can be moved to Utils.h
 
   using clbUtils = o2::calibration::Utils;
+  auto lock = mCalibrator->tryLockOutput();
+  if (!lock.owns_lock()) { // a slot is being finalized in background, its objects will be sent with one of the next TFs
+    return;
+  }
   const auto& payloadVec = mCalibrator->getMeanVertexObjectVector();
   auto& infoVec = mCalibrator->getMeanVertexObjectInfoVector(); // use non-const version as we update it
   assert(payloadVec.size() == infoVec.size());
+  LOG(INFO) << "Created " << infoVec.size() << " objects";
 
   for (uint32_t i = 0; i < payloadVec.size(); i++) {
     auto& w = infoVec[i];
@@ -118,7 +123,7 @@ DataProcessorSpec getMeanVertexCalibDeviceSpec()
     outputs,
     AlgorithmSpec{adaptFromTask<device>()},
     Options{
-      {}}};
+      {"finalize-in-background", VariantType::Bool, false, {"finalize the slots on a separate thread, not blocking the processing of new TFs"}}}};
 }
 
 } // namespace framework
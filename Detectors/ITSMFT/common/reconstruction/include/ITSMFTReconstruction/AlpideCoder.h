@@ -15,6 +15,7 @@
 #include <Rtypes.h>
 #include <cstdio>
 #include <cstdint>
+#include <array>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -66,6 +67,7 @@ class AlpideCoder
 
     ClassDefNV(PixLink, 1); // TODO remove
   };
+
   //
   static constexpr uint32_t ExpectChipHeader = 0x1 << 0;
   static constexpr uint32_t ExpectChipTrailer = 0x1 << 1;
@@ -79,6 +81,14 @@ class AlpideCoder
   static constexpr int NDColInReg = NCols / NRegions / 2;
   static constexpr int HitMapSize = 7;
 
+  struct HitMapPixels { // pixels encoded in the hit map of DATALONG, relative to the reference pixel of the record
+    uint8_t nHits = 0;                  // number of hits in the map
+    uint8_t rightCol = 0;               // bit i is set if the hit i is in the right column of the double column
+    uint8_t rowOffset[HitMapSize] = {}; // row of the hit i wrt the row of the reference pixel
+  };
+  // expansion of every hit map for the 4 possible values of the 2 lowest bits of the reference pixel address
+  using HitMapLUT = std::array<std::array<HitMapPixels, 0x1 << HitMapSize>, 4>;
+
   // masks for records components
   static constexpr uint32_t MaskEncoder = 0x3c00;                 // encoder (double column) ID takes 4 bit max (0:15)
   static constexpr uint32_t MaskPixID = 0x3ff;                    // pixel ID within encoder (double column) takes 10 bit max (0:1023)
@@ -136,7 +146,76 @@ class AlpideCoder
     chipData.clear();
 
     while (buffer.next(dataC)) {
-      //
+      // hit info ? Checked first as the most frequent record: the chip and region records cannot be confused
+      // with the data, which have the highest bit set to 0
+      if ((expectInp & ExpectData) && isData(dataC)) { // region header was seen, expect data
+        // note that here we are checking on the byte rather than the short, need complete to ushort
+        dataS = dataC << 8;
+        if (!buffer.next(dataC)) {
+#ifdef ALPIDE_DECODING_STAT
+          chipData.setError(ChipStat::TruncatedRegion);
+#endif
+          return unexpectedEOF("CHIPDATA");
+        }
+        dataS |= dataC;
+        // we are decoding the pixel addres, if this is a DATALONG, we will fetch the mask later
+        uint16_t dColID = (dataS & MaskEncoder) >> 10;
+        uint16_t pixID = dataS & MaskPixID;
+
+        // convert data to usual row/pixel format
+        uint16_t row = pixID >> 1;
+        // abs id of left column in double column
+        uint16_t colD = (region * NDColInReg + dColID) << 1; // TODO consider <<4 instead of *NDColInReg?
+
+        // if we start new double column, transfer the hits accumulated in the right column buffer of prev. double column
+        if (colD != colDPrev) {
+          colDPrev++;
+          for (int ihr = 0; ihr < nRightCHits; ihr++) {
+            addHit(chipData, rightColHits[ihr], colDPrev);
+          }
+          colDPrev = colD;
+          nRightCHits = 0; // reset the buffer
+        }
+
+        bool rightC = (row & 0x1) ? !(pixID & 0x1) : (pixID & 0x1); // true for right column / lalse for left
+
+        // we want to have hits sorted in column/row, so the hits in right column of given double column
+        // are first collected in the temporary buffer
+        // real columnt id is col = colD + 1;
+        if (rightC) {
+          rightColHits[nRightCHits++] = row; // col = colD+1
+        } else {
+          addHit(chipData, row, colD); // col = colD, left column hits are added directly to the container
+        }
+
+        if ((dataS & (~MaskDColID)) == DATALONG) { // multiple hits ?
+          uint8_t hitsPattern = 0;
+          if (!buffer.next(hitsPattern)) {
+#ifdef ALPIDE_DECODING_STAT
+            chipData.setError(ChipStat::TruncatedLondData);
+#endif
+            return unexpectedEOF("CHIP_DATA_LONG:Pattern");
+          }
+#ifdef ALPIDE_DECODING_STAT
+          if (hitsPattern & (~MaskHitMap)) {
+            chipData.setError(ChipStat::WrongDataLongPattern);
+          }
+#endif
+          // the positions of the hits of the map are tabulated, no need to test the bits one by one
+          const auto& hitMap = mHitMapLUT[pixID & 0x3][hitsPattern & MaskHitMap];
+          for (int ih = 0; ih < hitMap.nHits; ih++) {
+            uint16_t rowE = row + hitMap.rowOffset[ih];
+            if (hitMap.rightCol & (0x1 << ih)) { // same as above
+              rightColHits[nRightCHits++] = rowE;
+            } else {
+              addHit(chipData, rowE, colD); // left column hits are added directly to the container
+            }
+          }
+        }
+        expectInp = ExpectChipTrailer | ExpectData | ExpectRegion;
+        continue; // end of DATA(SHORT or LONG) processing
+      }
+
       // ---------- chip info ?
       uint8_t dataCM = dataC & (~MaskChipID);
       //
@@ -202,82 +281,11 @@ class AlpideCoder
         break;
       }
 
-      // hit info ?
-      if ((expectInp & ExpectData)) {
-        if (isData(dataC)) { // region header was seen, expect data
-                             // note that here we are checking on the byte rather than the short, need complete to ushort
-          dataS = dataC << 8;
-          if (!buffer.next(dataC)) {
-#ifdef ALPIDE_DECODING_STAT
-            chipData.setError(ChipStat::TruncatedRegion);
-#endif
-            return unexpectedEOF("CHIPDATA");
-          }
-          dataS |= dataC;
-          // we are decoding the pixel addres, if this is a DATALONG, we will fetch the mask later
-          uint16_t dColID = (dataS & MaskEncoder) >> 10;
-          uint16_t pixID = dataS & MaskPixID;
-
-          // convert data to usual row/pixel format
-          uint16_t row = pixID >> 1;
-          // abs id of left column in double column
-          uint16_t colD = (region * NDColInReg + dColID) << 1; // TODO consider <<4 instead of *NDColInReg?
-
-          // if we start new double column, transfer the hits accumulated in the right column buffer of prev. double column
-          if (colD != colDPrev) {
-            colDPrev++;
-            for (int ihr = 0; ihr < nRightCHits; ihr++) {
-              addHit(chipData, rightColHits[ihr], colDPrev);
-            }
-            colDPrev = colD;
-            nRightCHits = 0; // reset the buffer
-          }
-
-          bool rightC = (row & 0x1) ? !(pixID & 0x1) : (pixID & 0x1); // true for right column / lalse for left
-
-          // we want to have hits sorted in column/row, so the hits in right column of given double column
-          // are first collected in the temporary buffer
-          // real columnt id is col = colD + 1;
-          if (rightC) {
-            rightColHits[nRightCHits++] = row; // col = colD+1
-          } else {
-            addHit(chipData, row, colD); // col = colD, left column hits are added directly to the container
-          }
-
-          if ((dataS & (~MaskDColID)) == DATALONG) { // multiple hits ?
-            uint8_t hitsPattern = 0;
-            if (!buffer.next(hitsPattern)) {
+      if (expectInp & ExpectData) { // neither data nor a record allowed after the data was found
 #ifdef ALPIDE_DECODING_STAT
-              chipData.setError(ChipStat::TruncatedLondData);
+        chipData.setError(ChipStat::NoDataFound);
 #endif
-              return unexpectedEOF("CHIP_DATA_LONG:Pattern");
-            }
-#ifdef ALPIDE_DECODING_STAT
-            if (hitsPattern & (~MaskHitMap)) {
-              chipData.setError(ChipStat::WrongDataLongPattern);
-            }
-#endif
-            for (int ip = 0; ip < HitMapSize; ip++) {
-              if (hitsPattern & (0x1 << ip)) {
-                uint16_t addr = pixID + ip + 1, rowE = addr >> 1;
-                rightC = ((rowE & 0x1) ? !(addr & 0x1) : (addr & 0x1)); // true for right column / lalse for left
-                // the real columnt is int colE = colD + rightC;
-                if (rightC) { // same as above
-                  rightColHits[nRightCHits++] = rowE;
-                } else {
-                  addHit(chipData, rowE, colD + rightC); // left column hits are added directly to the container
-                }
-              }
-            }
-          }
-        } else {
-#ifdef ALPIDE_DECODING_STAT
-          chipData.setError(ChipStat::NoDataFound);
-#endif
-          return unexpectedEOF(fmt::format("Expected DataShort or DataLong mask, got {:x}", dataS));
-        }
-        expectInp = ExpectChipTrailer | ExpectData | ExpectRegion;
-        continue; // end of DATA(SHORT or LONG) processing
+        return unexpectedEOF(fmt::format("Expected DataShort or DataLong mask, got {:x}", dataS));
       }
 
       if (dataC == BUSYON) {
@@ -414,6 +422,8 @@ class AlpideCoder
 
   void resetMap();
 
+  static HitMapLUT makeHitMapLUT();
+
   ///< error message on unexpected EOF
   static int unexpectedEOF(const std::string& message)
   {
@@ -425,6 +435,7 @@ class AlpideCoder
   //
 
   static const NoiseMap* mNoisyPixels;
+  static const HitMapLUT mHitMapLUT;
 
   // cluster map used for the ENCODING only
   std::vector<int> mFirstInRow;     //! entry of 1st pixel of each non-empty row in the mPix2Encode
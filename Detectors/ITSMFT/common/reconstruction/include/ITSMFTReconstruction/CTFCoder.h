@@ -22,6 +22,7 @@
 #include "DataFormatsITSMFT/CTF.h"
 #include "DataFormatsITSMFT/ROFRecord.h"
 #include "DataFormatsITSMFT/CompCluster.h"
+#include "ITSMFTReconstruction/LookUp.h"
 #include "DetectorsCommonDataFormats/DetID.h"
 #include "DetectorsBase/CTFCoderBase.h"
 #include "rANS/rans.h"
@@ -49,9 +50,15 @@ class CTFCoder : public o2::ctf::CTFCoderBase
 
   void createCoders(const std::string& dictPath, o2::ctf::CTFCoderBase::OpType op);
 
+  /// load the dictionary of cluster topologies, used at encoding to give the clusters found w/o dictionary
+  /// the ID of their common topology instead of storing their pattern; it must be the one of the clusterer, if any
+  void loadPatternDictionary(const std::string& fileName) { mPattIdConverter.loadDictionary(fileName); }
+
  private:
   /// compres compact clusters to CompressedClusters
   void compress(CompressedClusters& cc, const gsl::span<const ROFRecord>& rofRecVec, const gsl::span<const CompClusterExt>& cclusVec, const gsl::span<const unsigned char>& pattVec);
+  /// store the explicit patterns of the clusters of a ROF, giving the common topologies their dictionary ID
+  void compressPatterns(CompressedClusters& cc, int firstCl, int lastCl, const unsigned char*& pattPtr, const unsigned char* pattEnd, std::vector<int>& pattIDs);
   size_t estimateCompressedSize(const CompressedClusters& cc);
 
   /// decompress CompressedClusters to compact clusters
@@ -61,6 +68,8 @@ class CTFCoder : public o2::ctf::CTFCoderBase
   void appendToTree(TTree& tree, CTF& ec);
   void readFromTree(TTree& tree, int entry, std::vector<ROFRecord>& rofRecVec, std::vector<CompClusterExt>& cclusVec, std::vector<unsigned char>& pattVec);
 
+  LookUp mPattIdConverter; //! Convert the explicit patterns to the corresponding entry in the dictionary
+
  protected:
   ClassDefNV(CTFCoder, 1);
 };
@@ -106,6 +106,10 @@ class Clusterer
     PatternCont patterns;
     MCTruth labels;
     std::vector<ThreadStat> stats; // statistics for each thread results, used at merging
+    /// patterns of the clusters of the chips being processed, their IDs in the dictionary are found at once
+    PatternCont pendingPatterns;   //! row span, column span and pattern bytes of each cluster
+    std::vector<bool> pendingHuge; //! flags of the pieces of split huge clusters, which get no pattern ID
+    std::vector<int> pendingIDs;   //! IDs found for the pending patterns
     ///
     ///< reset column buffer, for the performance reasons we use memset
     void resetColumn(int* buff) { std::memset(buff, -1, sizeof(int) * SegmentationAlpide::NRows); }
@@ -137,6 +141,8 @@ class Clusterer
                        uint16_t chipID,
                        CompClusCont* compClusPtr, PatternCont* patternsPtr,
                        MCTruth* labelsClusPtr, int nlab, bool isHuge = false);
+    void addPendingPattern(const unsigned char* patt, uint16_t rowSpan, uint16_t colSpan, bool isHuge);
+    void resolvePatternIDs(CompClusCont* compClusPtr, PatternCont* patternsPtr);
 
     void fetchMCLabels(int digID, const ConstMCTruth* labelsDig, int& nfilled);
     void initChip(const ChipPixelData* curChipData, uint32_t first);
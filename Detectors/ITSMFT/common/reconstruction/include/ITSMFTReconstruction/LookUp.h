@@ -17,12 +17,15 @@
 /// Short LookUp descritpion
 ///
 /// This class is for the association of the cluster topology with the corresponding
-/// entry in the dictionary
+/// entry in the dictionary. The hashes of the common topologies are stored, when the
+/// dictionary is loaded, in a flat open addressing table, which is only read afterwards,
+/// so that the lookup can be done concurrently by several threads.
 ///
 
 #ifndef ALICEO2_ITSMFT_LOOKUP_H
 #define ALICEO2_ITSMFT_LOOKUP_H
 #include <array>
+#include <vector>
 #include "DataFormatsITSMFT/ClusterTopology.h"
 #include "DataFormatsITSMFT/TopologyDictionary.h"
 
@@ -36,17 +39,33 @@ class LookUp
   LookUp();
   LookUp(std::string fileName);
   static int groupFinder(int nRow, int nCol);
-  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]);
-  int getTopologiesOverThreshold() { return mTopologiesOverThreshold; }
+  int findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const;
+  /// Find the IDs of consecutive patterns stored in the format used for the clusters w/o dictionary entry
+  /// (row span, column span and pattern bytes), e.g. all the patterns of a ROF
+  void findGroupIDs(const unsigned char* pattBegin, const unsigned char* pattEnd, std::vector<int>& ids) const;
+  int getTopologiesOverThreshold() const { return mTopologiesOverThreshold; }
   void loadDictionary(std::string fileName);
   bool isGroup(int id) const;
   int size() const { return mDictionary.getSize(); }
 
  private:
+  struct CommonTopology {
+    unsigned long hash = 0; ///< complete hash of the topology
+    int id = -1;            ///< its position in the dictionary, -1 for the empty bin
+  };
+
+  void buildLookUpTables();
+  int findCommonID(unsigned long hash) const;
+  int findRareGroupID(int nRow, int nCol) const;
+  size_t getBin(unsigned long hash) const { return ((hash ^ (hash >> 29)) * 0x9e3779b97f4a7c15UL >> 32) & mCommonMask; }
+
   TopologyDictionary mDictionary;
   int mTopologiesOverThreshold;
+  std::vector<CommonTopology> mCommonTable;                                   //! open addressing table of the common topologies
+  size_t mCommonMask = 0;                                                     //! mCommonTable size - 1
+  std::array<int, TopologyDictionary::NumberOfRareGroups> mRareGroupIDs = {}; //! dictionary IDs of the groups of rare topologies
 
-  ClassDefNV(LookUp, 3);
+  ClassDefNV(LookUp, 4);
 };
 } // namespace itsmft
 } // namespace o2
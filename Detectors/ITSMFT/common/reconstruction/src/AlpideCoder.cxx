@@ -17,6 +17,33 @@
 using namespace o2::itsmft;
 
 const NoiseMap* AlpideCoder::mNoisyPixels = nullptr;
+const AlpideCoder::HitMapLUT AlpideCoder::mHitMapLUT = AlpideCoder::makeHitMapLUT();
+
+//_____________________________________
+AlpideCoder::HitMapLUT AlpideCoder::makeHitMapLUT()
+{
+  // tabulate the hits of every DATALONG hit map: the hit ip is at the address pixID + ip + 1 in the double column,
+  // its row and column (left or right, since the rows are numbered alternatively left to right and right to left)
+  // depend only on the 2 lowest bits of the pixID
+  HitMapLUT lut;
+  for (int low = 0; low < 4; low++) {
+    for (int map = 0; map < (0x1 << HitMapSize); map++) {
+      auto& hm = lut[low][map];
+      for (int ip = 0; ip < HitMapSize; ip++) {
+        if (map & (0x1 << ip)) {
+          int addr = low + ip + 1, rowE = addr >> 1;
+          bool rightC = (rowE & 0x1) ? !(addr & 0x1) : (addr & 0x1);
+          hm.rowOffset[hm.nHits] = rowE - (low >> 1);
+          if (rightC) {
+            hm.rightCol |= 0x1 << hm.nHits;
+          }
+          hm.nHits++;
+        }
+      }
+    }
+  }
+  return lut;
+}
 
 //_____________________________________
 void AlpideCoder::print() const
@@ -66,7 +66,13 @@ void CTFCoder::compress(CompressedClusters& cc,
   cc.chipInc.reserve(1000); // this is the version with chipInc stored once per new chip
   cc.chipMul.reserve(1000); // this is the version with chipInc stored once per new chip
   cc.pattID.resize(cc.header.nClusters);
-  cc.pattMap.resize(cc.header.nPatternBytes);
+  if (mPattIdConverter.size()) { // only the patterns w/o dictionary ID are kept
+    cc.pattMap.reserve(cc.header.nPatternBytes);
+  } else {
+    cc.pattMap.resize(cc.header.nPatternBytes);
+  }
+  const unsigned char* pattPtr = pattVec.data();
+  std::vector<int> pattIDs;
 
   uint16_t prevBC = cc.header.firstBC;
   uint32_t prevOrbit = cc.header.firstOrbit;
@@ -114,10 +120,50 @@ void CTFCoder::compress(CompressedClusters& cc,
         prevChip = cl.getChipID();
       }
     }
+    if (mPattIdConverter.size()) {
+      compressPatterns(cc, rofRec.getFirstEntry(), iclMax, pattPtr, pattVec.data() + pattVec.size(), pattIDs);
+    }
   }
   cc.header.nChips = cc.chipMul.size();
-  // store explicit patters as they are
-  memcpy(cc.pattMap.data(), pattVec.data(), cc.header.nPatternBytes); // RSTODO: do we need this?
+  if (mPattIdConverter.size()) {
+    cc.header.nPatternBytes = cc.pattMap.size();
+  } else { // store explicit patters as they are
+    memcpy(cc.pattMap.data(), pattVec.data(), cc.header.nPatternBytes); // RSTODO: do we need this?
+  }
+}
+
+///________________________________
+void CTFCoder::compressPatterns(CompressedClusters& cc, int firstCl, int lastCl, const unsigned char*& pattPtr, const unsigned char* pattEnd, std::vector<int>& pattIDs)
+{
+  // the explicit patterns of the clusters [firstCl, lastCl) of a ROF are looked up in the dictionary in one go
+  auto isExplicit = [this](int id) { return id == CompCluster::InvalidPatternID || mPattIdConverter.isGroup(id); };
+  auto nextPattern = [](const unsigned char* patt) { return patt + 2 + (patt[0] * patt[1] + 7) / 8; };
+  auto pattBeg = pattPtr;
+  for (int icl = firstCl; icl < lastCl; icl++) {
+    if (isExplicit(cc.pattID[icl])) {
+      if (pattPtr >= pattEnd) {
+        LOG(ERROR) << "patterns of " << mDet.getName() << " exhausted at cluster " << icl;
+        throw std::runtime_error("fewer explicit patterns than clusters w/o pattern ID");
+      }
+      pattPtr = nextPattern(pattPtr);
+    }
+  }
+  mPattIdConverter.findGroupIDs(pattBeg, pattPtr, pattIDs);
+  auto patt = pattBeg;
+  auto id = pattIDs.begin();
+  for (int icl = firstCl; icl < lastCl; icl++) {
+    if (!isExplicit(cc.pattID[icl])) {
+      continue;
+    }
+    auto next = nextPattern(patt);
+    if (cc.pattID[icl] == CompCluster::InvalidPatternID && !isExplicit(*id)) {
+      cc.pattID[icl] = *id; // a common topology, whose pattern is in the dictionary
+    } else {
+      cc.pattMap.insert(cc.pattMap.end(), patt, next);
+    }
+    patt = next;
+    id++;
+  }
 }
 
 ///________________________________
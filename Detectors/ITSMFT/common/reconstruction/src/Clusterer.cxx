@@ -12,6 +12,7 @@
 /// \file Clusterer.cxx
 /// \brief Implementation of the ITS cluster finder
 #include <algorithm>
+#include <cstring>
 #include <TTree.h>
 #include "Framework/Logger.h"
 #include "ITSMFTBase/GeometryTGeo.h"
@@ -113,6 +114,7 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
       if (patterns) {
         patterns->reserve(nPattTot);
       }
+      std::vector<MCTruth::MergeRange> labelRanges;
       while (chid < nFired) {
         for (int ith = 0; ith < nThreads; ith++) {
           if (thrStatIdx[ith] >= mThreads[ith]->stats.size()) {
@@ -130,11 +132,21 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
               patterns->insert(patterns->end(), ptbeg, ptbeg + stat.nPatt);
             }
             if (labelsCl) {
-              labelsCl->mergeAtBack(mThreads[ith]->labels, stat.firstClus, stat.nClus);
+              labelRanges.push_back(MCTruth::MergeRange{&mThreads[ith]->labels, stat.firstClus, stat.nClus});
             }
           }
         }
       }
+      if (labelsCl) { // the labels of all chips are copied at once
+        labelsCl->mergeAtBack(gsl::span<const MCTruth::MergeRange>(labelRanges), [nThreads](size_t nRanges, auto&& copyRange) {
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+          for (size_t ir = 0; ir < nRanges; ir++) {
+            copyRange(ir);
+          }
+        });
+      }
       for (int ith = 0; ith < nThreads; ith++) {
         mThreads[ith]->patterns.clear();
         mThreads[ith]->compClusters.clear();
@@ -192,6 +204,7 @@ void Clusterer::ClustererThread::process(uint16_t chip, uint16_t nChips, CompClu
       parent->mChipsOld[chipID].swap(*curChipData);
     }
   }
+  resolvePatternIDs(compClusPtr, patternsPtr);
   auto& currStat = stats.back();
   currStat.nChips += nChips;
   currStat.nClus = compClusPtr->size() - currStat.firstClus;
@@ -302,32 +315,67 @@ void Clusterer::ClustererThread::streamCluster(const std::vector<PixelData>& pix
   }
 
   // add to compact clusters, which must be always filled
-  unsigned char patt[ClusterPattern::MaxPatternBytes] = {0}; // RSTODO FIX pattern filling
+  unsigned char patt[ClusterPattern::MaxPatternBytes];
+  memset(patt, 0, (rowSpanW * colSpanW + 7) / 8); // clear only the bytes used by the pattern
   for (const auto& pix : pixbuf) {
     unsigned short ir = pix.getRowDirect() - rowMin, ic = pix.getCol() - colMin;
     int nbits = ir * colSpanW + ic;
     patt[nbits >> 3] |= (0x1 << (7 - (nbits % 8)));
   }
-  uint16_t pattID = (isHuge || parent->mPattIdConverter.size() == 0) ? CompCluster::InvalidPatternID : parent->mPattIdConverter.findGroupID(rowSpanW, colSpanW, patt);
-  if (pattID == CompCluster::InvalidPatternID || parent->mPattIdConverter.isGroup(pattID)) {
-    if (pattID != CompCluster::InvalidPatternID) {
-      //For groupped topologies, the reference pixel is the COG pixel
-      float xCOG = 0., zCOG = 0.;
-      ClusterPattern::getCOG(rowSpanW, colSpanW, patt, xCOG, zCOG);
-      rowMin += round(xCOG);
-      colMin += round(zCOG);
+  if (parent->mPattIdConverter.size()) { // the pattern ID is set in resolvePatternIDs, once all chips are processed
+    addPendingPattern(patt, rowSpanW, colSpanW, isHuge);
+  } else if (patternsPtr) {
+    patternsPtr->emplace_back((unsigned char)rowSpanW);
+    patternsPtr->emplace_back((unsigned char)colSpanW);
+    int nBytes = rowSpanW * colSpanW / 8;
+    if (((rowSpanW * colSpanW) % 8) != 0) {
+      nBytes++;
     }
-    if (patternsPtr) {
-      patternsPtr->emplace_back((unsigned char)rowSpanW);
-      patternsPtr->emplace_back((unsigned char)colSpanW);
-      int nBytes = rowSpanW * colSpanW / 8;
-      if (((rowSpanW * colSpanW) % 8) != 0) {
-        nBytes++;
+    patternsPtr->insert(patternsPtr->end(), std::begin(patt), std::begin(patt) + nBytes);
+  }
+  compClusPtr->emplace_back(rowMin, colMin, CompCluster::InvalidPatternID, chipID);
+}
+
+//__________________________________________________
+void Clusterer::ClustererThread::addPendingPattern(const unsigned char* patt, uint16_t rowSpan, uint16_t colSpan, bool isHuge)
+{
+  pendingPatterns.emplace_back((unsigned char)rowSpan);
+  pendingPatterns.emplace_back((unsigned char)colSpan);
+  pendingPatterns.insert(pendingPatterns.end(), patt, patt + (rowSpan * colSpan + 7) / 8);
+  pendingHuge.push_back(isHuge);
+}
+
+//__________________________________________________
+void Clusterer::ClustererThread::resolvePatternIDs(CompClusCont* compClusPtr, PatternCont* patternsPtr)
+{
+  // the pending patterns belong to the last clusters, all of them are looked up in the dictionary in one go
+  if (pendingHuge.empty()) {
+    return;
+  }
+  parent->mPattIdConverter.findGroupIDs(pendingPatterns.data(), pendingPatterns.data() + pendingPatterns.size(), pendingIDs);
+  auto clus = compClusPtr->end() - pendingHuge.size();
+  const unsigned char* patt = pendingPatterns.data();
+  for (size_t i = 0; i < pendingHuge.size(); i++, clus++) {
+    uint16_t rowSpan = patt[0], colSpan = patt[1];
+    int nBytes = (rowSpan * colSpan + 7) / 8;
+    uint16_t pattID = pendingHuge[i] ? CompCluster::InvalidPatternID : pendingIDs[i];
+    if (pattID == CompCluster::InvalidPatternID || parent->mPattIdConverter.isGroup(pattID)) {
+      if (pattID != CompCluster::InvalidPatternID) {
+        //For groupped topologies, the reference pixel is the COG pixel
+        float xCOG = 0., zCOG = 0.;
+        ClusterPattern::getCOG(rowSpan, colSpan, patt + 2, xCOG, zCOG);
+        clus->setRow(clus->getRow() + round(xCOG));
+        clus->setCol(clus->getCol() + round(zCOG));
+      }
+      if (patternsPtr) {
+        patternsPtr->insert(patternsPtr->end(), patt, patt + 2 + nBytes);
       }
-      patternsPtr->insert(patternsPtr->end(), std::begin(patt), std::begin(patt) + nBytes);
     }
+    clus->setPatternID(pattID);
+    patt += 2 + nBytes;
   }
-  compClusPtr->emplace_back(rowMin, colMin, pattID, chipID);
+  pendingPatterns.clear();
+  pendingHuge.clear();
 }
 
 //__________________________________________________
@@ -349,13 +397,14 @@ void Clusterer::ClustererThread::finishChipSingleHitFast(uint32_t hit, ChipPixel
 
   // add to compact clusters, which must be always filled
   unsigned char patt[ClusterPattern::MaxPatternBytes]{0x1 << (7 - (0 % 8))}; // unrolled 1 hit version of full loop in finishChip
-  uint16_t pattID = (parent->mPattIdConverter.size() == 0) ? CompCluster::InvalidPatternID : parent->mPattIdConverter.findGroupID(1, 1, patt);
-  if ((pattID == CompCluster::InvalidPatternID || parent->mPattIdConverter.isGroup(pattID)) && patternsPtr) {
+  if (parent->mPattIdConverter.size()) { // the pattern ID is set in resolvePatternIDs, once all chips are processed
+    addPendingPattern(patt, 1, 1, false);
+  } else if (patternsPtr) {
     patternsPtr->emplace_back(1); // rowspan
     patternsPtr->emplace_back(1); // colspan
     patternsPtr->insert(patternsPtr->end(), std::begin(patt), std::begin(patt) + 1);
   }
-  compClusPtr->emplace_back(row, col, pattID, curChipData->getChipID());
+  compClusPtr->emplace_back(row, col, CompCluster::InvalidPatternID, curChipData->getChipID());
 }
 
 //__________________________________________________
@@ -15,6 +15,7 @@
 /// \author Luca Barioglio, University and INFN of Torino
 
 #include "ITSMFTReconstruction/LookUp.h"
+#include "DataFormatsITSMFT/CompCluster.h"
 
 ClassImp(o2::itsmft::LookUp);
 
@@ -25,7 +26,10 @@ namespace o2
 namespace itsmft
 {
 
-LookUp::LookUp() : mDictionary{}, mTopologiesOverThreshold{0} {}
+LookUp::LookUp() : mDictionary{}, mTopologiesOverThreshold{0}
+{
+  mRareGroupIDs.fill(CompCluster::InvalidPatternID);
+}
 
 LookUp::LookUp(std::string fileName)
 {
@@ -36,6 +40,49 @@ void LookUp::loadDictionary(std::string fileName)
 {
   mDictionary.readBinaryFile(fileName);
   mTopologiesOverThreshold = mDictionary.mCommonMap.size();
+  buildLookUpTables();
+}
+
+void LookUp::buildLookUpTables()
+{
+  // common topologies: power of 2 table with load factor below 1/2
+  size_t size = 16;
+  while (size < 2 * mDictionary.mCommonMap.size()) {
+    size <<= 1;
+  }
+  mCommonMask = size - 1;
+  mCommonTable.assign(size, CommonTopology{});
+  for (const auto& entry : mDictionary.mCommonMap) {
+    auto bin = getBin(entry.first);
+    while (mCommonTable[bin].id >= 0) {
+      bin = (bin + 1) & mCommonMask;
+    }
+    mCommonTable[bin].hash = entry.first;
+    mCommonTable[bin].id = entry.second;
+  }
+  // groups of rare topologies, indexed by the group number
+  mRareGroupIDs.fill(CompCluster::InvalidPatternID);
+  for (const auto& entry : mDictionary.mGroupMap) {
+    if (entry.first >= 0 && entry.first < TopologyDictionary::NumberOfRareGroups) {
+      mRareGroupIDs[entry.first] = entry.second;
+    }
+  }
+}
+
+int LookUp::findCommonID(unsigned long hash) const
+{
+  for (auto bin = getBin(hash);; bin = (bin + 1) & mCommonMask) {
+    const auto& entry = mCommonTable[bin];
+    if (entry.id < 0 || entry.hash == hash) {
+      return entry.id;
+    }
+  }
+}
+
+int LookUp::findRareGroupID(int nRow, int nCol) const
+{
+  int index = groupFinder(nRow, nCol);
+  return (index >= 0 && index < TopologyDictionary::NumberOfRareGroups) ? mRareGroupIDs[index] : CompCluster::InvalidPatternID;
 }
 
 int LookUp::groupFinder(int nRow, int nCol)
@@ -57,7 +104,7 @@ int LookUp::groupFinder(int nRow, int nCol)
   return grNum;
 }
 
-int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes])
+int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPattern::MaxPatternBytes]) const
 {
   int nBits = nRow * nCol;
   // Small topology
@@ -66,18 +113,26 @@ int LookUp::findGroupID(int nRow, int nCol, const unsigned char patt[ClusterPatt
     if (ID >= 0) {
       return ID;
     } else { //small rare topology (inside groups)
-      int index = groupFinder(nRow, nCol);
-      return mDictionary.mGroupMap[index];
+      return findRareGroupID(nRow, nCol);
     }
   }
   // Big topology
   unsigned long hash = ClusterTopology::getCompleteHash(nRow, nCol, patt);
-  auto ret = mDictionary.mCommonMap.find(hash);
-  if (ret != mDictionary.mCommonMap.end()) {
-    return ret->second;
+  int ID = mCommonTable.empty() ? -1 : findCommonID(hash);
+  if (ID >= 0) {
+    return ID;
   } else { // Big rare topology (inside groups)
-    int index = groupFinder(nRow, nCol);
-    return mDictionary.mGroupMap[index];
+    return findRareGroupID(nRow, nCol);
+  }
+}
+
+void LookUp::findGroupIDs(const unsigned char* pattBegin, const unsigned char* pattEnd, std::vector<int>& ids) const
+{
+  ids.clear();
+  for (auto patt = pattBegin; patt < pattEnd;) {
+    int nRow = *patt++, nCol = *patt++;
+    ids.push_back(findGroupID(nRow, nCol, patt));
+    patt += (nRow * nCol + 7) / 8;
   }
 }
 
@@ -0,0 +1,75 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "benchmark/benchmark.h"
+#include "ITSMFTReconstruction/AlpideCoder.h"
+#include "ITSMFTBase/SegmentationAlpide.h"
+#include <random>
+#include <set>
+#include <utility>
+
+using o2::itsmft::AlpideCoder;
+using o2::itsmft::ChipPixelData;
+using o2::itsmft::PayLoadCont;
+using o2::itsmft::SegmentationAlpide;
+
+// encodeChips fills the buffer with the ALPIDE payload of nChips chips, each having a few
+// clusters with nPixPerCluster fired pixels on average, so that both DATASHORT and DATALONG
+// records with sparse hitmaps are produced
+size_t encodeChips(PayLoadCont& buffer, int nChips, int nPixPerCluster)
+{
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int> rowDist(0, SegmentationAlpide::NRows - 1);
+  std::uniform_int_distribution<int> colDist(0, SegmentationAlpide::NCols - 1);
+  std::uniform_int_distribution<int> dDist(0, 3);
+  AlpideCoder coder;
+  ChipPixelData chipData;
+  size_t nPix = 0;
+  for (int ic = 0; ic < nChips; ic++) {
+    std::set<std::pair<int, int>> pixels; // ordered in row then column, as the encoder expects
+    for (int icl = 0; icl < 5; icl++) {
+      int row = rowDist(gen), col = colDist(gen);
+      for (int ip = 0; ip < nPixPerCluster; ip++) {
+        pixels.emplace(std::min(row + dDist(gen), SegmentationAlpide::NRows - 1), std::min(col + dDist(gen), SegmentationAlpide::NCols - 1));
+      }
+    }
+    auto& data = chipData.getData();
+    data.clear();
+    for (const auto& pix : pixels) {
+      data.emplace_back(pix.first, pix.second);
+    }
+    nPix += data.size();
+    buffer.ensureFreeCapacity(8 * data.size() + 16); // encodeChip does not check the capacity
+    coder.encodeChip(buffer, chipData, ic % 9, 0);
+  }
+  return nPix;
+}
+
+static void benchDecodeChip(benchmark::State& state)
+{
+  PayLoadCont buffer;
+  auto nPix = encodeChips(buffer, 1000, state.range(0));
+  ChipPixelData chipData;
+  for (auto _ : state) {
+    buffer.rewind();
+    size_t nDecoded = 0;
+    while (AlpideCoder::decodeChip(chipData, buffer, [](uint16_t chipInMod) { return chipInMod; }) > 0) {
+      nDecoded += chipData.getData().size();
+    }
+    benchmark::DoNotOptimize(nDecoded);
+  }
+  state.SetItemsProcessed(state.iterations() * nPix);
+  state.SetBytesProcessed(state.iterations() * buffer.getSize());
+}
+
+BENCHMARK(benchDecodeChip)->Arg(2)->Arg(8)->Arg(32);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,126 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test ITSMFT LookUp
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include "ITSMFTReconstruction/BuildTopologyDictionary.h"
+#include "ITSMFTReconstruction/LookUp.h"
+#include "DataFormatsITSMFT/CompCluster.h"
+#include <cstdio>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace o2::itsmft
+{
+
+/// random topologies, small ones (up to 8 pixels in the bounding box) as well as big ones
+std::vector<ClusterTopology> generateTopologies(int n)
+{
+  std::mt19937 gen(1234);
+  std::uniform_int_distribution<int> bit(0, 1);
+  std::vector<ClusterTopology> topologies;
+  for (int i = 0; i < n; i++) {
+    const int maxSpan = (i % 3 == 0) ? 3 : 20;
+    const int nRow = std::uniform_int_distribution<int>(1, maxSpan)(gen);
+    const int nCol = std::uniform_int_distribution<int>(1, maxSpan)(gen);
+    unsigned char patt[ClusterPattern::MaxPatternBytes] = {0};
+    const int nBits = nRow * nCol;
+    for (int iBit = 0; iBit < nBits; iBit++) {
+      if (iBit == 0 || iBit == nBits - 1 || bit(gen)) {
+        patt[iBit / 8] |= 1 << (7 - iBit % 8);
+      }
+    }
+    topologies.emplace_back(nRow, nCol, patt);
+  }
+  return topologies;
+}
+
+/// \brief The flat lookup tables give, for every topology used to build a dictionary, the same ID as the maps of the dictionary:
+/// the entry of the common topologies or the entry of the group of rare topologies with the same row and column classes
+BOOST_AUTO_TEST_CASE(LookUp_sameIDsAsDictionary)
+{
+  const std::string fileName = "testLookUpDictionary.bin";
+  const auto topologies = generateTopologies(5000);
+  BuildTopologyDictionary builder;
+  for (size_t i = 0; i < topologies.size(); i++) {
+    for (size_t j = 0; j < 1 + 2000 / (i + 1); j++) { // falling frequency, so that a part of the topologies are rare
+      builder.accountTopology(topologies[i]);
+    }
+  }
+  builder.setThreshold(1e-4);
+  builder.groupRareTopologies();
+  builder.printDictionaryBinary(fileName);
+
+  TopologyDictionary dictionary(fileName);
+  LookUp lookUp(fileName);
+  std::remove(fileName.c_str());
+  BOOST_REQUIRE_EQUAL(lookUp.size(), dictionary.getSize());
+
+  // the maps of the dictionary, as stored in its entries
+  std::unordered_map<unsigned long, int> commonMap;
+  std::map<int, int> groupMap;
+  for (int id = 0; id < dictionary.getSize(); id++) {
+    if (dictionary.isGroup(id)) {
+      groupMap[dictionary.getHash(id) >> 32] = id;
+    } else {
+      commonMap[dictionary.getHash(id)] = id;
+    }
+  }
+  BOOST_REQUIRE_EQUAL(lookUp.getTopologiesOverThreshold(), (int)commonMap.size());
+  BOOST_REQUIRE(commonMap.size() > 100 && commonMap.size() < topologies.size()); // both common and rare topologies are tested
+
+  int nCommon = 0, nRare = 0;
+  for (const auto& topology : topologies) {
+    const auto pattern = topology.getPattern();
+    const int nRow = topology.getRowSpan(), nCol = topology.getColumnSpan();
+    const auto common = commonMap.find(topology.getHash());
+    int expected = CompCluster::InvalidPatternID;
+    if (common != commonMap.end()) {
+      expected = common->second;
+      nCommon++;
+    } else {
+      const auto group = groupMap.find(LookUp::groupFinder(nRow, nCol));
+      if (group != groupMap.end()) {
+        expected = group->second;
+      }
+      nRare++;
+    }
+    BOOST_CHECK_EQUAL(lookUp.findGroupID(nRow, nCol, &pattern[2]), expected);
+  }
+  BOOST_CHECK(nCommon > 0 && nRare > 0);
+
+  // the patterns streamed as for the clusters w/o dictionary entry are resolved at once to the same IDs
+  std::vector<unsigned char> stream;
+  for (const auto& topology : topologies) {
+    const auto pattern = topology.getPattern();
+    stream.insert(stream.end(), pattern.begin(), pattern.begin() + 2 + (pattern[0] * pattern[1] + 7) / 8);
+  }
+  std::vector<int> ids;
+  lookUp.findGroupIDs(stream.data(), stream.data() + stream.size(), ids);
+  BOOST_REQUIRE_EQUAL(ids.size(), topologies.size());
+  for (size_t i = 0; i < topologies.size(); i++) {
+    const auto pattern = topologies[i].getPattern();
+    BOOST_CHECK_EQUAL(ids[i], lookUp.findGroupID(pattern[0], pattern[1], &pattern[2]));
+  }
+
+  // the patterns stored in the dictionary for the common topologies give back their IDs
+  for (const auto& [hash, id] : commonMap) {
+    const auto pattern = dictionary.getPattern(id).getPattern();
+    BOOST_CHECK_EQUAL(lookUp.findGroupID(pattern[0], pattern[1], &pattern[2]), id);
+  }
+}
+
+} // namespace o2::itsmft
@@ -20,7 +20,6 @@
 #include "SimulationDataFormat/MCCompLabel.h"
 #include "ITSMFTBase/SegmentationAlpide.h"
 #include "ITSMFTSimulation/PreDigit.h"
-#include <map>
 #include <vector>
 
 namespace o2
@@ -31,18 +30,36 @@ class DigiParams;
 
 /// @class ChipDigitsContainer
 /// @brief Container for similated points connected to a given chip
+///
+/// The fired pixels are stored per readout frame in flat vectors, the frames being kept in a
+/// sliding window starting from the oldest frame not yet sent to the output. Within a frame
+/// the pixel lookup is done via an open addressing hash table of indices in the vector, the
+/// ordering by column and row being established only once, when the frame is extracted.
 
 class ChipDigitsContainer
 {
  public:
+  /// Pixels fired in a single readout frame
+  struct ROFrameDigits {
+    std::vector<o2::itsmft::PreDigit> digits;        ///< fired pixels, in the order of their registration
+    std::vector<int> table;                          ///< open addressing table of indices in digits, -1 for empty bins
+    std::vector<o2::itsmft::PreDigitLabelRef> extra; ///< extra contributions to the digits, referred by PreDigitLabelRef::next
+    void clear()
+    {
+      digits.clear();
+      table.clear();
+      extra.clear();
+    }
+  };
+
   /// Default constructor
   ChipDigitsContainer(UShort_t idx = 0) : mChipIndex(idx){};
 
   /// Destructor
   ~ChipDigitsContainer() = default;
 
-  std::map<ULong64_t, o2::itsmft::PreDigit>& getPreDigits() { return mDigits; }
-  bool isEmpty() const { return mDigits.empty(); }
+  bool isEmpty() const { return mNDigits == 0; }
+  size_t getNDigits() const { return mNDigits; }
 
   void setChipIndex(UShort_t ind) { mChipIndex = ind; }
   UShort_t getChipIndex() const { return mChipIndex; }
@@ -51,6 +68,17 @@ class ChipDigitsContainer
   void addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col, int charge, o2::MCCompLabel lbl);
   void addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmft::DigiParams* params, int maxRows = o2::itsmft::SegmentationAlpide::NRows, int maxCols = o2::itsmft::SegmentationAlpide::NCols);
 
+  /// Get the digits of given readout frame sorted in the column/row order (i.e. in the ordering key order),
+  /// nullptr if there are none. The hash table is rebuilt for the new order, so that the digits of this frame
+  /// can still be looked up and added (the latter being appended out of order)
+  std::vector<o2::itsmft::PreDigit>* getSortedROFrameDigits(UInt_t roframe);
+  /// Get the extra contributions to the digits of given readout frame, which must contain at least 1 digit
+  std::vector<o2::itsmft::PreDigitLabelRef>& getExtraLabels(UInt_t roframe) { return getROFrame(roframe)->extra; }
+  /// Discard the digits of all readout frames up to and including given one
+  void releaseROFrames(UInt_t roframe);
+  /// Discard all digits
+  void clear();
+
   /// Get global ordering key made of readout frame, column and row
   static ULong64_t getOrderingKey(UInt_t roframe, UShort_t row, UShort_t col)
   {
@@ -63,26 +91,78 @@ class ChipDigitsContainer
     return static_cast<UInt_t>(key >> (8 * sizeof(UInt_t)));
   }
 
+  /// Get the pixel (column and row) part of the ordering key
+  static UInt_t key2Pixel(ULong64_t key)
+  {
+    return static_cast<UInt_t>(key);
+  }
+
  protected:
-  UShort_t mChipIndex = 0;                           ///< chip index
-  std::map<ULong64_t, o2::itsmft::PreDigit> mDigits; ///< Map of fired pixels, possibly in multiple frames
+  static constexpr int MinTableSize = 64; ///< initial size of the hash table of the frame, must be a power of 2
+
+  ROFrameDigits* getROFrame(UInt_t roframe);
+  ROFrameDigits& getOrCreateROFrame(UInt_t roframe);
+  void rehash(ROFrameDigits& rof, size_t size);
+  static UInt_t pixelHash(UInt_t pixel, size_t size)
+  {
+    UInt_t h = pixel * 0x9e3779b1u; // Fibonacci hashing, folding the well mixed upper bits to the lower ones
+    return (h ^ (h >> 16)) & (size - 1);
+  }
+  static UInt_t pixelOf(const o2::itsmft::PreDigit& dig) { return (UInt_t(dig.col) << (8 * sizeof(Short_t))) + dig.row; }
+
+  UShort_t mChipIndex = 0;                   ///< chip index
+  UInt_t mFirstROFrame = 0;                  ///< readout frame of the 1st entry of mROFrames
+  size_t mNDigits = 0;                       ///< total number of stored digits
+  std::vector<ROFrameDigits> mROFrames;      //! fired pixels of consecutive frames, starting from mFirstROFrame
+  std::vector<ROFrameDigits> mROFramesPool;  //! released frames kept to reuse their memory
 
-  ClassDefNV(ChipDigitsContainer, 1);
+  ClassDefNV(ChipDigitsContainer, 2);
 };
 
+//_______________________________________________________________________
+inline ChipDigitsContainer::ROFrameDigits* ChipDigitsContainer::getROFrame(UInt_t roframe)
+{
+  return (roframe >= mFirstROFrame && roframe - mFirstROFrame < mROFrames.size()) ? &mROFrames[roframe - mFirstROFrame] : nullptr;
+}
+
 //_______________________________________________________________________
 inline o2::itsmft::PreDigit* ChipDigitsContainer::findDigit(ULong64_t key)
 {
   // finds the digit corresponding to global key
-  auto digitentry = mDigits.find(key);
-  return digitentry != mDigits.end() ? &(digitentry->second) : nullptr;
+  auto rof = getROFrame(key2ROFrame(key));
+  if (!rof || rof->digits.empty()) {
+    return nullptr;
+  }
+  auto pixel = key2Pixel(key);
+  size_t size = rof->table.size();
+  for (auto bin = pixelHash(pixel, size);; bin = (bin + 1) & (size - 1)) {
+    int id = rof->table[bin];
+    if (id < 0) {
+      return nullptr;
+    }
+    if (pixelOf(rof->digits[id]) == pixel) {
+      return &rof->digits[id];
+    }
+  }
 }
 
 //_______________________________________________________________________
 inline void ChipDigitsContainer::addDigit(ULong64_t key, UInt_t roframe, UShort_t row, UShort_t col,
                                           int charge, o2::MCCompLabel lbl)
 {
-  mDigits.emplace(std::make_pair(key, o2::itsmft::PreDigit(roframe, row, col, charge, lbl)));
+  // adds new digit, the caller must make sure that it was not registered yet
+  auto& rof = getOrCreateROFrame(roframe);
+  if (2 * (rof.digits.size() + 1) > rof.table.size()) { // keep the load factor below 1/2
+    rehash(rof, rof.table.empty() ? MinTableSize : 2 * rof.table.size());
+  }
+  size_t size = rof.table.size();
+  auto bin = pixelHash(key2Pixel(key), size);
+  while (rof.table[bin] >= 0) {
+    bin = (bin + 1) & (size - 1);
+  }
+  rof.table[bin] = rof.digits.size();
+  rof.digits.emplace_back(roframe, row, col, charge, lbl);
+  mNDigits++;
 }
 } // namespace itsmft
 } // namespace o2
@@ -15,11 +15,11 @@
 #define ALICEO2_ITSMFT_DIGITIZER_H
 
 #include <vector>
-#include <deque>
 #include <memory>
 
 #include "Rtypes.h" // for Digitizer::Class
 #include "TObject.h" // for TObject
+#include "TRandom3.h"
 
 #include "ITSMFTSimulation/ChipDigitsContainer.h"
 #include "ITSMFTSimulation/AlpideSimResponse.h"
@@ -44,8 +44,6 @@ namespace itsmft
 {
 class Digitizer : public TObject
 {
-  using ExtraDig = std::vector<PreDigitLabelRef>; ///< container for extra contributions to PreDigits
-
  public:
   Digitizer() = default;
   ~Digitizer() override = default;
@@ -80,6 +78,10 @@ class Digitizer : public TObject
   // provide the common itsmft::GeometryTGeo to access matrices and segmentation
   void setGeometry(const o2::itsmft::GeometryTGeo* gm) { mGeometry = gm; }
 
+  /// number of threads digitizing the hits of different chips in parallel
+  void setNThreads(int n) { mNThreads = n > 0 ? n : 1; }
+  int getNThreads() const { return mNThreads; }
+
   uint32_t getEventROFrameMin() const { return mEventROFrameMin; }
   uint32_t getEventROFrameMax() const { return mEventROFrameMax; }
   void resetEventROFrames()
@@ -89,21 +91,17 @@ class Digitizer : public TObject
   }
 
  private:
-  void processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID, int srcID);
+  /// state of the hits digitization, private to each thread
+  struct HitsProcessingContext {
+    TRandom3 rnd;                          ///< random generator, reseeded for every chip
+    uint32_t maxFr = 0;                    ///< highest RO frame reached by the signal
+    uint32_t eventROFrameMin = 0xffffffff; ///< lowest RO frame with accounted contributions
+    uint32_t eventROFrameMax = 0;          ///< highest RO frame with accounted contributions
+  };
+
+  void processHit(const o2::itsmft::Hit& hit, int evID, int srcID, HitsProcessingContext& ctx);
   void registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
-                      uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl);
-
-  ExtraDig* getExtraDigBuffer(uint32_t roFrame)
-  {
-    if (mROFrameMin > roFrame) {
-      return nullptr; // nothing to do
-    }
-    int ind = roFrame - mROFrameMin;
-    while (ind >= int(mExtraBuff.size())) {
-      mExtraBuff.emplace_back(std::make_unique<ExtraDig>());
-    }
-    return mExtraBuff[ind].get();
-  }
+                      uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl, HitsProcessingContext& ctx);
 
   static constexpr float sec2ns = 1e9;
 
@@ -122,8 +120,10 @@ class Digitizer : public TObject
 
   const o2::itsmft::GeometryTGeo* mGeometry = nullptr; ///< ITS OR MFT upgrade geometry
 
+  int mNThreads = 1; ///< number of threads for the hits digitization
+
   std::vector<o2::itsmft::ChipDigitsContainer> mChips; ///< Array of chips digits containers
-  std::deque<std::unique_ptr<ExtraDig>> mExtraBuff;    ///< burrer (per roFrame) for extra digits
+  std::vector<HitsProcessingContext> mHitsContexts;    //! per thread state of the hits digitization
 
   std::vector<o2::itsmft::Digit>* mDigits = nullptr;                       //! output digits
   std::vector<o2::itsmft::ROFRecord>* mROFRecords = nullptr;               //! output ROF records
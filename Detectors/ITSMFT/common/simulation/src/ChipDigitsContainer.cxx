@@ -17,6 +17,7 @@
 #include "ITSMFTSimulation/ChipDigitsContainer.h"
 #include "ITSMFTSimulation/DigiParams.h"
 #include <TRandom.h>
+#include <algorithm>
 
 using namespace o2::itsmft;
 using Segmentation = o2::itsmft::SegmentationAlpide;
@@ -47,3 +48,80 @@ void ChipDigitsContainer::addNoise(UInt_t rofMin, UInt_t rofMax, const o2::itsmf
     }
   }
 }
+
+//______________________________________________________________________
+ChipDigitsContainer::ROFrameDigits& ChipDigitsContainer::getOrCreateROFrame(UInt_t roframe)
+{
+  // get the container of given frame, extending the window of frames if needed
+  auto newROFrame = [this]() {
+    if (mROFramesPool.empty()) {
+      return ROFrameDigits{};
+    }
+    auto rof = std::move(mROFramesPool.back());
+    mROFramesPool.pop_back();
+    return rof;
+  };
+  if (mROFrames.empty()) {
+    mFirstROFrame = roframe;
+  } else if (roframe < mFirstROFrame) {
+    mROFrames.insert(mROFrames.begin(), mFirstROFrame - roframe, ROFrameDigits{});
+    mFirstROFrame = roframe;
+  }
+  while (roframe - mFirstROFrame >= mROFrames.size()) {
+    mROFrames.emplace_back(newROFrame());
+  }
+  return mROFrames[roframe - mFirstROFrame];
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::rehash(ROFrameDigits& rof, size_t size)
+{
+  // rebuild the hash table of the frame with new size (power of 2)
+  rof.table.assign(size, -1);
+  for (int id = 0; id < int(rof.digits.size()); id++) {
+    auto bin = pixelHash(pixelOf(rof.digits[id]), size);
+    while (rof.table[bin] >= 0) {
+      bin = (bin + 1) & (size - 1);
+    }
+    rof.table[bin] = id;
+  }
+}
+
+//______________________________________________________________________
+std::vector<o2::itsmft::PreDigit>* ChipDigitsContainer::getSortedROFrameDigits(UInt_t roframe)
+{
+  auto rof = getROFrame(roframe);
+  if (!rof || rof->digits.empty()) {
+    return nullptr;
+  }
+  std::sort(rof->digits.begin(), rof->digits.end(), [](const PreDigit& a, const PreDigit& b) { return pixelOf(a) < pixelOf(b); });
+  rehash(*rof, rof->table.size()); // indices changed with the order
+  return &rof->digits;
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::releaseROFrames(UInt_t roframe)
+{
+  if (mROFrames.empty() || roframe < mFirstROFrame) {
+    return;
+  }
+  size_t nrel = std::min(size_t(roframe - mFirstROFrame + 1), mROFrames.size());
+  for (size_t i = 0; i < nrel; i++) {
+    mNDigits -= mROFrames[i].digits.size();
+    mROFrames[i].clear();
+    mROFramesPool.emplace_back(std::move(mROFrames[i]));
+  }
+  mROFrames.erase(mROFrames.begin(), mROFrames.begin() + nrel);
+  mFirstROFrame = roframe + 1;
+}
+
+//______________________________________________________________________
+void ChipDigitsContainer::clear()
+{
+  for (auto& rof : mROFrames) {
+    rof.clear();
+    mROFramesPool.emplace_back(std::move(rof));
+  }
+  mROFrames.clear();
+  mNDigits = 0;
+}
@@ -20,11 +20,16 @@
 #include "DetectorsRaw/HBFUtils.h"
 
 #include <TRandom.h>
+#include <atomic>
 #include <climits>
 #include <vector>
 #include <numeric>
 #include "FairLogger.h" // for LOG
 
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
+
 using o2::itsmft::Digit;
 using o2::itsmft::Hit;
 using Segmentation = o2::itsmft::SegmentationAlpide;
@@ -67,13 +72,49 @@ void Digitizer::process(const std::vector<Hit>* hits, int evID, int srcID)
   int nHits = hits->size();
   std::vector<int> hitIdx(nHits);
   std::iota(std::begin(hitIdx), std::end(hitIdx), 0);
-  // sort hits to improve memory access
+  // sort hits to improve memory access and to group them per chip
   std::sort(hitIdx.begin(), hitIdx.end(),
             [hits](auto lhs, auto rhs) {
               return (*hits)[lhs].GetDetectorID() < (*hits)[rhs].GetDetectorID();
             });
-  for (int i : hitIdx) {
-    processHit((*hits)[i], mROFrameMax, evID, srcID);
+  std::vector<int> chipFirstHit; // the hits of a given chip are digitized by the same thread
+  for (int i = 0; i < nHits; i++) {
+    if (!i || (*hits)[hitIdx[i]].GetDetectorID() != (*hits)[hitIdx[i - 1]].GetDetectorID()) {
+      chipFirstHit.push_back(i);
+    }
+  }
+  int nChipsHit = chipFirstHit.size();
+  chipFirstHit.push_back(nHits);
+
+  // every chip gets its own random stream derived from the event seed, so that the result does
+  // not depend on the number of threads and on the order in which the chips are processed
+  UInt_t eventSeed = gRandom->Integer(0xffffffff);
+  mHitsContexts.resize(mNThreads);
+  for (auto& ctx : mHitsContexts) {
+    ctx.maxFr = mROFrameMax;
+    ctx.eventROFrameMin = mEventROFrameMin;
+    ctx.eventROFrameMax = mEventROFrameMax;
+  }
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(mNThreads)
+#endif
+  for (int ic = 0; ic < nChipsHit; ic++) {
+#ifdef WITH_OPENMP
+    auto& ctx = mHitsContexts[omp_get_thread_num()];
+#else
+    auto& ctx = mHitsContexts[0];
+#endif
+    UInt_t chipID = (*hits)[hitIdx[chipFirstHit[ic]]].GetDetectorID();
+    UInt_t seed = (eventSeed ^ ((chipID + 1) * 0x9e3779b1u));
+    ctx.rnd.SetSeed(seed ? seed : 1); // 0 would request the time-based seeding
+    for (int i = chipFirstHit[ic]; i < chipFirstHit[ic + 1]; i++) {
+      processHit((*hits)[hitIdx[i]], evID, srcID, ctx);
+    }
+  }
+  for (const auto& ctx : mHitsContexts) {
+    mROFrameMax = std::max(mROFrameMax, ctx.maxFr);
+    mEventROFrameMin = std::min(mEventROFrameMin, ctx.eventROFrameMin);
+    mEventROFrameMax = std::max(mEventROFrameMax, ctx.eventROFrameMax);
   }
   // in the triggered mode store digits after every MC event
   // TODO: in the real triggered mode this will not be needed, this is actually for the
@@ -123,9 +164,6 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
   if (frameLast > mROFrameMax) {
     frameLast = mROFrameMax;
   }
-  // make sure all buffers for extra digits are created up to the maxFrame
-  getExtraDigBuffer(mROFrameMax);
-
   LOG(INFO) << "Filling " << mGeometry->getName() << " digits output for RO frames " << mROFrameMin << ":"
             << frameLast;
 
@@ -136,21 +174,14 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
     rcROF.setROFrame(mROFrameMin);
     rcROF.setFirstEntry(mDigits->size()); // start of current ROF in digits
 
-    auto& extra = *(mExtraBuff.front().get());
     for (auto& chip : mChips) {
       chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
-      auto& buffer = chip.getPreDigits();
-      if (buffer.empty()) {
+      auto buffer = chip.getSortedROFrameDigits(mROFrameMin);
+      if (!buffer) {
         continue;
       }
-      auto itBeg = buffer.begin();
-      auto iter = itBeg;
-      ULong64_t maxKey = chip.getOrderingKey(mROFrameMin + 1, 0, 0) - 1; // fetch digits with key below that
-      for (; iter != buffer.end(); ++iter) {
-        if (iter->first > maxKey) {
-          break; // is the digit ROFrame from the key > the max requested frame
-        }
-        auto& preDig = iter->second; // preDigit
+      const auto& extra = chip.getExtraLabels(mROFrameMin);
+      for (auto& preDig : *buffer) {
         if (preDig.charge >= mParams.getChargeThreshold()) {
           int digID = mDigits->size();
           mDigits->emplace_back(chip.getChipIndex(), preDig.row, preDig.col, preDig.charge);
@@ -162,7 +193,7 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
           }
         }
       }
-      buffer.erase(itBeg, iter);
+      chip.releaseROFrames(mROFrameMin);
     }
     // finalize ROF record
     rcROF.setNEntries(mDigits->size() - rcROF.getFirstEntry()); // number of digits
@@ -174,24 +205,21 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
     if (mROFRecords) {
       mROFRecords->push_back(rcROF);
     }
-    extra.clear(); // clear container for extra digits of the mROFrameMin ROFrame
-    // and move it as a new slot in the end
-    mExtraBuff.emplace_back(mExtraBuff.front().release());
-    mExtraBuff.pop_front();
   }
 }
 
 //_______________________________________________________________________
-void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID, int srcID)
+void Digitizer::processHit(const o2::itsmft::Hit& hit, int evID, int srcID, HitsProcessingContext& ctx)
 {
   // convert single hit to digits
   float timeInROF = hit.GetTime() * sec2ns;
   if (timeInROF > 20e3) {
     const int maxWarn = 10;
-    static int warnNo = 0;
-    if (warnNo < maxWarn) {
+    static std::atomic<int> warnNo{0}; // the hits are processed in threads
+    int iWarn = warnNo++;
+    if (iWarn < maxWarn) {
       LOG(WARNING) << "Ignoring hit with time_in_event = " << timeInROF << " ns"
-                   << ((++warnNo < maxWarn) ? "" : " (suppressing further warnings)");
+                   << ((iWarn + 1 < maxWarn) ? "" : " (suppressing further warnings)");
     }
     return;
   }
@@ -209,8 +237,8 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
   uint32_t roFrameRelMax = mParams.isContinuous() ? (timeInROF + tTot) * mParams.getROFrameLengthInv() : roFrameRel;
   int nFrames = roFrameRelMax + 1 - roFrameRel;
   uint32_t roFrameMax = mNewROFrame + roFrameRelMax;
-  if (roFrameMax > maxFr) {
-    maxFr = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
+  if (roFrameMax > ctx.maxFr) {
+    ctx.maxFr = roFrameMax; // if signal extends beyond current maxFrame, increase the latter
   }
 
   // here we start stepping in the depth of the sensor to generate charge diffision
@@ -334,21 +362,21 @@ void Digitizer::processHit(const o2::itsmft::Hit& hit, uint32_t& maxFr, int evID
       if (!nEleResp) {
         continue;
       }
-      int nEle = gRandom->Poisson(nElectrons * nEleResp); // total charge in given pixel
+      int nEle = ctx.rnd.Poisson(nElectrons * nEleResp); // total charge in given pixel
       // ignore charge which have no chance to fire the pixel
       if (nEle < mParams.getMinChargeToAccount()) {
         continue;
       }
       uint16_t colIS = icol + colS;
       //
-      registerDigits(chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl);
+      registerDigits(chip, roFrameAbs, timeInROF, nFrames, rowIS, colIS, nEle, lbl, ctx);
     }
   }
 }
 
 //________________________________________________________________________________
 void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, float tInROF, int nROF,
-                               uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl)
+                               uint16_t row, uint16_t col, int nEle, o2::MCCompLabel& lbl, HitsProcessingContext& ctx)
 {
   // Register digits for given pixel, accounting for the possible signal contribution to
   // multiple ROFrame. The signal starts at time tInROF wrt the start of provided roFrame
@@ -364,11 +392,11 @@ void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, floa
     if (nEleROF < mParams.getMinChargeToAccount()) {
       continue;
     }
-    if (roFr > mEventROFrameMax) {
-      mEventROFrameMax = roFr;
+    if (roFr > ctx.eventROFrameMax) {
+      ctx.eventROFrameMax = roFr;
     }
-    if (roFr < mEventROFrameMin) {
-      mEventROFrameMin = roFr;
+    if (roFr < ctx.eventROFrameMin) {
+      ctx.eventROFrameMin = roFr;
     }
     auto key = chip.getOrderingKey(roFr, row, col);
     PreDigit* pd = chip.findDigit(key);
@@ -379,7 +407,7 @@ void Digitizer::registerDigits(ChipDigitsContainer& chip, uint32_t roFrame, floa
       if (pd->labelRef.label == lbl) { // don't store the same label twice
         continue;
       }
-      ExtraDig* extra = getExtraDigBuffer(roFr);
+      auto* extra = &chip.getExtraLabels(roFr);
       int& nxt = pd->labelRef.next;
       bool skip = false;
       while (nxt >= 0) {
@@ -0,0 +1,111 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "benchmark/benchmark.h"
+#include "ITSMFTSimulation/ChipDigitsContainer.h"
+#include <map>
+#include <random>
+#include <vector>
+
+using o2::itsmft::ChipDigitsContainer;
+using o2::itsmft::PreDigit;
+
+struct PixelHit {
+  UInt_t roFrame;
+  UShort_t row;
+  UShort_t col;
+};
+
+// createHits generates nROF frames of nHitsPerROF pixel contributions, each hit
+// spilling over to the next frame, as the digitizer does for the signal tails,
+// with a fraction of hits on the same pixels mimicking the cluster overlaps in pile-up
+std::vector<PixelHit> createHits(int nROF, int nHitsPerROF)
+{
+  std::vector<PixelHit> hits;
+  std::mt19937 gen(12345);
+  std::uniform_int_distribution<int> rowDist(0, o2::itsmft::SegmentationAlpide::NRows - 1);
+  std::uniform_int_distribution<int> colDist(0, o2::itsmft::SegmentationAlpide::NCols - 1);
+  for (int rof = 0; rof < nROF; rof++) {
+    for (int i = 0; i < nHitsPerROF; i++) {
+      UShort_t row = rowDist(gen), col = colDist(gen);
+      for (int j = 0; j < 2; j++) {
+        hits.push_back({UInt_t(rof + j), row, col});
+        hits.push_back({UInt_t(rof + j), UShort_t(row ^ 1), col});
+      }
+    }
+  }
+  return hits;
+}
+
+// the digits accumulation and extraction as it was done with the map of ordering keys
+static void benchMap(benchmark::State& state)
+{
+  auto hits = createHits(10, state.range(0));
+  for (auto _ : state) {
+    std::map<ULong64_t, PreDigit> digits;
+    size_t nOut = 0, iHit = 0;
+    for (UInt_t rof = 0; rof < 10; rof++) {
+      for (; iHit < hits.size() && hits[iHit].roFrame <= rof + 1; iHit++) {
+        const auto& h = hits[iHit];
+        auto key = ChipDigitsContainer::getOrderingKey(h.roFrame, h.row, h.col);
+        auto it = digits.find(key);
+        if (it == digits.end()) {
+          digits.emplace(key, PreDigit(h.roFrame, h.row, h.col, 100, o2::MCCompLabel(int(iHit), 0, 0)));
+        } else {
+          it->second.charge += 100;
+        }
+      }
+      auto maxKey = ChipDigitsContainer::getOrderingKey(rof + 1, 0, 0) - 1;
+      auto iter = digits.begin();
+      for (; iter != digits.end() && iter->first <= maxKey; ++iter) {
+        nOut += iter->second.charge;
+      }
+      digits.erase(digits.begin(), iter);
+    }
+    benchmark::DoNotOptimize(nOut);
+  }
+  state.SetItemsProcessed(state.iterations() * hits.size());
+}
+
+static void benchChipDigitsContainer(benchmark::State& state)
+{
+  auto hits = createHits(10, state.range(0));
+  ChipDigitsContainer chip;
+  for (auto _ : state) {
+    size_t nOut = 0, iHit = 0;
+    for (UInt_t rof = 0; rof < 10; rof++) {
+      for (; iHit < hits.size() && hits[iHit].roFrame <= rof + 1; iHit++) {
+        const auto& h = hits[iHit];
+        auto key = ChipDigitsContainer::getOrderingKey(h.roFrame, h.row, h.col);
+        auto pd = chip.findDigit(key);
+        if (!pd) {
+          chip.addDigit(key, h.roFrame, h.row, h.col, 100, o2::MCCompLabel(int(iHit), 0, 0));
+        } else {
+          pd->charge += 100;
+        }
+      }
+      if (auto buffer = chip.getSortedROFrameDigits(rof)) {
+        for (const auto& preDig : *buffer) {
+          nOut += preDig.charge;
+        }
+      }
+      chip.releaseROFrames(rof);
+    }
+    chip.clear();
+    benchmark::DoNotOptimize(nOut);
+  }
+  state.SetItemsProcessed(state.iterations() * hits.size());
+}
+
+BENCHMARK(benchMap)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+BENCHMARK(benchChipDigitsContainer)->Arg(10)->Arg(100)->Arg(1000)->Arg(10000);
+
+BENCHMARK_MAIN();
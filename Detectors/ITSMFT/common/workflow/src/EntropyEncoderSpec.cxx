@@ -40,6 +40,11 @@ void EntropyEncoderSpec::init(o2::framework::InitContext& ic)
   if (!dictPath.empty() && dictPath != "none") {
     mCTFCoder.createCoders(dictPath, o2::ctf::CTFCoderBase::OpType::Encoder);
   }
+  std::string topoDictPath = ic.options().get<std::string>("topology-dict");
+  if (!topoDictPath.empty() && topoDictPath != "none") {
+    mCTFCoder.loadPatternDictionary(topoDictPath);
+    LOG(INFO) << mOrigin.as<std::string>() << " patterns of the clusters w/o ID are looked up in the dictionary " << topoDictPath;
+  }
 }
 
 void EntropyEncoderSpec::run(ProcessingContext& pc)
@@ -78,7 +83,8 @@ DataProcessorSpec getEntropyEncoderSpec(o2::header::DataOrigin orig)
     inputs,
     Outputs{{orig, "CTFDATA", 0, Lifetime::Timeframe}},
     AlgorithmSpec{adaptFromTask<EntropyEncoderSpec>(orig)},
-    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF encoding dictionary"}}}};
+    Options{{"ctf-dict", VariantType::String, o2::base::NameConf::getCTFDictFileName(), {"File of CTF encoding dictionary"}},
+            {"topology-dict", VariantType::String, "none", {"File of cluster-topology dictionary to store the clusters found w/o it by pattern ID"}}}};
 }
 
 } // namespace itsmft
@@ -40,6 +40,9 @@ class Track
   Track(Track&&) = delete;
   Track& operator=(Track&&) = delete;
 
+  void copyFrom(const Track& track);
+  void reset();
+
   /// Return the number of attached clusters
   int getNClusters() const { return mParamAtClusters.size(); }
 
@@ -80,7 +83,7 @@ class Track
   /// get a reference to the current chamber on which the current parameters are given
   int& getCurrentChamber() { return mCurrentChamber; }
   /// check whether the current track parameters exist
-  bool hasCurrentParam() const { return mCurrentParam ? true : false; }
+  bool hasCurrentParam() const { return mHasCurrentParam; }
   /// check if the current parameters are valid
   bool areCurrentParamValid() const { return (mCurrentChamber > -1); }
   /// invalidate the current parameters
@@ -101,6 +104,7 @@ class Track
  private:
   std::list<TrackParam> mParamAtClusters{};    ///< list of track parameters at each cluster
   std::unique_ptr<TrackParam> mCurrentParam{}; ///< current track parameters used during tracking
+  bool mHasCurrentParam = false;               ///< flag telling if the current track parameters are set
   int mCurrentChamber = -1;                    ///< current chamber on which the current parameters are given
   bool mConnected = false;                     ///< flag telling if this track shares cluster(s) with another
   bool mRemovable = false;                     ///< flag telling if this track should be deleted
@@ -83,6 +83,8 @@ class TrackFinder
   void finalize();
 
   void createTrack(const Cluster& cl1, const Cluster& cl2);
+  std::list<Track>::iterator duplicateTrack(const std::list<Track>::iterator& itPos, const Track& track);
+  std::list<Track>::iterator eraseTrack(const std::list<Track>::iterator& itTrack);
 
   bool isAcceptable(const TrackParam& param) const;
 
@@ -130,7 +132,8 @@ class TrackFinder
 
   std::array<std::vector<std::pair<const int, const std::list<Cluster>*>>, 32> mClusters{}; ///< array of pointers to the lists of clusters per DE
 
-  std::list<Track> mTracks{}; ///< list of reconstructed tracks
+  std::list<Track> mTracks{};     ///< list of reconstructed tracks
+  std::list<Track> mFreeTracks{}; ///< pool of removed tracks kept to be recycled without reallocation
 
   double mChamberResolutionX2 = 0.;      ///< chamber resolution square (cm^2) in x direction
   double mChamberResolutionY2 = 0.;      ///< chamber resolution square (cm^2) in y direction
@@ -31,6 +31,7 @@ using namespace std;
 Track::Track(const Track& track)
   : mParamAtClusters(track.mParamAtClusters),
     mCurrentParam(nullptr),
+    mHasCurrentParam(false),
     mCurrentChamber(-1),
     mConnected(track.mConnected),
     mRemovable(track.mRemovable)
@@ -38,6 +39,32 @@ Track::Track(const Track& track)
   /// Copy the track, except the current parameters and chamber, which are reset
 }
 
+//__________________________________________________________________________
+void Track::copyFrom(const Track& track)
+{
+  /// Copy the track into this one, except the current parameters and chamber, which are reset
+  /// The memory already allocated for the track parameters is reused as much as possible
+  if (this == &track) {
+    return;
+  }
+  mParamAtClusters = track.mParamAtClusters;
+  mHasCurrentParam = false;
+  mCurrentChamber = -1;
+  mConnected = track.mConnected;
+  mRemovable = track.mRemovable;
+}
+
+//__________________________________________________________________________
+void Track::reset()
+{
+  /// Reset the track to its default state, keeping the memory allocated for the current parameters
+  mParamAtClusters.clear();
+  mHasCurrentParam = false;
+  mCurrentChamber = -1;
+  mConnected = false;
+  mRemovable = false;
+}
+
 //__________________________________________________________________________
 TrackParam& Track::createParamAtCluster(const Cluster& cluster)
 {
@@ -201,6 +228,7 @@ void Track::setCurrentParam(const TrackParam& param, int chamber)
     mCurrentParam = std::make_unique<TrackParam>(param);
   }
   mCurrentParam->setClusterPtr(nullptr);
+  mHasCurrentParam = true;
   mCurrentChamber = chamber;
 }
 
@@ -210,7 +238,10 @@ TrackParam& Track::getCurrentParam()
   /// get a reference to the current track parameters. Create dummy parameters if needed
   if (!mCurrentParam) {
     mCurrentParam = std::make_unique<TrackParam>();
+  } else if (!mHasCurrentParam) {
+    *mCurrentParam = TrackParam();
   }
+  mHasCurrentParam = true;
   return *mCurrentParam;
 }
 
@@ -144,7 +144,8 @@ const std::list<Track>& TrackFinder::findTracks(const std::unordered_map<int, st
 {
   /// Run the track finder algorithm
 
-  mTracks.clear();
+  // recycle the tracks of the previous call
+  mFreeTracks.splice(mFreeTracks.end(), mTracks);
 
   // fill the internal array of pointers to the list of clusters per DE
   for (auto& plane : mClusters) {
@@ -182,7 +183,7 @@ const std::list<Track>& TrackFinder::findTracks(const std::unordered_map<int, st
     std::unordered_map<int, std::unordered_set<uint32_t>> excludedClusters{};
     followTrackInChamber(itTrack, 5, 0, false, excludedClusters);
     print("findTracks: removing candidate at position #", getTrackIndex(itTrack));
-    itTrack = mTracks.erase(itTrack);
+    itTrack = eraseTrack(itTrack);
   }
   tEnd = std::chrono::high_resolution_clock::now();
   mTimeFollowTracks += tEnd - tStart;
@@ -241,7 +242,7 @@ void TrackFinder::findTrackCandidates()
       ++itTrack;
     } else {
       print("findTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
       // prepare backward tracking for the new tracks
       for (; itNewTrack != mTracks.end() && itNewTrack != itTrack; ++itNewTrack) {
         prepareBackwardTracking(itNewTrack, false);
@@ -263,7 +264,7 @@ void TrackFinder::findTrackCandidates()
         prepareForwardTracking(itTrack, true);
       } catch (exception const&) {
         print("findTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-        itTrack = mTracks.erase(itTrack);
+        itTrack = eraseTrack(itTrack);
         continue;
       }
     }
@@ -287,7 +288,7 @@ void TrackFinder::findTrackCandidates()
       ++itTrack;
     } else {
       print("findTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     }
 
     // refit the track(s) and prepare to continue the tracking in the backward direction
@@ -297,7 +298,7 @@ void TrackFinder::findTrackCandidates()
         ++itFirstNewTrack;
       } catch (exception const&) {
         print("findTrackCandidates: removing candidate at position #", getTrackIndex(itFirstNewTrack));
-        itFirstNewTrack = mTracks.erase(itFirstNewTrack);
+        itFirstNewTrack = eraseTrack(itFirstNewTrack);
       }
     }
   }
@@ -337,7 +338,7 @@ void TrackFinder::findTrackCandidatesInSt5()
             prepareForwardTracking(itTrack, true);
           } catch (exception const&) {
             print("findTrackCandidatesInSt5: removing candidate at position #", getTrackIndex(itTrack));
-            itTrack = mTracks.erase(itTrack);
+            itTrack = eraseTrack(itTrack);
             continue;
           }
           auto itNewTrack = followTrackInOverlapDE(itTrack, itTrack->last().getClusterPtr()->getDEId(), iPlaneCh10 + 1);
@@ -346,7 +347,7 @@ void TrackFinder::findTrackCandidatesInSt5()
 
             // remove the initial candidate if compatible cluster(s) are found
             print("findTrackCandidatesInSt5: removing candidate at position #", getTrackIndex(itTrack));
-            itTrack = mTracks.erase(itTrack);
+            itTrack = eraseTrack(itTrack);
 
             // refit the track(s) with new attached cluster(s) and prepare to continue the tracking in the backward direction
             bool stop(false);
@@ -359,7 +360,7 @@ void TrackFinder::findTrackCandidatesInSt5()
                 prepareBackwardTracking(itTrack, true);
               } catch (exception const&) {
                 print("findTrackCandidatesInSt5: removing candidate at position #", getTrackIndex(itTrack));
-                itTrack = mTracks.erase(itTrack);
+                itTrack = eraseTrack(itTrack);
               }
             }
           } else {
@@ -383,7 +384,7 @@ void TrackFinder::findTrackCandidatesInSt5()
               ++itTrack;
             } else {
               print("findTrackCandidatesInSt5: removing candidate at position #", getTrackIndex(itTrack));
-              itTrack = mTracks.erase(itTrack);
+              itTrack = eraseTrack(itTrack);
             }
           }
         }
@@ -396,7 +397,7 @@ void TrackFinder::findTrackCandidatesInSt5()
   // remove tracks out of limits now that overlaps have been checked
   for (auto itTrack = mTracks.begin(); itTrack != mTracks.end();) {
     if (itTrack->isRemovable()) {
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     } else {
       ++itTrack;
     }
@@ -442,7 +443,7 @@ void TrackFinder::findTrackCandidatesInSt4()
           // keep the initial candidate only if no compatible cluster is found
           if (itNewTrack != mTracks.end()) {
             print("findTrackCandidatesInSt4: removing candidate at position #", getTrackIndex(itTrack));
-            mTracks.erase(itTrack);
+            eraseTrack(itTrack);
             itTrack = itNewTrack;
           }
         }
@@ -454,7 +455,7 @@ void TrackFinder::findTrackCandidatesInSt4()
             prepareForwardTracking(itTrack, true);
           } catch (exception const&) {
             print("findTrackCandidatesInSt4: removing candidate at position #", getTrackIndex(itTrack));
-            itTrack = mTracks.erase(itTrack);
+            itTrack = eraseTrack(itTrack);
             continue;
           }
 
@@ -472,7 +473,7 @@ void TrackFinder::findTrackCandidatesInSt4()
                 prepareForwardTracking(itNewTrack, false);
               }
               print("findTrackCandidatesInSt4: removing candidate at position #", getTrackIndex(itTrack));
-              itTrack = mTracks.erase(itTrack);
+              itTrack = eraseTrack(itTrack);
             }
           } else {
             ++itTrack;
@@ -486,7 +487,7 @@ void TrackFinder::findTrackCandidatesInSt4()
   auto itTrack = (itLastCandidateFromSt5 == mTracks.end()) ? mTracks.begin() : ++itLastCandidateFromSt5;
   while (itTrack != mTracks.end()) {
     if (itTrack->isRemovable()) {
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     } else {
       ++itTrack;
     }
@@ -528,7 +529,7 @@ void TrackFinder::findMoreTrackCandidates()
             prepareForwardTracking(itTrack, true);
           } catch (exception const&) {
             print("findMoreTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-            itTrack = mTracks.erase(itTrack);
+            itTrack = eraseTrack(itTrack);
             continue;
           }
           auto itNewTrack = followTrackInOverlapDE(itTrack, itTrack->last().getClusterPtr()->getDEId(), iPlaneSt5 + 1);
@@ -537,7 +538,7 @@ void TrackFinder::findMoreTrackCandidates()
 
             // remove the initial candidate if compatible cluster(s) are found
             print("findMoreTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-            itTrack = mTracks.erase(itTrack);
+            itTrack = eraseTrack(itTrack);
 
             // refit the track(s) with new cluster(s) and prepare to continue the tracking in the backward direction
             bool stop(false);
@@ -550,7 +551,7 @@ void TrackFinder::findMoreTrackCandidates()
                 prepareBackwardTracking(itTrack, true);
               } catch (exception const&) {
                 print("findMoreTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-                itTrack = mTracks.erase(itTrack);
+                itTrack = eraseTrack(itTrack);
               }
             }
           } else {
@@ -574,7 +575,7 @@ void TrackFinder::findMoreTrackCandidates()
               ++itTrack;
             } else {
               print("findMoreTrackCandidates: removing candidate at position #", getTrackIndex(itTrack));
-              itTrack = mTracks.erase(itTrack);
+              itTrack = eraseTrack(itTrack);
             }
           }
         }
@@ -589,7 +590,7 @@ void TrackFinder::findMoreTrackCandidates()
   auto itTrack = (itLastCandidate == mTracks.end()) ? mTracks.begin() : ++itLastCandidate;
   while (itTrack != mTracks.end()) {
     if (itTrack->isRemovable()) {
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     } else {
       if (!itTrack->hasCurrentParam()) {
         prepareBackwardTracking(itTrack, false);
@@ -728,7 +729,7 @@ std::list<Track>::iterator TrackFinder::followTrackInOverlapDE(const std::list<T
       }
 
       // duplicate the track and add the new cluster
-      itNewTrack = mTracks.emplace(itNewTrack, *itTrack);
+      itNewTrack = duplicateTrack(itNewTrack, *itTrack);
       print("followTrackInOverlapDE: duplicating candidate at position #", getTrackIndex(itNewTrack), " to add cluster ", cluster.getIdAsString());
       itNewTrack->addParamAtCluster(paramAtCluster);
 
@@ -826,7 +827,7 @@ std::list<Track>::iterator TrackFinder::followTrackInChamber(std::list<Track>::i
     // or if one reaches station 1 and it is not requested, whether a cluster has been found on it or not
     if ((!isFirstOnStation && canSkip && excludedClusters.empty()) ||
         (chamber / 2 == 0 && !TrackerParam::Instance().requestStation[0] && (isFirstOnStation || !canSkip))) {
-      itFirstNewTrack = mTracks.emplace(itTrack, *itTrack);
+      itFirstNewTrack = duplicateTrack(itTrack, *itTrack);
       print("followTrackInChamber: duplicating candidate at position #", getTrackIndex(itFirstNewTrack));
     }
   }
@@ -1086,7 +1087,7 @@ std::list<Track>::iterator TrackFinder::addClustersAndFollowTrack(std::list<Trac
   } else {
 
     // or duplicate the track and add the new cluster(s)
-    itFirstNewTrack = mTracks.emplace(itTrack, *itTrack);
+    itFirstNewTrack = duplicateTrack(itTrack, *itTrack);
     itFirstNewTrack->addParamAtCluster(paramAtCluster1);
     if (paramAtCluster2) {
       itFirstNewTrack->addParamAtCluster(*paramAtCluster2);
@@ -1169,7 +1170,7 @@ void TrackFinder::improveTracks()
     // Remove the track if it couldn't be improved
     if (removeTrack) {
       print("improveTracks: removing candidate at position #", getTrackIndex(itTrack));
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     } else {
       ++itTrack;
     }
@@ -1240,7 +1241,7 @@ void TrackFinder::removeConnectedTracks(int stMin, int stMax)
   for (auto itTrack = mTracks.begin(); itTrack != mTracks.end();) {
     if (itTrack->isConnected()) {
       print("removeConnectedTracks: removing candidate at position #", getTrackIndex(itTrack));
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     } else {
       ++itTrack;
     }
@@ -1258,7 +1259,7 @@ void TrackFinder::refineTracks()
       ++itTrack;
     } catch (exception const&) {
       print("refineTracks: removing candidate at position #", getTrackIndex(itTrack));
-      itTrack = mTracks.erase(itTrack);
+      itTrack = eraseTrack(itTrack);
     }
   }
 }
@@ -1281,8 +1282,14 @@ void TrackFinder::createTrack(const Cluster& cl1, const Cluster& cl2)
   /// Create a new track with these 2 clusters and store it at the end of the list of tracks
   /// Compute the track parameters and covariance matrices at the 2 clusters
 
-  // create the track and the trackParam at each cluster
-  Track& track = mTracks.emplace_back();
+  // create the track, recycling a previously removed one if any, and the trackParam at each cluster
+  if (mFreeTracks.empty()) {
+    mTracks.emplace_back();
+  } else {
+    mTracks.splice(mTracks.end(), mFreeTracks, mFreeTracks.begin());
+    mTracks.back().reset();
+  }
+  Track& track = mTracks.back();
   track.createParamAtCluster(cl2);
   track.createParamAtCluster(cl1);
   print("createTrack: creating candidate at position #", getTrackIndex(std::prev(mTracks.end())),
@@ -1293,10 +1300,34 @@ void TrackFinder::createTrack(const Cluster& cl1, const Cluster& cl2)
     mTrackFitter.fit(track, false);
   } catch (exception const&) {
     print("... fit failed --> removing it");
-    mTracks.erase(std::prev(mTracks.end()));
+    eraseTrack(std::prev(mTracks.end()));
   }
 }
 
+//_________________________________________________________________________________________________
+std::list<Track>::iterator TrackFinder::duplicateTrack(const std::list<Track>::iterator& itPos, const Track& track)
+{
+  /// Insert a copy of the given track before the position itPos and return an iterator to it
+  /// A previously removed track is recycled if any, so that its memory is reused
+  if (mFreeTracks.empty()) {
+    return mTracks.emplace(itPos, track);
+  }
+  mTracks.splice(itPos, mFreeTracks, mFreeTracks.begin());
+  auto itNewTrack = std::prev(itPos);
+  itNewTrack->copyFrom(track);
+  return itNewTrack;
+}
+
+//_________________________________________________________________________________________________
+std::list<Track>::iterator TrackFinder::eraseTrack(const std::list<Track>::iterator& itTrack)
+{
+  /// Remove the track from the list and return an iterator to the track that follows
+  /// The removed track is kept aside to be recycled later on
+  auto itNextTrack = std::next(itTrack);
+  mFreeTracks.splice(mFreeTracks.end(), mTracks, itTrack);
+  return itNextTrack;
+}
+
 //_________________________________________________________________________________________________
 bool TrackFinder::isAcceptable(const TrackParam& param) const
 {
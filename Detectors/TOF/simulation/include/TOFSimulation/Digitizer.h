@@ -18,6 +18,7 @@
 #include "TOFBase/WindowFiller.h"
 #include "TOFSimulation/Detector.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
+#include "SimulationDataFormat/MCTruthContainerBuilder.h"
 #include "TOFSimulation/MCLabel.h"
 #include "TOFCalibration/CalibTOFapi.h"
 
@@ -101,9 +102,10 @@ class Digitizer : public WindowFiller
   std::vector<o2::dataformats::MCTruthContainer<o2::MCCompLabel>> mMCTruthOutputContainerPerTimeFrame;
 
   // temporary MC info in the current tof readout windows
-  o2::dataformats::MCTruthContainer<o2::tof::MCLabel> mMCTruthContainer[MAXWINDOWS];
-  o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mMCTruthContainerCurrent = &mMCTruthContainer[0]; ///< Array for MCTruth information associated to digits in mDigitsArrray.
-  o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mMCTruthContainerNext[MAXWINDOWS - 1];            ///< Array for MCTruth information associated to digits in mDigitsArrray.
+  o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel> mMCTruthContainer[MAXWINDOWS];
+  o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mMCTruthContainerCurrent = &mMCTruthContainer[0]; ///< Array for MCTruth information associated to digits in mDigitsArrray.
+  o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mMCTruthContainerNext[MAXWINDOWS - 1];            ///< Array for MCTruth information associated to digits in mDigitsArrray.
+  o2::dataformats::MCTruthContainer<o2::tof::MCLabel> mMCTruthWindow;                                           ///< MC info of the readout window being flushed
   o2::dataformats::MCTruthContainer<o2::MCCompLabel>* mMCTruthOutputContainer;
 
   // arrays with digit and MCLabels out of the current readout windows (stored to fill future readout window)
@@ -115,7 +117,7 @@ class Digitizer : public WindowFiller
 
   CalibApi* mCalibApi = nullptr; //! calib api to handle the TOF calibration
 
-  void fillDigitsInStrip(std::vector<Strip>* strips, o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mcTruthContainer, int channel, int tdc, int tot, uint64_t nbc, UInt_t istrip, Int_t trackID, Int_t eventID, Int_t sourceID);
+  void fillDigitsInStrip(std::vector<Strip>* strips, o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mcTruthContainer, int channel, int tdc, int tot, uint64_t nbc, UInt_t istrip, Int_t trackID, Int_t eventID, Int_t sourceID);
 
   Int_t processHit(const HitType& hit, Double_t event_time);
   void addDigit(Int_t channel, UInt_t istrip, Double_t time, Float_t x, Float_t z, Float_t charge, Int_t iX, Int_t iZ, Int_t padZfired,
@@ -352,7 +352,7 @@ void Digitizer::addDigit(Int_t channel, UInt_t istrip, Double_t time, Float_t x,
   //printf("add TOF digit c=%i n=%i\n",iscurrent,isnext);
 
   std::vector<Strip>* strips;
-  o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mcTruthContainer;
+  o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mcTruthContainer;
 
   if (iscurrent) {
     strips = mStripsCurrent;
@@ -377,7 +377,7 @@ void Digitizer::addDigit(Int_t channel, UInt_t istrip, Double_t time, Float_t x,
   }
 }
 //______________________________________________________________________
-void Digitizer::fillDigitsInStrip(std::vector<Strip>* strips, o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mcTruthContainer, int channel, int tdc, int tot, uint64_t nbc, UInt_t istrip, Int_t trackID, Int_t eventID, Int_t sourceID)
+void Digitizer::fillDigitsInStrip(std::vector<Strip>* strips, o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mcTruthContainer, int channel, int tdc, int tot, uint64_t nbc, UInt_t istrip, Int_t trackID, Int_t eventID, Int_t sourceID)
 {
   int lblCurrent;
   if (mcTruthContainer) {
@@ -387,18 +387,9 @@ void Digitizer::fillDigitsInStrip(std::vector<Strip>* strips, o2::dataformats::M
   Int_t lbl = (*strips)[istrip].addDigit(channel, tdc, tot * Geo::NTOTBIN_PER_NS, nbc, lblCurrent);
 
   if (mcTruthContainer) {
-    if (lbl == lblCurrent) { // it means that the digit was a new one --> we have to add the info in the MC container
-      o2::tof::MCLabel label(trackID, eventID, sourceID, tdc);
-      mcTruthContainer->addElement(lbl, label);
-    } else {
-      o2::tof::MCLabel label(trackID, eventID, sourceID, tdc);
-      mcTruthContainer->addElementRandomAccess(lbl, label);
-
-      // sort the labels according to increasing tdc value
-      auto labels = mcTruthContainer->getLabels(lbl);
-      std::sort(labels.begin(), labels.end(),
-                [](o2::tof::MCLabel a, o2::tof::MCLabel b) { return a.getTDC() < b.getTDC(); });
-    }
+    // new digit or a label to add to an existing one, the labels are sorted in tdc when the window is flushed
+    o2::tof::MCLabel label(trackID, eventID, sourceID, tdc);
+    mcTruthContainer->addElement(lbl, label);
   }
 }
 //______________________________________________________________________
@@ -824,10 +815,11 @@ void Digitizer::fillOutputContainer(std::vector<Digit>& digits)
 
   // copying the transient labels to the output labels (stripping the tdc information)
   if (mMCTruthOutputContainer) {
-    // copy from transientTruthContainer to mMCTruthAray
-    // a brute force solution for the moment; should be handled by a dedicated API
-    for (int index = 0; index < mMCTruthContainerCurrent->getIndexedSize(); ++index) {
-      mMCTruthOutputContainer->addElements(index, mMCTruthContainerCurrent->getLabels(index));
+    // copy from transientTruthContainer to mMCTruthAray, with the labels of each digit in increasing tdc value
+    mMCTruthWindow.clear();
+    mMCTruthContainerCurrent->flushTo(mMCTruthWindow, [](const o2::tof::MCLabel& a, const o2::tof::MCLabel& b) { return a.getTDC() < b.getTDC(); });
+    for (int index = 0; index < mMCTruthWindow.getIndexedSize(); ++index) {
+      mMCTruthOutputContainer->addElements(index, mMCTruthWindow.getLabels(index));
     }
   }
 
@@ -936,7 +928,7 @@ void Digitizer::checkIfReuseFutureDigits()
 
     if (isnext < MAXWINDOWS - 1) { // move from digit buffer array to the proper window
       std::vector<Strip>* strips = mStripsCurrent;
-      o2::dataformats::MCTruthContainer<o2::tof::MCLabel>* mcTruthContainer = mMCTruthContainerCurrent;
+      o2::dataformats::MCTruthContainerBuilder<o2::tof::MCLabel>* mcTruthContainer = mMCTruthContainerCurrent;
 
       if (isnext) {
         strips = mStripsNext[isnext - 1];
@@ -24,6 +24,7 @@
 #include "TPCFastTransform.h"
 #include "Rtypes.h"
 #include <functional>
+#include <string>
 
 namespace o2
 {
@@ -61,7 +62,21 @@ class TPCFastTransformHelperO2
     mSpaceChargeCorrection = spaceChargeCorrection;
   };
 
-  /// creates TPCFastTransform object
+  /// set the number of threads used to approximate the correction map by splines
+  /// the external space charge correction must be thread safe when more than one thread is used
+  void setNthreads(int nThreads) { mNthreads = nThreads > 0 ? nThreads : 1; }
+
+  /// enable the caching of the created transformations in the directory cacheDir
+  /// mapID must uniquely identify the content of the space charge correction set by setSpaceChargeCorrection(),
+  /// e.g. by a checksum of its input; the other inputs (geometry, drift and electronics parameters) are accounted
+  /// for by the helper. An empty cacheDir disables the cache
+  void setCache(const std::string& cacheDir, const std::string& mapID)
+  {
+    mCacheDir = cacheDir;
+    mCacheMapID = mapID;
+  }
+
+  /// creates TPCFastTransform object, or reads it from the cache when it was already created for the same time stamp and map
   std::unique_ptr<TPCFastTransform> create(Long_t TimeStamp);
 
   /// Updates the transformation with the new time stamp
@@ -76,13 +91,20 @@ class TPCFastTransformHelperO2
   void init();
   /// get space charge correction in internal TPCFastTransform coordinates su,sv->dx,du,dv
   int getSpaceChargeCorrection(int slice, int row, double su, double sv, double& dx, double& du, double& dv);
+  /// name of the cache file for the transformation at the time stamp, containing a checksum of its inputs
+  std::string getCacheFileName(Long_t TimeStamp) const;
+
+  static constexpr int CacheVersion = 1; ///< version of the construction of the transformation, to be increased when it changes
 
   static TPCFastTransformHelperO2* sInstance;                                                  ///< singleton instance
   bool mIsInitialized = 0;                                                                     ///< initialization flag
   std::function<void(int roc, const double XYZ[3], double dXdYdZ[3])> mSpaceChargeCorrection = nullptr; ///< pointer to an external correction method
   TPCFastTransformGeo mGeo;                                                                    ///< geometry parameters
+  int mNthreads = 1;                                                                           ///< number of threads for the spline approximation
+  std::string mCacheDir;                                                                       ///< directory of the transformation cache, empty: no cache
+  std::string mCacheMapID;                                                                     ///< identifier of the space charge correction in the cache
 
-  ClassDefNV(TPCFastTransformHelperO2, 2);
+  ClassDefNV(TPCFastTransformHelperO2, 3);
 };
 } // namespace tpc
 } // namespace o2
@@ -25,6 +25,13 @@
 #include "Spline2DHelper.h"
 #include "Riostream.h"
 #include "FairLogger.h"
+#include "TROOT.h"
+#include "TSystem.h"
+#include "TMD5.h"
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
 
 using namespace o2::gpu;
 
@@ -100,6 +107,21 @@ std::unique_ptr<TPCFastTransform> TPCFastTransformHelperO2::create(Long_t TimeSt
     init();
   }
 
+  // look for the transformation in the cache
+
+  std::string cacheFileName;
+  if (!mCacheDir.empty()) {
+    cacheFileName = getCacheFileName(TimeStamp);
+    if (std::filesystem::exists(cacheFileName)) {
+      std::unique_ptr<TPCFastTransform> cachedPtr(TPCFastTransform::loadFromFile(cacheFileName));
+      if (cachedPtr) {
+        LOG(INFO) << "TPCFastTransform for time stamp " << TimeStamp << " is read from the cache " << cacheFileName;
+        return cachedPtr;
+      }
+      LOG(WARNING) << "Failed to read TPCFastTransform from the cache " << cacheFileName << ", it will be recreated";
+    }
+  }
+
   TPCFastSpaceChargeCorrection correction;
 
   { // create the correction map
@@ -194,9 +216,45 @@ std::unique_ptr<TPCFastTransform> TPCFastTransformHelperO2::create(Long_t TimeSt
 
   updateCalibration(fastTransform, TimeStamp);
 
+  if (!cacheFileName.empty()) {
+    // write to a temporary file first, such that concurrent processes never read an incomplete cache file
+    std::filesystem::create_directories(mCacheDir);
+    std::string tmpFileName = cacheFileName + "." + std::to_string(gSystem->GetPid()) + ".tmp";
+    if (fastTransform.writeToFile(tmpFileName) == 0 && std::rename(tmpFileName.c_str(), cacheFileName.c_str()) == 0) {
+      LOG(INFO) << "TPCFastTransform for time stamp " << TimeStamp << " is stored in the cache " << cacheFileName;
+    } else {
+      LOG(WARNING) << "Failed to store TPCFastTransform in the cache " << cacheFileName;
+      std::remove(tmpFileName.c_str());
+    }
+  }
+
   return std::move(fastTransformPtr);
 }
 
+std::string TPCFastTransformHelperO2::getCacheFileName(Long_t TimeStamp) const
+{
+  // besides the map and the time stamp, the transformation depends on the version of its construction,
+  // on the row geometry and on the drift and electronics parameters, which are identified by their checksum
+
+  auto& detParam = ParameterDetector::Instance();
+  auto& gasParam = ParameterGas::Instance();
+  auto& elParam = ParameterElectronics::Instance();
+
+  std::ostringstream inputs;
+  inputs << std::setprecision(9) << CacheVersion << " " << detParam.TPClength << " " << gasParam.DriftV << " "
+         << elParam.ZbinWidth << " " << elParam.getAverageShapingTime();
+  for (int row = 0; row < mGeo.getNumberOfRows(); row++) {
+    const auto& rowInfo = mGeo.getRowInfo(row);
+    inputs << " " << rowInfo.x << " " << rowInfo.maxPad << " " << rowInfo.padWidth;
+  }
+  const std::string inputsString = inputs.str();
+  TMD5 checksum;
+  checksum.Update(reinterpret_cast<const UChar_t*>(inputsString.data()), inputsString.size());
+  checksum.Final();
+
+  return mCacheDir + "/tpcFastTransform_" + mCacheMapID + "_" + checksum.AsString() + "_" + std::to_string(TimeStamp) + ".root";
+}
+
 int TPCFastTransformHelperO2::updateCalibration(TPCFastTransform& fastTransform, Long_t TimeStamp)
 {
   // Update the calibration with the new time stamp
@@ -263,18 +321,27 @@ int TPCFastTransformHelperO2::updateCalibration(TPCFastTransform& fastTransform,
   // for the future: switch TOF correction off for a while
 
   if (mSpaceChargeCorrection) {
-    for (int slice = 0; slice < correction.getGeometry().getNumberOfSlices(); slice++) {
-      for (int row = 0; row < correction.getGeometry().getNumberOfRows(); row++) {
-        const TPCFastSpaceChargeCorrection::SplineType& spline = correction.getSpline(slice, row);
-        float* data = correction.getSplineData(slice, row);
-        Spline2DHelper<float> helper;
-        helper.setSpline(spline, 3, 3);
-        auto F = [&](double su, double sv, double dxuv[3]) {
-          getSpaceChargeCorrection(slice, row, su, sv, dxuv[0], dxuv[1], dxuv[2]);
-        };
-        helper.approximateFunction(data, 0., 1., 0., 1., F);
-      } // row
-    }   // slice
+    // the splines of different slices and rows are independent, they are approximated in parallel
+    const int nSlices = correction.getGeometry().getNumberOfSlices();
+    const int nRows = correction.getGeometry().getNumberOfRows();
+#ifdef WITH_OPENMP
+    if (mNthreads > 1) {
+      ROOT::EnableThreadSafety();
+    }
+#pragma omp parallel for schedule(dynamic) num_threads(mNthreads)
+#endif
+    for (int iSliceRow = 0; iSliceRow < nSlices * nRows; iSliceRow++) {
+      const int slice = iSliceRow / nRows;
+      const int row = iSliceRow % nRows;
+      const TPCFastSpaceChargeCorrection::SplineType& spline = correction.getSpline(slice, row);
+      float* data = correction.getSplineData(slice, row);
+      Spline2DHelper<float> helper;
+      helper.setSpline(spline, 3, 3);
+      auto F = [&](double su, double sv, double dxuv[3]) {
+        getSpaceChargeCorrection(slice, row, su, sv, dxuv[0], dxuv[1], dxuv[2]);
+      };
+      helper.approximateFunction(data, 0., 1., 0., 1., F);
+    } // slice, row
     correction.initInverse();
   } else {
     correction.setNoCorrection();
@@ -29,6 +29,11 @@
 #include "Riostream.h"
 #include "FairLogger.h"
 
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
 #include <vector>
 #include <iostream>
 #include <iomanip>
@@ -193,9 +198,102 @@ BOOST_AUTO_TEST_CASE(FastTransform_test_setSpaceChargeCorrection)
   BOOST_CHECK_MESSAGE(fabs(statDiff) < 1.e-3, "test of correction map failed, average difference " << statDiff << " cm is too large");
   BOOST_CHECK_MESSAGE(fabs(statDiffFile) < 1.e-10, "test of file streamer failed, average difference " << statDiffFile << " cm is too large");
 
+  { // the batched transformation must agree with the single-cluster one
+    fastTransform->setApplyCorrectionOn();
+    std::vector<int> slices, rows;
+    std::vector<float> pads, times;
+    for (int slice = 0; slice < geo.getNumberOfSlices(); slice += 5) {
+      float lastTimeBin = fastTransform->getMaxDriftTime(slice, 0.f);
+      for (int row = 0; row < geo.getNumberOfRows(); row += 7) {
+        int nPads = geo.getRowInfo(row).maxPad + 1;
+        for (int pad = 0; pad < nPads; pad += 13) {
+          for (float time = 0; time < lastTimeBin; time += 50) {
+            slices.push_back(slice);
+            rows.push_back(row);
+            pads.push_back(pad);
+            times.push_back(time);
+          }
+        }
+      }
+    }
+    const int n = slices.size();
+    std::vector<float> xb(n), yb(n), zb(n);
+    fastTransform->TransformBatch(n, slices.data(), rows.data(), pads.data(), times.data(), xb.data(), yb.data(), zb.data());
+    double maxDiffBatch = 0.;
+    for (int i = 0; i < n; i++) {
+      float x, y, z;
+      fastTransform->Transform(slices[i], rows[i], pads[i], times[i], x, y, z);
+      maxDiffBatch = std::max<double>(maxDiffBatch, fabs(x - xb[i]) + fabs(y - yb[i]) + fabs(z - zb[i]));
+    }
+    BOOST_CHECK_MESSAGE(maxDiffBatch < 1.e-4, "test of batched transformation failed, max difference " << maxDiffBatch << " cm is too large");
+  }
+
   double maxDeviation = fastTransform->getCorrection().testInverse();
   BOOST_CHECK_MESSAGE(fabs(maxDeviation) < 1.e-2, "test of inverse correction map failed, max difference " << maxDeviation << " cm is too large");
 }
 
+/// @brief Test of the multi-threaded creation of the correction map and of the cache of the transformations:
+/// the transformation built with several threads and the one read back from the cache must equal the one built freshly
+BOOST_AUTO_TEST_CASE(FastTransform_test_threadsAndCache)
+{
+  auto helper = TPCFastTransformHelperO2::instance();
+  auto correctionGlobal = [](int roc, const double XYZ[3], double dXdYdZ[3]) {
+    dXdYdZ[0] = 0.1 + 0.001 * XYZ[0];
+    dXdYdZ[1] = 0.2 - 0.002 * XYZ[2];
+    dXdYdZ[2] = 0.3 + 0.0001 * XYZ[1] * XYZ[2];
+  };
+  helper->setSpaceChargeCorrection(correctionGlobal);
+  helper->setCache("", "");
+  helper->setNthreads(1);
+  std::unique_ptr<TPCFastTransform> fresh(helper->create(0));
+
+  helper->setNthreads(4);
+  std::unique_ptr<TPCFastTransform> threaded(helper->create(0));
+
+  const std::string cacheDir = "tmpTestTPCFastTransformCache";
+  std::filesystem::remove_all(cacheDir);
+  helper->setCache(cacheDir, "test");
+  auto nCacheFiles = [&cacheDir]() { return std::distance(std::filesystem::directory_iterator(cacheDir), std::filesystem::directory_iterator{}); };
+  std::unique_ptr<TPCFastTransform> stored(helper->create(0));
+  BOOST_CHECK_EQUAL(nCacheFiles(), 1);
+  std::unique_ptr<TPCFastTransform> cached(helper->create(0));
+  BOOST_CHECK_EQUAL(nCacheFiles(), 1);
+  // a transformation with other drift parameters is not taken from the cache
+  const float driftV = ParameterGas::Instance().DriftV;
+  o2::conf::ConfigurableParam::setValue("TPCGasParam", "DriftV", 1.1f * driftV);
+  std::unique_ptr<TPCFastTransform> otherDrift(helper->create(0));
+  BOOST_CHECK_EQUAL(nCacheFiles(), 2);
+  BOOST_CHECK(otherDrift->getVDrift() != cached->getVDrift());
+  o2::conf::ConfigurableParam::setValue("TPCGasParam", "DriftV", driftV);
+  helper->setCache("", "");
+  helper->setNthreads(1);
+  helper->setSpaceChargeCorrection(nullptr);
+
+  for (auto* transform : {fresh.get(), threaded.get(), cached.get()}) {
+    transform->setApplyCorrectionOn();
+  }
+  const TPCFastTransformGeo& geo = fresh->getGeometry();
+  double maxDiffThreaded = 0., maxDiffCached = 0.;
+  for (int slice = 0; slice < geo.getNumberOfSlices(); slice += 3) {
+    float lastTimeBin = fresh->getMaxDriftTime(slice, 0.f);
+    for (int row = 0; row < geo.getNumberOfRows(); row += 5) {
+      int nPads = geo.getRowInfo(row).maxPad + 1;
+      for (int pad = 0; pad < nPads; pad += 10) {
+        for (float time = 0; time < lastTimeBin; time += 30) {
+          float x0, y0, z0, x1, y1, z1, x2, y2, z2;
+          fresh->Transform(slice, row, pad, time, x0, y0, z0);
+          threaded->Transform(slice, row, pad, time, x1, y1, z1);
+          cached->Transform(slice, row, pad, time, x2, y2, z2);
+          maxDiffThreaded = std::max<double>(maxDiffThreaded, fabs(x1 - x0) + fabs(y1 - y0) + fabs(z1 - z0));
+          maxDiffCached = std::max<double>(maxDiffCached, fabs(x2 - x0) + fabs(y2 - y0) + fabs(z2 - z0));
+        }
+      }
+    }
+  }
+  BOOST_CHECK_MESSAGE(maxDiffThreaded == 0., "multi-threaded creation differs by " << maxDiffThreaded << " cm");
+  BOOST_CHECK_MESSAGE(maxDiffCached == 0., "transformation read from the cache differs by " << maxDiffCached << " cm");
+  std::filesystem::remove_all(cacheDir);
+}
+
 } // namespace tpc
 } // namespace o2
@@ -72,13 +72,14 @@ class DigitGlobalPad
   /// Fill output vector
   /// \param output Output container
   /// \param mcTruth MC Truth container
+  /// \param sampaProcessing SAMPA processing adding the noise and converting the charge to ADC counts
   /// \param cru CRU ID
   /// \param timeBin Time bin
   /// \param globalPad Global pad ID
   /// \param commonMode Common mode value of that specific ROC
   template <DigitzationMode MODE>
   void fillOutputContainer(std::vector<Digit>& output, dataformats::MCTruthContainer<MCCompLabel>& mcTruth,
-                           const CRU& cru, TimeBin timeBin,
+                           SAMPAProcessing& sampaProcessing, const CRU& cru, TimeBin timeBin,
                            GlobalPadNumber globalPad,
                            o2::dataformats::LabelContainer<std::pair<MCCompLabel, int>, false>& labelContainer,
                            float commonMode = 0.f);
@@ -131,15 +132,14 @@ inline bool DigitGlobalPad::compareMClabels(const MCCompLabel& label1, const MCC
 template <DigitzationMode MODE>
 inline void DigitGlobalPad::fillOutputContainer(std::vector<Digit>& output,
                                                 dataformats::MCTruthContainer<MCCompLabel>& mcTruth,
-                                                const CRU& cru, TimeBin timeBin,
+                                                SAMPAProcessing& sampaProcessing, const CRU& cru, TimeBin timeBin,
                                                 GlobalPadNumber globalPad,
                                                 o2::dataformats::LabelContainer<std::pair<MCCompLabel, int>, false>& labels,
                                                 float commonMode)
 {
   const static Mapper& mapper = Mapper::instance();
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
   const PadPos pad = mapper.padPos(globalPad);
-  static std::vector<std::pair<MCCompLabel, int>> labelCollector; // static workspace container for sorting
+  static thread_local std::vector<std::pair<MCCompLabel, int>> labelCollector; // static workspace container for sorting
 
   /// The charge accumulated on that pad is converted into ADC counts, saturation of the SAMPA is applied and a Digit
   /// is created in written out
@@ -69,12 +69,14 @@ class DigitTime
   /// \param output Output container
   /// \param mcTruth MC Truth container
   /// \param commonModeOutput Output container for common mode
-  /// \param cru CRU ID
+  /// \param sector Sector ID
+  /// \param sampaProcessing SAMPA processing adding the noise and converting the charge to ADC counts
   /// \param timeBin Time bin
   /// \param commonMode Common mode value of that specific ROC
   template <DigitzationMode MODE>
   void fillOutputContainer(std::vector<Digit>& output, dataformats::MCTruthContainer<MCCompLabel>& mcTruth,
-                           std::vector<CommonMode>& commonModeOutput, const Sector& sector, TimeBin timeBin, float commonMode = 0.f);
+                           std::vector<CommonMode>& commonModeOutput, const Sector& sector, SAMPAProcessing& sampaProcessing,
+                           TimeBin timeBin, float commonMode = 0.f);
 
  private:
   std::array<float, GEMSTACKSPERSECTOR> mCommonMode;                 ///< Common mode container - 4 GEM ROCs per sector
@@ -121,8 +123,8 @@ inline float DigitTime::getCommonMode(const GEMstack& gemstack) const
 
 template <DigitzationMode MODE>
 inline void DigitTime::fillOutputContainer(std::vector<Digit>& output, dataformats::MCTruthContainer<MCCompLabel>& mcTruth,
-                                           std::vector<CommonMode>& commonModeOutput, const Sector& sector, TimeBin timeBin,
-                                           float commonMode)
+                                           std::vector<CommonMode>& commonModeOutput, const Sector& sector,
+                                           SAMPAProcessing& sampaProcessing, TimeBin timeBin, float commonMode)
 {
   static Mapper& mapper = Mapper::instance();
   GlobalPadNumber globalPad = 0;
@@ -135,7 +137,7 @@ inline void DigitTime::fillOutputContainer(std::vector<Digit>& output, dataforma
   for (auto& pad : mGlobalPads) {
     if (pad.getChargePad() > 0.) {
       const CRU cru = mapper.getCRU(sector, globalPad);
-      pad.fillOutputContainer<MODE>(output, mcTruth, cru, timeBin, globalPad, mLabels, getCommonMode(cru));
+      pad.fillOutputContainer<MODE>(output, mcTruth, sampaProcessing, cru, timeBin, globalPad, mLabels, getCommonMode(cru));
     }
     ++globalPad;
   }
@@ -17,13 +17,17 @@
 #define ALICEO2_TPC_Digitizer_H_
 
 #include "TPCSimulation/DigitContainer.h"
+#include "TPCSimulation/ElectronTransport.h"
+#include "TPCSimulation/GEMAmplification.h"
 #include "TPCSimulation/PadResponse.h"
+#include "TPCSimulation/SAMPAProcessing.h"
 #include "TPCSimulation/Point.h"
 #include "TPCSpaceCharge/SpaceCharge.h"
 
 #include "TPCBase/Mapper.h"
 
 #include <cmath>
+#include <memory>
 
 using std::vector;
 
@@ -55,6 +59,22 @@ class Digitizer
  public:
   using SC = SpaceCharge<double, 129, 129, 180>;
 
+  /// Processing steps of the digitization with random rings of their own, e.g. for one thread digitizing sectors
+  /// concurrently with others
+  struct Processing {
+    std::unique_ptr<ElectronTransport> electronTransport;
+    std::unique_ptr<GEMAmplification> gemAmplification;
+    std::unique_ptr<SAMPAProcessing> sampaProcessing;
+
+    /// Copy with the same random rings, whose positions are then advanced independently
+    Processing copy() const
+    {
+      return Processing{std::make_unique<ElectronTransport>(*electronTransport),
+                        std::make_unique<GEMAmplification>(*gemAmplification),
+                        std::make_unique<SAMPAProcessing>(*sampaProcessing)};
+    }
+  };
+
   /// Default constructor
   Digitizer() = default;
 
@@ -125,16 +145,52 @@ class Digitizer
   /// \param TFile file containing distortions and corrections
   void setUseSCDistortions(TFile& finp);
 
+  /// Use the space-charge distortions of another digitizer, sharing its distortion maps.
+  /// The maps have to be initialized by the init() of the other digitizer
+  /// \param digitizer Digitizer providing the distortions
+  void setUseSCDistortions(const Digitizer& digitizer);
+
+  /// Create processing steps with the random rings filled from the given generator. The rings take about 16 MB
+  /// \param random Generator filling the random rings
+  /// \return Processing steps
+  static Processing createProcessing(TRandom& random);
+
+  /// Use the given processing steps instead of the global instances, until the next call
+  /// \param processing Processing steps, which must outlive their use by the digitizer
+  void setProcessing(Processing& processing)
+  {
+    mElectronTransport = processing.electronTransport.get();
+    mGEMAmplification = processing.gemAmplification.get();
+    mSAMPAProcessing = processing.sampaProcessing.get();
+  }
+
+  /// Set the position of the random rings of the processing steps, e.g. to start each sector at a position
+  /// of its own, independently of what was digitized before with the same rings
+  /// \param position Position in the random rings
+  void setRandomRingsPosition(size_t position)
+  {
+    getElectronTransport().setRandomRingsPosition(position);
+    getGEMAmplification().setRandomRingsPosition(position);
+    getSAMPAProcessing().setRandomRingsPosition(position);
+  }
+
  private:
+  ElectronTransport& getElectronTransport() { return mElectronTransport ? *mElectronTransport : ElectronTransport::instance(); }
+  GEMAmplification& getGEMAmplification() { return mGEMAmplification ? *mGEMAmplification : GEMAmplification::instance(); }
+  SAMPAProcessing& getSAMPAProcessing() { return mSAMPAProcessing ? *mSAMPAProcessing : SAMPAProcessing::instance(); }
+
   DigitContainer mDigitContainer;    ///< Container for the Digits
-  std::unique_ptr<SC> mSpaceCharge;  ///< Handler of space-charge distortions
+  std::shared_ptr<SC> mSpaceCharge;  //!< Handler of space-charge distortions, can be shared between digitizers
   Sector mSector = -1;               ///< ID of the currently processed sector
   double mEventTime = 0.f;           ///< Time of the currently processed event
   double mOutputDigitTimeOffset = 0; ///< Time of the first IR sampled in the digitizer
   // FIXME: whats the reason for hving this static?
   static bool mIsContinuous;      ///< Switch for continuous readout
   bool mUseSCDistortions = false; ///< Flag to switch on the use of space-charge distortions
-  ClassDefNV(Digitizer, 1);
+  ElectronTransport* mElectronTransport = nullptr; //!< Electron transport, the global instance if not set
+  GEMAmplification* mGEMAmplification = nullptr;   //!< GEM amplification, the global instance if not set
+  SAMPAProcessing* mSAMPAProcessing = nullptr;     //!< SAMPA processing, the global instance if not set
+  ClassDefNV(Digitizer, 2);
 };
 } // namespace tpc
 } // namespace o2
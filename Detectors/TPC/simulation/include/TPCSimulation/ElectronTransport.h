@@ -22,11 +22,36 @@
 #include "TPCBase/Mapper.h"
 #include "MathUtils/RandomRing.h"
 
+#include <memory>
+#include <vector>
+
 namespace o2
 {
 namespace tpc
 {
 
+/// \struct ElectronBatch
+/// Electrons of one hit after the drift, stored as structure of arrays to be processed in vectorised loops
+struct ElectronBatch {
+  std::vector<float> x;         ///< x position after the drift
+  std::vector<float> y;         ///< y position after the drift
+  std::vector<float> z;         ///< z position after the drift
+  std::vector<float> driftTime; ///< Drift time
+  std::vector<char> attached;   ///< Flag whether the electron is attached (and lost) during the drift
+  std::vector<float> random;    ///< Workspace for the random values
+
+  size_t size() const { return x.size(); }
+
+  void resize(size_t n)
+  {
+    x.resize(n);
+    y.resize(n);
+    z.resize(n);
+    driftTime.resize(n);
+    attached.resize(n);
+  }
+};
+
 /// \class ElectronTransport
 /// This class handles the electron transport in the active volume of the TPC.
 /// In particular, in deals with the diffusion of the charge cloud while drifting towards the readout chambers and the
@@ -41,6 +66,12 @@ class ElectronTransport
     return electronTransport;
   }
 
+  /// Create an instance of its own, with the random rings filled from the given generator instead of gRandom.
+  /// The random rings take about 3 MB per instance
+  /// \param random Generator filling the random rings
+  /// \return New instance
+  static std::unique_ptr<ElectronTransport> create(TRandom& random);
+
   /// Destructor
   ~ElectronTransport();
 
@@ -53,6 +84,13 @@ class ElectronTransport
   /// \return GlobalPosition3D with position of the electrons after the drift taking into account diffusion
   GlobalPosition3D getElectronDrift(GlobalPosition3D posEle, float& driftTime);
 
+  /// Drift of many electrons starting from the same position, taking into account diffusion.
+  /// Equivalent to calling getElectronDrift for each electron, with the random values drawn in bulk
+  /// \param posEle GlobalPosition3D with start position of the electrons
+  /// \param nElectrons Number of electrons
+  /// \param electrons Output batch with the positions and drift times of the electrons after the drift
+  void getElectronDrift(GlobalPosition3D posEle, int nElectrons, ElectronBatch& electrons);
+
   /// Drift of electrons in electric field taking into account diffusion with 3 sigma of the width
   /// \param posEle GlobalPosition3D with start position of the electrons
   /// \return GlobalPosition3D with position of the electrons after the drift taking into account diffusion with
@@ -64,6 +102,10 @@ class ElectronTransport
   /// \return Boolean whether the electron is attached (and lost) or not
   bool isElectronAttachment(float driftTime);
 
+  /// Attachment of a batch of electrons, for the drift times of the batch
+  /// \param electrons Batch of electrons, the attached flags of which are set
+  void setElectronAttachment(ElectronBatch& electrons);
+
   /// Compute electron drift time from z position
   /// \param zPos z position of the charge
   /// \param signChange If the zPosition of the charge is shifted to the other TPC side, the drift length needs to be
@@ -71,8 +113,13 @@ class ElectronTransport
   /// \return Time of the charge
   float getDriftTime(float zPos, float signChange = 1.f) const;
 
+  /// Set the position of the random rings
+  /// \param position Position in the rings
+  void setRandomRingsPosition(size_t position);
+
  private:
-  ElectronTransport();
+  /// \param random Generator filling the random rings, gRandom if not given
+  ElectronTransport(TRandom* random = nullptr);
 
   /// Circular random buffer containing random values of the Gauss distribution to take into account diffusion of the
   /// electrons
@@ -23,6 +23,8 @@
 #include "TPCBase/PadPos.h"
 #include "TPCBase/CalDet.h"
 
+#include <memory>
+
 namespace o2
 {
 namespace tpc
@@ -43,6 +45,12 @@ class GEMAmplification
     return gemAmplification;
   }
 
+  /// Create an instance of its own, with the random rings filled from the given generator instead of gRandom.
+  /// The random rings take about 11 MB per instance
+  /// \param random Generator filling the random rings
+  /// \return New instance
+  static std::unique_ptr<GEMAmplification> create(TRandom& random);
+
   /// Destructor
   ~GEMAmplification();
 
@@ -89,8 +97,22 @@ class GEMAmplification
   /// \return Number of electrons after amplification in the GEM
   int getGEMMultiplication(int nElectrons, int GEM);
 
+  /// Set the position of the random rings
+  /// \param position Position in the rings
+  void setRandomRingsPosition(size_t position);
+
  private:
-  GEMAmplification();
+  /// \param random Generator filling the random rings, gRandom if not given
+  GEMAmplification(TRandom* random = nullptr);
+
+  /// Number of random values drawn at once from the rings
+  static constexpr int RandomChunkSize = 64;
+
+  /// Sum of the integer parts of the next n values of a random ring
+  /// \param ring Random ring
+  /// \param n Number of values
+  /// \return Sum of the integer parts
+  static int sumOfIntegerParts(math_utils::RandomRing<>& ring, int n);
 
   /// Circular random buffer containing random Gaus values for gain fluctuation if the number of electrons is larger
   /// (central limit theorem)
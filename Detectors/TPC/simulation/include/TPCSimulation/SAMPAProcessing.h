@@ -28,6 +28,8 @@
 
 #include "TSpline.h"
 
+#include <memory>
+
 namespace o2
 {
 namespace tpc
@@ -45,6 +47,13 @@ class SAMPAProcessing
     static SAMPAProcessing sampaProcessing;
     return sampaProcessing;
   }
+
+  /// Create an instance of its own, with the random ring filled from the given generator instead of gRandom.
+  /// The random ring takes about 1.6 MB per instance
+  /// \param random Generator filling the random ring
+  /// \return New instance
+  static std::unique_ptr<SAMPAProcessing> create(TRandom& random);
+
   /// Destructor
   ~SAMPAProcessing();
 
@@ -124,8 +133,13 @@ class SAMPAProcessing
   /// \return Pedestal on the channel of interest
   float getPedestal(const int sector, const int globalPadInSector) const;
 
+  /// Set the position of the random ring
+  /// \param position Position in the ring
+  void setRandomRingsPosition(size_t position) { mRandomNoiseRing.setRingPosition(position); }
+
  private:
-  SAMPAProcessing();
+  /// \param random Generator filling the random ring, gRandom if not given
+  SAMPAProcessing(TRandom* random = nullptr);
 
   const ParameterGas* mGasParam;         ///< Caching of the parameter class to avoid multiple CDB calls
   const ParameterDetector* mDetParam;    ///< Caching of the parameter class to avoid multiple CDB calls
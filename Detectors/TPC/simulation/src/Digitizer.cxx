@@ -53,17 +53,18 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
   auto& eleParam = ParameterElectronics::Instance();
   auto& gemParam = ParameterGEM::Instance();
 
-  static GEMAmplification& gemAmplification = GEMAmplification::instance();
+  GEMAmplification& gemAmplification = getGEMAmplification();
   gemAmplification.updateParameters();
-  static ElectronTransport& electronTransport = ElectronTransport::instance();
+  ElectronTransport& electronTransport = getElectronTransport();
   electronTransport.updateParameters();
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+  SAMPAProcessing& sampaProcessing = getSAMPAProcessing();
   sampaProcessing.updateParameters();
 
   const int nShapedPoints = eleParam.NShapedPoints;
   const auto amplificationMode = gemParam.AmplMode;
-  static std::vector<float> signalArray;
+  static thread_local std::vector<float> signalArray;
   signalArray.resize(nShapedPoints);
+  static thread_local ElectronBatch electrons;
 
   /// Reserve space in the digit container for the current event
   mDigitContainer.reserve(sampaProcessing.getTimeBinFromTime(mEventTime - mOutputDigitTimeOffset));
@@ -92,15 +93,17 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
       /// The energy loss stored corresponds to nElectrons
       const int nPrimaryElectrons = static_cast<int>(eh.GetEnergyLoss());
       const float hitTime = eh.GetTime() * 0.001; /// in us
-      float driftTime = 0.f;
 
       /// TODO: add primary ions to space-charge density
 
+      /// Drift, diffusion and attachment of all electrons of the hit in one go
+      electronTransport.getElectronDrift(posEle, nPrimaryElectrons, electrons);
+      electronTransport.setElectronAttachment(electrons);
+
       /// Loop over electrons
       for (int iEle = 0; iEle < nPrimaryElectrons; ++iEle) {
 
-        /// Drift and Diffusion
-        const GlobalPosition3D posEleDiff = electronTransport.getElectronDrift(posEle, driftTime);
+        const float driftTime = electrons.driftTime[iEle];
         const float eleTime = driftTime + hitTime; /// in us
         if (eleTime > maxEleTime) {
           LOG(WARNING) << "Skipping electron with driftTime " << driftTime << " from hit at time " << hitTime;
@@ -109,10 +112,12 @@ void Digitizer::process(const std::vector<o2::tpc::HitGroup>& hits,
         const float absoluteTime = eleTime + (mEventTime - mOutputDigitTimeOffset); /// in us
 
         /// Attachment
-        if (electronTransport.isElectronAttachment(driftTime)) {
+        if (electrons.attached[iEle]) {
           continue;
         }
 
+        const GlobalPosition3D posEleDiff(electrons.x[iEle], electrons.y[iEle], electrons.z[iEle]);
+
         /// Remove electrons that end up outside the active volume
         if (std::abs(posEleDiff.Z()) > detParam.TPClength) {
           continue;
@@ -161,15 +166,24 @@ void Digitizer::flush(std::vector<o2::tpc::Digit>& digits,
                       std::vector<o2::tpc::CommonMode>& commonModeOutput,
                       bool finalFlush)
 {
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
-  mDigitContainer.fillOutputContainer(digits, labels, commonModeOutput, mSector, sampaProcessing.getTimeBinFromTime(mEventTime - mOutputDigitTimeOffset), mIsContinuous, finalFlush);
+  SAMPAProcessing& sampaProcessing = getSAMPAProcessing();
+  mDigitContainer.fillOutputContainer(digits, labels, commonModeOutput, mSector, sampaProcessing, sampaProcessing.getTimeBinFromTime(mEventTime - mOutputDigitTimeOffset), mIsContinuous, finalFlush);
+}
+
+Digitizer::Processing Digitizer::createProcessing(TRandom& random)
+{
+  Processing processing;
+  processing.electronTransport = ElectronTransport::create(random);
+  processing.gemAmplification = GEMAmplification::create(random);
+  processing.sampaProcessing = SAMPAProcessing::create(random);
+  return processing;
 }
 
 void Digitizer::setUseSCDistortions(SC::SCDistortionType distortionType, const TH3* hisInitialSCDensity)
 {
   mUseSCDistortions = true;
   if (!mSpaceCharge) {
-    mSpaceCharge = std::make_unique<SC>();
+    mSpaceCharge = std::make_shared<SC>();
   }
   mSpaceCharge->setSCDistortionType(distortionType);
   if (hisInitialSCDensity) {
@@ -188,7 +202,7 @@ void Digitizer::setUseSCDistortions(TFile& finp)
 {
   mUseSCDistortions = true;
   if (!mSpaceCharge) {
-    mSpaceCharge = std::make_unique<SC>();
+    mSpaceCharge = std::make_shared<SC>();
   }
   mSpaceCharge->setGlobalDistortionsFromFile(finp, Side::A);
   mSpaceCharge->setGlobalDistortionsFromFile(finp, Side::C);
@@ -196,9 +210,15 @@ void Digitizer::setUseSCDistortions(TFile& finp)
   mSpaceCharge->setGlobalCorrectionsFromFile(finp, Side::C);
 }
 
+void Digitizer::setUseSCDistortions(const Digitizer& digitizer)
+{
+  mUseSCDistortions = digitizer.mUseSCDistortions;
+  mSpaceCharge = digitizer.mSpaceCharge;
+}
+
 void Digitizer::setStartTime(double time)
 {
-  static SAMPAProcessing& sampaProcessing = SAMPAProcessing::instance();
+  SAMPAProcessing& sampaProcessing = getSAMPAProcessing();
   sampaProcessing.updateParameters();
   mDigitContainer.setStartTime(sampaProcessing.getTimeBinFromTime(time - mOutputDigitTimeOffset));
 }
@@ -21,19 +21,32 @@
 using namespace o2::tpc;
 using namespace o2::math_utils;
 
-ElectronTransport::ElectronTransport() : mRandomGaus(), mRandomFlat(RandomRing<>::RandomType::Flat)
+ElectronTransport::ElectronTransport(TRandom* random)
+  : mRandomGaus(RandomRing<>::RandomType::Gaus, random ? *random : *gRandom),
+    mRandomFlat(RandomRing<>::RandomType::Flat, random ? *random : *gRandom)
 {
   updateParameters();
 }
 
 ElectronTransport::~ElectronTransport() = default;
 
+std::unique_ptr<ElectronTransport> ElectronTransport::create(TRandom& random)
+{
+  return std::unique_ptr<ElectronTransport>(new ElectronTransport(&random));
+}
+
 void ElectronTransport::updateParameters()
 {
   mGasParam = &(ParameterGas::Instance());
   mDetParam = &(ParameterDetector::Instance());
 }
 
+void ElectronTransport::setRandomRingsPosition(size_t position)
+{
+  mRandomGaus.setRingPosition(position);
+  mRandomFlat.setRingPosition(position);
+}
+
 GlobalPosition3D ElectronTransport::getElectronDrift(GlobalPosition3D posEle, float& driftTime)
 {
   /// For drift lengths shorter than 1 mm, the drift length is set to that value
@@ -66,6 +79,58 @@ GlobalPosition3D ElectronTransport::getElectronDrift(GlobalPosition3D posEle, fl
   return posEleDiffusion;
 }
 
+void ElectronTransport::getElectronDrift(GlobalPosition3D posEle, int nElectrons, ElectronBatch& electrons)
+{
+  electrons.resize(nElectrons);
+  if (nElectrons <= 0) {
+    return;
+  }
+  /// The diffusion width is the same for all electrons, see the single electron version for the details
+  float driftl = mDetParam->TPClength - std::abs(posEle.Z());
+  if (driftl < 0.01) {
+    driftl = 0.01;
+  }
+  driftl = std::sqrt(driftl);
+  const float sigT = driftl * mGasParam->DiffT;
+  const float sigL = driftl * mGasParam->DiffL;
+  const float x0 = posEle.X(), y0 = posEle.Y(), z0 = posEle.Z();
+  const float tpcLength = mDetParam->TPClength;
+  const float driftV = mGasParam->DriftV;
+
+  /// The random values are consumed in the same order as by the single electron version (x, y, z of each electron)
+  electrons.random.resize(3 * nElectrons);
+  mRandomGaus.getNextValues(electrons.random.data(), 3 * nElectrons);
+  const float* rnd = electrons.random.data();
+  float* x = electrons.x.data();
+  float* y = electrons.y.data();
+  float* z = electrons.z.data();
+  float* driftTime = electrons.driftTime.data();
+  for (int i = 0; i < nElectrons; ++i) {
+    x[i] = rnd[3 * i] * sigT + x0;
+    y[i] = rnd[3 * i + 1] * sigT + y0;
+    const float zDiff = rnd[3 * i + 2] * sigL + z0;
+    /// A sign change in z elongates the drift time, keeping the original z position
+    const bool sideChange = z0 / zDiff < 0.f;
+    const float signChange = sideChange ? -1.f : 1.f;
+    driftTime[i] = (tpcLength - signChange * std::abs(zDiff)) / driftV;
+    z[i] = sideChange ? z0 : zDiff;
+  }
+}
+
+void ElectronTransport::setElectronAttachment(ElectronBatch& electrons)
+{
+  const int nElectrons = electrons.size();
+  electrons.random.resize(nElectrons);
+  mRandomFlat.getNextValues(electrons.random.data(), nElectrons);
+  const float attachment = mGasParam->AttCoeff * mGasParam->OxygenCont;
+  const float* rnd = electrons.random.data();
+  const float* driftTime = electrons.driftTime.data();
+  char* attached = electrons.attached.data();
+  for (int i = 0; i < nElectrons; ++i) {
+    attached[i] = rnd[i] < attachment * driftTime[i];
+  }
+}
+
 bool ElectronTransport::isCompletelyOutOfSectorCoarseElectronDrift(GlobalPosition3D posEle, const Sector& sector) const
 {
   /// For drift lengths shorter than 1 mm, the drift length is set to that value
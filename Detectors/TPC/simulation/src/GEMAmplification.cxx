@@ -21,14 +21,16 @@
 #include <fstream>
 #include "FairLogger.h"
 #include <filesystem>
+#include <algorithm>
+#include <array>
 
 using namespace o2::tpc;
 using namespace o2::math_utils;
 using boost::format;
 
-GEMAmplification::GEMAmplification()
-  : mRandomGaus(),
-    mRandomFlat(RandomRing<>::RandomType::Flat),
+GEMAmplification::GEMAmplification(TRandom* random)
+  : mRandomGaus(RandomRing<>::RandomType::Gaus, random ? *random : *gRandom),
+    mRandomFlat(RandomRing<>::RandomType::Flat, random ? *random : *gRandom),
     mGain()
 {
   updateParameters();
@@ -65,7 +67,11 @@ GEMAmplification::GEMAmplification()
       polyaDistribution = (o2::math_utils::CachingTF1*)outfile->Get(TString::Format("func%d", i).Data());
       // FIXME: verify that distribution corresponds to the parameters used here
     }
-    mGain[i].initialize(*polyaDistribution);
+    if (random) {
+      mGain[i].initialize(*polyaDistribution, *random);
+    } else {
+      mGain[i].initialize(*polyaDistribution);
+    }
 
     if (!cacheexists) {
       outfile->WriteTObject(polyaDistribution, TString::Format("func%d", i).Data());
@@ -87,7 +93,11 @@ GEMAmplification::GEMAmplification()
   } else {
     polyaDistribution = (o2::math_utils::CachingTF1*)outfile->Get("polyaStack");
   }
-  mGainFullStack.initialize(*polyaDistribution);
+  if (random) {
+    mGainFullStack.initialize(*polyaDistribution, *random);
+  } else {
+    mGainFullStack.initialize(*polyaDistribution);
+  }
 
   if (!cacheexists) {
     outfile->WriteTObject(polyaDistribution, "polyaStack");
@@ -103,6 +113,11 @@ GEMAmplification::GEMAmplification()
 
 GEMAmplification::~GEMAmplification() = default;
 
+std::unique_ptr<GEMAmplification> GEMAmplification::create(TRandom& random)
+{
+  return std::unique_ptr<GEMAmplification>(new GEMAmplification(&random));
+}
+
 void GEMAmplification::updateParameters()
 {
   auto& cdb = CDBInterface::instance();
@@ -111,6 +126,16 @@ void GEMAmplification::updateParameters()
   mGainMap = &(cdb.getGainMap());
 }
 
+void GEMAmplification::setRandomRingsPosition(size_t position)
+{
+  mRandomGaus.setRingPosition(position);
+  mRandomFlat.setRingPosition(position);
+  for (auto& gain : mGain) {
+    gain.setRingPosition(position);
+  }
+  mGainFullStack.setRingPosition(position);
+}
+
 int GEMAmplification::getStackAmplification(int nElectrons)
 {
   /// We start with an arbitrary number of electrons given to the first amplification stage
@@ -128,16 +153,36 @@ int GEMAmplification::getEffectiveStackAmplification(int nElectrons)
   /// We start with an arbitrary number of electrons given to the first amplification stage
   /// The amplification in the GEM stack is handled for each electron individually and the amplification
   /// in the stack is handled in an effective manner
+  /// The random values are drawn in chunks and processed in vectorisable loops, in the same order as electron by electron
   int nElectronsGEM = 0;
-  for (int i = 0; i < nElectrons; ++i) {
-    if (mRandomFlat.getNextValue() < mGEMParam->EfficiencyStack) {
-      continue;
+  std::array<float, RandomChunkSize> values;
+  for (int i = 0; i < nElectrons; i += RandomChunkSize) {
+    const int nChunk = std::min(RandomChunkSize, nElectrons - i);
+    mRandomFlat.getNextValues(values.data(), nChunk);
+    int nAmplified = 0;
+    for (int j = 0; j < nChunk; ++j) {
+      nAmplified += values[j] >= mGEMParam->EfficiencyStack;
     }
-    nElectronsGEM += mGainFullStack.getNextValue();
+    nElectronsGEM += sumOfIntegerParts(mGainFullStack, nAmplified);
   }
   return nElectronsGEM;
 }
 
+int GEMAmplification::sumOfIntegerParts(math_utils::RandomRing<>& ring, int n)
+{
+  /// The gains are positive, hence adding them one by one to an integer is adding their integer parts
+  int sum = 0;
+  std::array<float, RandomChunkSize> values;
+  for (int i = 0; i < n; i += RandomChunkSize) {
+    const int nChunk = std::min(RandomChunkSize, n - i);
+    ring.getNextValues(values.data(), nChunk);
+    for (int j = 0; j < nChunk; ++j) {
+      sum += static_cast<int>(values[j]);
+    }
+  }
+  return sum;
+}
+
 int GEMAmplification::getSingleGEMAmplification(int nElectrons, int GEM)
 {
   /// The effective gain of the GEM foil is given by three components
@@ -171,11 +216,7 @@ int GEMAmplification::getGEMMultiplication(int nElectrons, int GEM)
   } else {
     /// Otherwise we compute the gain fluctuations as the convolution of many single electron amplification
     /// fluctuations
-    int electronsOut = 0;
-    for (int i = 0; i < nElectrons; ++i) {
-      electronsOut += mGain[GEM].getNextValue();
-    }
-    return electronsOut;
+    return sumOfIntegerParts(mGain[GEM], nElectrons);
   }
 }
 
@@ -197,9 +238,12 @@ int GEMAmplification::getElectronLosses(int nElectrons, float probability)
   } else {
     /// Explicit handling of the probability for each individual electron
     int nElectronsOut = 0;
-    for (int i = 0; i < nElectrons; ++i) {
-      if (mRandomFlat.getNextValue() < probability) {
-        ++nElectronsOut;
+    std::array<float, RandomChunkSize> values;
+    for (int i = 0; i < nElectrons; i += RandomChunkSize) {
+      const int nChunk = std::min(RandomChunkSize, nElectrons - i);
+      mRandomFlat.getNextValues(values.data(), nChunk);
+      for (int j = 0; j < nChunk; ++j) {
+        nElectronsOut += values[j] < probability;
       }
     }
     return nElectronsOut;
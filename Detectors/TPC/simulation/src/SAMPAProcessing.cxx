@@ -24,13 +24,18 @@
 
 using namespace o2::tpc;
 
-SAMPAProcessing::SAMPAProcessing() : mRandomNoiseRing()
+SAMPAProcessing::SAMPAProcessing(TRandom* random) : mRandomNoiseRing(math_utils::RandomRing<>::RandomType::Gaus, random ? *random : *gRandom)
 {
   updateParameters();
 }
 
 SAMPAProcessing::~SAMPAProcessing() = default;
 
+std::unique_ptr<SAMPAProcessing> SAMPAProcessing::create(TRandom& random)
+{
+  return std::unique_ptr<SAMPAProcessing>(new SAMPAProcessing(&random));
+}
+
 void SAMPAProcessing::updateParameters()
 {
   mGasParam = &(ParameterGas::Instance());
@@ -39,7 +39,7 @@ BOOST_AUTO_TEST_CASE(DigitContainer_test1)
   cdb.setUseDefaults();
   o2::conf::ConfigurableParam::updateFromString("TPCEleParam.DigiMode=3"); // propagate the ADC values, otherwise the computation get complicated
   const Mapper& mapper = Mapper::instance();
-  const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+  SAMPAProcessing& sampa = SAMPAProcessing::instance();
   DigitContainer digitContainer;
   dataformats::MCTruthContainer<MCCompLabel> mMCTruthArray;
   digitContainer.reset();
@@ -61,7 +61,7 @@ BOOST_AUTO_TEST_CASE(DigitContainer_test1)
 
   std::vector<Digit> mDigitsArray;
   std::vector<o2::tpc::CommonMode> commonMode;
-  digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, commonMode, 0, 0, true, true);
+  digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, commonMode, 0, sampa, 0, true, true);
 
   for (size_t i = 0; i < commonMode.size(); ++i) {
     auto digit = mDigitsArray[i];
@@ -99,7 +99,7 @@ BOOST_AUTO_TEST_CASE(DigitContainer_test2)
   cdb.setUseDefaults();
   o2::conf::ConfigurableParam::updateFromString("TPCEleParam.DigiMode=3"); // propagate the ADC values, otherwise the computation get complicated
   const Mapper& mapper = Mapper::instance();
-  const SAMPAProcessing& sampa = SAMPAProcessing::instance();
+  SAMPAProcessing& sampa = SAMPAProcessing::instance();
   DigitContainer digitContainer;
   digitContainer.reset();
   dataformats::MCTruthContainer<MCCompLabel> mMCTruthArray;
@@ -133,7 +133,7 @@ BOOST_AUTO_TEST_CASE(DigitContainer_test2)
 
   std::vector<Digit> mDigitsArray;
   std::vector<o2::tpc::CommonMode> commonMode;
-  digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, commonMode, 0, 0, true, true);
+  digitContainer.fillOutputContainer(mDigitsArray, mMCTruthArray, commonMode, 0, sampa, 0, true, true);
 
   BOOST_CHECK(mDigitsArray.size() == cru.size());
 
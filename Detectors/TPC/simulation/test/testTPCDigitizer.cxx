@@ -0,0 +1,123 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file testTPCDigitizer.cxx
+/// \brief This task tests the processing steps of the TPC digitization
+
+#define BOOST_TEST_MODULE Test TPC Digitizer
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "TPCSimulation/Digitizer.h"
+#include "TPCBase/CDBInterface.h"
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+namespace o2
+{
+namespace tpc
+{
+
+/// draw n values from a random sequence
+template <typename T>
+std::vector<T> draw(std::function<T()> next, size_t n)
+{
+  std::vector<T> values(n);
+  std::generate(values.begin(), values.end(), next);
+  return values;
+}
+
+/// \brief Test of the random sequences of the processing steps
+/// Processing steps created from generators with the same seed, or copied from each other, give the same
+/// sequences from the same ring positions, and their creation does not touch gRandom
+BOOST_AUTO_TEST_CASE(Digitizer_Processing_test)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+
+  const size_t nSequence = 32;
+  auto* globalRandom = dynamic_cast<TRandom3*>(gRandom);
+  BOOST_REQUIRE(globalRandom != nullptr);
+  TRandom3 globalRandomBefore(*globalRandom);
+
+  TRandom3 random(42), randomAgain(42);
+  auto processing = Digitizer::createProcessing(random);
+  auto processingAgain = Digitizer::createProcessing(randomAgain);
+  auto processingCopy = processing.copy();
+  BOOST_CHECK(gRandom == globalRandom);
+  BOOST_CHECK_EQUAL(globalRandom->Rndm(), globalRandomBefore.Rndm());
+
+  auto noise = [](Digitizer::Processing& processing) {
+    return std::function<float()>([&processing]() { return processing.sampaProcessing->getNoise(0, 0); });
+  };
+  auto gain = [](Digitizer::Processing& processing) {
+    return std::function<int()>([&processing]() { return processing.gemAmplification->getGEMMultiplication(1, 0); });
+  };
+  auto drift = [](Digitizer::Processing& processing) {
+    return std::function<float()>([&processing]() {
+      float driftTime = 0.f;
+      return processing.electronTransport->getElectronDrift(GlobalPosition3D(100.f, 10.f, 100.f), driftTime).X();
+    });
+  };
+
+  Digitizer digitizer, digitizerAgain, digitizerCopy;
+  digitizer.setProcessing(processing);
+  digitizerAgain.setProcessing(processingAgain);
+  digitizerCopy.setProcessing(processingCopy);
+  for (const size_t position : {size_t(0), size_t(123456)}) {
+    for (auto* d : {&digitizer, &digitizerAgain, &digitizerCopy}) {
+      d->setRandomRingsPosition(position);
+    }
+    const auto noiseSequence = draw(noise(processing), nSequence);
+    BOOST_CHECK(draw(noise(processingAgain), nSequence) == noiseSequence);
+    BOOST_CHECK(draw(noise(processingCopy), nSequence) == noiseSequence);
+    const auto gainSequence = draw(gain(processing), nSequence);
+    BOOST_CHECK(draw(gain(processingAgain), nSequence) == gainSequence);
+    BOOST_CHECK(draw(gain(processingCopy), nSequence) == gainSequence);
+    const auto driftSequence = draw(drift(processing), nSequence);
+    BOOST_CHECK(draw(drift(processingAgain), nSequence) == driftSequence);
+    BOOST_CHECK(draw(drift(processingCopy), nSequence) == driftSequence);
+  }
+
+  // different start positions give different sequences
+  digitizer.setRandomRingsPosition(0);
+  const auto noiseSequence = draw(noise(processing), nSequence);
+  digitizer.setRandomRingsPosition(1000);
+  BOOST_CHECK(draw(noise(processing), nSequence) != noiseSequence);
+}
+
+/// \brief Test of the gain rings filled from a given generator
+/// The Polya distributions are sampled from their cumulative distributions instead of TF1::GetRandom,
+/// the mean gain has to agree with the one of the global instance
+BOOST_AUTO_TEST_CASE(Digitizer_ProcessingGain_test)
+{
+  auto& cdb = CDBInterface::instance();
+  cdb.setUseDefaults();
+
+  const int nDraws = 400000; // size of the random rings
+  TRandom3 random(4711);
+  auto processing = Digitizer::createProcessing(random);
+  auto& gemAmplification = GEMAmplification::instance();
+  for (int gem = 0; gem < 4; ++gem) {
+    double mean = 0., meanGlobal = 0.;
+    for (int i = 0; i < nDraws; ++i) {
+      mean += processing.gemAmplification->getGEMMultiplication(1, gem);
+      meanGlobal += gemAmplification.getGEMMultiplication(1, gem);
+    }
+    BOOST_CHECK_CLOSE(mean / nDraws, meanGlobal / nDraws, 2.);
+  }
+}
+
+} // namespace tpc
+} // namespace o2
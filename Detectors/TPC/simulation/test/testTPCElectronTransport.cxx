@@ -25,6 +25,8 @@
 #include "TH1D.h"
 #include "TF1.h"
 
+#include <vector>
+
 namespace o2
 {
 namespace tpc
@@ -143,5 +145,42 @@ BOOST_AUTO_TEST_CASE(ElectronAttatchment_test_1)
   BOOST_CHECK_CLOSE(lostElectrons / nEvents,
                     gasParam.AttCoeff * gasParam.OxygenCont * driftTime, 0.5);
 }
+
+/// \brief Test of the batched getElectronDrift and setElectronAttachment functions
+/// Starting from the same positions of the random rings, the batch of electrons
+/// has to be the same as the electrons drifted one by one
+BOOST_AUTO_TEST_CASE(ElectronBatch_test)
+{
+  auto& electronTransport = ElectronTransport::instance();
+  const int nElectrons = 1000;
+  for (const float z : {10.f, -0.01f, 249.99f}) {
+    const GlobalPosition3D posEle(10.f, 10.f, z);
+    electronTransport.setRandomRingsPosition(0);
+    std::vector<GlobalPosition3D> positions;
+    std::vector<float> driftTimes;
+    std::vector<bool> attached;
+    for (int i = 0; i < nElectrons; ++i) {
+      float driftTime = 0.f;
+      positions.emplace_back(electronTransport.getElectronDrift(posEle, driftTime));
+      driftTimes.emplace_back(driftTime);
+    }
+    for (int i = 0; i < nElectrons; ++i) {
+      attached.emplace_back(electronTransport.isElectronAttachment(driftTimes[i]));
+    }
+
+    electronTransport.setRandomRingsPosition(0);
+    ElectronBatch electrons;
+    electronTransport.getElectronDrift(posEle, nElectrons, electrons);
+    electronTransport.setElectronAttachment(electrons);
+    BOOST_REQUIRE_EQUAL(electrons.size(), nElectrons);
+    for (int i = 0; i < nElectrons; ++i) {
+      BOOST_CHECK_CLOSE(electrons.x[i], positions[i].X(), 1.e-4);
+      BOOST_CHECK_CLOSE(electrons.y[i], positions[i].Y(), 1.e-4);
+      BOOST_CHECK_CLOSE(electrons.z[i], positions[i].Z(), 1.e-4);
+      BOOST_CHECK_CLOSE(electrons.driftTime[i], driftTimes[i], 1.e-4);
+      BOOST_CHECK_EQUAL(bool(electrons.attached[i]), attached[i]);
+    }
+  }
+}
 } // namespace tpc
 } // namespace o2
@@ -361,6 +361,11 @@ class TrapSimulator
   int mADCFilled = 0; // stores bitpattern of fillted adc, for know when to fill with pure baseline, for use with setData(int iadc, const ArrayADC& adc);
   int mNHits{0};      // Number of detected hits
 
+  // filter kernels for a single sample, with the configuration already retrieved from the TrapConfig
+  unsigned short filterPedestalOutput(unsigned short value, unsigned short fpnp, unsigned short fpby, unsigned short accumulatorShifted) const;
+  unsigned short filterTailSample(FilterReg& reg, unsigned short value, unsigned short alphaLong,
+                                  unsigned short lambdaLong, unsigned short lambdaShort, unsigned short ftby) const;
+
   // Sort functions as in TRAP
   void sort2(unsigned short idx1i, unsigned short idx2i, unsigned short val1i, unsigned short val2i,
              unsigned short* const idx1o, unsigned short* const idx2o, unsigned short* const val1o, unsigned short* const val2o) const;
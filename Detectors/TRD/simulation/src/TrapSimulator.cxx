@@ -1133,42 +1133,36 @@ unsigned short TrapSimulator::filterPedestalNextSample(int adc, int timebin, uns
   // Returns the output of the pedestal filter given the input value.
   // The output depends on the internal registers and, thus, the
   // history of the filter.
-  LOG(debug) << "BEGIN: " << __FILE__ << ":" << __func__ << ":" << __LINE__;
 
   unsigned short fpnp = mTrapConfig->getTrapReg(TrapConfig::kFPNP, mDetector, mRobPos, mMcmPos); // 0..511 -> 0..127.75, pedestal at the output
   unsigned short fptc = mTrapConfig->getTrapReg(TrapConfig::kFPTC, mDetector, mRobPos, mMcmPos); // 0..3, 0 - fastest, 3 - slowest
   unsigned short fpby = mTrapConfig->getTrapReg(TrapConfig::kFPBY, mDetector, mRobPos, mMcmPos); // 0..1 bypass, active low
 
-  unsigned short accumulatorShifted;
-  unsigned short inpAdd;
-
-  inpAdd = value + fpnp;
-
-  accumulatorShifted = (mInternalFilterRegisters[adc].mPedAcc >> mgkFPshifts[fptc]) & 0x3FF; // 10 bits
-  if (timebin == 0)                                                                          // the accumulator is disabled in the drift time
+  unsigned short accumulatorShifted = (mInternalFilterRegisters[adc].mPedAcc >> mgkFPshifts[fptc]) & 0x3FF; // 10 bits
+  if (timebin == 0)                                                                                         // the accumulator is disabled in the drift time
   {
     int correction = (value & 0x3FF) - accumulatorShifted;
     mInternalFilterRegisters[adc].mPedAcc = (mInternalFilterRegisters[adc].mPedAcc + correction) & 0x7FFFFFFF; // 31 bits
   }
 
-  // LOG(debug) << "LEAVE: " << __FILE__ << ":" << __func__ << ":" << __LINE__ ;
+  return filterPedestalOutput(value, fpnp, fpby, accumulatorShifted);
+}
+
+unsigned short TrapSimulator::filterPedestalOutput(unsigned short value, unsigned short fpnp, unsigned short fpby, unsigned short accumulatorShifted) const
+{
+  // Output of the pedestal filter for the given input value and
+  // (shifted) accumulator, the internal registers are not changed.
+
   if (fpby == 0) {
-    LOG(debug) << "LEAVE: (about to)" << __FILE__ << ":" << __func__ << ":" << __LINE__;
-    if (fpby == 0) {
-      return value;
-    }
+    return value;
   }
 
+  unsigned short inpAdd = value + fpnp;
   if (inpAdd <= accumulatorShifted) {
     return 0;
-  } else {
-    inpAdd = inpAdd - accumulatorShifted;
-    if (inpAdd > 0xFFF) {
-      return 0xFFF;
-    } else {
-      return inpAdd;
-    }
   }
+  inpAdd = inpAdd - accumulatorShifted;
+  return (inpAdd > 0xFFF) ? 0xFFF : inpAdd;
 }
 
 void TrapSimulator::filterPedestal()
@@ -1181,16 +1175,39 @@ void TrapSimulator::filterPedestal()
   // It has only an effect if previous samples have been fed to
   // find the pedestal. Currently, the simulation assumes that
   // the input has been stable for a sufficiently long time.
-  // LOG(debug) << "BEGIN: " << __FILE__ << ":" << __func__ << ":" << __LINE__ ;
+  //
+  // The filter configuration is the same for all channels and timebins
+  // of this MCM, so it is read only once. The accumulator is only updated
+  // in the first timebin, hence the remaining timebins of each channel are
+  // processed as an independent (vectorizable) loop over contiguous data.
 
-  for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
-    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
-      int oldadc = mADCF[iAdc * mNTimeBin + iTimeBin];
-      mADCF[iAdc * mNTimeBin + iTimeBin] = filterPedestalNextSample(iAdc, iTimeBin, mADCR[iAdc * mNTimeBin + iTimeBin]);
-      //    LOG(debug) << "mADCF : time : " << iTimeBin << " adc : " << iAdc << " change : " << oldadc << " -> " << mADCF[iAdc * mNTimeBin + iTimeBin];
+  if (mNTimeBin <= 0) {
+    return;
+  }
+
+  unsigned short fpnp = mTrapConfig->getTrapReg(TrapConfig::kFPNP, mDetector, mRobPos, mMcmPos); // 0..511 -> 0..127.75, pedestal at the output
+  unsigned short fptc = mTrapConfig->getTrapReg(TrapConfig::kFPTC, mDetector, mRobPos, mMcmPos); // 0..3, 0 - fastest, 3 - slowest
+  unsigned short fpby = mTrapConfig->getTrapReg(TrapConfig::kFPBY, mDetector, mRobPos, mMcmPos); // 0..1 bypass, active low
+  unsigned short shift = mgkFPshifts[fptc];
+
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    const int* adcR = &mADCR[iAdc * mNTimeBin];
+    int* adcF = &mADCF[iAdc * mNTimeBin];
+    unsigned int& pedAcc = mInternalFilterRegisters[iAdc].mPedAcc;
+
+    // first timebin, the accumulator is updated after computing the output
+    unsigned short value = adcR[0];
+    unsigned short accumulatorShifted = (pedAcc >> shift) & 0x3FF; // 10 bits
+    adcF[0] = filterPedestalOutput(value, fpnp, fpby, accumulatorShifted);
+    int correction = (value & 0x3FF) - accumulatorShifted;
+    pedAcc = (pedAcc + correction) & 0x7FFFFFFF; // 31 bits
+
+    // the accumulator is disabled in the drift time
+    accumulatorShifted = (pedAcc >> shift) & 0x3FF;
+    for (int iTimeBin = 1; iTimeBin < mNTimeBin; iTimeBin++) {
+      adcF[iTimeBin] = filterPedestalOutput(adcR[iTimeBin], fpnp, fpby, accumulatorShifted);
     }
   }
-  // LOG(debug) << "BEGIN: " << __FILE__ << ":" << __func__ << ":" << __LINE__ ;
 }
 
 void TrapSimulator::filterGainInit()
@@ -1321,6 +1338,16 @@ unsigned short TrapSimulator::filterTailNextSample(int adc, unsigned short value
   unsigned short alphaLong = 0x3ff & mTrapConfig->getTrapReg(TrapConfig::kFTAL, mDetector, mRobPos, mMcmPos);                            // the weight of the long component
   unsigned short lambdaLong = (1 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLL, mDetector, mRobPos, mMcmPos) & 0x1FF);  // the multiplier of the long component
   unsigned short lambdaShort = (0 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLS, mDetector, mRobPos, mMcmPos) & 0x1FF); // the multiplier of the short component
+  unsigned short ftby = mTrapConfig->getTrapReg(TrapConfig::kFTBY, mDetector, mRobPos, mMcmPos);                                         // bypass, active low
+
+  return filterTailSample(mInternalFilterRegisters[adc], value, alphaLong, lambdaLong, lambdaShort, ftby);
+}
+
+unsigned short TrapSimulator::filterTailSample(FilterReg& reg, unsigned short value, unsigned short alphaLong,
+                                               unsigned short lambdaLong, unsigned short lambdaShort, unsigned short ftby) const
+{
+  // Tail filter kernel for a single sample, with the configuration
+  // already retrieved from the TrapConfig. Updates the given registers.
 
   // intermediate signals
   unsigned int aDiff;
@@ -1331,7 +1358,7 @@ unsigned short TrapSimulator::filterTailNextSample(int adc, unsigned short value
   unsigned short inpVolt = value & 0xFFF; // 12 bits
 
   // add the present generator outputs
-  aQ = addUintClipping(mInternalFilterRegisters[adc].mTailAmplLong, mInternalFilterRegisters[adc].mTailAmplShort, 12);
+  aQ = addUintClipping(reg.mTailAmplLong, reg.mTailAmplShort, 12);
 
   // calculate the difference between the input and the generated signal
   if (inpVolt > aQ) {
@@ -1345,16 +1372,16 @@ unsigned short TrapSimulator::filterTailNextSample(int adc, unsigned short value
 
   // the new values of the registers, used next time
   // long component
-  tmp = addUintClipping(mInternalFilterRegisters[adc].mTailAmplLong, alInpv, 12);
+  tmp = addUintClipping(reg.mTailAmplLong, alInpv, 12);
   tmp = (tmp * lambdaLong) >> 11;
-  mInternalFilterRegisters[adc].mTailAmplLong = tmp & 0xFFF;
+  reg.mTailAmplLong = tmp & 0xFFF;
   // short component
-  tmp = addUintClipping(mInternalFilterRegisters[adc].mTailAmplShort, aDiff - alInpv, 12);
+  tmp = addUintClipping(reg.mTailAmplShort, aDiff - alInpv, 12);
   tmp = (tmp * lambdaShort) >> 11;
-  mInternalFilterRegisters[adc].mTailAmplShort = tmp & 0xFFF;
+  reg.mTailAmplShort = tmp & 0xFFF;
 
   // the output of the filter
-  if (mTrapConfig->getTrapReg(TrapConfig::kFTBY, mDetector, mRobPos, mMcmPos) == 0) { // bypass mode, active low
+  if (ftby == 0) { // bypass mode, active low
     return value;
   } else {
     return aDiff;
@@ -1364,10 +1391,19 @@ unsigned short TrapSimulator::filterTailNextSample(int adc, unsigned short value
 void TrapSimulator::filterTail()
 {
   // Apply tail cancellation filter to all data.
+  // The configuration is read once for the MCM, then each channel is
+  // filtered along its contiguous timebins (the channels are independent).
 
-  for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
-    for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
-      mADCF[iAdc * mNTimeBin + iTimeBin] = filterTailNextSample(iAdc, mADCF[iAdc * mNTimeBin + iTimeBin]);
+  unsigned short alphaLong = 0x3ff & mTrapConfig->getTrapReg(TrapConfig::kFTAL, mDetector, mRobPos, mMcmPos);
+  unsigned short lambdaLong = (1 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLL, mDetector, mRobPos, mMcmPos) & 0x1FF);
+  unsigned short lambdaShort = (0 << 10) | (1 << 9) | (mTrapConfig->getTrapReg(TrapConfig::kFTLS, mDetector, mRobPos, mMcmPos) & 0x1FF);
+  unsigned short ftby = mTrapConfig->getTrapReg(TrapConfig::kFTBY, mDetector, mRobPos, mMcmPos);
+
+  for (int iAdc = 0; iAdc < NADCMCM; iAdc++) {
+    int* adcF = &mADCF[iAdc * mNTimeBin];
+    auto& reg = mInternalFilterRegisters[iAdc];
+    for (int iTimeBin = 0; iTimeBin < mNTimeBin; iTimeBin++) {
+      adcF[iTimeBin] = filterTailSample(reg, adcF[iTimeBin], alphaLong, lambdaLong, lambdaShort, ftby);
     }
   }
 }
@@ -43,6 +43,12 @@ class TRDDPLTrapSimulatorTask : public o2::framework::Task
 
 
  private:
+  struct HalfChamberRange {
+    int iTrig;      // index of the trigger record the digits belong to
+    int firstDigit; // first entry in the array of digit indices sorted by half chamber
+    int nDigits;    // number of digits in this half chamber
+  };
+
   TrapConfig* mTrapConfig = nullptr;
   unsigned long mRunNumber = 297595; //run number to anchor simulation to.
   bool mEnableOnlineGainCorrection{false};
@@ -235,35 +235,45 @@ void TRDDPLTrapSimulatorTask::run(o2::framework::ProcessingContext& pc)
   }
   auto sortTime = std::chrono::high_resolution_clock::now() - sortStart;
 
-  // prepare data structures for accumulating results per collision
-  std::vector<int> nTracklets(triggerRecords.size());
-  std::vector<std::vector<Tracklet64>> trackletsAccum;
-  trackletsAccum.resize(triggerRecords.size());
-  std::vector<std::vector<short>> digitCountsAccum; // holds the number of digits included in each tracklet (therefore has the same number of elements as trackletsAccum)
+  // split the digits of each collision into half chambers, which are the units of work processed in parallel
+  // (a single TF can contain only few collisions, so parallelising over collisions alone is not sufficient)
+  std::vector<HalfChamberRange> hcRanges;
+  for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
+    int firstDigit = triggerRecords[iTrig].getFirstDigit();
+    int lastDigit = firstDigit + triggerRecords[iTrig].getNumberOfDigits();
+    for (int iDigit = firstDigit; iDigit < lastDigit; ++iDigit) {
+      if (iDigit == firstDigit || digits[digitIdxArray[iDigit]].getHCId() != digits[digitIdxArray[iDigit - 1]].getHCId()) {
+        hcRanges.push_back({iTrig, iDigit, 0});
+      }
+      ++hcRanges.back().nDigits;
+    }
+  }
+
+  // prepare data structures for accumulating results per half chamber
+  std::vector<int> nTracklets(hcRanges.size());
+  std::vector<std::vector<Tracklet64>> trackletsAccum(hcRanges.size());
+  std::vector<std::vector<short>> digitCountsAccum(hcRanges.size()); // holds the number of digits included in each tracklet (therefore has the same number of elements as trackletsAccum)
   // digitIndicesAccum holds the global indices of the digits which comprise the tracklets
   // with the help of digitCountsAccum one can loop through this vector and find the corresponding digit indices for each tracklet
-  std::vector<std::vector<int>> digitIndicesAccum;
-  digitCountsAccum.resize(triggerRecords.size());
-  digitIndicesAccum.resize(triggerRecords.size());
+  std::vector<std::vector<int>> digitIndicesAccum(hcRanges.size());
+
+  // the up to 64 trap simulators for a single half chamber, one set per thread which is reused for every half chamber
+  std::vector<std::array<TrapSimulator, NMCMHCMAX>> trapSimulatorsPerThread(std::max(1, mNumThreads));
 
   auto timeParallelStart = std::chrono::high_resolution_clock::now();
 
 #ifdef WITH_OPENMP
 #pragma omp parallel for schedule(dynamic) num_threads(mNumThreads)
 #endif
-  for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
-    int currHCId = -1;
-    std::array<TrapSimulator, NMCMHCMAX> trapSimulators{}; //the up to 64 trap simulators for a single half chamber
-    for (int iDigit = triggerRecords[iTrig].getFirstDigit(); iDigit < (triggerRecords[iTrig].getFirstDigit() + triggerRecords[iTrig].getNumberOfDigits()); ++iDigit) {
+  for (int iHC = 0; iHC < hcRanges.size(); ++iHC) {
+#ifdef WITH_OPENMP
+    auto& trapSimulators = trapSimulatorsPerThread[omp_get_thread_num()];
+#else
+    auto& trapSimulators = trapSimulatorsPerThread[0];
+#endif
+    const auto& hcRange = hcRanges[iHC];
+    for (int iDigit = hcRange.firstDigit; iDigit < hcRange.firstDigit + hcRange.nDigits; ++iDigit) {
       const auto& digit = &digits[digitIdxArray[iDigit]];
-      if (currHCId < 0) {
-        currHCId = digit->getHCId();
-      }
-      if (currHCId != digit->getHCId()) {
-        // we switch to a new half chamber, process all TRAPs of the previous half chamber which contain data
-        processTRAPchips(nTracklets[iTrig], trackletsAccum[iTrig], trapSimulators, digitCountsAccum[iTrig], digitIndicesAccum[iTrig]);
-        currHCId = digit->getHCId();
-      }
       // fill the digit data into the corresponding TRAP chip
       int trapIdx = (digit->getROB() / 2) * NMCMROB + digit->getMCM();
       if (!trapSimulators[trapIdx].isDataSet()) {
@@ -271,47 +281,51 @@ void TRDDPLTrapSimulatorTask::run(o2::framework::ProcessingContext& pc)
       }
       trapSimulators[trapIdx].setData(digit->getChannel(), digit->getADC(), digitIdxArray[iDigit]);
     }
-    // take care of the TRAPs for the last half chamber
-    processTRAPchips(nTracklets[iTrig], trackletsAccum[iTrig], trapSimulators, digitCountsAccum[iTrig], digitIndicesAccum[iTrig]);
+    // process all TRAPs of this half chamber which contain data
+    processTRAPchips(nTracklets[iHC], trackletsAccum[iHC], trapSimulators, digitCountsAccum[iHC], digitIndicesAccum[iHC]);
   } // done with parallel processing
   auto parallelTime = std::chrono::high_resolution_clock::now() - timeParallelStart;
 
-  // accumulate results and add MC labels
+  // accumulate results and add MC labels, the half chambers are ordered by collision
+  int iHC = 0;
   for (int iTrig = 0; iTrig < triggerRecords.size(); ++iTrig) {
-    if (mUseMC) {
-      int currDigitIndex = 0; // counter for all digits which are associated to tracklets
-      int trkltIdxStart = tracklets.size();
-      for (int iTrklt = 0; iTrklt < nTracklets[iTrig]; ++iTrklt) {
-        int tmp = currDigitIndex;
-        for (int iDigitIndex = tmp; iDigitIndex < tmp + digitCountsAccum[iTrig][iTrklt]; ++iDigitIndex) {
-          if (iDigitIndex == tmp) {
-            // for the first digit composing the tracklet we don't need to check for duplicate labels
-            lblTracklets.addElements(trkltIdxStart + iTrklt, lblDigitsPtr->getLabels(digitIndicesAccum[iTrig][iDigitIndex]));
-          } else {
-            // in case more than one digit composes the tracklet we add only the labels
-            // from the additional digit(s) which are not already contained in the previous
-            // digit(s)
-            auto currentLabels = lblTracklets.getLabels(trkltIdxStart + iTrklt);
-            auto newLabels = lblDigitsPtr->getLabels(digitIndicesAccum[iTrig][iDigitIndex]);
-            for (const auto& newLabel : newLabels) {
-              bool alreadyIn = false;
-              for (const auto& currLabel : currentLabels) {
-                if (currLabel.compare(newLabel)) {
-                  alreadyIn = true;
-                  break;
+    int trkltIdxFirst = tracklets.size();
+    for (; iHC < hcRanges.size() && hcRanges[iHC].iTrig == iTrig; ++iHC) {
+      if (mUseMC) {
+        int currDigitIndex = 0; // counter for all digits which are associated to tracklets
+        int trkltIdxStart = tracklets.size();
+        for (int iTrklt = 0; iTrklt < nTracklets[iHC]; ++iTrklt) {
+          int tmp = currDigitIndex;
+          for (int iDigitIndex = tmp; iDigitIndex < tmp + digitCountsAccum[iHC][iTrklt]; ++iDigitIndex) {
+            if (iDigitIndex == tmp) {
+              // for the first digit composing the tracklet we don't need to check for duplicate labels
+              lblTracklets.addElements(trkltIdxStart + iTrklt, lblDigitsPtr->getLabels(digitIndicesAccum[iHC][iDigitIndex]));
+            } else {
+              // in case more than one digit composes the tracklet we add only the labels
+              // from the additional digit(s) which are not already contained in the previous
+              // digit(s)
+              auto currentLabels = lblTracklets.getLabels(trkltIdxStart + iTrklt);
+              auto newLabels = lblDigitsPtr->getLabels(digitIndicesAccum[iHC][iDigitIndex]);
+              for (const auto& newLabel : newLabels) {
+                bool alreadyIn = false;
+                for (const auto& currLabel : currentLabels) {
+                  if (currLabel.compare(newLabel)) {
+                    alreadyIn = true;
+                    break;
+                  }
+                }
+                if (!alreadyIn) {
+                  lblTracklets.addElement(trkltIdxStart + iTrklt, newLabel);
                 }
-              }
-              if (!alreadyIn) {
-                lblTracklets.addElement(trkltIdxStart + iTrklt, newLabel);
               }
             }
+            ++currDigitIndex;
           }
-          ++currDigitIndex;
         }
       }
+      tracklets.insert(tracklets.end(), trackletsAccum[iHC].begin(), trackletsAccum[iHC].end());
     }
-    tracklets.insert(tracklets.end(), trackletsAccum[iTrig].begin(), trackletsAccum[iTrig].end());
-    triggerRecords[iTrig].setTrackletRange(tracklets.size() - nTracklets[iTrig], nTracklets[iTrig]);
+    triggerRecords[iTrig].setTrackletRange(trkltIdxFirst, tracklets.size() - trkltIdxFirst);
   }
 
   auto processingTime = std::chrono::high_resolution_clock::now() - timeProcessingStart;
@@ -116,6 +116,7 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
       if (patterns) {
         patterns->reserve(nPattTot);
       }
+      std::vector<MCTruth::MergeRange> labelRanges;
       while (chid < nFired) {
         for (int ith = 0; ith < nThreads; ith++) {
           if (thrStatIdx[ith] >= mThreads[ith]->stats.size()) {
@@ -133,11 +134,21 @@ void Clusterer::process(int nThreads, PixelReader& reader, CompClusCont* compClu
               patterns->insert(patterns->end(), ptbeg, ptbeg + stat.nPatt);
             }
             if (labelsCl) {
-              labelsCl->mergeAtBack(mThreads[ith]->labels, stat.firstClus, stat.nClus);
+              labelRanges.push_back(MCTruth::MergeRange{&mThreads[ith]->labels, stat.firstClus, stat.nClus});
             }
           }
         }
       }
+      if (labelsCl) { // the labels of all chips are copied at once
+        labelsCl->mergeAtBack(gsl::span<const MCTruth::MergeRange>(labelRanges), [nThreads](size_t nRanges, auto&& copyRange) {
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+          for (size_t ir = 0; ir < nRanges; ir++) {
+            copyRange(ir);
+          }
+        });
+      }
       for (int ith = 0; ith < nThreads; ith++) {
         mThreads[ith]->patterns.clear();
         mThreads[ith]->compClusters.clear();
@@ -147,18 +147,11 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
       } else {
         chip.addNoise(mROFrameMin, mROFrameMin, &mParams);
       }
-      auto& buffer = chip.getPreDigits();
-      if (buffer.empty()) {
+      auto buffer = chip.getSortedROFrameDigits(mROFrameMin);
+      if (!buffer) {
         continue;
       }
-      auto itBeg = buffer.begin();
-      auto iter = itBeg;
-      ULong64_t maxKey = chip.getOrderingKey(mROFrameMin + 1, 0, 0) - 1; // fetch digits with key below that
-      for (; iter != buffer.end(); ++iter) {
-        if (iter->first > maxKey) {
-          break; // is the digit ROFrame from the key > the max requested frame
-        }
-        auto& preDig = iter->second; // preDigit
+      for (auto& preDig : *buffer) {
         if (preDig.charge >= mParams.getChargeThreshold()) {
           int digID = mDigits->size();
           mDigits->emplace_back(chip.getChipIndex(), preDig.row, preDig.col, preDig.charge);
@@ -170,7 +163,7 @@ void Digitizer::fillOutputContainer(uint32_t frameLast)
           }
         }
       }
-      buffer.erase(itBeg, iter);
+      chip.releaseROFrames(mROFrameMin);
     }
     // finalize ROF record
     rcROF.setNEntries(mDigits->size() - rcROF.getFirstEntry()); // number of digits
@@ -20,6 +20,10 @@
 #include "MathUtils/Cartesian.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "DetectorsVertexing/HelixHelper.h"
+#include <gsl/span>
+#include <algorithm>
+#include <utility>
+#include <vector>
 
 namespace o2
 {
@@ -94,6 +98,8 @@ class DCAFitterN
   using ArrTrPos = std::array<Vec3D, N>;         // container of Track positions
 
  public:
+  using Combination = std::array<int, N>; // indices of the prongs of a combination in the batch of tracks
+
   static constexpr int getNProngs() { return N; }
 
   DCAFitterN() = default;
@@ -186,9 +192,24 @@ class DCAFitterN
 
   template <class... Tr>
   int process(const Tr&... args);
+
+  ///< fit many combinations of the tracks, tracks[comb[i]] being the i-th prong of the combination comb.
+  ///  The circle parameters of every track are calculated once for all combinations it enters. For each combination
+  ///  with at least 1 candidate onCandidates(icomb, fitter) is called with a fitter in the state left by process(),
+  ///  such that the candidates can be queried as usual. Returns the number of combinations with candidates.
+  template <typename F>
+  int processBatch(gsl::span<const Track> tracks, gsl::span<const Combination> combinations, F&& onCandidates);
+
+  ///< same as above, with the fits dispatched by the caller provided parallelFor(nComb, fitComb), which must call
+  ///  fitComb(fitter, icomb) once for every icomb in [0, nComb). Concurrent calls must use distinct copies of this
+  ///  fitter, onCandidates is then called concurrently as well.
+  template <typename F, typename ParallelFor>
+  int processBatch(gsl::span<const Track> tracks, gsl::span<const Combination> combinations, F&& onCandidates, ParallelFor&& parallelFor);
+
   void print() const;
 
  protected:
+  int fit();
   bool calcPCACoefs();
   bool calcInverseWeight();
   void calcResidDerivatives();
@@ -315,6 +336,53 @@ int DCAFitterN<N, Args...>::process(const Tr&... args)
   for (int i = 0; i < N; i++) {
     mTrAux[i].set(*mOrigTrPtr[i], mBz);
   }
+  return fit();
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+template <typename F>
+int DCAFitterN<N, Args...>::processBatch(gsl::span<const Track> tracks, gsl::span<const Combination> combinations, F&& onCandidates)
+{
+  return processBatch(tracks, combinations, std::forward<F>(onCandidates), [this](int nComb, auto&& fitComb) {
+    for (int icomb = 0; icomb < nComb; icomb++) {
+      fitComb(*this, icomb);
+    }
+  });
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+template <typename F, typename ParallelFor>
+int DCAFitterN<N, Args...>::processBatch(gsl::span<const Track> tracks, gsl::span<const Combination> combinations, F&& onCandidates, ParallelFor&& parallelFor)
+{
+  std::vector<TrackAuxPar> trAux(tracks.size());
+  for (size_t it = 0; it < tracks.size(); it++) {
+    trAux[it].set(tracks[it], mBz);
+  }
+  const int nComb = combinations.size();
+  std::vector<char> hasCandidates(nComb, 0);
+  auto fitComb = [&](DCAFitterN& fitter, int icomb) {
+    const auto& comb = combinations[icomb];
+    for (int i = 0; i < N; i++) {
+      fitter.mOrigTrPtr[i] = &tracks[comb[i]];
+      fitter.mTrAux[i] = trAux[comb[i]];
+    }
+    fitter.clear();
+    if (fitter.fit()) {
+      hasCandidates[icomb] = 1;
+      onCandidates(icomb, fitter);
+    }
+  };
+  parallelFor(nComb, fitComb);
+  return std::count(hasCandidates.begin(), hasCandidates.end(), 1);
+}
+
+///_________________________________________________________________________
+template <int N, typename... Args>
+int DCAFitterN<N, Args...>::fit()
+{
+  // fit PCA of N tracks assigned with their auxiliary parameters
   if (!mCrossings.set(mTrAux[0], *mOrigTrPtr[0], mTrAux[1], *mOrigTrPtr[1], mMaxDXYIni)) { // even for N>2 it should be enough to test just 1 loop
     return 0;                                                                  // no crossing
   }
@@ -17,7 +17,9 @@
 #define O2_PVERTEXER_H
 
 #include <array>
+#include <memory>
 #include <utility>
+#include <vector>
 #include "CommonConstants/LHCConstants.h"
 #include "CommonDataFormat/TimeStamp.h"
 #include "CommonDataFormat/BunchFilling.h"
@@ -116,7 +118,7 @@ class PVertexer
   void initMeanVertexConstraint();
   void applyConstraint(VertexSeed& vtxSeed) const;
   bool upscaleSigma(VertexSeed& vtxSeed) const;
-  bool relateTrackToMeanVertex(o2::track::TrackParCov& trc, float vtxErr2) const;
+  int relateTracksToMeanVertex(std::vector<o2::track::TrackParCov>& trcs, bool* accepted) const;
 
   template <typename TR>
   void createTracksPool(const TR& tracks, gsl::span<const o2d::GlobalTrackID> gids);
@@ -205,23 +207,25 @@ void PVertexer::createTracksPool(const TR& tracks, gsl::span<const o2d::GlobalTr
   mTracksPool.clear();
   auto ntGlo = tracks.size();
   std::vector<int> sortedTrackID(ntGlo);
-  mTracksPool.reserve(ntGlo);
   std::iota(sortedTrackID.begin(), sortedTrackID.end(), 0);
   std::sort(sortedTrackID.begin(), sortedTrackID.end(), [&tracks](int i, int j) {
     return tracks[i].timeEst.getTimeStamp() < tracks[j].timeEst.getTimeStamp();
   });
 
   // check all containers
-  float vtxErr2 = 0.5 * (mMeanVertex.getSigmaX2() + mMeanVertex.getSigmaY2());
-  o2d::DCA dca;
+  std::vector<o2::track::TrackParCov> trcs(ntGlo);
+  std::unique_ptr<bool[]> accepted(new bool[ntGlo]);
+  for (uint32_t i = 0; i < ntGlo; i++) {
+    trcs[i] = tracks[sortedTrackID[i]];
+  }
+  mTracksPool.reserve(relateTracksToMeanVertex(trcs, accepted.get()));
 
   for (uint32_t i = 0; i < ntGlo; i++) {
-    int id = sortedTrackID[i];
-    o2::track::TrackParCov trc = tracks[id];
-    if (!relateTrackToMeanVertex(trc, vtxErr2)) {
+    if (!accepted[i]) {
       continue;
     }
-    auto& tvf = mTracksPool.emplace_back(trc, tracks[id].getTimeMUS(), id, gids[id], mPVParams->addTimeSigma2, mPVParams->addZSigma2);
+    int id = sortedTrackID[i];
+    auto& tvf = mTracksPool.emplace_back(trcs[i], tracks[id].getTimeMUS(), id, gids[id], mPVParams->addTimeSigma2, mPVParams->addZSigma2);
   }
 
   if (mTracksPool.empty()) {
@@ -955,12 +955,20 @@ SeedHistoTZ PVertexer::buildHistoTZ(const VertexingInput& input)
 }
 
 //______________________________________________
-bool PVertexer::relateTrackToMeanVertex(o2::track::TrackParCov& trc, float vtxErr2) const
+int PVertexer::relateTracksToMeanVertex(std::vector<o2::track::TrackParCov>& trcs, bool* accepted) const
 {
-  o2d::DCA dca;
-  return o2::base::Propagator::Instance()->propagateToDCA(mMeanVertex, trc, mBz, 2.0f,
-                                                          o2::base::Propagator::MatCorrType::USEMatCorrLUT, &dca, nullptr, 0, mPVParams->dcaTolerance) &&
-         (dca.getY() * dca.getY() / (dca.getSigmaY2() + vtxErr2) < mPVParams->pullIniCut);
+  // propagate the tracks to their DCA to the mean vertex, all at once, and flag those compatible with it
+  float vtxErr2 = 0.5 * (mMeanVertex.getSigmaX2() + mMeanVertex.getSigmaY2());
+  std::vector<o2d::DCA> dcas(trcs.size());
+  o2::base::Propagator::Instance()->propagateBatchToDCA(mMeanVertex, trcs.data(), trcs.size(), accepted, mBz, 2.0f,
+                                                        o2::base::Propagator::MatCorrType::USEMatCorrLUT, dcas.data(), nullptr, 0, mPVParams->dcaTolerance);
+  int nAcc = 0;
+  for (size_t i = 0; i < trcs.size(); i++) {
+    const auto& dca = dcas[i];
+    accepted[i] = accepted[i] && (dca.getY() * dca.getY() / (dca.getSigmaY2() + vtxErr2) < mPVParams->pullIniCut);
+    nAcc += accepted[i];
+  }
+  return nAcc;
 }
 
 //______________________________________________
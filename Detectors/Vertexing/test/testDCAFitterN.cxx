@@ -387,5 +387,88 @@ BOOST_AUTO_TEST_CASE(DCAFitterNProngs)
   outStream.Close();
 }
 
+BOOST_AUTO_TEST_CASE(DCAFitterNBatch)
+{
+  // the batched fit must give the same candidates as the fit of each combination
+  constexpr int NDecays = 200;
+  TGenPhaseSpace genPHS;
+  constexpr double pion = 0.13957;
+  constexpr double k0 = 0.49761;
+  std::vector<double> k0dec = {pion, pion};
+  std::vector<int> forceQ{1, 1};
+  std::vector<o2::track::TrackParCov> vctracks, tracks;
+  Vec3D vtxGen;
+  double bz = 5.0;
+  for (int iev = 0; iev < NDecays; iev++) {
+    generate(vtxGen, vctracks, bz, genPHS, k0, k0dec, forceQ);
+    tracks.insert(tracks.end(), vctracks.begin(), vctracks.end());
+  }
+  // all combinations of positive (even) and negative (odd) tracks, most of them not coming from the same decay
+  std::vector<o2::vertexing::DCAFitterN<2>::Combination> combinations;
+  for (int ip = 0; ip < 2 * NDecays; ip += 2) {
+    for (int in = 1; in < 2 * NDecays; in += 2) {
+      combinations.push_back({ip, in});
+    }
+  }
+
+  for (bool useAbsDCA : {true, false}) {
+    o2::vertexing::DCAFitterN<2> ft;
+    ft.setBz(bz);
+    ft.setUseAbsDCA(useAbsDCA);
+    std::vector<int> nCand(combinations.size(), 0);
+    std::vector<float> chi2(combinations.size(), -1.);
+    std::vector<std::array<float, 3>> pca(combinations.size());
+    for (size_t ic = 0; ic < combinations.size(); ic++) {
+      nCand[ic] = ft.process(tracks[combinations[ic][0]], tracks[combinations[ic][1]]);
+      if (nCand[ic]) {
+        chi2[ic] = ft.getChi2AtPCACandidate();
+        pca[ic] = ft.getPCACandidatePos();
+      }
+    }
+    for (int nThreads : {1, 4}) {
+      int nDiff = 0;
+      std::vector<char> found(combinations.size(), 0);
+      auto onCandidates = [&](int ic, const o2::vertexing::DCAFitterN<2>& fitter) {
+        found[ic] = 1;
+        if (fitter.getNCandidates() != nCand[ic] || fitter.getChi2AtPCACandidate() != chi2[ic] || fitter.getPCACandidatePos() != pca[ic]) {
+#ifdef WITH_OPENMP
+#pragma omp atomic
+#endif
+          nDiff++;
+        }
+      };
+      int nFound = 0;
+      if (nThreads == 1) {
+        nFound = ft.processBatch(tracks, combinations, onCandidates);
+      } else {
+        nFound = ft.processBatch(tracks, combinations, onCandidates, [&ft, nThreads](int nComb, auto&& fitComb) {
+#ifdef WITH_OPENMP
+#pragma omp parallel num_threads(nThreads)
+#endif
+          {
+            auto fitter = ft;
+#ifdef WITH_OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+            for (int ic = 0; ic < nComb; ic++) {
+              fitComb(fitter, ic);
+            }
+          }
+        });
+      }
+      int nExpected = 0;
+      for (size_t ic = 0; ic < combinations.size(); ic++) {
+        nExpected += nCand[ic] > 0;
+        nDiff += (nCand[ic] > 0) != (found[ic] != 0);
+      }
+      LOG(INFO) << "Batch fit of " << combinations.size() << " combinations with " << nThreads << " threads: "
+                << nFound << " with candidates, " << nDiff << " differences";
+      BOOST_CHECK(nExpected > NDecays / 2);
+      BOOST_CHECK_EQUAL(nFound, nExpected);
+      BOOST_CHECK_EQUAL(nDiff, 0);
+    }
+  }
+}
+
 } // namespace vertexing
 } // namespace o2
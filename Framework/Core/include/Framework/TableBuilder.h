@@ -746,6 +746,15 @@ class TableBuilder
     visitBuilders(pack, [s](auto& holder) { return holder.builder->Reserve(s).ok(); });
   }
 
+  /// Reserve space for @a s rows in the columns of table T, to be used
+  /// after the corresponding cursor<T>() has been created.
+  template <typename T>
+  auto reserve(int s)
+  {
+    using persistent_columns_pack = typename T::table_t::persistent_columns_t;
+    reserveColumns(persistent_columns_pack{}, s);
+  }
+
   /// Invoke the appropriate visitor on the various builders
   template <typename... ARGS, typename V>
   auto visitBuilders(o2::framework::pack<ARGS...> pack, V&& visitor)
@@ -777,6 +786,12 @@ class TableBuilder
     return this->template persist<E>(columnNames);
   }
 
+  template <typename... C>
+  auto reserveColumns(o2::framework::pack<C...>, int s)
+  {
+    reserve(o2::framework::pack<typename C::type...>{}, s);
+  }
+
   bool (*mFinalizer)(std::shared_ptr<arrow::Schema> schema, std::vector<std::shared_ptr<arrow::Array>>& arrays, void* holders);
   void* mHolders;
   arrow::MemoryPool* mMemoryPool;
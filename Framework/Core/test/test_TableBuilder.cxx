@@ -344,6 +344,26 @@ BOOST_AUTO_TEST_CASE(TestSoAIntegration)
   }
 }
 
+BOOST_AUTO_TEST_CASE(TestSoAReserve)
+{
+  TableBuilder builder;
+  auto rowWriter = builder.cursor<TestTable>();
+  builder.reserve<TestTable>(6);
+  for (uint64_t i = 0; i < 8; ++i) {
+    rowWriter(0, i * 10, i);
+  }
+  auto table = builder.finalize();
+  BOOST_REQUIRE_EQUAL(table->num_rows(), 8);
+  auto readBack = TestTable{table};
+
+  size_t i = 0;
+  for (auto& row : readBack) {
+    BOOST_CHECK_EQUAL(row.x(), i * 10);
+    BOOST_CHECK_EQUAL(row.y(), i);
+    ++i;
+  }
+}
+
 BOOST_AUTO_TEST_CASE(TestDataAllocatorReturnType)
 {
   std::vector<OutputRoute> routes;
@@ -54,13 +54,35 @@ void GPUReconstructionConvert::ConvertNativeToClusterData(o2::tpc::ClusterNative
     }
     nClusters[i] = nClSlice;
     clusters[i].reset(new GPUTPCClusterData[nClSlice]);
+    // triggered data: transform the clusters of the slice in one batch
+    std::vector<int> slices, rows;
+    std::vector<float> pads, times, xs, ys, zs;
+    if (continuousMaxTimeBin == 0) {
+      slices.assign(nClSlice, i);
+      rows.reserve(nClSlice);
+      pads.reserve(nClSlice);
+      times.reserve(nClSlice);
+      for (int j = 0; j < GPUCA_ROW_COUNT; j++) {
+        for (unsigned int k = 0; k < native->nClusters[i][j]; k++) {
+          rows.emplace_back(j);
+          pads.emplace_back(native->clusters[i][j][k].getPad());
+          times.emplace_back(native->clusters[i][j][k].getTime());
+        }
+      }
+      xs.resize(nClSlice);
+      ys.resize(nClSlice);
+      zs.resize(nClSlice);
+      transform->TransformBatch(nClSlice, slices.data(), rows.data(), pads.data(), times.data(), xs.data(), ys.data(), zs.data());
+    }
     nClSlice = 0;
     for (int j = 0; j < GPUCA_ROW_COUNT; j++) {
       for (unsigned int k = 0; k < native->nClusters[i][j]; k++) {
         const auto& clin = native->clusters[i][j][k];
         float x = 0, y = 0, z = 0;
         if (continuousMaxTimeBin == 0) {
-          transform->Transform(i, j, clin.getPad(), clin.getTime(), x, y, z);
+          x = xs[nClSlice];
+          y = ys[nClSlice];
+          z = zs[nClSlice];
         } else {
           transform->TransformInTimeFrame(i, j, clin.getPad(), clin.getTime(), x, y, z, continuousMaxTimeBin);
         }
@@ -147,6 +147,11 @@ class TPCFastSpaceChargeCorrection : public FlatObject
   ///
   GPUd() int getCorrection(int slice, int row, float u, float v, float& dx, float& du, float& dv) const;
 
+#if !defined(GPUCA_GPUCODE)
+  /// Batched version of getCorrection() for n points on the CPU
+  void getCorrectionBatch(int n, const int* slice, const int* row, const float* u, const float* v, float* dx, float* du, float* dv) const;
+#endif
+
   /// inverse correction: Corrected U and V -> coorrected X
   GPUd() void getCorrectionInvCorrectedX(int slice, int row, float corrU, float corrV, float& corrX) const;
 
@@ -136,6 +136,52 @@ void TPCFastTransform::finishConstruction()
   mCorrection.moveBufferTo(mFlatBufferPtr);
 }
 
+#if !defined(GPUCA_GPUCODE)
+void TPCFastTransform::TransformBatch(int n, const int* slice, const int* row, const float* pad, const float* time, float* x, float* y, float* z, float vertexTime) const
+{
+  /// Batched cluster transformation, see Transform()
+  ///
+  /// The clusters are processed in chunks. Each step of the transformation is done for the whole chunk,
+  /// such that the loops over the clusters are vectorized.
+  ///
+
+  constexpr int ChunkSize = 64;
+  float u[ChunkSize], v[ChunkSize], dx[ChunkSize], du[ChunkSize], dv[ChunkSize];
+
+  for (int iStart = 0; iStart < n; iStart += ChunkSize) {
+    const int nChunk = (n - iStart < ChunkSize) ? n - iStart : ChunkSize;
+    const int* chunkSlice = slice + iStart;
+    const int* chunkRow = row + iStart;
+
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < nChunk; i++) {
+      convPadTimeToUV(chunkSlice[i], chunkRow[i], pad[iStart + i], time[iStart + i], u[i], v[i], vertexTime);
+      dx[i] = du[i] = dv[i] = 0.f;
+    }
+
+    if (mApplyCorrection) {
+      mCorrection.getCorrectionBatch(nChunk, chunkSlice, chunkRow, u, v, dx, du, dv);
+    }
+
+#ifdef WITH_OPENMP
+#pragma omp simd
+#endif
+    for (int i = 0; i < nChunk; i++) {
+      float cx = getGeometry().getRowInfo(chunkRow[i]).x + dx[i];
+      float cy, cz;
+      getGeometry().convUVtoLocal(chunkSlice[i], u[i] + du[i], v[i] + dv[i], cy, cz);
+      float dzTOF = 0;
+      getTOFcorrection(chunkSlice[i], chunkRow[i], cx, cy, cz, dzTOF);
+      x[iStart + i] = cx;
+      y[iStart + i] = cy;
+      z[iStart + i] = cz + dzTOF;
+    }
+  }
+}
+#endif
+
 void TPCFastTransform::print() const
 {
 #if !defined(GPUCA_GPUCODE)
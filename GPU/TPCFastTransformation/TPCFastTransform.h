@@ -131,6 +131,11 @@ class TPCFastTransform : public FlatObject
   ///
   GPUd() void Transform(int slice, int row, float pad, float time, float& x, float& y, float& z, float vertexTime = 0) const;
 
+#if !defined(GPUCA_GPUCODE)
+  /// Batched version of Transform() for n clusters on the CPU
+  void TransformBatch(int n, const int* slice, const int* row, const float* pad, const float* time, float* x, float* y, float* z, float vertexTime = 0) const;
+#endif
+
   /// Transformation in the time frame
   GPUd() void TransformInTimeFrame(int slice, int row, float pad, float time, float& x, float& y, float& z, float maxTimeBin) const;
 
@@ -254,6 +254,7 @@ class ITSDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    mDigitizer.setNThreads(dopt.nThreads);
   }
 };
 
@@ -297,6 +298,7 @@ class MFTDPLDigitizerTask : public ITSMFTDPLDigitizerTask
     digipar.setNoisePerPixel(dopt.noisePerPixel);     // noise level
     digipar.setTimeOffset(dopt.timeOffset);
     digipar.setNSimSteps(dopt.nSimSteps);
+    mDigitizer.setNThreads(dopt.nThreads);
   }
 };
 
@@ -42,6 +42,14 @@
 #include "CommonDataFormat/RangeReference.h"
 #include "SimConfig/DigiParams.h"
 #include <filesystem>
+#include <limits>
+#include <memory>
+#include <random>
+#include "TROOT.h"
+#include "TRandom3.h"
+#ifdef WITH_OPENMP
+#include <omp.h>
+#endif
 
 using namespace o2::framework;
 using SubSpecificationType = o2::framework::DataAllocator::SubSpecificationType;
@@ -170,12 +178,39 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     }
     mDigitizer.setContinuousReadout(!triggeredMode);
 
+    mNThreads = std::max(1, ic.options().get<int>("TPCthreads"));
+    if (mNThreads > 1) {
+      if (mInternalWriter) {
+        LOG(WARNING) << "TPC: Internal writer mode digitizes the sectors serially, ignoring " << mNThreads << " threads";
+        mNThreads = 1;
+      } else {
+#ifdef WITH_OPENMP
+        LOG(INFO) << "TPC: Digitizing the sectors of this lane with " << mNThreads << " threads";
+        ROOT::EnableThreadSafety();
+#else
+        LOG(WARNING) << "TPC: Multi-threaded digitization needs OpenMP, digitizing the sectors serially";
+        mNThreads = 1;
+#endif
+      }
+    }
+
+    // the random rings are filled once from this seed and shared by all sectors, each sector starts at a position
+    // of the rings derived from the seed, the timeframe and the sector, so that the digits of a sector do not depend
+    // on the number of threads. A seed of 0 would make TRandom3 seed itself from the time
+    mRandomSeed = 1 + gRandom->Integer(std::numeric_limits<unsigned int>::max() - 1);
+    LOG(INFO) << "TPC: Random seed of the digitization " << mRandomSeed;
+    TRandom3 random(mRandomSeed);
+    mThreadProcessing.clear();
+    mThreadProcessing.emplace_back(o2::tpc::Digitizer::createProcessing(random));
+    mDigitizer.setProcessing(mThreadProcessing[0]);
+
     // we send the GRP data once if the corresponding output channel is available
     // and set the flag to false after
     mWriteGRP = true;
   }
 
-  void writeToROOTFile()
+  void writeToROOTFile(std::vector<o2::tpc::Digit>& digits, o2::dataformats::MCTruthContainer<o2::MCCompLabel>& labels,
+                       std::vector<o2::tpc::CommonMode>& commonMode)
   {
     if (!mInternalROOTFlushFile) {
       std::stringstream tmp;
@@ -188,7 +223,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     {
       std::stringstream brname;
       brname << "TPCDigit_" << mSector;
-      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &mDigits);
+      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &digits);
       br->Fill();
       br->ResetAddress();
     }
@@ -196,7 +231,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       // labels
       std::stringstream brname;
       brname << "TPCDigitMCTruth_" << mSector;
-      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &mLabels);
+      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &labels);
       br->Fill();
       br->ResetAddress();
     }
@@ -204,7 +239,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       // common
       std::stringstream brname;
       brname << "TPCCommonMode_" << mSector;
-      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &mCommonMode);
+      auto br = o2::base::getOrMakeBranch(*mInternalROOTFlushTTree, brname.str().c_str(), &commonMode);
       br->Fill();
       br->ResetAddress();
     }
@@ -222,22 +257,53 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       cdb.setGainMapFromFile("GainMap.root");
     }
 
-    for (auto it = pc.inputs().begin(), end = pc.inputs().end(); it != end; ++it) {
-      for (auto const& inputref : it) {
-        process(pc, inputref);
-        if (mInternalWriter) {
-          mInternalROOTFlushTTree->SetEntries(mFlushCounter);
-          mInternalROOTFlushFile->Write("", TObject::kOverwrite);
-          mInternalROOTFlushFile->Close();
-          // delete mInternalROOTFlushTTree; --> automatically done by ->Close()
-          delete mInternalROOTFlushFile;
-          mInternalROOTFlushFile = nullptr;
+    if (mNThreads > 1) {
+      std::vector<framework::DataRef> inputrefs;
+      for (auto it = pc.inputs().begin(), end = pc.inputs().end(); it != end; ++it) {
+        for (auto const& inputref : it) {
+          inputrefs.push_back(inputref);
+        }
+      }
+      processSectors(pc, inputrefs);
+    } else {
+      for (auto it = pc.inputs().begin(), end = pc.inputs().end(); it != end; ++it) {
+        for (auto const& inputref : it) {
+          process(pc, inputref);
+          if (mInternalWriter) {
+            mInternalROOTFlushTTree->SetEntries(mFlushCounter);
+            mInternalROOTFlushFile->Write("", TObject::kOverwrite);
+            mInternalROOTFlushFile->Close();
+            // delete mInternalROOTFlushTTree; --> automatically done by ->Close()
+            delete mInternalROOTFlushFile;
+            mInternalROOTFlushFile = nullptr;
+          }
+          //TODO: make generic reset method?
+          mFlushCounter = 0;
         }
-        //TODO: make generic reset method?
-        mFlushCounter = 0;
-        mDigitCounter = 0;
       }
     }
+    mTFCounter++;
+  }
+
+  // we publish the GRP data once if the output channel is there
+  void sendROMode(framework::ProcessingContext& pc)
+  {
+    bool isContinuous = mDigitizer.isContinuousReadout();
+    if (mWriteGRP && pc.outputs().isAllowed({"TPC", "ROMode", 0})) {
+      auto roMode = isContinuous ? o2::parameters::GRPObject::CONTINUOUS : o2::parameters::GRPObject::PRESENT;
+      LOG(INFO) << "TPC: Sending ROMode= " << (isContinuous ? "Continuous" : "Triggered") << " to GRPUpdater";
+      pc.outputs().snapshot(Output{"TPC", "ROMode", 0, Lifetime::Timeframe}, roMode);
+    }
+    mWriteGRP = false;
+  }
+
+  // start position of the random rings for a sector in the current timeframe
+  size_t getRandomRingsPosition(int sector) const
+  {
+    std::seed_seq seedSequence{mRandomSeed, mTFCounter, static_cast<unsigned int>(sector)};
+    unsigned int position = 0;
+    seedSequence.generate(&position, &position + 1);
+    return position;
   }
 
   // process one sector
@@ -253,15 +319,7 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
     }
     auto const* dh = DataRefUtils::getHeader<o2::header::DataHeader*>(inputref);
 
-    bool isContinuous = mDigitizer.isContinuousReadout();
-    // we publish the GRP data once if the output channel is there
-    if (mWriteGRP && pc.outputs().isAllowed({"TPC", "ROMode", 0})) {
-      auto roMode = isContinuous ? o2::parameters::GRPObject::CONTINUOUS : o2::parameters::GRPObject::PRESENT;
-      LOG(INFO) << "TPC: Sending ROMode= " << (mDigitizer.isContinuousReadout() ? "Continuous" : "Triggered")
-                << " to GRPUpdater from channel " << dh->subSpecification;
-      pc.outputs().snapshot(Output{"TPC", "ROMode", 0, Lifetime::Timeframe}, roMode);
-    }
-    mWriteGRP = false;
+    sendROMode(pc);
 
     // extract which sector to treat
     auto const* sectorHeader = DataRefUtils::getHeader<TPCSectorHeader*>(inputref);
@@ -341,111 +399,235 @@ class TPCDPLDigitizerTask : public BaseDPLDigitizer
       throw std::runtime_error("Digitizer can only work on single sectors");
     }
 
-    mDigitizer.setSector(sector);
     mDigitizer.init();
 
-    auto& eventParts = context->getEventParts();
-
-    auto flushDigitsAndLabels = [this, digitsAccum, &labelAccum, &commonModeAccum](bool finalFlush = false) {
+    auto flushDigitsAndLabels = [this, digitsAccum, &labelAccum, &commonModeAccum](std::vector<o2::tpc::Digit>& digits,
+                                                                                  o2::dataformats::MCTruthContainer<o2::MCCompLabel>& labels,
+                                                                                  std::vector<o2::tpc::CommonMode>& commonMode) {
       mFlushCounter++;
-      // flush previous buffer
-      mDigits.clear();
-      mLabels.clear();
-      mCommonMode.clear();
-      mDigitizer.flush(mDigits, mLabels, mCommonMode, finalFlush);
-      LOG(INFO) << "TPC: Flushed " << mDigits.size() << " digits, " << mLabels.getNElements() << " labels and " << mCommonMode.size() << " common mode entries";
+      LOG(INFO) << "TPC: Flushed " << digits.size() << " digits, " << labels.getNElements() << " labels and " << commonMode.size() << " common mode entries";
 
       if (mInternalWriter) {
         // the natural place to write out this independent datachunk immediately ...
-        writeToROOTFile();
+        writeToROOTFile(digits, labels, commonMode);
       } else {
         // ... or to accumulate and later forward to next DPL proc
-        std::copy(mDigits.begin(), mDigits.end(), std::back_inserter(*digitsAccum));
+        std::copy(digits.begin(), digits.end(), std::back_inserter(*digitsAccum));
         if (mWithMCTruth) {
-          labelAccum.mergeAtBack(mLabels);
+          labelAccum.mergeAtBack(labels);
         }
-        std::copy(mCommonMode.begin(), mCommonMode.end(), std::back_inserter(commonModeAccum));
+        std::copy(commonMode.begin(), commonMode.end(), std::back_inserter(commonModeAccum));
       }
-      mDigitCounter += mDigits.size();
     };
 
-    if (isContinuous) {
-      auto& hbfu = o2::raw::HBFUtils::Instance();
-      double time = hbfu.getFirstIRofTF(o2::InteractionRecord(0, hbfu.orbitFirstSampled)).bc2ns() / 1000.;
-      mDigitizer.setOutputDigitTimeOffset(time);
-      mDigitizer.setStartTime(irecords[0].getTimeNS() / 1000.f);
+    TStopwatch timer;
+    timer.Start();
+
+    digitizeSector(mDigitizer, *context, mSimChains, sector, eventAccum, flushDigitsAndLabels);
+
+    if (!mInternalWriter) {
+      // send out to next stage
+      snapshotEvents(eventAccum);
+      // snapshotDigits(digitsAccum); --> done automatically
+      snapshotCommonMode(commonModeAccum);
+      snapshotLabels(labelAccum);
+    }
+
+    timer.Stop();
+    LOG(INFO) << "TPC: Digitization took " << timer.CpuTime() << "s";
+  }
+
+  /// digitization output of one sector, accumulated over the collisions of the timeframe
+  struct SectorOutput {
+    std::vector<o2::tpc::Digit> digits;
+    o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+    std::vector<o2::tpc::CommonMode> commonMode;
+    std::vector<DigiGroupRef> events;
+  };
+
+  // process all sectors of the timeframe, digitizing them concurrently and publishing them in the input order
+  void processSectors(framework::ProcessingContext& pc, std::vector<framework::DataRef> const& inputrefs)
+  {
+    const int nSectors = inputrefs.size();
+    std::vector<decltype(pc.inputs().get<o2::steer::DigitizationContext*>(framework::DataRef{}))> contexts;
+    std::vector<TPCSectorHeader> sectorHeaders;
+    for (int is = 0; is < nSectors; is++) {
+      contexts.emplace_back(pc.inputs().get<o2::steer::DigitizationContext*>(inputrefs[is]));
+      auto const* sectorHeader = DataRefUtils::getHeader<TPCSectorHeader*>(inputrefs[is]);
+      if (sectorHeader == nullptr) {
+        throw std::runtime_error("TPC: Sector header missing");
+      }
+      if (sectorHeader->sector() < 0 || sectorHeader->sector() >= TPCSectorHeader::NSectors) {
+        throw std::runtime_error("Digitizer can only work on single sectors");
+      }
+      sectorHeaders.push_back(*sectorHeader);
+    }
+    if (nSectors == 0 || contexts[0]->getEventRecords().size() == 0) {
+      LOG(INFO) << "TPC: No collisions to process";
+      return;
+    }
+
+    sendROMode(pc);
+
+    // everything shared by the threads is set up here: the sim chains and the processing steps (one set per thread,
+    // since reading the same TChain concurrently is not allowed and the random ring positions are advanced),
+    // the space-charge maps and the digitizers of the sectors, which only share the read-only space-charge maps
+    const int nThreads = std::min(mNThreads, nSectors);
+    if (mThreadSimChains.size() < nThreads) {
+      mThreadSimChains.resize(nThreads);
+    }
+    while (mThreadProcessing.size() < nThreads) {
+      mThreadProcessing.emplace_back(mThreadProcessing[0].copy());
     }
+    for (auto& chains : mThreadSimChains) {
+      contexts[0]->initSimChains(o2::detectors::DetID::TPC, chains);
+    }
+    mDigitizer.init();
+    if (mSectorDigitizers.size() < nSectors) {
+      mSectorDigitizers.resize(nSectors);
+    }
+    for (int is = 0; is < nSectors; is++) {
+      auto& digitizer = mSectorDigitizers[is];
+      if (!digitizer) {
+        digitizer = std::make_unique<o2::tpc::Digitizer>();
+        digitizer->setUseSCDistortions(mDigitizer);
+      }
+    }
+    std::vector<SectorOutput> outputs(nSectors);
 
     TStopwatch timer;
     timer.Start();
+#ifdef WITH_OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(nThreads)
+#endif
+    for (int is = 0; is < nSectors; is++) {
+#ifdef WITH_OPENMP
+      const int threadID = omp_get_thread_num();
+#else
+      const int threadID = 0;
+#endif
+      mSectorDigitizers[is]->setProcessing(mThreadProcessing[threadID]);
+      auto& output = outputs[is];
+      auto accumulate = [this, &output](std::vector<o2::tpc::Digit>& digits, o2::dataformats::MCTruthContainer<o2::MCCompLabel>& labels,
+                                        std::vector<o2::tpc::CommonMode>& commonMode) {
+        std::copy(digits.begin(), digits.end(), std::back_inserter(output.digits));
+        if (mWithMCTruth) {
+          output.labels.mergeAtBack(labels);
+        }
+        std::copy(commonMode.begin(), commonMode.end(), std::back_inserter(output.commonMode));
+      };
+      digitizeSector(*mSectorDigitizers[is], *contexts[is], mThreadSimChains[threadID], sectorHeaders[is].sector(), output.events, accumulate);
+    }
+    timer.Stop();
+    LOG(INFO) << "TPC: Digitization of " << nSectors << " sectors with " << nThreads << " threads took " << timer.RealTime() << "s";
+
+    for (int is = 0; is < nSectors; is++) {
+      auto subSpec = static_cast<SubSpecificationType>(DataRefUtils::getHeader<o2::header::DataHeader*>(inputrefs[is])->subSpecification);
+      const auto& header = sectorHeaders[is];
+      auto& out = outputs[is];
+      LOG(INFO) << "TPC: Send " << out.digits.size() << " digits for sector " << header.sector() << " channel " << subSpec;
+      pc.outputs().snapshot(Output{"TPC", "DIGITS", subSpec, Lifetime::Timeframe, header}, out.digits);
+      pc.outputs().snapshot(Output{"TPC", "DIGTRIGGERS", subSpec, Lifetime::Timeframe, header}, out.events);
+      pc.outputs().snapshot(Output{"TPC", "COMMONMODE", subSpec, Lifetime::Timeframe, header}, out.commonMode);
+      if (mWithMCTruth) {
+        auto& sharedlabels = pc.outputs().make<o2::dataformats::ConstMCTruthContainer<o2::MCCompLabel>>(Output{"TPC", "DIGITSMCTR", subSpec, Lifetime::Timeframe, header});
+        out.labels.flatten_to(sharedlabels);
+      }
+      mListOfSectors.push_back(header.sector());
+    }
+  }
+
+  // digitize all collisions of the context for one sector, used by both the serial and the concurrent processing.
+  // Every flushed chunk of digits, labels and common mode is handed to onFlush, the digit groups are added to events.
+  // Thread-safe as long as the digitizer, its processing steps and the chains are used by a single thread
+  template <typename F>
+  void digitizeSector(o2::tpc::Digitizer& digitizer, o2::steer::DigitizationContext const& context, std::vector<TChain*> const& simChains,
+                      int sector, std::vector<DigiGroupRef>& events, F&& onFlush) const
+  {
+    auto& irecords = context.getEventRecords();
+    auto& eventParts = context.getEventParts();
+    bool isContinuous = digitizer.isContinuousReadout();
+    digitizer.setSector(sector);
+    digitizer.setRandomRingsPosition(getRandomRingsPosition(sector));
+
+    std::vector<o2::tpc::Digit> digits;
+    o2::dataformats::MCTruthContainer<o2::MCCompLabel> labels;
+    std::vector<o2::tpc::CommonMode> commonMode;
+    size_t nDigits = 0;
+    auto flushDigitsAndLabels = [&](bool finalFlush = false) {
+      // flush previous buffer
+      digits.clear();
+      labels.clear();
+      commonMode.clear();
+      digitizer.flush(digits, labels, commonMode, finalFlush);
+      onFlush(digits, labels, commonMode);
+      nDigits += digits.size();
+    };
+
+    if (isContinuous) {
+      auto& hbfu = o2::raw::HBFUtils::Instance();
+      double time = hbfu.getFirstIRofTF(o2::InteractionRecord(0, hbfu.orbitFirstSampled)).bc2ns() / 1000.;
+      digitizer.setOutputDigitTimeOffset(time);
+      digitizer.setStartTime(irecords[0].getTimeNS() / 1000.f);
+    }
 
     // loop over all composite collisions given from context
     // (aka loop over all the interaction records)
+    std::vector<o2::tpc::HitGroup> hitsLeft;
+    std::vector<o2::tpc::HitGroup> hitsRight;
     for (int collID = 0; collID < irecords.size(); ++collID) {
       const double eventTime = irecords[collID].getTimeNS() / 1000.f;
-      LOG(INFO) << "TPC: Event time " << eventTime << " us";
-      mDigitizer.setEventTime(eventTime);
+      LOG(DEBUG) << "TPC: Event time " << eventTime << " us";
+      digitizer.setEventTime(eventTime);
       if (!isContinuous) {
-        mDigitizer.setStartTime(eventTime);
+        digitizer.setStartTime(eventTime);
       }
-      size_t startSize = mDigitCounter; // digitsAccum->size();
+      size_t startSize = nDigits;
 
       // for each collision, loop over the constituents event and source IDs
       // (background signal merging is basically taking place here)
       for (auto& part : eventParts[collID]) {
-        const int eventID = part.entryID;
-        const int sourceID = part.sourceID;
-
         // get the hits for this event and this source
-        std::vector<o2::tpc::HitGroup> hitsLeft;
-        std::vector<o2::tpc::HitGroup> hitsRight;
-        context->retrieveHits(mSimChains, getBranchNameLeft(sector).c_str(), part.sourceID, part.entryID, &hitsLeft);
-        context->retrieveHits(mSimChains, getBranchNameRight(sector).c_str(), part.sourceID, part.entryID, &hitsRight);
+        hitsLeft.clear();
+        hitsRight.clear();
+        context.retrieveHits(simChains, getBranchNameLeft(sector).c_str(), part.sourceID, part.entryID, &hitsLeft);
+        context.retrieveHits(simChains, getBranchNameRight(sector).c_str(), part.sourceID, part.entryID, &hitsRight);
         LOG(DEBUG) << "TPC: Found " << hitsLeft.size() << " hit groups left and " << hitsRight.size() << " hit groups right in collision " << collID << " eventID " << part.entryID;
 
-        mDigitizer.process(hitsLeft, eventID, sourceID);
-        mDigitizer.process(hitsRight, eventID, sourceID);
+        digitizer.process(hitsLeft, part.entryID, part.sourceID);
+        digitizer.process(hitsRight, part.entryID, part.sourceID);
 
         flushDigitsAndLabels();
 
         if (!isContinuous) {
-          eventAccum.emplace_back(startSize, mDigits.size());
+          events.emplace_back(startSize, digits.size());
         }
       }
     }
 
     // final flushing step; getting everything not yet written out
     if (isContinuous) {
-      LOG(INFO) << "TPC: Final flush";
+      LOG(DEBUG) << "TPC: Final flush";
       flushDigitsAndLabels(true);
-      eventAccum.emplace_back(0, mDigitCounter); // all digits are grouped to 1 super-event pseudo-triggered mode
-    }
-
-    if (!mInternalWriter) {
-      // send out to next stage
-      snapshotEvents(eventAccum);
-      // snapshotDigits(digitsAccum); --> done automatically
-      snapshotCommonMode(commonModeAccum);
-      snapshotLabels(labelAccum);
+      events.emplace_back(0, nDigits); // all digits are grouped to 1 super-event pseudo-triggered mode
     }
-
-    timer.Stop();
-    LOG(INFO) << "TPC: Digitization took " << timer.CpuTime() << "s";
   }
 
  private:
   o2::tpc::Digitizer mDigitizer;
+  std::vector<std::unique_ptr<o2::tpc::Digitizer>> mSectorDigitizers; // digitizers of the sectors processed concurrently
+  std::vector<o2::tpc::Digitizer::Processing> mThreadProcessing;      // processing steps of each thread, the first ones also used serially
+  std::vector<std::vector<TChain*>> mThreadSimChains;                 // sim chains of each thread
   std::vector<TChain*> mSimChains;
-  std::vector<o2::tpc::Digit> mDigits;
-  o2::dataformats::MCTruthContainer<o2::MCCompLabel> mLabels;
-  std::vector<o2::tpc::CommonMode> mCommonMode;
   std::vector<int> mListOfSectors; //  a list of sectors treated by this task
   TFile* mInternalROOTFlushFile = nullptr;
   TTree* mInternalROOTFlushTTree = nullptr;
-  size_t mDigitCounter = 0;
   size_t mFlushCounter = 0;
   int mLaneId = 0; // the id of the current process within the parallel pipeline
   int mSector = 0;
+  int mNThreads = 1;            // number of threads digitizing the sectors of the lane concurrently
+  unsigned int mRandomSeed = 0; // seed from which the random rings and their start positions for the sectors are drawn
+  unsigned int mTFCounter = 0;  // number of processed timeframes
   bool mWriteGRP = false;
   bool mWithMCTruth = true;
   bool mInternalWriter = false;
@@ -484,7 +666,8 @@ o2::framework::DataProcessorSpec getTPCDigitizerSpec(int channel, bool writeGRP,
     Options{{"distortionType", VariantType::Int, 0, {"Distortion type to be used. 0 = no distortions (default), 1 = realistic distortions (not implemented yet), 2 = constant distortions"}},
             {"initialSpaceChargeDensity", VariantType::String, "", {"Path to root file containing TH3 with initial space-charge density and name of the TH3 (comma separated)"}},
             {"readSpaceCharge", VariantType::String, "", {"Path to root file containing pre-calculated space-charge object and name of the object (comma separated)"}},
-            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}}}};
+            {"TPCtriggered", VariantType::Bool, false, {"Impose triggered RO mode (default: continuous)"}},
+            {"TPCthreads", VariantType::Int, 1, {"Number of threads digitizing the sectors of one lane concurrently (not supported with the internal writer)"}}}};
 }
 
 o2::framework::WorkflowSpec getTPCDigitizerSpec(int nLanes, std::vector<int> const& sectors, bool mctruth, bool internalwriter)
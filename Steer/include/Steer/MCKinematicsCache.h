@@ -0,0 +1,97 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_STEER_MCKINEMATICSCACHE_H_
+#define O2_STEER_MCKINEMATICSCACHE_H_
+
+#include "SimulationDataFormat/MCTrack.h"
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace o2
+{
+namespace steer
+{
+
+/// Cache of the MC tracks of the events read from kinematics files, shared by the
+/// MCKinematicsReader instances of one process (separate processes, e.g. the devices of a
+/// workflow, do not share it). The events are identified by the file name and the entry in
+/// the file and are evicted in least recently used order once the memory taken by the cached
+/// tracks exceeds the configured limit. The cache is disabled (limit 0) unless a limit is set
+/// with setMaxBytes. Evicted events stay alive as long as a reader still holds them.
+/// All methods can be called concurrently.
+class MCKinematicsCache
+{
+ public:
+  using TrackVector = std::vector<o2::MCTrack>;
+  using TrackVectorPtr = std::shared_ptr<const TrackVector>;
+
+  static constexpr size_t DefaultMaxBytes = 0; ///< no caching unless requested
+
+  static MCKinematicsCache& instance()
+  {
+    static MCKinematicsCache cache;
+    return cache;
+  }
+
+  /// returns the tracks of the entry of the file, nullptr if they are not cached
+  TrackVectorPtr get(std::string const& file, int entry);
+
+  /// adds the tracks of the entry of the file, returns the cached tracks
+  /// (which are the ones given unless another reader added the same entry before
+  /// or the cache is disabled)
+  TrackVectorPtr add(std::string const& file, int entry, TrackVectorPtr tracks);
+
+  /// sets the memory limit of the cached tracks, evicting events if needed
+  void setMaxBytes(size_t maxbytes);
+  size_t getMaxBytes() const;
+
+  /// memory taken by the cached tracks
+  size_t getBytes() const;
+
+  /// number of cached events
+  size_t getNEvents() const;
+
+  /// removes all events from the cache
+  void clear();
+
+  static size_t getBytes(TrackVector const& tracks) { return sizeof(TrackVector) + tracks.capacity() * sizeof(o2::MCTrack); }
+
+ private:
+  MCKinematicsCache() = default;
+
+  using Key = std::pair<std::string, int>;
+  struct Entry {
+    TrackVectorPtr tracks;
+    size_t bytes = 0;
+    std::list<Key>::iterator lru; // position in the LRU list
+  };
+
+  // evicts the least recently used events until the memory limit is respected (mutex is held)
+  void evict();
+
+  mutable std::mutex mMutex;
+  std::map<Key, Entry> mEntries;
+  std::list<Key> mLRU; // most recently used first
+  size_t mBytes = 0;
+  size_t mMaxBytes = DefaultMaxBytes;
+};
+
+} // namespace steer
+} // namespace o2
+
+#endif
@@ -15,6 +15,10 @@
 #include "SimulationDataFormat/MCEventHeader.h"
 #include "SimulationDataFormat/TrackReference.h"
 #include "SimulationDataFormat/MCTruthContainer.h"
+#include "Steer/MCKinematicsCache.h"
+#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
 
 class TChain;
@@ -25,6 +29,12 @@ namespace o2
 namespace steer
 {
 
+/// Reader of the MC kinematics of one or several simulation productions.
+/// The tracks of an event are only read from the file when they are first asked for. They are
+/// then kept by the reader until released. If the MCKinematicsCache of the process is enabled,
+/// they are also put there, such that other readers of the same files in this process do not
+/// read them again.
+/// The query methods can be called concurrently from several threads.
 class MCKinematicsReader
 {
  public:
@@ -76,7 +86,12 @@ class MCKinematicsReader
   /// variant returning all tracks for source and event at once
   std::vector<MCTrack> const& getTracks(int source, int event) const;
 
+  /// variant returning all tracks for source and event as a shared pointer, which stays
+  /// valid after the tracks are released by the reader
+  MCKinematicsCache::TrackVectorPtr getTracksPtr(int source, int event) const;
+
   /// API to ask releasing tracks (freeing memory) for source + event
+  /// (they may still be kept by the cache, if it is enabled)
   void releaseTracksForSourceAndEvent(int source, int event);
 
   /// variant returning all tracks for source and event at once
@@ -121,8 +136,14 @@ class MCKinematicsReader
   // chains for each source
   std::vector<TChain*> mInputChains;
 
+  // the files of each source, identifying its events in the shared cache
+  std::vector<std::string> mSourceFiles;
+
+  // guards the lazy loading and the reading from the chains
+  mutable std::mutex mMutex; //!
+
   // a vector of tracks foreach source and each collision
-  mutable std::vector<std::vector<std::vector<o2::MCTrack>*>> mTracks;                                       // the in-memory track container
+  mutable std::vector<std::vector<MCKinematicsCache::TrackVectorPtr>> mTracks;                               // the in-memory track container
   mutable std::vector<std::vector<o2::dataformats::MCEventHeader>> mHeaders;                                 // the in-memory header container
   mutable std::vector<std::vector<o2::dataformats::MCTruthContainer<o2::TrackReference>>> mIndexedTrackRefs; // the in-memory track ref container
 
@@ -149,13 +170,7 @@ inline MCTrack const* MCKinematicsReader::getTrack(int event, int track) const
 
 inline std::vector<MCTrack> const& MCKinematicsReader::getTracks(int source, int event) const
 {
-  if (mTracks[source].size() == 0) {
-    initTracksForSource(source);
-  }
-  if (mTracks[source][event] == nullptr) {
-    loadTracksForSourceAndEvent(source, event);
-  }
-  return *mTracks[source][event];
+  return *getTracksPtr(source, event);
 }
 
 inline std::vector<MCTrack> const& MCKinematicsReader::getTracks(int event) const
@@ -165,6 +180,7 @@ inline std::vector<MCTrack> const& MCKinematicsReader::getTracks(int event) cons
 
 inline o2::dataformats::MCEventHeader const& MCKinematicsReader::getMCEventHeader(int source, int event) const
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   if (mHeaders.at(source).size() == 0) {
     loadHeadersForSource(source);
   }
@@ -173,6 +189,7 @@ inline o2::dataformats::MCEventHeader const& MCKinematicsReader::getMCEventHeade
 
 inline gsl::span<o2::TrackReference> MCKinematicsReader::getTrackRefs(int source, int event, int track) const
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   if (mIndexedTrackRefs[source].size() == 0) {
     loadTrackRefsForSource(source);
   }
@@ -181,6 +198,7 @@ inline gsl::span<o2::TrackReference> MCKinematicsReader::getTrackRefs(int source
 
 inline const std::vector<o2::TrackReference>& MCKinematicsReader::getTrackRefsByEvent(int source, int event) const
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   if (mIndexedTrackRefs[source].size() == 0) {
     loadTrackRefsForSource(source);
   }
@@ -199,6 +217,7 @@ inline size_t MCKinematicsReader::getNSources() const
 
 inline size_t MCKinematicsReader::getNEvents(int source) const
 {
+  std::lock_guard<std::mutex> lock(mMutex);
   if (mTracks[source].size() == 0) {
     initTracksForSource(source);
   }
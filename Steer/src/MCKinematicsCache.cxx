@@ -0,0 +1,91 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "Steer/MCKinematicsCache.h"
+
+using namespace o2::steer;
+
+MCKinematicsCache::TrackVectorPtr MCKinematicsCache::get(std::string const& file, int entry)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto iter = mEntries.find(Key(file, entry));
+  if (iter == mEntries.end()) {
+    return nullptr;
+  }
+  // mark as most recently used
+  mLRU.splice(mLRU.begin(), mLRU, iter->second.lru);
+  return iter->second.tracks;
+}
+
+MCKinematicsCache::TrackVectorPtr MCKinematicsCache::add(std::string const& file, int entry, TrackVectorPtr tracks)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mMaxBytes == 0) {
+    return tracks;
+  }
+  Key key(file, entry);
+  auto iter = mEntries.find(key);
+  if (iter != mEntries.end()) {
+    mLRU.splice(mLRU.begin(), mLRU, iter->second.lru);
+    return iter->second.tracks;
+  }
+  mLRU.push_front(key);
+  auto& e = mEntries[std::move(key)];
+  e.tracks = tracks;
+  e.bytes = getBytes(*tracks);
+  e.lru = mLRU.begin();
+  mBytes += e.bytes;
+  evict();
+  return tracks;
+}
+
+void MCKinematicsCache::evict()
+{
+  while (mBytes > mMaxBytes && !mLRU.empty()) {
+    auto iter = mEntries.find(mLRU.back());
+    mBytes -= iter->second.bytes;
+    mEntries.erase(iter);
+    mLRU.pop_back();
+  }
+}
+
+void MCKinematicsCache::setMaxBytes(size_t maxbytes)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mMaxBytes = maxbytes;
+  evict();
+}
+
+size_t MCKinematicsCache::getMaxBytes() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mMaxBytes;
+}
+
+size_t MCKinematicsCache::getBytes() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mBytes;
+}
+
+size_t MCKinematicsCache::getNEvents() const
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  return mEntries.size();
+}
+
+void MCKinematicsCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mEntries.clear();
+  mLRU.clear();
+  mBytes = 0;
+}
@@ -14,11 +14,29 @@
 #include "SimulationDataFormat/MCEventHeader.h"
 #include "SimulationDataFormat/TrackReference.h"
 #include <TChain.h>
+#include <TSystem.h>
 #include <vector>
 #include "FairLogger.h"
 
 using namespace o2::steer;
 
+namespace
+{
+// the (absolute) name of the file read by a chain, identifying its entries in the cache, empty if there is none
+std::string getChainFile(TChain* chain)
+{
+  auto files = chain->GetListOfFiles();
+  if (!files || files->GetEntries() == 0) {
+    return "";
+  }
+  std::string name = files->At(0)->GetTitle();
+  if (!gSystem->IsAbsoluteFileName(name.c_str())) {
+    name = std::string(gSystem->WorkingDirectory()) + "/" + name;
+  }
+  return name;
+}
+} // namespace
+
 MCKinematicsReader::~MCKinematicsReader()
 {
   for (auto chain : mInputChains) {
@@ -62,6 +80,11 @@ void MCKinematicsReader::initTracksForSource(int source) const
 
 void MCKinematicsReader::loadTracksForSourceAndEvent(int source, int event) const
 {
+  // another reader of the same file may have read the event already, sources w/o file are not cached
+  const auto& file = mSourceFiles[source];
+  if (!file.empty() && (mTracks[source][event] = MCKinematicsCache::instance().get(file, event))) {
+    return;
+  }
   auto chain = mInputChains[source];
   if (chain) {
     // todo: get name from NameConfig
@@ -70,19 +93,30 @@ void MCKinematicsReader::loadTracksForSourceAndEvent(int source, int event) cons
       std::vector<MCTrack>* loadtracks = nullptr;
       br->SetAddress(&loadtracks);
       br->GetEntry(event);
-      mTracks[source][event] = new std::vector<o2::MCTrack>;
-      *mTracks[source][event] = *loadtracks;
+      auto tracks = std::make_shared<const std::vector<o2::MCTrack>>(std::move(*loadtracks));
       delete loadtracks;
+      br->ResetAddress();
+      mTracks[source][event] = file.empty() ? tracks : MCKinematicsCache::instance().add(file, event, std::move(tracks));
     }
   }
 }
 
-void MCKinematicsReader::releaseTracksForSourceAndEvent(int source, int eventID)
+MCKinematicsCache::TrackVectorPtr MCKinematicsReader::getTracksPtr(int source, int event) const
 {
-  if (mTracks.at(source).at(eventID) != nullptr) {
-    delete mTracks[source][eventID];
-    mTracks[source][eventID] = nullptr;
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (mTracks[source].size() == 0) {
+    initTracksForSource(source);
   }
+  if (mTracks[source][event] == nullptr) {
+    loadTracksForSourceAndEvent(source, event);
+  }
+  return mTracks[source][event];
+}
+
+void MCKinematicsReader::releaseTracksForSourceAndEvent(int source, int eventID)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  mTracks.at(source).at(eventID).reset();
 }
 
 void MCKinematicsReader::loadHeadersForSource(int source) const
@@ -148,6 +182,9 @@ bool MCKinematicsReader::initFromDigitContext(std::string_view name)
 
   // get the chains to read
   mDigitizationContext->initSimKinematicsChains(mInputChains);
+  for (auto chain : mInputChains) {
+    mSourceFiles.emplace_back(getChainFile(chain));
+  }
 
   // load the kinematics information
   mTracks.resize(mInputChains.size());
@@ -168,6 +205,7 @@ bool MCKinematicsReader::initFromKinematics(std::string_view name)
   }
   mInputChains.emplace_back(new TChain("o2sim"));
   mInputChains.back()->AddFile(o2::base::NameConf::getMCKinematicsFileName(name.data()).c_str());
+  mSourceFiles.emplace_back(getChainFile(mInputChains.back()));
   mTracks.resize(1);
   mHeaders.resize(1);
   mIndexedTrackRefs.resize(1);
@@ -233,7 +233,7 @@ void O2MCApplication::attachSubEventInfo(FairMQParts& parts, o2::data::SubEventI
   o2::base::attachTMessage(info, *mSimDataChannel, parts);
 }
 
-// helper function to fetch data from FairRootManager branch and serialize it
+// helper function to fetch data from FairRootManager branch and attach it as flat message
 // returns handle to container
 template <typename T>
 const T* attachBranch(std::string const& name, FairMQChannel& channel, FairMQParts& parts)
@@ -246,7 +246,7 @@ const T* attachBranch(std::string const& name, FairMQChannel& channel, FairMQPar
   }
   auto data = mgr->InitObjectAs<const T*>(name.c_str());
   if (data) {
-    o2::base::attachTMessage(*data, channel, parts);
+    o2::base::attachFlatMessage(*data, channel, parts);
   }
   return data;
 }
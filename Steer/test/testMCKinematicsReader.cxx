@@ -0,0 +1,105 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#define BOOST_TEST_MODULE Test MCKinematicsReader class
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include "Steer/MCKinematicsReader.h"
+#include "DetectorsCommonDataFormats/NameConf.h"
+#include <TFile.h>
+#include <TTree.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+namespace steer
+{
+
+BOOST_AUTO_TEST_CASE(MCKinematicsReaderTest)
+{
+  // make a mockup kinematics file with nevents events of event + 1 tracks
+  const std::string prefix = "mckinereadertest";
+  const int nevents = 10;
+  {
+    TFile file(o2::base::NameConf::getMCKinematicsFileName(prefix).c_str(), "RECREATE");
+    TTree tree("o2sim", "");
+    std::vector<o2::MCTrack> tracks;
+    auto tracksptr = &tracks;
+    tree.Branch("MCTrack", &tracksptr);
+    for (int event = 0; event < nevents; ++event) {
+      tracks.clear();
+      for (int i = 0; i <= event; ++i) {
+        tracks.emplace_back(211, i - 1, -1, -1, -1, 1. * event, 1. * i, 0., 0., 0., 0., 0., 0);
+      }
+      tree.Fill();
+    }
+    tree.Write();
+    file.Close();
+  }
+
+  // the cache is disabled by default
+  auto& cache = MCKinematicsCache::instance();
+  BOOST_CHECK(cache.getMaxBytes() == 0);
+  {
+    MCKinematicsReader reader(prefix, MCKinematicsReader::Mode::kMCKine);
+    auto tracks = reader.getTracksPtr(0, 0);
+    reader.releaseTracksForSourceAndEvent(0, 0);
+    BOOST_CHECK_EQUAL(cache.getNEvents(), 0);
+    BOOST_CHECK(tracks.use_count() == 1); // only held here after the release
+    BOOST_CHECK(reader.getTracksPtr(0, 0) != tracks);
+  }
+  cache.setMaxBytes(64 * 1024 * 1024);
+
+  MCKinematicsReader reader1(prefix, MCKinematicsReader::Mode::kMCKine);
+  MCKinematicsReader reader2(prefix, MCKinematicsReader::Mode::kMCKine);
+  BOOST_CHECK_EQUAL(reader1.getNEvents(0), nevents);
+
+  // concurrent queries of the same reader
+  std::vector<std::thread> threads;
+  std::atomic<int> nwrong{0};
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&reader1, &nwrong, nevents]() {
+      for (int event = nevents; event--;) {
+        auto track = reader1.getTrack(event, event);
+        if (track->Px() != event || track->Py() != event) {
+          nwrong++;
+        }
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  BOOST_CHECK_EQUAL(nwrong.load(), 0);
+  BOOST_CHECK_EQUAL(cache.getNEvents(), nevents);
+
+  // the second reader gets the tracks read by the first one
+  for (int event = 0; event < nevents; ++event) {
+    BOOST_CHECK(&reader1.getTracks(event) == &reader2.getTracks(event));
+    BOOST_CHECK_EQUAL(reader2.getTracks(event).size(), event + 1);
+  }
+
+  // the cache respects its memory limit, tracks held by the readers are still valid
+  const auto bytes = MCKinematicsCache::getBytes(reader1.getTracks(nevents - 1));
+  cache.setMaxBytes(bytes);
+  BOOST_CHECK(cache.getBytes() <= bytes);
+  BOOST_CHECK_EQUAL(cache.getNEvents(), 1);
+  reader1.releaseTracksForSourceAndEvent(0, 0);
+  BOOST_CHECK_EQUAL(reader2.getTrack(0, 0)->Px(), 0.);
+  BOOST_CHECK_EQUAL(reader1.getTracks(0).size(), 1);
+  cache.setMaxBytes(MCKinematicsCache::DefaultMaxBytes);
+}
+
+} // namespace steer
+} // namespace o2
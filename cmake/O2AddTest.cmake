@@ -36,6 +36,10 @@ include(O2AddTestWrapper)
 # * INSTALL : by default tests are _not_ installed. If that option is present
 #   then the test is installed (under ${CMAKE_INSTALL_PREFIX}/tests, not in
 #   ${CMAKE_INSTALL_PREFIX}/bin like other binaries)
+# * TARGETVARNAME : the name of a variable that will hold the name of the
+#   test executable target, e.g. to add compile definitions or libraries to it.
+#   The variable is not set if BUILD_TESTING is off, so its use must be guarded
+#   by BUILD_TESTING
 #
 # Parameters of the test wrapper :
 #
@@ -57,7 +61,7 @@ function(o2_add_test)
     1
     A
     "INSTALL;NO_BOOST_TEST"
-    "COMPONENT_NAME;MAX_ATTEMPTS;TIMEOUT;WORKING_DIRECTORY;NAME"
+    "COMPONENT_NAME;MAX_ATTEMPTS;TIMEOUT;WORKING_DIRECTORY;NAME;TARGETVARNAME"
     "SOURCES;PUBLIC_LINK_LIBRARIES;COMMAND_LINE_ARGS;LABELS;CONFIGURATIONS;ENVIRONMENT"
     )
 
@@ -95,6 +99,10 @@ function(o2_add_test)
                     COMPONENT_NAME ${A_COMPONENT_NAME}
                     IS_TEST ${noInstall} TARGETVARNAME targetName)
 
+  if(A_TARGETVARNAME)
+    set(${A_TARGETVARNAME} ${targetName} PARENT_SCOPE)
+  endif()
+
   # create a test with a script wrapping the executable above
   set(name "")
   if(A_NAME)
@@ -27,7 +27,6 @@
 #include <DetectorsCommonDataFormats/NameConf.h>
 #include <gsl/gsl>
 #include "TFile.h"
-#include "TMemFile.h"
 #include "TTree.h"
 #include "TROOT.h"
 #include <memory>
@@ -63,6 +62,9 @@
 #include <vector>
 #include <csignal>
 #include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 #include <filesystem>
 
 #include "SimPublishChannelHelper.h"
@@ -97,6 +99,14 @@ class O2HitMerger : public FairMQDevice
     ~TMessageWrapper() override = default;
   };
 
+  // the data of one sub-event, kept in memory as received until the event is complete
+  struct SubEventData {
+    std::unique_ptr<o2::data::SubEventInfo> info;
+    o2::base::SubEventPayload tracks;                         // the MCTracks
+    o2::base::SubEventPayload trackrefs;                      // the TrackReferences
+    std::vector<std::vector<o2::base::SubEventPayload>> hits; // the payloads of the hit branches, indexed by detector ID
+  };
+
  public:
   /// Default constructor
   O2HitMerger()
@@ -220,8 +230,7 @@ class O2HitMerger : public FairMQDevice
 
     // clear "counter" datastructures
     mPartsCheckSum.clear();
-    mEventToTTreeMap.clear();
-    mEventToTMemFileMap.clear();
+    mEventToSubEvents.clear();
     mEntries = 0;
     mEventChecksum = 0;
     return true;
@@ -248,7 +257,7 @@ class O2HitMerger : public FairMQDevice
     return checksum == nparts * (nparts + 1) / 2;
   }
 
-  void consumeHits(int eventID, FairMQParts& data, int& index)
+  void consumeHits(SubEventData& subevent, FairMQParts& data, int& index)
   {
     auto detIDmessage = std::move(data.At(index++));
     // this should be a detector ID
@@ -258,62 +267,12 @@ class O2HitMerger : public FairMQDevice
       LOG(DEBUG2) << "I1 " << ptr[0] << " NAME " << id.getName() << " MB "
                   << data.At(index)->GetSize() / 1024. / 1024.;
 
-      TTree* tree = mEventToTTreeMap[eventID];
-
       // get the detector that can interpret it
       auto detector = mDetectorInstances[id].get();
       if (detector) {
-        detector->fillHitBranch(*tree, data, index);
-      }
-    }
-  }
-
-  template <typename T>
-  void fillBranch(int eventID, std::string const& name, T* ptr)
-  {
-    // fetch tree into which to fill
-    const std::lock_guard<std::mutex> lock(mMapsMtx);
-    auto iter = mEventToTTreeMap.find(eventID);
-    if (iter == mEventToTTreeMap.end()) {
-      {
-        std::stringstream str;
-        str << "memfile" << eventID;
-        mEventToTMemFileMap[eventID] = new TMemFile(str.str().c_str(), "RECREATE");
-      }
-      {
-        std::stringstream str;
-        str << "o2sim" << eventID;
-        mEventToTTreeMap[eventID] = new TTree(str.str().c_str(), str.str().c_str());
-        mEventToTTreeMap[eventID]->SetDirectory(mEventToTMemFileMap[eventID]);
+        detector->decodeHits(data, index, subevent.hits[id]);
       }
     }
-    TTree* tree = mEventToTTreeMap[eventID];
-
-    auto br = o2::base::getOrMakeBranch(*tree, name.c_str(), &ptr);
-    br->SetAddress(&ptr);
-    br->Fill();
-    br->ResetAddress();
-  }
-
-  template <typename T>
-  void consumeData(int eventID, std::string name, FairMQParts& data, int& index)
-  {
-    auto decodeddata = o2::base::decodeTMessage<T*>(data, index);
-    fillBranch(eventID, name, decodeddata);
-    delete decodeddata;
-    index++;
-  }
-
-  // fills a special branch of SubEventInfos in order to keep
-  // track of which entry corresponds to which event etc.
-  // also creates the MCEventHeader branch expected for physics analysis
-  void fillSubEventInfoEntry(o2::data::SubEventInfo& info)
-  {
-    auto infoptr = &info;
-    fillBranch(info.eventID, "SubEventInfo", infoptr);
-    // a separate branch for MCEventHeader to be backward compatible
-    auto headerptr = &info.mMCEventHeader;
-    fillBranch(info.eventID, "MCEventHeader.", headerptr);
   }
 
   bool waitForControlInput()
@@ -368,23 +327,25 @@ class O2HitMerger : public FairMQDevice
   {
     bool expectmore = true;
     int index = 0;
-    auto infoptr = o2::base::decodeTMessage<o2::data::SubEventInfo*>(data, index++);
-    o2::data::SubEventInfo& info = *infoptr;
+    SubEventData subevent;
+    subevent.info.reset(o2::base::decodeTMessage<o2::data::SubEventInfo*>(data, index++));
+    // the sub-event may be merged and discarded as soon as it is handed over, keep what is needed below
+    const auto info = *subevent.info;
     auto accum = insertAdd<uint32_t, uint32_t>(mPartsCheckSum, info.eventID, (uint32_t)info.part);
 
     LOG(INFO) << "SIMDATA channel got " << data.Size() << " parts for event " << info.eventID << " part " << info.part << " out of " << info.nparts;
 
-    fillSubEventInfoEntry(info);
-    consumeData<std::vector<o2::MCTrack>>(info.eventID, "MCTrack", data, index);
-    consumeData<std::vector<o2::TrackReference>>(info.eventID, "TrackRefs", data, index);
+    // tracks and track references come as flat messages which are kept as they are until the event is merged
+    subevent.tracks = o2::base::decodeFlatMessage<o2::MCTrack>(data, index++);
+    subevent.trackrefs = o2::base::decodeFlatMessage<o2::TrackReference>(data, index++);
+    subevent.hits.resize(o2::detectors::DetID::nDetectors);
     while (index < data.Size()) {
-      consumeHits(info.eventID, data, index);
+      consumeHits(subevent, data, index);
+    }
+    {
+      const std::lock_guard<std::mutex> lock(mMapsMtx);
+      mEventToSubEvents[info.eventID].emplace_back(std::move(subevent));
     }
-    // set the number of entries in the tree
-    auto tree = mEventToTTreeMap[info.eventID];
-    auto memfile = mEventToTMemFileMap[info.eventID];
-    tree->SetEntries(tree->GetEntries() + 1);
-    LOG(INFO) << "tree has file " << tree->GetDirectory()->GetFile()->GetName();
     mEntries++;
 
     if (isDataComplete<uint32_t>(accum, info.nparts)) {
@@ -424,29 +385,15 @@ class O2HitMerger : public FairMQDevice
     return expectmore;
   }
 
-  void cleanEvent(int eventID)
-  {
-    // remove tree for that eventID
-    const std::lock_guard<std::mutex> lock(mMapsMtx);
-    delete mEventToTTreeMap[eventID];
-    delete mEventToTMemFileMap[eventID];
-    mEventToTTreeMap.erase(eventID);
-    mEventToTMemFileMap.erase(eventID); // remove memfile
-  }
-
-  template <typename T>
-  void backInsert(T const& from, T& to)
+  void reorderAndMergeMCTRacks(std::vector<SubEventData> const& subevents, TTree& target, const std::vector<int>& nprimaries, const std::vector<int>& nsubevents)
   {
-    std::copy(from.begin(), from.end(), std::back_inserter(to));
-  }
-
-  void reorderAndMergeMCTRacks(TTree& origin, TTree& target, const std::vector<int>& nprimaries, const std::vector<int>& nsubevents)
-  {
-    std::vector<MCTrack>* incomingdata = nullptr;
-    auto targetdata = new std::vector<MCTrack>;
-    auto originbr = origin.GetBranch("MCTrack");
-    originbr->SetAddress(&incomingdata);
-    const auto entries = origin.GetEntries();
+    auto targetdata = std::make_unique<std::vector<MCTrack>>();
+    const int entries = subevents.size();
+    size_t ntracks = 0;
+    for (auto& subevent : subevents) {
+      ntracks += subevent.tracks.size();
+    }
+    targetdata->reserve(ntracks);
     //
     // loop over subevents to store the primary events
     //
@@ -454,19 +401,15 @@ class O2HitMerger : public FairMQDevice
     for (auto entry = entries - 1; entry >= 0; --entry) {
       int index = nsubevents[entry];
       nprimTot += nprimaries[index];
-      printf("merge %lld %5d %5d %5d \n", entry, index, nsubevents[entry], nsubevents[index]);
-      originbr->GetEntry(index);
+      printf("merge %d %5d %5d %5d \n", entry, index, nsubevents[entry], nsubevents[index]);
+      auto incomingdata = subevents[index].tracks.begin<MCTrack>();
       for (Int_t i = 0; i < nprimaries[index]; i++) {
-        auto& track = incomingdata->at(i);
+        auto& track = targetdata->emplace_back(incomingdata[i]);
         if (track.isTransported()) { // reset daughters only if track was transported, it will be fixed below
           track.SetFirstDaughterTrackId(-1);
           track.SetLastDaughterTrackId(-1);
         }
-        targetdata->push_back(track);
       }
-      incomingdata->clear();
-      delete incomingdata;
-      incomingdata = nullptr;
     }
     //
     // loop a second time to store the secondaries and fix the mother track IDs
@@ -476,14 +419,13 @@ class O2HitMerger : public FairMQDevice
     for (auto entry = entries - 1; entry >= 0; --entry) {
       int index = nsubevents[entry];
 
-      originbr->GetEntry(index);
-
-      Int_t npart = (int)(incomingdata->size());
+      auto incomingdata = subevents[index].tracks.begin<MCTrack>();
+      Int_t npart = (int)(subevents[index].tracks.size());
       Int_t nprim = nprimaries[index];
       idelta1 -= nprim;
 
       for (Int_t i = nprim; i < npart; i++) {
-        auto& track = incomingdata->at(i);
+        MCTrack track = incomingdata[i];
         Int_t cId = track.getMotherTrackId();
         if (cId >= nprim) {
           cId += idelta1;
@@ -504,22 +446,19 @@ class O2HitMerger : public FairMQDevice
       }
       idelta0 += nprim;
       idelta1 += npart;
-      incomingdata->clear();
-      delete incomingdata;
-      incomingdata = nullptr;
     }
 
     //
     // write to output
-    auto targetbr = o2::base::getOrMakeBranch(target, "MCTrack", &targetdata);
-    targetbr->SetAddress(&targetdata);
+    auto filladdress = targetdata.get();
+    auto targetbr = o2::base::getOrMakeBranch(target, "MCTrack", &filladdress);
+    targetbr->SetAddress(&filladdress);
     targetbr->Fill();
     targetbr->ResetAddress();
-    targetdata->clear();
   }
 
   template <typename T>
-  void remapTrackIdsAndMerge(std::string brname, TTree& origin, TTree& target,
+  void remapTrackIdsAndMerge(std::string brname, o2::base::SubEventPayload SubEventData::*payload, std::vector<SubEventData> const& subevents, TTree& target,
                              const std::vector<int>& trackoffsets, const std::vector<int>& nprimaries, const std::vector<int>& subevOrdered)
   {
     //
@@ -527,45 +466,37 @@ class O2HitMerger : public FairMQDevice
     // The offset calculated as the sum of the number of entries in the particle list of the previous subevents.
     // This method is called by O2HitMerger::mergeAndFlushData(int)
     //
-    T* incomingdata = nullptr;
-    auto targetdata = new T;
-    auto originbr = origin.GetBranch(brname.c_str());
-    originbr->SetAddress(&incomingdata);
-    const auto entries = origin.GetEntries();
-
-    if (entries == 1) {
-      // nothing to do in case there is only one entry
-      originbr->GetEntry(0);
-      targetdata = incomingdata;
-    } else {
-      // loop over subevents
-      Int_t nprimTot = 0;
-      for (auto entry = 0; entry < entries; entry++) {
-        nprimTot += nprimaries[entry];
-      }
-      Int_t idelta0 = 0;
-      Int_t idelta1 = nprimTot;
-      for (auto entry = entries - 1; entry >= 0; --entry) {
-        Int_t index = subevOrdered[entry];
-        Int_t nprim = nprimaries[index];
-        originbr->GetEntry(index);
-        idelta1 -= nprim;
-        for (auto& data : *incomingdata) {
-          updateTrackIdWithOffset(data, nprim, idelta0, idelta1);
-          targetdata->push_back(data);
-        }
-        incomingdata->clear();
-        idelta0 += nprim;
-        idelta1 += trackoffsets[index];
-        delete incomingdata;
-        incomingdata = nullptr;
+    auto targetdata = std::make_unique<std::vector<T>>();
+    const int entries = subevents.size();
+    size_t ndata = 0;
+    for (auto& subevent : subevents) {
+      ndata += (subevent.*payload).size();
+    }
+    targetdata->reserve(ndata);
+
+    // loop over subevents
+    Int_t nprimTot = 0;
+    for (auto entry = 0; entry < entries; entry++) {
+      nprimTot += nprimaries[entry];
+    }
+    Int_t idelta0 = 0;
+    Int_t idelta1 = nprimTot;
+    for (auto entry = entries - 1; entry >= 0; --entry) {
+      Int_t index = subevOrdered[entry];
+      Int_t nprim = nprimaries[index];
+      auto& incomingdata = subevents[index].*payload;
+      idelta1 -= nprim;
+      for (auto data = incomingdata.template begin<T>(); data != incomingdata.template end<T>(); ++data) {
+        updateTrackIdWithOffset(targetdata->emplace_back(*data), nprim, idelta0, idelta1);
       }
+      idelta0 += nprim;
+      idelta1 += trackoffsets[index];
     }
-    auto targetbr = o2::base::getOrMakeBranch(target, brname.c_str(), &targetdata);
-    targetbr->SetAddress(&targetdata);
+    auto filladdress = targetdata.get();
+    auto targetbr = o2::base::getOrMakeBranch(target, brname.c_str(), &filladdress);
+    targetbr->SetAddress(&filladdress);
     targetbr->Fill();
     targetbr->ResetAddress();
-    targetdata->clear();
   }
 
   void updateTrackIdWithOffset(MCTrack& track, Int_t nprim, Int_t idelta0, Int_t idelta1)
@@ -584,48 +515,6 @@ class O2HitMerger : public FairMQDevice
     ref.setTrackID(cId + ioffset);
   }
 
-  // this merges all entries from the TBranch brname from the origin TTree (containing one event only)
-  // into a single entry in a target TTree / same branch
-  // (assuming T is typically a vector; merging is simply done by appending)
-  template <typename T>
-  void merge(std::string brname, TTree& origin, TTree& target)
-  {
-    auto originbr = origin.GetBranch(brname.c_str());
-    auto targetdata = new T;
-    T* incomingdata = nullptr;
-    originbr->SetAddress(&incomingdata);
-
-    const auto entries = origin.GetEntries();
-
-    T* filladdress = nullptr;
-    if (entries == 1) {
-      // this avoids useless copy in case there was no sub-event splitting; we just use the original data
-      originbr->GetEntry(0);
-      filladdress = incomingdata;
-    } else {
-      filladdress = targetdata;
-      for (auto entry = 0; entry < entries; ++entry) {
-        originbr->GetEntry(entry);
-        backInsert(*incomingdata, *targetdata);
-        delete incomingdata;
-        incomingdata = nullptr;
-      }
-    }
-
-    // fill target for this event
-    auto targetbr = o2::base::getOrMakeBranch(target, brname.c_str(), &filladdress);
-    targetbr->SetAddress(&filladdress);
-    targetbr->Fill();
-    targetbr->ResetAddress();
-    targetdata->clear();
-    if (incomingdata) {
-      delete incomingdata;
-      incomingdata = nullptr;
-    }
-
-    delete targetdata;
-  }
-
   void initHitTreeAndOutFile(std::string prefix, int detID)
   {
     using o2::detectors::DetID;
@@ -640,30 +529,34 @@ class O2HitMerger : public FairMQDevice
     mDetectorToTTreeMap[detID]->SetDirectory(mDetectorOutFiles[detID]);
   }
 
-  // This method goes over the tree containing data for a given event; potentially merges
-  // it and flushes it into the actual output file.
+  // This method goes over the sub-events collected for a given event; merges
+  // them and flushes them into the actual output file.
   // The method can be called asynchronously to data collection
   bool mergeAndFlushData(int eventID)
   {
     LOG(INFO) << "ENTERING MERGING/FLUSHING HITS STAGE FOR EVENT " << eventID;
 
-    auto tree = mEventToTTreeMap[eventID];
-    if (!tree) {
-      LOG(INFO) << "NO TTREE FOUND FOR EVENT " << eventID;
-      return false;
+    // take over the sub-events of this event, they are released at the end of the merging
+    std::vector<SubEventData> subevents;
+    {
+      const std::lock_guard<std::mutex> lock(mMapsMtx);
+      auto iter = mEventToSubEvents.find(eventID);
+      if (iter == mEventToSubEvents.end()) {
+        LOG(INFO) << "NO DATA FOUND FOR EVENT " << eventID;
+        return false;
+      }
+      subevents = std::move(iter->second);
+      mEventToSubEvents.erase(iter);
     }
 
-    if (tree->GetEntries() == 0 || mNExpectedEvents == 0) {
-      LOG(INFO) << "NO ENTRY IN TTREE FOUND FOR EVENT " << eventID;
+    if (subevents.size() == 0 || mNExpectedEvents == 0) {
+      LOG(INFO) << "NO SUBEVENT FOUND FOR EVENT " << eventID;
       return false;
     }
 
     TStopwatch timer;
     timer.Start();
 
-    // calculate trackoffsets
-    auto infobr = tree->GetBranch("SubEventInfo");
-
     auto& confref = o2::conf::SimConfig::Instance();
 
     std::vector<int> trackoffsets; // collecting trackoffsets to be applied to correct
@@ -672,11 +565,9 @@ class O2HitMerger : public FairMQDevice
 
     o2::dataformats::MCEventHeader* eventheader = nullptr; // The event header
 
-    // the MC labels (trackID) for hits
-    o2::data::SubEventInfo* info = nullptr;
-    infobr->SetAddress(&info);
-    for (int i = 0; i < infobr->GetEntries(); ++i) {
-      infobr->GetEntry(i);
+    // calculate trackoffsets
+    for (auto& subevent : subevents) {
+      auto info = subevent.info.get();
       assert(info->npersistenttracks >= 0);
       trackoffsets.emplace_back(info->npersistenttracks);
       nprimaries.emplace_back(info->nprimarytracks);
@@ -693,7 +584,6 @@ class O2HitMerger : public FairMQDevice
     if (confref.isFilterOutNoHitEvents()) {
       if (eventheader && eventheader->getMCEventStats().getNHits() == 0) {
         LOG(INFO) << " Taking out event " << eventID << " due to no hits ";
-        cleanEvent(eventID);
         return false;
       }
     }
@@ -711,37 +601,59 @@ class O2HitMerger : public FairMQDevice
     // b) merge the general data
     //
     // for MCTrack remap the motherIds and merge at the same go
-    const auto entries = tree->GetEntries();
+    const int entries = subevents.size();
     std::vector<int> subevOrdered((int)(nsubevents.size()));
     for (auto entry = entries - 1; entry >= 0; --entry) {
       subevOrdered[nsubevents[entry] - 1] = entry;
-      printf("HitMerger entry: %lld nprimry: %5d trackoffset: %5d \n", entry, nprimaries[entry], trackoffsets[entry]);
+      printf("HitMerger entry: %d nprimry: %5d trackoffset: %5d \n", entry, nprimaries[entry], trackoffsets[entry]);
     }
 
-    reorderAndMergeMCTRacks(*tree, *mOutTree, nprimaries, subevOrdered);
-    Int_t ioffset = 0;
-    remapTrackIdsAndMerge<std::vector<o2::TrackReference>>("TrackRefs", *tree, *mOutTree, trackoffsets, nprimaries, subevOrdered);
-
     // c) do the merge procedure for all hits ... delegate this to detector specific functions
     // since they know about types; number of branches; etc.
     // this will also fix the trackIDs inside the hits
+    // The detectors write to their own trees and files, so they are merged concurrently by a few
+    // helper threads while this thread takes care of the kinematics; the track offsets computed
+    // above are shared by all of them.
+    std::vector<int> detIDs;
     for (int id = 0; id < mDetectorInstances.size(); ++id) {
-      auto& det = mDetectorInstances[id];
-      if (det) {
-        auto hittree = mDetectorToTTreeMap[id];
-        det->mergeHitEntries(*tree, *hittree, trackoffsets, nprimaries, subevOrdered);
+      if (mDetectorInstances[id]) {
+        detIDs.push_back(id);
+      }
+    }
+    std::atomic<int> nextDet{0};
+    auto mergeDetectors = [&]() {
+      std::vector<std::vector<o2::base::SubEventPayload> const*> hits(entries);
+      for (int i = nextDet++; i < detIDs.size(); i = nextDet++) {
+        const int id = detIDs[i];
+        auto hittree = mDetectorToTTreeMap.at(id);
+        for (int entry = 0; entry < entries; ++entry) {
+          hits[entry] = &subevents[entry].hits[id];
+        }
+        mDetectorInstances[id]->mergeHits(hits, *hittree, trackoffsets, nprimaries, subevOrdered);
         hittree->SetEntries(hittree->GetEntries() + 1);
         LOG(INFO) << "flushing tree to file " << hittree->GetDirectory()->GetFile()->GetName();
-        mDetectorOutFiles[id]->Write("", TObject::kOverwrite);
+        mDetectorOutFiles.at(id)->Write("", TObject::kOverwrite);
       }
+    };
+    const int nHelpers = std::min<int>(std::max(confref.getNMergerThreads(), 1), detIDs.size()) - 1;
+    std::vector<std::thread> helpers;
+    for (int i = 0; i < nHelpers; ++i) {
+      helpers.emplace_back(mergeDetectors);
     }
 
+    reorderAndMergeMCTRacks(subevents, *mOutTree, nprimaries, subevOrdered);
+    remapTrackIdsAndMerge<o2::TrackReference>("TrackRefs", &SubEventData::trackrefs, subevents, *mOutTree, trackoffsets, nprimaries, subevOrdered);
+
     // increase the entry count in the tree
     mOutTree->SetEntries(mOutTree->GetEntries() + 1);
     LOG(INFO) << "outtree has file " << mOutTree->GetDirectory()->GetFile()->GetName();
     mOutFile->Write("", TObject::kOverwrite);
 
-    cleanEvent(eventID);
+    // join the helpers in merging the remaining detectors
+    mergeDetectors();
+    for (auto& helper : helpers) {
+      helper.join();
+    }
 
     LOG(INFO) << "MERGING HITS TOOK " << timer.RealTime();
     return true;
@@ -758,10 +670,9 @@ class O2HitMerger : public FairMQDevice
   std::unordered_map<int, TTree*> mDetectorToTTreeMap; //! the trees
 
   // intermediate structures to collect data per event
-  std::unordered_map<int, TTree*> mEventToTTreeMap;       //! in memory trees to collect / presort incoming data per event
-  std::unordered_map<int, TMemFile*> mEventToTMemFileMap; //! files associated to the TTrees
-  std::thread mMergerIOThread;                            //! a thread used to do hit merging and IO flushing asynchronously
-  std::mutex mMapsMtx;                                    //!
+  std::unordered_map<int, std::vector<SubEventData>> mEventToSubEvents; //! sub-events collected in memory per event
+  std::thread mMergerIOThread;                                          //! a thread used to do hit merging and IO flushing asynchronously
+  std::mutex mMapsMtx;                                                  //!
   int mEntries = 0;         //! counts the number of entries in the branches
   int mEventChecksum = 0;   //! checksum for events
   int mNExpectedEvents = 0; //! number of events that we expect to receive
@@ -38,6 +38,9 @@
 #include <fstream>
 #include <iostream>
 #include <atomic>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include "PrimaryServerState.h"
 #include "SimPublishChannelHelper.h"
 #include <chrono>
@@ -57,9 +60,7 @@ class O2PrimaryServerDevice final : public FairMQDevice
   ~O2PrimaryServerDevice() final
   {
     try {
-      if (mGeneratorThread.joinable()) {
-        mGeneratorThread.join();
-      }
+      stopGeneration();
       if (mControlThread.joinable()) {
         mControlThread.join();
       }
@@ -68,6 +69,13 @@ class O2PrimaryServerDevice final : public FairMQDevice
   }
 
  protected:
+  // an event generated in advance, already split into the serialized primary chunks sent to the workers
+  struct PrefetchedEvent {
+    int eventID = 0;
+    std::vector<std::unique_ptr<TMessage>> chunks;
+    size_t bytes = 0;
+  };
+
   void initGenerator()
   {
     TStopwatch timer;
@@ -114,9 +122,6 @@ class O2PrimaryServerDevice final : public FairMQDevice
     mPrimGen->SetEvent(&mEventHeader);
 
     LOG(INFO) << "Generator initialization took " << timer.CpuTime() << "s";
-    if (mMaxEvents > 0) {
-      generateEvent(); // generate a first event
-    }
   }
 
   // function generating one event
@@ -143,6 +148,124 @@ class O2PrimaryServerDevice final : public FairMQDevice
     }
   }
 
+  // splits the event on the stack into the serialized primary chunks served to the workers
+  void chunkEvent(PrefetchedEvent& event)
+  {
+    auto& prims = mStack->getPrimaries();
+    auto numberofparts = (int)std::ceil(prims.size() / (1. * mChunkGranularity));
+    // number of parts should be at least 1 (even if empty)
+    numberofparts = std::max(1, numberofparts);
+
+    for (int part = 0; part < numberofparts; ++part) {
+      o2::data::PrimaryChunk m;
+      o2::data::SubEventInfo i;
+      i.eventID = event.eventID;
+      i.maxEvents = mMaxEvents;
+      i.part = part + 1;
+      i.nparts = numberofparts;
+      i.seed = event.eventID + mInitialSeed;
+      i.index = m.mParticles.size();
+      i.mMCEventHeader = mEventHeader;
+      m.mSubEventInfo = i;
+
+      int endindex = std::max(0, (int)prims.size() - part * mChunkGranularity);
+      int startindex = std::max(0, (int)prims.size() - (part + 1) * mChunkGranularity);
+      for (int index = startindex; index < endindex; ++index) {
+        m.mParticles.emplace_back(prims[index]);
+      }
+
+      auto tmsg = std::make_unique<TMessage>(kMESS_OBJECT);
+      tmsg->WriteObjectAny((void*)&m, TClass::GetClass("o2::data::PrimaryChunk"));
+      event.bytes += tmsg->BufferSize();
+      event.chunks.emplace_back(std::move(tmsg));
+    }
+  }
+
+  // the loop of the generator thread: keeps the prefetch queue filled with events ready to be served,
+  // pausing while the queue holds the configured number of events or amount of memory
+  void generationLoop()
+  {
+    const auto& conf = mSimConfig;
+    const size_t maxEvents = std::max(1, conf.getNPrefetchEvents());
+    const size_t maxBytes = size_t(std::max(1, conf.getPrefetchMemory())) << 20;
+    while (true) {
+      PrefetchedEvent event;
+      {
+        std::unique_lock<std::mutex> lock(mQueueMtx);
+        // at least one event is always allowed in the queue, even if above the memory limit
+        mQueueCV.wait(lock, [&]() { return mStopGeneration || mEventQueue.empty() || (mEventQueue.size() < maxEvents && mQueuedBytes < maxBytes); });
+        if (mStopGeneration || mGeneratedEvents >= mMaxEvents) {
+          break;
+        }
+        event.eventID = ++mGeneratedEvents;
+      }
+      generateEvent();
+      chunkEvent(event);
+      {
+        std::lock_guard<std::mutex> lock(mQueueMtx);
+        LOG(INFO) << "Prefetched event " << event.eventID << " in " << event.chunks.size() << " parts, "
+                  << mEventQueue.size() + 1 << " events queued";
+        mQueuedBytes += event.bytes;
+        mEventQueue.emplace_back(std::move(event));
+      }
+      mQueueCV.notify_all();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mQueueMtx);
+      mGenerationDone = true;
+    }
+    mQueueCV.notify_all();
+  }
+
+  // starts the asynchronous generation of the events to be served
+  void startGeneration()
+  {
+    stopGeneration();
+    {
+      std::lock_guard<std::mutex> lock(mQueueMtx);
+      mEventQueue.clear();
+      mQueuedBytes = 0;
+      mGeneratedEvents = 0;
+      mStopGeneration = false;
+      mGenerationDone = false;
+    }
+    mGeneratorThread = std::thread(&O2PrimaryServerDevice::generationLoop, this);
+  }
+
+  // stops the asynchronous generation (after the event being generated)
+  void stopGeneration()
+  {
+    {
+      std::lock_guard<std::mutex> lock(mQueueMtx);
+      mStopGeneration = true;
+    }
+    mQueueCV.notify_all();
+    if (mGeneratorThread.joinable()) {
+      mGeneratorThread.join();
+    }
+  }
+
+  // takes the next event from the prefetch queue, waiting for it if needed
+  // returns false if no event will come
+  bool popEvent()
+  {
+    {
+      std::unique_lock<std::mutex> lock(mQueueMtx);
+      if (mEventQueue.empty()) {
+        LOG(INFO) << "Waiting for event generation";
+      }
+      mQueueCV.wait(lock, [this]() { return !mEventQueue.empty() || mGenerationDone; });
+      if (mEventQueue.empty()) {
+        return false;
+      }
+      mCurrentEvent = std::move(mEventQueue.front());
+      mEventQueue.pop_front();
+      mQueuedBytes -= mCurrentEvent.bytes;
+    }
+    mQueueCV.notify_all();
+    return true;
+  }
+
   // launches a thread that listens for status requests from outside asynchronously
   void launchInfoThread()
   {
@@ -232,6 +355,10 @@ class O2PrimaryServerDevice final : public FairMQDevice
     if (mGeneratorThread.joinable()) {
       mGeneratorThread.join();
     }
+    // start filling the prefetch queue
+    if (mMaxEvents > 0) {
+      startGeneration();
+    }
 
     // init pipe
     auto pipeenv = getenv("ALICE_O2SIMSERVERTODRIVER_PIPE");
@@ -270,6 +397,7 @@ class O2PrimaryServerDevice final : public FairMQDevice
     o2::conf::ConfigurableParam::updateFromString(reconfig.keyValueTokens);
 
     // initial initial seed --> we should store this somewhere
+    stopGeneration();
     mInitialSeed = reconfig.startSeed;
     mInitialSeed = o2::utils::RngHelper::setGRandomSeed(mInitialSeed);
     LOG(INFO) << "RNG INITIAL SEED " << mInitialSeed;
@@ -285,15 +413,15 @@ class O2PrimaryServerDevice final : public FairMQDevice
     mEventCounter = 0;
     mPartCounter = 0;
     mNeedNewEvent = true;
-    // reinit generator and start generation of a new event
-    if (mGeneratorThread.joinable()) {
-      mGeneratorThread.join();
-    }
+    // reinit generator and start generation of new events
     mGeneratorThread = std::thread(&O2PrimaryServerDevice::initGenerator, this);
     // initGenerator();
     if (mGeneratorThread.joinable()) {
       mGeneratorThread.join();
     }
+    if (mMaxEvents > 0) {
+      startGeneration();
+    }
 
     return true;
   }
@@ -392,65 +520,33 @@ class O2PrimaryServerDevice final : public FairMQDevice
       workavailable = false;
     }
 
-    PrimaryChunkAnswer header{mState, workavailable};
-    FairMQParts reply;
-    std::unique_ptr<FairMQMessage> headermsg(channel.NewSimpleMessage(header));
-    reply.AddPart(std::move(headermsg));
-
     LOG(INFO) << "Received request for work " << mEventCounter << " " << mMaxEvents << " " << mNeedNewEvent << " available " << workavailable;
-    if (mNeedNewEvent) {
-      // we need a newly generated event now
-      if (mGeneratorThread.joinable()) {
-        try {
-          mGeneratorThread.join();
-        } catch (std::exception const& e) {
-          LOG(WARN) << "Exception during thread join ..ignoring";
-        }
+    if (mNeedNewEvent && workavailable) {
+      // we need a newly generated event now, it is taken from the prefetch queue
+      if (popEvent()) {
+        mNeedNewEvent = false;
+        mPartCounter = 0;
+        mEventCounter++;
+      } else {
+        LOG(WARN) << "No more events from the generator";
+        workavailable = false;
       }
-      mNeedNewEvent = false;
-      mPartCounter = 0;
-      mEventCounter++;
     }
 
-    auto& prims = mStack->getPrimaries();
-    auto numberofparts = (int)std::ceil(prims.size() / (1. * mChunkGranularity));
-    // number of parts should be at least 1 (even if empty)
-    numberofparts = std::max(1, numberofparts);
-
-    LOG(INFO) << "Have " << prims.size() << " " << numberofparts;
-
-    o2::data::PrimaryChunk m;
-    o2::data::SubEventInfo i;
-    i.eventID = workavailable ? mEventCounter : -1;
-    i.maxEvents = mMaxEvents;
-    i.part = mPartCounter + 1;
-    i.nparts = numberofparts;
-    i.seed = mEventCounter + mInitialSeed;
-    i.index = m.mParticles.size();
-    i.mMCEventHeader = mEventHeader;
-    m.mSubEventInfo = i;
+    PrimaryChunkAnswer header{mState, workavailable};
+    FairMQParts reply;
+    std::unique_ptr<FairMQMessage> headermsg(channel.NewSimpleMessage(header));
+    reply.AddPart(std::move(headermsg));
 
     if (workavailable) {
-      int endindex = prims.size() - mPartCounter * mChunkGranularity;
-      int startindex = prims.size() - (mPartCounter + 1) * mChunkGranularity;
-      LOG(INFO) << "indices " << startindex << " " << endindex;
+      // the chunks were serialized when the event was prefetched
+      auto numberofparts = (int)mCurrentEvent.chunks.size();
+      auto tmsg = mCurrentEvent.chunks[mPartCounter].release();
 
-      if (startindex < 0) {
-        startindex = 0;
-      }
-      if (endindex < 0) {
-        endindex = 0;
-      }
-
-      for (int index = startindex; index < endindex; ++index) {
-        m.mParticles.emplace_back(prims[index]);
-      }
-
-      LOG(INFO) << "Sending " << m.mParticles.size() << " particles";
-      LOG(INFO) << "treating ev " << mEventCounter << " part " << i.part << " out of " << i.nparts;
+      LOG(INFO) << "treating ev " << mCurrentEvent.eventID << " part " << mPartCounter + 1 << " out of " << numberofparts;
 
       // feedback to driver if new event started
-      if (mPipeToDriver != -1 && i.part == 1 && workavailable) {
+      if (mPipeToDriver != -1 && mPartCounter == 0) {
         if (write(mPipeToDriver, &mEventCounter, sizeof(mEventCounter))) {
         }
       }
@@ -458,13 +554,8 @@ class O2PrimaryServerDevice final : public FairMQDevice
       mPartCounter++;
       if (mPartCounter == numberofparts) {
         mNeedNewEvent = true;
-        // start generation of a new event
-        mGeneratorThread = std::thread(&O2PrimaryServerDevice::generateEvent, this);
       }
 
-      TMessage* tmsg = new TMessage(kMESS_OBJECT);
-      tmsg->WriteObjectAny((void*)&m, TClass::GetClass("o2::data::PrimaryChunk"));
-
       auto free_tmessage = [](void* data, void* hint) { delete static_cast<TMessage*>(hint); };
 
       std::unique_ptr<FairMQMessage> message(channel.NewMessage(tmsg->Buffer(), tmsg->BufferSize(), free_tmessage, tmsg));
@@ -555,6 +646,16 @@ class O2PrimaryServerDevice final : public FairMQDevice
 
   std::thread mGeneratorThread; //! a thread used to concurrently init the particle generator
                                 //  or to generate events
+
+  // prefetch queue of generated events, filled by the generator thread
+  std::deque<PrefetchedEvent> mEventQueue; //! events ready to be served
+  PrefetchedEvent mCurrentEvent;           //! the event being served
+  std::mutex mQueueMtx;                    //! protects the queue and the generation state
+  std::condition_variable mQueueCV;        //! signals changes of the queue and the generation state
+  size_t mQueuedBytes = 0;                 //! size of the serialized chunks in the queue
+  int mGeneratedEvents = 0;                //! number of events generated so far
+  bool mStopGeneration = false;            //! request to the generator thread to stop
+  bool mGenerationDone = true;             //! the generator thread finished
   std::thread mControlThread;   //! a thread used to wait for control commands
 
   // Keeps various generators instantiated in memory